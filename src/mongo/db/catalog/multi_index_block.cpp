@@ -33,6 +33,7 @@
 
 #include "mongo/db/catalog/multi_index_block.h"
 
+#include <algorithm>
 #include <ostream>
 
 #include "mongo/base/error_codes.h"
@@ -207,10 +208,13 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
         std::vector<BSONObj> indexInfoObjs;
         indexInfoObjs.reserve(indexSpecs.size());
         std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
+        std::size_t eachIndexBuildSortParallelism = 1;
         if (!indexSpecs.empty()) {
             eachIndexBuildMaxMemoryUsageBytes =
                 static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
                 indexSpecs.size();
+            eachIndexBuildSortParallelism = std::max<std::size_t>(
+                1, static_cast<std::size_t>(maxIndexBuildSortParallelism.load()) / indexSpecs.size());
         }
 
         for (size_t i = 0; i < indexSpecs.size(); i++) {
@@ -249,7 +253,8 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
             if (!status.isOK())
                 return status;
 
-            index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
+            index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes,
+                                                  eachIndexBuildSortParallelism);
 
             const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
 
@@ -40,7 +40,11 @@
 namespace mongo {
 namespace {
 
-const int kMaxPerfThreads = 16;  // max number of threads to use for lock perf
+const int kMaxPerfThreads = 128;  // max number of threads to use for lock perf
+
+// In benchmarks which mix intent and conflicting locks, how often thread 0 takes the conflicting
+// lock instead of the intent one.
+const int kConflictingLockInterval = 1000;
 
 
 class DConcurrencyTest : public benchmark::Fixture {
@@ -128,6 +132,30 @@ BENCHMARK_DEFINE_F(DConcurrencyTest, BM_CollectionIntentExclusiveLock)(benchmark
     }
 }
 
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_CollectionIntentExclusiveLockWithConflicts)
+(benchmark::State& state) {
+    std::unique_ptr<ForceSupportsDocLocking> supportDocLocking;
+
+    if (state.thread_index == 0) {
+        makeKClientsWithLockers(state.threads);
+        supportDocLocking = std::make_unique<ForceSupportsDocLocking>(true);
+    }
+
+    int iteration = 0;
+    for (auto keepRunning : state) {
+        const bool conflicting =
+            state.thread_index == 0 && ++iteration % kConflictingLockInterval == 0;
+        Lock::DBLock dlk(clients[state.thread_index].second.get(), "test", MODE_IX);
+        Lock::CollectionLock clk(clients[state.thread_index].second.get(),
+                                 NamespaceString("test.coll"),
+                                 conflicting ? MODE_X : MODE_IX);
+    }
+
+    if (state.thread_index == 0) {
+        clients.clear();
+    }
+}
+
 BENCHMARK_DEFINE_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)(benchmark::State& state) {
     std::unique_ptr<ForceSupportsDocLocking> supportDocLocking;
 
@@ -175,6 +203,8 @@ BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentSharedLock)
     ->ThreadRange(1, kMaxPerfThreads);
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentExclusiveLock)
     ->ThreadRange(1, kMaxPerfThreads);
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentExclusiveLockWithConflicts)
+    ->ThreadRange(1, kMaxPerfThreads);
 
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)
     ->ThreadRange(1, kMaxPerfThreads);
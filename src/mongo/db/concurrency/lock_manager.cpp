@@ -45,6 +45,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/logv2/log.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/str.h"
 #include "mongo/util/timer.h"
@@ -129,8 +130,79 @@ static const char* LockRequestStatusNames[] = {
 MONGO_STATIC_ASSERT((sizeof(LockRequestStatusNames) / sizeof(LockRequestStatusNames[0])) ==
                     LockRequest::StatusCount);
 
+// Hands out fast path stripes to threads in round-robin order
+AtomicWord<unsigned> nextFastPathStripe{0};
+
 }  // namespace
 
+/**
+ * Grants the intent modes MODE_IS and MODE_IX on a single resource without taking any mutex. Every
+ * operation acquires the Global, RSTL, database and collection locks in intent modes, so even the
+ * short critical section of a PartitionedLockHead becomes a point of contention with many threads.
+ * Instead, each thread increments the counter for its mode in its own stripe of the slot, and
+ * threads on different stripes do not share any cache lines.
+ *
+ * A slot is claimed by a LockHead under its LockManager bucket mutex while the lock has no granted
+ * or pending conflicting modes. Before a conflicting mode is requested or granted, 'blocked' is set
+ * under the same mutex, which sends all subsequent intent requests to the regular LockHead queues.
+ * Requests already granted through the slot are not migrated: they keep conflicting with waiting
+ * requests until they are released, and every release while the slot is blocked re-evaluates the
+ * LockHead so that waiting requests can be granted.
+ *
+ * Acquisitions increment the counter before checking 'blocked', and conflicting requests set
+ * 'blocked' before reading the counters, so with sequentially consistent atomics at least one side
+ * always observes the other.
+ */
+struct FastPathLockSlot {
+    static constexpr unsigned kNumStripes = 32;
+
+    struct alignas(stdx::hardware_destructive_interference_size) Stripe {
+        // Indexed by the mode offset from MODE_IS
+        AtomicWord<int64_t> counts[2];
+    };
+
+    static unsigned stripeForCurrentThread() {
+        thread_local const unsigned stripe = nextFastPathStripe.fetchAndAdd(1) % kNumStripes;
+        return stripe;
+    }
+
+    AtomicWord<int64_t>& counter(unsigned stripe, LockMode mode) {
+        invariant(mode == MODE_IS || mode == MODE_IX);
+        return stripes[stripe].counts[mode - MODE_IS];
+    }
+
+    /**
+     * Bit-mask of the modes currently granted through this slot. May include requests which are
+     * about to back off after finding the slot blocked, which is harmless, because those notify
+     * the owning LockHead once they have released their count.
+     */
+    uint32_t grantedModes() const {
+        uint32_t modes = 0;
+        for (const auto& stripe : stripes) {
+            if (stripe.counts[MODE_IS - MODE_IS].load())
+                modes |= modeMask(MODE_IS);
+            if (stripe.counts[MODE_IX - MODE_IS].load())
+                modes |= modeMask(MODE_IX);
+        }
+        return modes;
+    }
+
+    // Full hash of the resource which owns this slot, or zero if the slot is free. Claimed with a
+    // compare-and-swap, since resources sharing a slot may be in different buckets, and released
+    // under the bucket mutex of the owning resource.
+    AtomicWord<uint64_t> resourceId{0};
+
+    // LockHead of the resource which owns this slot. Protected by the bucket mutex of the owning
+    // resource, so it may only be read after checking 'resourceId' under that mutex.
+    LockHead* owner = nullptr;
+
+    // When set, no new requests are granted through this slot. Written under the bucket mutex of
+    // the owning resource.
+    AtomicWord<bool> blocked{true};
+
+    Stripe stripes[kNumStripes];
+};
+
 /**
  * There is one of these objects for each resource that has a lock request. Empty objects (i.e.
  * LockHead with no requests) are allowed to exist on the lock manager's hash table.
@@ -159,6 +231,8 @@ struct LockHead {
 
         conversionsCount = 0;
         compatibleFirstCount = 0;
+
+        fastPath = nullptr;
     }
 
     /**
@@ -168,6 +242,53 @@ struct LockHead {
         return !partitions.empty();
     }
 
+    /**
+     * Bit-mask of the modes granted through the fast path slot of this lock. These must be taken
+     * into account, in addition to grantedModes, whenever checking for conflicts.
+     */
+    uint32_t fastPathModes() const {
+        return fastPath ? fastPath->grantedModes() : 0;
+    }
+
+    /**
+     * Stops granting requests through the fast path slot of this lock. Must be called before
+     * requesting a mode that conflicts with the intent modes.
+     */
+    void blockFastPath() {
+        if (fastPath) {
+            fastPath->blocked.store(true);
+        }
+    }
+
+    /**
+     * Resumes granting requests through the fast path slot of this lock, if it no longer has any
+     * granted or pending modes that conflict with the intent modes.
+     */
+    void unblockFastPathIfUncontended() {
+        if (fastPath && !(grantedModes & ~intentModes) && !conflictModes) {
+            fastPath->blocked.store(false);
+        }
+    }
+
+    /**
+     * Moves a request granted through the fast path slot of this lock to the granted queue, so
+     * that its mode can be changed. The request stays granted, even if there are conflicting
+     * requests waiting.
+     */
+    void migrateFastPathRequest(LockRequest* request) {
+        invariant(request->fastPathSlot == fastPath);
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+
+        // Add to the granted queue before releasing the count, so that the mode stays accounted
+        // for at all times.
+        request->lock = this;
+        grantedList.push_back(request);
+        incGrantedModeCount(request->mode);
+
+        fastPath->counter(request->fastPathStripe, request->mode).fetchAndSubtract(1);
+        request->fastPathSlot = nullptr;
+    }
+
     /**
      * Locates the request corresponding to the particular locker or returns nullptr. Must be called
      * with the bucket holding this lock head locked.
@@ -202,9 +323,14 @@ struct LockHead {
         // access to that field is not protected. The 'partitioned' member instead indicates if a
         // request was initially partitioned.
 
+        // Requests granted through the fast path hold intent modes, so only check them for
+        // requests which conflict with those
+        const uint32_t allGrantedModes =
+            grantedModes | (conflicts(request->mode, intentModes) ? fastPathModes() : 0);
+
         // New lock request. Queue after all granted modes and after any already requested
         // conflicting modes
-        if (conflicts(request->mode, grantedModes) ||
+        if (conflicts(request->mode, allGrantedModes) ||
             (!compatibleFirstCount && conflicts(request->mode, conflictModes))) {
             request->status = LockRequest::STATUS_WAITING;
 
@@ -316,6 +442,10 @@ struct LockHead {
     // TODO: Remove this vector and make LockHead a POD
     std::vector<LockManager::Partition*> partitions;
 
+    // Fast path slot owned by this lock, or null if it does not own one. While set, the slot's
+    // resourceId is this lock's resourceId and this LockHead is not deleted.
+    FastPathLockSlot* fastPath;
+
     //
     // Conversion
     //
@@ -417,6 +547,10 @@ const unsigned LockManager::_numLockBuckets(128);
 // The exact value doesn't appear very important, but should be power of two
 const unsigned LockManager::_numPartitions = 32;
 
+// Only a handful of resources are locked by nearly every operation, but the slots are
+// direct-mapped, so have enough of them to make collisions between those unlikely.
+const unsigned LockManager::_numFastPathSlots = 64;
+
 // static
 std::map<LockerId, BSONObj> LockManager::getLockToClientMap(ServiceContext* serviceContext) {
     std::map<LockerId, BSONObj> lockToClientMap;
@@ -446,6 +580,7 @@ std::map<LockerId, BSONObj> LockManager::getLockToClientMap(ServiceContext* serv
 LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
+    _fastPathSlots = new FastPathLockSlot[_numFastPathSlots];
 }
 
 LockManager::~LockManager() {
@@ -458,6 +593,7 @@ LockManager::~LockManager() {
 
     delete[] _lockBuckets;
     delete[] _partitions;
+    delete[] _fastPathSlots;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -468,8 +604,12 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
 
-    // For intent modes, try the PartitionedLockHead
+    // For intent modes, try the fast path slot first and then the PartitionedLockHead
     if (request->partitioned) {
+        if (_tryLockFastPath(resId, request)) {
+            return LOCK_OK;
+        }
+
         Partition* partition = _getPartition(request);
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
 
@@ -491,8 +631,12 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     LockHead* lock = bucket->findOrInsert(resId);
 
-    // Start a partitioned lock if possible
+    // Use the fast path slot or start a partitioned lock if possible
     if (request->partitioned && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
+        if (_lockFastPath(lock, request)) {
+            return LOCK_OK;
+        }
+
         Partition* partition = _getPartition(request);
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
         PartitionedLockHead* partitionedLock = partition->findOrInsert(resId);
@@ -507,6 +651,10 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
         lock->migratePartitionedLockHeads();
     }
 
+    if (!(modeMask(mode) & intentModes)) {
+        lock->blockFastPath();
+    }
+
     request->partitioned = false;
     return lock->newRequest(request);
 }
@@ -546,9 +694,17 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
         lock->migratePartitionedLockHeads();
     }
 
+    if (request->fastPathSlot) {
+        lock->migrateFastPathRequest(request);
+    }
+
+    if (!(modeMask(newMode) & intentModes)) {
+        lock->blockFastPath();
+    }
+
     // Construct granted mask without our current mode, so that it is not counted as
     // conflicting
-    uint32_t grantedModesWithoutCurrentRequest = 0;
+    uint32_t grantedModesWithoutCurrentRequest = lock->fastPathModes();
 
     // We start the counting at 1 below, because LockModesCount also includes MODE_NONE
     // at position 0, which can never be acquired/granted.
@@ -596,6 +752,14 @@ bool LockManager::unlock(LockRequest* request) {
         return false;
     }
 
+    if (request->fastPathSlot) {
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        FastPathLockSlot* const slot = request->fastPathSlot;
+        request->fastPathSlot = nullptr;
+        _unlockFastPath(slot, request->fastPathStripe, request->mode);
+        return true;
+    }
+
     if (request->partitioned) {
         // Unlocking a lock that was acquired as partitioned. The lock request may since have
         // moved to the lock head, but there is no safe way to find out without synchronizing
@@ -666,7 +830,7 @@ bool LockManager::unlock(LockRequest* request) {
 }
 
 void LockManager::downgrade(LockRequest* request, LockMode newMode) {
-    invariant(request->lock);
+    invariant(request->lock || request->fastPathSlot);
     invariant(request->status == LockRequest::STATUS_GRANTED);
     invariant(request->recursiveCount > 0);
 
@@ -675,6 +839,18 @@ void LockManager::downgrade(LockRequest* request, LockMode newMode) {
     invariant((LockConflictsTable[request->mode] | LockConflictsTable[newMode]) ==
               LockConflictsTable[request->mode]);
 
+    if (request->fastPathSlot) {
+        // Both modes are intent modes, so only move the grant between the counters of the slot
+        if (newMode != request->mode) {
+            FastPathLockSlot* const slot = request->fastPathSlot;
+            const LockMode oldMode = request->mode;
+            slot->counter(request->fastPathStripe, newMode).fetchAndAdd(1);
+            request->mode = newMode;
+            _unlockFastPath(slot, request->fastPathStripe, oldMode);
+        }
+        return;
+    }
+
     LockHead* lock = request->lock;
 
     LockBucket* bucket = _getBucket(lock->resourceId);
@@ -705,7 +881,21 @@ void LockManager::_cleanupUnusedLocksInBucket(LockBucket* bucket) {
             lock->migratePartitionedLockHeads();
         }
 
-        if (lock->grantedModes == 0) {
+        // The fast path slot can only be freed once no request is counted in it, and blocking it
+        // first guarantees that none will be while it is being freed
+        if (lock->fastPath && lock->grantedModes == 0 && lock->conflictModes == 0) {
+            FastPathLockSlot* const slot = lock->fastPath;
+            slot->blocked.store(true);
+            if (slot->grantedModes() == 0) {
+                slot->owner = nullptr;
+                slot->resourceId.store(0);
+                lock->fastPath = nullptr;
+            } else {
+                lock->unblockFastPathIfUncontended();
+            }
+        }
+
+        if (lock->grantedModes == 0 && !lock->fastPath) {
             invariant(lock->grantedModes == 0);
             invariant(lock->grantedList._front == nullptr);
             invariant(lock->grantedList._back == nullptr);
@@ -725,6 +915,13 @@ void LockManager::_cleanupUnusedLocksInBucket(LockBucket* bucket) {
 }
 
 void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
+    // Requests granted through the fast path conflict with waiting requests just like the ones on
+    // the granted queue. Only read the slot's counters if there is anything waiting.
+    const uint32_t fastPathModes =
+        (lock->conversionsCount > 0 || (checkConflictQueue && lock->conflictModes))
+        ? lock->fastPathModes()
+        : 0;
+
     // Unblock any converting requests (because conversions are still counted as granted and
     // are on the granted queue).
     for (LockRequest* iter = lock->grantedList._front;
@@ -736,7 +933,7 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
 
             // Construct granted mask without our current mode, so that it is not accounted as
             // a conflict
-            uint32_t grantedModesWithoutCurrentRequest = 0;
+            uint32_t grantedModesWithoutCurrentRequest = fastPathModes;
 
             // We start the counting at 1 below, because LockModesCount also includes
             // MODE_NONE at position 0, which can never be acquired/granted.
@@ -794,7 +991,7 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         // the granted queue.
         iterNext = iter->next;
 
-        if (conflicts(iter->mode, lock->grantedModes)) {
+        if (conflicts(iter->mode, lock->grantedModes | fastPathModes)) {
             // If iter doesn't have a previous pointer, this means that it is at the front of the
             // queue. If we continue scanning the queue beyond this point, we will starve it by
             // granting more and more requests. However, if we newly transition to compatibleFirst
@@ -828,6 +1025,8 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         }
     }
 
+    lock->unblockFastPathIfUncontended();
+
     // This is a convenient place to check that the state of the two request queues is in sync
     // with the bitmask on the modes.
     invariant((lock->grantedModes == 0) ^ (lock->grantedList._front != nullptr));
@@ -842,6 +1041,91 @@ LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
+FastPathLockSlot* LockManager::_getFastPathSlot(ResourceId resId) const {
+    return &_fastPathSlots[resId % _numFastPathSlots];
+}
+
+bool LockManager::_tryLockFastPath(ResourceId resId, LockRequest* request) {
+    FastPathLockSlot* const slot = _getFastPathSlot(resId);
+    if (slot->resourceId.load() != resId || slot->blocked.load()) {
+        return false;
+    }
+
+    const unsigned stripe = FastPathLockSlot::stripeForCurrentThread();
+    AtomicWord<int64_t>& counter = slot->counter(stripe, request->mode);
+    counter.fetchAndAdd(1);
+
+    // The slot may have been blocked or changed owner since it was checked above. A conflicting
+    // request blocks the slot before reading the counters, so if it is still not blocked now, the
+    // conflicting request will see this grant.
+    if (slot->resourceId.load() != resId || slot->blocked.load()) {
+        _unlockFastPath(slot, stripe, request->mode);
+        return false;
+    }
+
+    request->partitioned = false;
+    request->fastPathSlot = slot;
+    request->fastPathStripe = stripe;
+    request->status = LockRequest::STATUS_GRANTED;
+    return true;
+}
+
+bool LockManager::_lockFastPath(LockHead* lock, LockRequest* request) {
+    if (!lock->fastPath) {
+        // Resources which map to the same slot may live in different buckets, so only the bucket
+        // mutex of this resource is held here. Claim the slot atomically so that at most one
+        // resource can own it.
+        FastPathLockSlot* const slot = _getFastPathSlot(lock->resourceId);
+        uint64_t freeSlot = 0;
+        if (!slot->resourceId.compareAndSwap(&freeSlot, lock->resourceId)) {
+            return false;
+        }
+
+        // A free slot stays blocked until it is claimed, and nothing can be counted in it before
+        // it is unblocked below. Anyone who reads 'owner' first takes this resource's bucket
+        // mutex, which is held until the claim is complete.
+        slot->owner = lock;
+        lock->fastPath = slot;
+    }
+
+    // The caller checked that there are no conflicting modes, so the slot may be used even if the
+    // last conflicting request has not unblocked it yet
+    lock->fastPath->blocked.store(false);
+
+    const unsigned stripe = FastPathLockSlot::stripeForCurrentThread();
+    lock->fastPath->counter(stripe, request->mode).fetchAndAdd(1);
+
+    request->partitioned = false;
+    request->fastPathSlot = lock->fastPath;
+    request->fastPathStripe = stripe;
+    request->status = LockRequest::STATUS_GRANTED;
+    return true;
+}
+
+void LockManager::_unlockFastPath(FastPathLockSlot* slot, unsigned stripe, LockMode mode) {
+    slot->counter(stripe, mode).fetchAndSubtract(1);
+
+    // A request which conflicts with this one blocks the slot before reading the counters, so if
+    // the slot is not blocked now, there cannot be anyone waiting for this release.
+    if (!slot->blocked.load()) {
+        return;
+    }
+
+    // The slot may have changed owner in the meantime, which is only a problem if a request for
+    // the new owner saw this count before it was released. Such a request waits with the slot
+    // blocked, which also prevents the owner from changing again, so notify the current owner.
+    const uint64_t resId = slot->resourceId.load();
+    if (resId == 0) {
+        return;
+    }
+
+    LockBucket* bucket = &_lockBuckets[resId % _numLockBuckets];
+    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+    if (slot->resourceId.load() == resId) {
+        _onLockModeChanged(slot->owner, true);
+    }
+}
+
 void LockManager::dump() const {
     BSONArrayBuilder locks;
     _buildLocksArray(getLockToClientMap(getGlobalServiceContext()), true, nullptr, &locks);
@@ -976,6 +1260,8 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
 
     lock = nullptr;
     partitionedLock = nullptr;
+    fastPathSlot = nullptr;
+    fastPathStripe = 0;
     prev = nullptr;
     next = nullptr;
     status = STATUS_NEW;
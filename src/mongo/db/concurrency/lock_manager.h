@@ -187,6 +187,37 @@ private:
      */
     Partition* _getPartition(LockRequest* request) const;
 
+    /**
+     * Retrieves the fast path slot that intent requests for the resource may use. The slot may
+     * currently be free or owned by some other resource.
+     */
+    FastPathLockSlot* _getFastPathSlot(ResourceId resId) const;
+
+    /**
+     * Attempts to grant an intent mode request through the fast path slot of 'resId' without
+     * taking any mutex. Returns false if the slot is not owned by 'resId' or if it is blocked by a
+     * conflicting request, in which case the regular path must be used.
+     */
+    bool _tryLockFastPath(ResourceId resId, LockRequest* request);
+
+    /**
+     * Grants an intent mode request through the fast path slot of 'lock', claiming the slot first
+     * if it is free. Returns false if the slot is owned by some other resource.
+     *
+     * MUST be called under the lock bucket's mutex, and only when the lock has no granted or
+     * pending modes that conflict with intent modes.
+     */
+    bool _lockFastPath(LockHead* lock, LockRequest* request);
+
+    /**
+     * Releases one grant previously counted in 'stripe' of 'slot' for 'mode'. If the slot is
+     * blocked, a conflicting request may be waiting for the counters to drain, so the owning
+     * LockHead is re-evaluated under its bucket's mutex.
+     *
+     * Must NOT be called under any lock bucket's mutex.
+     */
+    void _unlockFastPath(FastPathLockSlot* slot, unsigned stripe, LockMode mode);
+
     /**
      * The backend of `dump` and `getLockInfoBSON`.
      * If `mutableThis`, then we also clean the unused locks in the buckets while iterating.
@@ -221,5 +252,8 @@ private:
 
     static const unsigned _numPartitions;
     Partition* _partitions;
+
+    static const unsigned _numFastPathSlots;
+    FastPathLockSlot* _fastPathSlots;
 };
 }  // namespace mongo
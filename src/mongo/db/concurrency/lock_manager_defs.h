@@ -46,6 +46,7 @@ namespace mongo {
 
 class Locker;
 
+struct FastPathLockSlot;
 struct LockHead;
 struct PartitionedLockHead;
 
@@ -426,6 +427,17 @@ struct LockRequest {
     // Protected by LockHead bucket's mutex
     PartitionedLockHead* partitionedLock;
 
+    // Pointer to the fast path slot through which this request was granted, or null if it was not.
+    // Such a request is on neither 'lock' nor 'partitionedLock' and is only accounted for by the
+    // counter for its mode in stripe 'fastPathStripe' of the slot. A request leaves the fast path
+    // when it is unlocked, converted or downgraded, never the other way around.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    FastPathLockSlot* fastPathSlot;
+    unsigned fastPathStripe;
+
     // The linked list chain on which this request hangs off the owning lock head. The reason
     // intrusive linked list is used instead of the std::list class is to allow for entries to be
     // removed from the middle of the list in O(1) time, if they are known instead of having to
@@ -29,6 +29,8 @@
 
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -952,4 +954,163 @@ TEST(LockManager, Fairness) {
     ASSERT(lockMgr.unlock(&requestIX1));
 }
 
+TEST(LockManager, IntentLocksWaitedOnByConflictingLock) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    // Uncontended intent locks are granted without going through the lock head
+    LockerImpl lockerIS;
+    LockRequestCombo requestIS(&lockerIS);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS, MODE_IS));
+
+    LockerImpl lockerIX;
+    LockRequestCombo requestIX(&lockerIX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+
+    LockerImpl lockerS;
+    LockRequestCombo requestS(&lockerS);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestS, MODE_S));
+
+    // Conflicting intent locks requested after S must queue behind it
+    LockerImpl lockerIX1;
+    LockRequestCombo requestIX1(&lockerIX1);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestIX1, MODE_IX));
+
+    // Releasing the compatible intent lock doesn't unblock S, but releasing the last IX does
+    ASSERT(lockMgr.unlock(&requestIS));
+    ASSERT_EQ(0, requestS.numNotifies);
+    ASSERT(lockMgr.unlock(&requestIX));
+    ASSERT_EQ(LOCK_OK, requestS.lastResult);
+    ASSERT_EQ(1, requestS.numNotifies);
+    ASSERT_EQ(0, requestIX1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestS));
+    ASSERT_EQ(LOCK_OK, requestIX1.lastResult);
+    ASSERT_EQ(1, requestIX1.numNotifies);
+    ASSERT(lockMgr.unlock(&requestIX1));
+
+    // Once the conflicting lock is gone, intent locks are granted right away again
+    LockerImpl lockerIX2;
+    LockRequestCombo requestIX2(&lockerIX2);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX2, MODE_IX));
+    ASSERT(lockMgr.unlock(&requestIX2));
+}
+
+TEST(LockManager, ConvertAndDowngradeUncontendedIntentLocks) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IX));
+
+    LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request2, MODE_IX));
+
+    // The conversion must wait for the other intent lock
+    ASSERT(LOCK_WAITING == lockMgr.convert(resId, &request1, MODE_X));
+    ASSERT(request1.status == LockRequest::STATUS_CONVERTING);
+
+    // Downgrading the other intent lock doesn't unblock the conversion, but releasing it does
+    lockMgr.downgrade(&request2, MODE_IS);
+    ASSERT(request2.mode == MODE_IS);
+    ASSERT_EQ(0, request1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT_EQ(LOCK_OK, request1.lastResult);
+    ASSERT_EQ(1, request1.numNotifies);
+    ASSERT(request1.mode == MODE_X);
+
+    // The conversion counts as a recursive acquisition
+    ASSERT(!lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+}
+
+TEST(LockManager, IntentLocksOnResourcesSharingFastPathSlot) {
+    LockManager lockMgr;
+
+    // Fast path slots are direct-mapped, so only one of these resources can use one
+    const ResourceId resId1(RESOURCE_COLLECTION, 1);
+    const ResourceId resId2(RESOURCE_COLLECTION, 1 + 1024);
+
+    LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId1, &request1, MODE_IX));
+
+    LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    ASSERT(LOCK_OK == lockMgr.lock(resId2, &request2, MODE_IX));
+
+    // Locks on each resource still conflict only with locks on the same resource
+    LockerImpl lockerX1;
+    LockRequestCombo requestX1(&lockerX1);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId1, &requestX1, MODE_X));
+
+    LockerImpl lockerX2;
+    LockRequestCombo requestX2(&lockerX2);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId2, &requestX2, MODE_X));
+
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT_EQ(0, requestX1.numNotifies);
+    ASSERT_EQ(1, requestX2.numNotifies);
+
+    ASSERT(lockMgr.unlock(&request1));
+    ASSERT_EQ(1, requestX1.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestX1));
+    ASSERT(lockMgr.unlock(&requestX2));
+}
+
+TEST(LockManager, ResourcesInDifferentBucketsSharingFastPathSlot) {
+    LockManager lockMgr;
+
+    // These map to the same fast path slot, but to different lock buckets, so their LockHeads try
+    // to claim the slot under different bucket mutexes
+    const ResourceId resIds[] = {ResourceId(RESOURCE_COLLECTION, 1),
+                                 ResourceId(RESOURCE_COLLECTION, 1 + 64)};
+
+    const int kIterations = 10000;
+    AtomicWord<int> failures{0};
+
+    auto lockAndUnlock = [&](ResourceId resId) {
+        LockerImpl lockerIX;
+        LockerImpl lockerX;
+        for (int i = 0; i < kIterations; ++i) {
+            LockRequestCombo requestIX(&lockerIX);
+            if (lockMgr.lock(resId, &requestIX, MODE_IX) != LOCK_OK) {
+                failures.fetchAndAdd(1);
+                return;
+            }
+
+            // X must wait for this resource's IX, and be granted as soon as it is released,
+            // whichever resource owns the slot
+            LockRequestCombo requestX(&lockerX);
+            if (lockMgr.lock(resId, &requestX, MODE_X) != LOCK_WAITING) {
+                failures.fetchAndAdd(1);
+                lockMgr.unlock(&requestX);
+                lockMgr.unlock(&requestIX);
+                return;
+            }
+
+            lockMgr.unlock(&requestIX);
+            if (requestX.numNotifies != 1 || requestX.lastResult != LOCK_OK) {
+                failures.fetchAndAdd(1);
+                return;
+            }
+            lockMgr.unlock(&requestX);
+
+            // Free the slot so that both resources race to claim it again
+            lockMgr.cleanupUnusedLocks();
+        }
+    };
+
+    stdx::thread thread0([&] { lockAndUnlock(resIds[0]); });
+    stdx::thread thread1([&] { lockAndUnlock(resIds[1]); });
+    thread0.join();
+    thread1.join();
+
+    ASSERT_EQ(0, failures.load());
+}
+
 }  // namespace mongo
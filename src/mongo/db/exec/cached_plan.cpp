@@ -300,6 +300,26 @@ PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     return child()->work(out);
 }
 
+PlanStage::StageState CachedPlanStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    // First exhaust any results buffered during the trial period.
+    if (!_results.empty()) {
+        while (!_results.empty() && out->size() < maxBatchSize) {
+            out->push_back(_results.front());
+            _results.pop();
+        }
+        recordAdvancedBatch(out->size());
+        return PlanStage::ADVANCED;
+    }
+
+    StageState state = child()->workBatch(maxBatchSize, out);
+    if (PlanStage::ADVANCED == state) {
+        recordAdvancedBatch(out->size());
+    } else {
+        recordWorkResult(state);
+    }
+    return state;
+}
+
 std::unique_ptr<PlanStageStats> CachedPlanStage::getStats() {
     _commonStats.isEOF = isEOF();
 
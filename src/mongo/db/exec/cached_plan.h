@@ -68,6 +68,10 @@ public:
 
     StageState doWork(WorkingSetID* out) final;
 
+    bool supportsBatchedExecution() const final {
+        return child()->supportsBatchedExecution();
+    }
+
     StageType stageType() const final {
         return STAGE_CACHED_PLAN;
     }
@@ -88,6 +92,9 @@ public:
      */
     Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
+protected:
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
+
 private:
     /**
      * Passes stats from the trial period run of the cached plan to the plan cache.
@@ -221,6 +221,104 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     return returnIfMatches(member, id, out);
 }
 
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    // Cursor creation, seeking and the oplog start hack are all handled by doWork(). Only a
+    // steady-state scan over an open cursor is batched. A result of doWork() may point into the
+    // cursor's buffer, so only one unit of work is done per call here.
+    if (_commonStats.isEOF || !_cursor || (_lastSeenId.isNull() && _params.minTs)) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        const StageState state = recordWorkResult(doWork(&id));
+        if (PlanStage::ADVANCED == state) {
+            out->push_back(id);
+            return state;
+        }
+        return endBatch(state, id, out);
+    }
+
+    // Read the whole block of records first, so that the filter can be applied to all of them at
+    // once. A filter which is dropped after its first match must see the documents one at a time.
+    const bool filterAsBatch = _filter && !_params.stopApplyingFilterAfterFirstMatch;
+    const auto snapshotId = opCtx()->recoveryUnit()->getSnapshotId();
+    boost::optional<StageState> stopState;
+
+    // Our caller has finished with the previous batch, so its records can be released.
+    _batchBuffer.clear();
+    _scannedIds.clear();
+    _matchBatch.clear();
+    while (_scannedIds.size() < maxBatchSize) {
+        boost::optional<Record> record;
+        try {
+            record = _cursor->next();
+        } catch (const WriteConflictException&) {
+            stopState = PlanStage::NEED_YIELD;
+            break;
+        }
+
+        if (!record) {
+            _commonStats.isEOF = true;
+            stopState = PlanStage::IS_EOF;
+            break;
+        }
+
+        _lastSeenId = record->id;
+
+        // The record may point into the cursor's buffer, which is reused by the next call to
+        // next() while this document is still waiting to be returned.
+        BSONObj obj = _batchBuffer.append(std::move(record->data));
+
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->recordId = record->id;
+        member->resetDocument(snapshotId, obj);
+        _workingSet->transitionToRecordIdAndObj(id);
+
+        _scannedIds.push_back(id);
+        if (filterAsBatch) {
+            _matchBatch.append(std::move(obj));
+        }
+    }
+
+    SelectionVector selection;
+    if (filterAsBatch) {
+        selection = _matchBatch.selectAll();
+        _filter->matchesBatch(&_matchBatch, &selection);
+    }
+
+    auto nextSelected = selection.begin();
+    for (size_t i = 0; i < _scannedIds.size(); ++i) {
+        const WorkingSetID id = _scannedIds[i];
+        WorkingSetMember* member = _workingSet->get(id);
+
+        WorkingSetID resultId = WorkingSet::INVALID_ID;
+        StageState state;
+        if (filterAsBatch) {
+            const bool passes = nextSelected != selection.end() && *nextSelected == i;
+            if (passes) {
+                ++nextSelected;
+            }
+            state = recordWorkResult(returnIfPasses(member, id, passes, &resultId));
+        } else {
+            state = recordWorkResult(returnIfMatches(member, id, &resultId));
+        }
+
+        if (PlanStage::ADVANCED == state) {
+            out->push_back(resultId);
+        } else if (PlanStage::IS_EOF == state) {
+            // The end condition was met, so nothing read after this document is returned.
+            for (size_t j = i + 1; j < _scannedIds.size(); ++j) {
+                _workingSet->free(_scannedIds[j]);
+            }
+            return endBatch(state, resultId, out);
+        }
+    }
+
+    if (stopState) {
+        recordWorkResult(*stopState);
+        return endBatch(*stopState, WorkingSet::INVALID_ID, out);
+    }
+    return out->empty() ? PlanStage::NEED_TIME : PlanStage::ADVANCED;
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()[repl::OpTime::kTimestampFieldName];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -237,8 +335,15 @@ Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
 PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID memberID,
                                                       WorkingSetID* out) {
+    return returnIfPasses(member, memberID, Filter::passes(member, _filter), out);
+}
+
+PlanStage::StageState CollectionScan::returnIfPasses(WorkingSetMember* member,
+                                                     WorkingSetID memberID,
+                                                     bool passesFilter,
+                                                     WorkingSetID* out) {
     ++_specificStats.docsTested;
-    if (Filter::passes(member, _filter)) {
+    if (passesFilter) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
         }
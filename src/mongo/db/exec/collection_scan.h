@@ -32,8 +32,10 @@
 #include <memory>
 
 #include "mongo/db/exec/collection_scan_common.h"
+#include "mongo/db/exec/record_batch_buffer.h"
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/match_batch.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -62,6 +64,16 @@ public:
     StageState doWork(WorkingSetID* out) final;
     bool isEOF() final;
 
+    /**
+     * Scans which report oplog timestamps or resume tokens must not read ahead of the results
+     * consumed by their caller, and tailable scans rely on per-result EOF handling, so none of
+     * them are batched.
+     */
+    bool supportsBatchedExecution() const final {
+        return !_params.tailable && !_params.shouldTrackLatestOplogTimestamp &&
+            !_params.requestResumeToken;
+    }
+
     void doDetachFromOperationContext() final;
     void doReattachToOperationContext() final;
 
@@ -82,6 +94,8 @@ public:
     const SpecificStats* getSpecificStats() const final;
 
 protected:
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
+
     void doSaveStateRequiresCollection() final;
 
     void doRestoreStateRequiresCollection() final;
@@ -93,6 +107,14 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * As returnIfMatches(), for a member which has already been tested against our filter.
+     */
+    StageState returnIfPasses(WorkingSetMember* member,
+                              WorkingSetID memberID,
+                              bool passesFilter,
+                              WorkingSetID* out);
+
     /**
      * Extracts the timestamp from the 'ts' field of 'record', and sets '_latestOplogEntryTimestamp'
      * to that time if it isn't already greater.  Returns an error if the 'ts' field cannot be
@@ -121,6 +143,14 @@ private:
     // timestamp seen in the collection.  Otherwise, this is a null timestamp.
     Timestamp _latestOplogEntryTimestamp;
 
+    // Scratch space for doWorkBatch(): the members read in the current batch, and their documents
+    // for filtering with MatchExpression::matchesBatch().
+    WorkingSetIDBatch _scannedIds;
+    MatchBatch _matchBatch;
+
+    // Holds the records of the current batch until our caller is done with them.
+    RecordBatchBuffer _batchBuffer;
+
     // Stats
     CollectionScanStats _specificStats;
 };
@@ -253,8 +253,8 @@ void DocumentStorage::alloc(unsigned newSize) {
 
     uassert(16490, "Tried to make oversized document", capacity <= size_t(BufferMaxSize));
 
-    std::unique_ptr<char[]> oldBuf(_cache);
-    _cache = new char[capacity];
+    std::unique_ptr<char, Arena::Deleter> oldBuf(_cache);
+    _cache = static_cast<char*>(Arena::allocate(capacity));
     _cacheEnd = _cache + capacity - hashTabBytes();
 
     if (!firstAlloc) {
@@ -286,7 +286,7 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 
     uassert(16491, "Tried to make oversized document", newSize <= size_t(BufferMaxSize));
 
-    _cache = new char[newSize + hashTabBytes()];
+    _cache = static_cast<char*>(Arena::allocate(newSize + hashTabBytes()));
     _cacheEnd = _cache + newSize;
 }
 
@@ -297,7 +297,7 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
         // Make a copy of the buffer with the fields.
         // It is very important that the positions of each field are the same after cloning.
         const size_t bufferBytes = allocatedBytes();
-        out->_cache = new char[bufferBytes];
+        out->_cache = static_cast<char*>(Arena::allocate(bufferBytes));
         out->_cacheEnd = out->_cache + (_cacheEnd - _cache);
         memcpy(out->_cache, _cache, bufferBytes);
 
@@ -329,7 +329,7 @@ size_t DocumentStorage::getMetadataApproximateSize() const {
 }
 
 DocumentStorage::~DocumentStorage() {
-    std::unique_ptr<char[]> deleteBufferAtScopeEnd(_cache);
+    std::unique_ptr<char, Arena::Deleter> deleteBufferAtScopeEnd(_cache);
 
     for (auto it = iteratorCacheOnly(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
@@ -38,6 +38,7 @@
 #include "mongo/db/exec/document_value/document_metadata_fields.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/stdx/variant.h"
+#include "mongo/util/arena.h"
 #include "mongo/util/intrusive_counter.h"
 
 namespace mongo {
@@ -297,6 +298,14 @@ public:
 
     ~DocumentStorage();
 
+    // Storage, along with its field cache, is drawn from the current thread's Arena, if any.
+    static void* operator new(size_t size) {
+        return Arena::allocate(size);
+    }
+    static void operator delete(void* ptr) {
+        Arena::deallocate(ptr);
+    }
+
     void reset(const BSONObj& bson, bool stripMetadata);
 
     static const DocumentStorage& emptyDoc() {
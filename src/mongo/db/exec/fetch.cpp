@@ -131,6 +131,31 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    // Our caller has finished with the previous batch, so its records can be released.
+    _batchBuffer.clear();
+    for (size_t works = 0; works < maxBatchSize; ++works) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        const StageState state = recordWorkResult(FetchStage::doWork(&id));
+
+        if (PlanStage::ADVANCED == state) {
+            // The fetched document may point into the cursor's buffer, which is reused by the
+            // next fetch while this document is still waiting to be returned.
+            WorkingSetMember* member = _ws->get(id);
+            if (member->hasObj() && !member->doc.value().isOwned()) {
+                const BSONObj& obj = member->doc.value().toBson();
+                RecordData data(obj.objdata(), obj.objsize());
+                member->resetDocument(member->doc.snapshotId(), _batchBuffer.append(data));
+            }
+            out->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            return endBatch(state, id, out);
+        }
+    }
+
+    return out->empty() ? PlanStage::NEED_TIME : PlanStage::ADVANCED;
+}
+
 void FetchStage::doSaveStateRequiresCollection() {
     if (_cursor) {
         _cursor->saveUnpositioned();
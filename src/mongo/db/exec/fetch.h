@@ -31,6 +31,7 @@
 
 #include <memory>
 
+#include "mongo/db/exec/record_batch_buffer.h"
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
@@ -61,6 +62,10 @@ public:
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
 
+    bool supportsBatchedExecution() const final {
+        return child()->supportsBatchedExecution();
+    }
+
     void doDetachFromOperationContext() final;
     void doReattachToOperationContext() final;
 
@@ -75,6 +80,8 @@ public:
     static const char* kStageType;
 
 protected:
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
+
     void doSaveStateRequiresCollection() final;
 
     void doRestoreStateRequiresCollection() final;
@@ -98,6 +105,9 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Holds the documents fetched for the current batch until our caller is done with them.
+    RecordBatchBuffer _batchBuffer;
+
     // Stats
     FetchStats _specificStats;
 };
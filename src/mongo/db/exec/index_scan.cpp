@@ -242,6 +242,22 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     return PlanStage::ADVANCED;
 }
 
+PlanStage::StageState IndexScan::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    for (size_t works = 0; works < maxBatchSize; ++works) {
+        // IndexScan is final, so this call is bound statically rather than through the vtable.
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        const StageState state = recordWorkResult(IndexScan::doWork(&id));
+
+        if (PlanStage::ADVANCED == state) {
+            out->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            return endBatch(state, id, out);
+        }
+    }
+
+    return out->empty() ? PlanStage::NEED_TIME : PlanStage::ADVANCED;
+}
+
 bool IndexScan::isEOF() {
     return _commonStats.isEOF;
 }
@@ -114,7 +114,12 @@ public:
               const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
     bool isEOF() final;
+
+    bool supportsBatchedExecution() const final {
+        return true;
+    }
     void doDetachFromOperationContext() final;
     void doReattachToOperationContext() final;
 
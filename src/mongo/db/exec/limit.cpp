@@ -29,6 +29,7 @@
 
 #include "mongo/db/exec/limit.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/db/exec/scoped_timer.h"
@@ -82,6 +83,26 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    if (0 == _numToReturn) {
+        return recordWorkResult(PlanStage::IS_EOF);
+    }
+
+    // Never ask our child for more results than we are going to return.
+    const auto childBatchSize =
+        static_cast<size_t>(std::min(static_cast<long long>(maxBatchSize), _numToReturn));
+    StageState status = child()->workBatch(childBatchSize, out);
+
+    if (PlanStage::ADVANCED == status) {
+        _numToReturn -= out->size();
+        recordAdvancedBatch(out->size());
+    } else {
+        recordWorkResult(status);
+    }
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = std::make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
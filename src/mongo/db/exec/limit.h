@@ -53,6 +53,11 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
+
+    bool supportsBatchedExecution() const final {
+        return child()->supportsBatchedExecution();
+    }
 
     StageType stageType() const final {
         return STAGE_LIMIT;
@@ -159,6 +159,33 @@ PlanStage::StageState MultiPlanStage::doWork(WorkingSetID* out) {
     return state;
 }
 
+bool MultiPlanStage::supportsBatchedExecution() const {
+    return bestPlanChosen() && !hasBackupPlan() && !_failure &&
+        _candidates[_bestPlanIdx].root->supportsBatchedExecution();
+}
+
+PlanStage::StageState MultiPlanStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    CandidatePlan& bestPlan = _candidates[_bestPlanIdx];
+
+    // Hand out the results produced during the trial period first.
+    if (!bestPlan.results.empty()) {
+        while (!bestPlan.results.empty() && out->size() < maxBatchSize) {
+            out->push_back(bestPlan.results.front());
+            bestPlan.results.pop();
+        }
+        recordAdvancedBatch(out->size());
+        return PlanStage::ADVANCED;
+    }
+
+    StageState state = bestPlan.root->workBatch(maxBatchSize, out);
+    if (PlanStage::ADVANCED == state) {
+        recordAdvancedBatch(out->size());
+    } else {
+        recordWorkResult(state);
+    }
+    return state;
+}
+
 Status MultiPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
     // These are the conditions which can cause us to yield:
     //   1) The yield policy's timer elapsed, or
@@ -85,6 +85,12 @@ public:
 
     StageState doWork(WorkingSetID* out) final;
 
+    /**
+     * Once a plan has been chosen, only the winner is worked, so batching depends on it alone. A
+     * backup plan means that the winner has a blocking stage, which is never batched anyway.
+     */
+    bool supportsBatchedExecution() const final;
+
     StageType stageType() const final {
         return STAGE_MULTI_PLAN;
     }
@@ -155,6 +161,8 @@ public:
     static const char* kStageType;
 
 protected:
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
+
     void doSaveStateRequiresCollection() final {}
 
     void doRestoreStateRequiresCollection() final {}
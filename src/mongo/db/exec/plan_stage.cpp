@@ -77,6 +77,60 @@ void PlanStage::reattachToOperationContext(OperationContext* opCtx) {
     doReattachToOperationContext();
 }
 
+PlanStage::StageState PlanStage::workBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    invariant(maxBatchSize > 0);
+    invariant(out->empty());
+    dassert(supportsBatchedExecution());
+
+    if (_deferredBatchState) {
+        auto [state, id] = *_deferredBatchState;
+        _deferredBatchState = boost::none;
+        out->push_back(id);
+        return state;
+    }
+
+    auto optTimer(getOptTimer());
+    return doWorkBatch(maxBatchSize, out);
+}
+
+PlanStage::StageState PlanStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    // Bound the number of units of work rather than the number of results, so that a stage which
+    // filters out most of its input cannot starve the caller's yield and interrupt checks.
+    for (size_t works = 0; works < maxBatchSize; ++works) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        const StageState state = recordWorkResult(doWork(&id));
+
+        if (PlanStage::ADVANCED == state) {
+            out->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            return endBatch(state, id, out);
+        }
+    }
+
+    return out->empty() ? PlanStage::NEED_TIME : PlanStage::ADVANCED;
+}
+
+PlanStage::StageState PlanStage::endBatch(StageState state,
+                                          WorkingSetID id,
+                                          WorkingSetIDBatch* out) {
+    invariant(PlanStage::ADVANCED != state);
+
+    if (out->empty()) {
+        if (PlanStage::NEED_YIELD == state || PlanStage::FAILURE == state) {
+            out->push_back(id);
+        }
+        return state;
+    }
+
+    // Hand back the results produced so far. EOF and NEED_TIME will be observed again on the next
+    // call, but a yield request or failure is reported exactly once, so it must be remembered.
+    if (PlanStage::NEED_YIELD == state || PlanStage::FAILURE == state) {
+        invariant(!_deferredBatchState);
+        _deferredBatchState.emplace(state, id);
+    }
+    return PlanStage::ADVANCED;
+}
+
 ClockSource* PlanStage::getClock() const {
     return _opCtx->getServiceContext()->getFastClockSource();
 }
@@ -44,6 +44,11 @@ class Collection;
 class OperationContext;
 class RecordId;
 
+/**
+ * A block of results produced by a single call to PlanStage::workBatch().
+ */
+using WorkingSetIDBatch = std::vector<WorkingSetID>;
+
 /**
  * A PlanStage ("stage") is the basic building block of a "Query Execution Plan."  A stage is
  * the smallest piece of machinery used in executing a compiled query.  Stages either access
@@ -74,6 +79,10 @@ class RecordId;
  * saveState() if any underlying database state changes.  If saveState() is called,
  * restoreState() must be called again before any work() is done.
  *
+ * Stages which report supportsBatchedExecution() may also be driven with workBatch(), which
+ * produces a block of results per call rather than a single result. This amortizes virtual
+ * dispatch, yield checks and stats bookkeeping over many documents. See workBatch() below.
+ *
  * Here is a very simple usage example:
  *
  * WorkingSet workingSet;
@@ -203,21 +212,34 @@ public:
     StageState work(WorkingSetID* out) {
         auto optTimer(getOptTimer());
 
-        ++_commonStats.works;
-
-        StageState workResult = doWork(out);
+        return recordWorkResult(doWork(out));
+    }
 
-        if (StageState::ADVANCED == workResult) {
-            ++_commonStats.advanced;
-        } else if (StageState::NEED_TIME == workResult) {
-            ++_commonStats.needTime;
-        } else if (StageState::NEED_YIELD == workResult) {
-            ++_commonStats.needYield;
-        } else if (StageState::FAILURE == workResult) {
-            _commonStats.failed = true;
-        }
+    /**
+     * Performs up to 'maxBatchSize' units of work, appending every result produced to 'out', which
+     * must be empty on entry. Only legal to call if supportsBatchedExecution() returns true for
+     * this stage.
+     *
+     * Returns ADVANCED if 'out' holds one or more results. Otherwise 'out' holds no results and
+     * the return value is NEED_TIME, IS_EOF, NEED_YIELD or FAILURE, with the same meaning as for
+     * work(). For NEED_YIELD and FAILURE, 'out' is populated with the single WorkingSetID that
+     * work() would have returned through its out parameter.
+     *
+     * If a NEED_YIELD or FAILURE is encountered after some results have already been produced,
+     * those results are returned first and the state is reported by the next call to workBatch().
+     *
+     * Documents in the results may be unowned views into storage which the stage releases on its
+     * next call to workBatch(), so the caller must be done with them, or have made them owned, by
+     * then.
+     */
+    StageState workBatch(size_t maxBatchSize, WorkingSetIDBatch* out);
 
-        return workResult;
+    /**
+     * Returns true if this stage may be driven with workBatch(). Stages opt in by overriding this
+     * method; those with children must only do so if every child they will work supports it too.
+     */
+    virtual bool supportsBatchedExecution() const {
+        return false;
     }
 
     /**
@@ -377,6 +399,53 @@ protected:
      */
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs a batch of work. See comment at workBatch() above.
+     *
+     * The default implementation calls doWork() up to 'maxBatchSize' times. Stages may override it
+     * with a native implementation which processes a whole block of input at once; such
+     * implementations are responsible for keeping '_commonStats' up to date through
+     * recordWorkResult() and recordAdvancedBatch().
+     */
+    virtual StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out);
+
+    /**
+     * Updates the common stats to account for a single unit of work which returned 'state', and
+     * returns 'state'.
+     */
+    StageState recordWorkResult(StageState state) {
+        ++_commonStats.works;
+
+        if (StageState::ADVANCED == state) {
+            ++_commonStats.advanced;
+        } else if (StageState::NEED_TIME == state) {
+            ++_commonStats.needTime;
+        } else if (StageState::NEED_YIELD == state) {
+            ++_commonStats.needYield;
+        } else if (StageState::FAILURE == state) {
+            _commonStats.failed = true;
+        }
+
+        return state;
+    }
+
+    /**
+     * Updates the common stats to account for 'nResults' units of work which each produced a
+     * result.
+     */
+    void recordAdvancedBatch(size_t nResults) {
+        _commonStats.works += nResults;
+        _commonStats.advanced += nResults;
+    }
+
+    /**
+     * Completes a batch which was interrupted by a unit of work returning 'state', with 'id' being
+     * the WorkingSetID that accompanied it. If 'out' already holds results, they are returned and
+     * a NEED_YIELD or FAILURE is deferred until the next call to workBatch(). Returns the state
+     * which doWorkBatch() should report to its caller.
+     */
+    StageState endBatch(StageState state, WorkingSetID id, WorkingSetIDBatch* out);
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
@@ -439,6 +508,10 @@ protected:
 private:
     OperationContext* _opCtx;
 
+    // A NEED_YIELD or FAILURE state, along with its WorkingSetID, which was encountered part way
+    // through a batch and has yet to be reported by workBatch().
+    boost::optional<std::pair<StageState, WorkingSetID>> _deferredBatchState;
+
     // The PlanExecutor holds a strong reference to this which ensures that this pointer remains
     // valid for the entire lifetime of the PlanStage.
     ExpressionContext* _expCtx;
@@ -0,0 +1,198 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+//
+// This file contains tests for batched execution through PlanStage::workBatch().
+//
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+
+#include "mongo/db/exec/limit.h"
+#include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/skip.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source_mock.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("db.dummy");
+
+class PlanStageBatchTest : public ServiceContextMongoDTest {
+public:
+    PlanStageBatchTest() {
+        getServiceContext()->setFastClockSource(std::make_unique<ClockSourceMock>());
+        _opCtx = makeOperationContext();
+        _expCtx = make_intrusive<ExpressionContext>(_opCtx.get(), nullptr, kNss);
+    }
+
+protected:
+    /**
+     * Returns a QueuedDataStage which produces 'nResults' results, each a document {a: i}.
+     */
+    std::unique_ptr<QueuedDataStage> makeQueuedResults(int nResults) {
+        auto stage = std::make_unique<QueuedDataStage>(_expCtx.get(), &_ws);
+        for (int i = 0; i < nResults; ++i) {
+            queueResult(stage.get(), i);
+        }
+        return stage;
+    }
+
+    void queueResult(QueuedDataStage* stage, int value) {
+        WorkingSetID id = _ws.allocate();
+        WorkingSetMember* member = _ws.get(id);
+        member->doc = {SnapshotId(), Document{BSON("a" << value)}};
+        member->transitionToOwnedObj();
+        stage->pushBack(id);
+    }
+
+    /**
+     * Returns the values of the 'a' field of the members in 'batch'.
+     */
+    std::vector<int> values(const WorkingSetIDBatch& batch) {
+        std::vector<int> result;
+        for (auto&& id : batch) {
+            result.push_back(_ws.get(id)->doc.value()["a"].getInt());
+        }
+        return result;
+    }
+
+    ExpressionContext* expCtx() {
+        return _expCtx.get();
+    }
+
+    WorkingSet _ws;
+
+private:
+    ServiceContext::UniqueOperationContext _opCtx;
+    boost::intrusive_ptr<ExpressionContext> _expCtx;
+};
+
+TEST_F(PlanStageBatchTest, DefaultBatchStopsAfterMaxBatchSizeUnitsOfWork) {
+    auto stage = makeQueuedResults(2);
+    stage->pushBack(PlanStage::NEED_TIME);
+    queueResult(stage.get(), 2);
+
+    WorkingSetIDBatch batch;
+    ASSERT_EQ(PlanStage::ADVANCED, stage->workBatch(3, &batch));
+    ASSERT(values(batch) == std::vector<int>({0, 1}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::ADVANCED, stage->workBatch(3, &batch));
+    ASSERT(values(batch) == std::vector<int>({2}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::IS_EOF, stage->workBatch(3, &batch));
+    ASSERT(batch.empty());
+
+    const CommonStats* stats = stage->getCommonStats();
+    ASSERT_EQ(stats->works, 6U);
+    ASSERT_EQ(stats->advanced, 3U);
+    ASSERT_EQ(stats->needTime, 1U);
+}
+
+TEST_F(PlanStageBatchTest, YieldAfterResultsIsDeferredToNextBatch) {
+    auto stage = makeQueuedResults(1);
+    stage->pushBack(PlanStage::NEED_YIELD);
+    queueResult(stage.get(), 1);
+
+    WorkingSetIDBatch batch;
+    ASSERT_EQ(PlanStage::ADVANCED, stage->workBatch(10, &batch));
+    ASSERT(values(batch) == std::vector<int>({0}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::NEED_YIELD, stage->workBatch(10, &batch));
+    ASSERT_EQ(batch.size(), 1U);
+    ASSERT_EQ(batch.front(), WorkingSet::INVALID_ID);
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::ADVANCED, stage->workBatch(10, &batch));
+    ASSERT(values(batch) == std::vector<int>({1}));
+}
+
+TEST_F(PlanStageBatchTest, FailureAfterResultsIsDeferredToNextBatch) {
+    auto stage = makeQueuedResults(2);
+    stage->pushBack(PlanStage::FAILURE);
+
+    WorkingSetIDBatch batch;
+    ASSERT_EQ(PlanStage::ADVANCED, stage->workBatch(10, &batch));
+    ASSERT(values(batch) == std::vector<int>({0, 1}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::FAILURE, stage->workBatch(10, &batch));
+    ASSERT_EQ(batch.size(), 1U);
+    ASSERT_NE(batch.front(), WorkingSet::INVALID_ID);
+}
+
+TEST_F(PlanStageBatchTest, LimitNeverReturnsMoreThanItsLimit) {
+    LimitStage limit(expCtx(), 3, &_ws, makeQueuedResults(5));
+    ASSERT_TRUE(limit.supportsBatchedExecution());
+
+    WorkingSetIDBatch batch;
+    ASSERT_EQ(PlanStage::ADVANCED, limit.workBatch(10, &batch));
+    ASSERT(values(batch) == std::vector<int>({0, 1, 2}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::IS_EOF, limit.workBatch(10, &batch));
+    ASSERT_TRUE(limit.isEOF());
+    ASSERT_EQ(limit.getCommonStats()->advanced, 3U);
+}
+
+TEST_F(PlanStageBatchTest, SkipDropsLeadingResultsAcrossBatches) {
+    SkipStage skip(expCtx(), 3, &_ws, makeQueuedResults(5));
+    ASSERT_TRUE(skip.supportsBatchedExecution());
+
+    WorkingSetIDBatch batch;
+    ASSERT_EQ(PlanStage::NEED_TIME, skip.workBatch(2, &batch));
+    ASSERT(batch.empty());
+
+    ASSERT_EQ(PlanStage::ADVANCED, skip.workBatch(2, &batch));
+    ASSERT(values(batch) == std::vector<int>({3}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::ADVANCED, skip.workBatch(2, &batch));
+    ASSERT(values(batch) == std::vector<int>({4}));
+
+    batch.clear();
+    ASSERT_EQ(PlanStage::IS_EOF, skip.workBatch(2, &batch));
+
+    const CommonStats* stats = skip.getCommonStats();
+    ASSERT_EQ(stats->advanced, 2U);
+    ASSERT_EQ(stats->needTime, 3U);
+}
+
+}  // namespace
+}  // namespace mongo
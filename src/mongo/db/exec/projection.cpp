@@ -161,6 +161,37 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    StageState status = child()->workBatch(maxBatchSize, out);
+    if (PlanStage::ADVANCED != status) {
+        recordWorkResult(status);
+        return status;
+    }
+
+    for (size_t i = 0; i < out->size(); ++i) {
+        Status projStatus = transform(_ws.get((*out)[i]));
+        if (!projStatus.isOK()) {
+            LOGV2_WARNING(4900100,
+                          "Couldn't execute projection, status = {projStatus}",
+                          "projStatus"_attr = redact(projStatus));
+
+            // Return the members which were projected successfully and report the failure on the
+            // next call.
+            for (size_t j = i; j < out->size(); ++j) {
+                _ws.free((*out)[j]);
+            }
+            out->resize(i);
+            recordAdvancedBatch(i);
+            recordWorkResult(PlanStage::FAILURE);
+            return endBatch(
+                PlanStage::FAILURE, WorkingSetCommon::allocateStatusMember(&_ws, projStatus), out);
+        }
+    }
+
+    recordAdvancedBatch(out->size());
+    return status;
+}
+
 std::unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     auto ret = std::make_unique<PlanStageStats>(_commonStats, stageType());
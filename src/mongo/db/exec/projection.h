@@ -52,6 +52,11 @@ protected:
 public:
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) final;
+
+    bool supportsBatchedExecution() const final {
+        return child()->supportsBatchedExecution();
+    }
 
     std::unique_ptr<PlanStageStats> getStats() final;
 
@@ -62,6 +62,7 @@ void ProjectionNode::addExpressionForPath(const FieldPath& path,
     if (path.getPathLength() == 1) {
         auto fieldName = path.fullPath();
         _expressions[fieldName] = expr;
+        _compiledExpressions.erase(fieldName);
         _orderToProcessAdditionsAndChildren.push_back(fieldName);
         return;
     }
@@ -184,10 +185,12 @@ void ProjectionNode::applyExpressions(const Document& root, MutableDocument* out
         } else {
             auto expressionIt = _expressions.find(field);
             invariant(expressionIt != _expressions.end());
-            outputDoc->setField(
-                field,
-                expressionIt->second->evaluate(
-                    root, &expressionIt->second->getExpressionContext()->variables));
+            auto& variables = expressionIt->second->getExpressionContext()->variables;
+            auto programIt = _compiledExpressions.find(field);
+            outputDoc->setField(field,
+                                programIt != _compiledExpressions.end()
+                                    ? programIt->second->evaluate(root, &variables)
+                                    : expressionIt->second->evaluate(root, &variables));
         }
     }
 }
@@ -246,8 +249,12 @@ void ProjectionNode::reportComputedPaths(std::set<std::string>* computedPaths,
 }
 
 void ProjectionNode::optimize() {
+    _compiledExpressions.clear();
     for (auto&& expressionIt : _expressions) {
         _expressions[expressionIt.first] = expressionIt.second->optimize();
+        if (auto program = ExpressionBytecode::compile(expressionIt.second)) {
+            _compiledExpressions[expressionIt.first] = std::move(program);
+        }
     }
     for (auto&& childPair : _children) {
         childPair.second->optimize();
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/exec/projection_executor.h"
+#include "mongo/db/pipeline/expression_bytecode.h"
 
 #include "mongo/db/query/projection_policies.h"
 
@@ -155,6 +156,9 @@ protected:
 
     stdx::unordered_map<std::string, std::unique_ptr<ProjectionNode>> _children;
     stdx::unordered_map<std::string, boost::intrusive_ptr<Expression>> _expressions;
+    // The compiled form of the entries of '_expressions' which could be compiled. Populated by
+    // optimize().
+    stdx::unordered_map<std::string, std::unique_ptr<ExpressionBytecode>> _compiledExpressions;
     stdx::unordered_set<std::string> _projectedFields;
     ProjectionPolicies _policies;
     std::string _pathToNode;
@@ -54,6 +54,10 @@ public:
 
     bool isEOF() final;
 
+    bool supportsBatchedExecution() const final {
+        return true;
+    }
+
     StageType stageType() const final {
         return STAGE_QUEUED_DATA;
     }
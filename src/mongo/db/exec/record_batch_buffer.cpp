@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_batch_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mongo {
+
+BSONObj RecordBatchBuffer::append(RecordData data) {
+    if (data.isOwned()) {
+        // Keep the storage engine's buffer alive ourselves so that the document can be handed out
+        // unowned like the others.
+        _ownedRecords.push_back(data.releaseToBson());
+        return BSONObj(_ownedRecords.back().objdata());
+    }
+
+    const size_t size = data.size();
+    if (_blocks.empty() || _capacity - _used < size) {
+        _capacity = std::max(kBlockSize, size);
+        _blocks.push_back(SharedBuffer::allocate(_capacity));
+        _used = 0;
+    }
+
+    char* dest = _blocks.back().get() + _used;
+    std::memcpy(dest, data.data(), size);
+    _used += size;
+    return BSONObj(dest);
+}
+
+void RecordBatchBuffer::clear() {
+    // Reuse the last block for the next batch, unless it was sized for one oversized record.
+    if (!_blocks.empty() && _capacity == kBlockSize) {
+        _blocks.erase(_blocks.begin(), _blocks.end() - 1);
+    } else {
+        _blocks.clear();
+        _capacity = 0;
+    }
+    _used = 0;
+    _ownedRecords.clear();
+}
+
+}  // namespace mongo
@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/storage/record_data.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+/**
+ * Holds the records read by a stage during one call to PlanStage::workBatch().
+ *
+ * A storage engine cursor only guarantees that a record it returns is valid until the cursor is
+ * next used, but a batch holds many records at once. Rather than giving each record its own
+ * allocation with getOwned(), records which the storage engine does not already own are packed
+ * into large blocks which are kept alive until clear() is called at the start of the next batch.
+ * The documents handed out are unowned views, so they cost no reference counting either.
+ */
+class RecordBatchBuffer {
+public:
+    /**
+     * Returns the record in 'data' as a BSONObj which remains valid until the next call to clear().
+     */
+    BSONObj append(RecordData data);
+
+    /**
+     * Releases the records of the previous batch. Every document returned by append() must be
+     * dead, or owned, by the time this is called.
+     */
+    void clear();
+
+private:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    std::vector<SharedBuffer> _blocks;
+
+    // Bytes used in the last element of '_blocks'.
+    size_t _used = 0;
+
+    // Size of the last element of '_blocks'.
+    size_t _capacity = 0;
+
+    // Records which were already owned by the storage engine, kept as they are.
+    std::vector<BSONObj> _ownedRecords;
+};
+
+}  // namespace mongo
@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/record_batch_buffer.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+RecordData unownedRecord(const BSONObj& obj) {
+    return RecordData(obj.objdata(), obj.objsize());
+}
+
+TEST(RecordBatchBufferTest, RecordsOutliveTheirSourceUntilCleared) {
+    RecordBatchBuffer buffer;
+    std::vector<BSONObj> results;
+    for (int i = 0; i < 1000; ++i) {
+        // The source of each record is gone before the next one is appended, like a cursor's
+        // buffer which is reused by the next call to next().
+        auto source = BSON("_id" << i << "payload" << std::string(100, 'x'));
+        results.push_back(buffer.append(unownedRecord(source)));
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_FALSE(results[i].isOwned());
+        ASSERT_BSONOBJ_EQ(results[i], BSON("_id" << i << "payload" << std::string(100, 'x')));
+    }
+}
+
+TEST(RecordBatchBufferTest, RecordLargerThanABlock) {
+    RecordBatchBuffer buffer;
+    auto small = buffer.append(unownedRecord(BSON("_id" << 0)));
+    auto bigSource = BSON("_id" << 1 << "payload" << std::string(200 * 1024, 'y'));
+    auto big = buffer.append(unownedRecord(bigSource));
+    auto next = buffer.append(unownedRecord(BSON("_id" << 2)));
+
+    ASSERT_BSONOBJ_EQ(small, BSON("_id" << 0));
+    ASSERT_BSONOBJ_EQ(big, bigSource);
+    ASSERT_BSONOBJ_EQ(next, BSON("_id" << 2));
+
+    buffer.clear();
+    ASSERT_BSONOBJ_EQ(buffer.append(unownedRecord(BSON("_id" << 3))), BSON("_id" << 3));
+}
+
+TEST(RecordBatchBufferTest, OwnedRecordsAreKeptWithoutCopying) {
+    RecordBatchBuffer buffer;
+    auto owned = BSON("_id" << 0);
+    RecordData data(owned.objdata(), owned.objsize());
+    data.makeOwned();
+    const char* ownedData = data.data();
+
+    auto result = buffer.append(std::move(data));
+    ASSERT_FALSE(result.isOwned());
+    ASSERT_EQ(result.objdata(), ownedData);
+    ASSERT_BSONOBJ_EQ(result, owned);
+}
+
+}  // namespace
+}  // namespace mongo
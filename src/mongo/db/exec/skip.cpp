@@ -29,6 +29,7 @@
 
 #include "mongo/db/exec/skip.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/db/exec/scoped_timer.h"
@@ -86,6 +87,29 @@ PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState SkipStage::doWorkBatch(size_t maxBatchSize, WorkingSetIDBatch* out) {
+    StageState status = child()->workBatch(maxBatchSize, out);
+    if (PlanStage::ADVANCED != status) {
+        recordWorkResult(status);
+        return status;
+    }
+
+    // Drop as much of the batch as we still need to skip.
+    const auto nToDrop =
+        static_cast<size_t>(std::min(static_cast<long long>(out->size()), _toSkip));
+    for (size_t i = 0; i < nToDrop; ++i) {
+        _ws->free((*out)[i]);
+    }
+    out->erase(out->begin(), out->begin() + nToDrop);
+    _toSkip -= nToDrop;
+
+    _commonStats.works += nToDrop;
+    _commonStats.needTime += nToDrop;
+    recordAdvancedBatch(out->size());
+
+    return out->empty() ? PlanStage::NEED_TIME : PlanStage::ADVANCED;
+}
+
 unique_ptr<PlanStageStats> SkipStage::getStats() {
     _commonStats.isEOF = isEOF();
     _specificStats.skip = _toSkip;
@@ -448,7 +448,8 @@ class AbstractIndexAccessMethod::BulkBuilderImpl : public IndexAccessMethod::Bul
 public:
     BulkBuilderImpl(IndexCatalogEntry* indexCatalogEntry,
                     const IndexDescriptor* descriptor,
-                    size_t maxMemoryUsageBytes);
+                    size_t maxMemoryUsageBytes,
+                    size_t sortParallelism);
 
     Status insert(OperationContext* opCtx,
                   const BSONObj& obj,
@@ -486,18 +487,21 @@ private:
 };
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initiateBulk(
-    size_t maxMemoryUsageBytes) {
-    return std::make_unique<BulkBuilderImpl>(_indexCatalogEntry, _descriptor, maxMemoryUsageBytes);
+    size_t maxMemoryUsageBytes, size_t sortParallelism) {
+    return std::make_unique<BulkBuilderImpl>(
+        _indexCatalogEntry, _descriptor, maxMemoryUsageBytes, sortParallelism);
 }
 
 AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(IndexCatalogEntry* index,
                                                             const IndexDescriptor* descriptor,
-                                                            size_t maxMemoryUsageBytes)
+                                                            size_t maxMemoryUsageBytes,
+                                                            size_t sortParallelism)
     : _sorter(Sorter::make(
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .Parallelism(sortParallelism),
           BtreeExternalSortComparison(),
           std::pair<KeyString::Value::SorterDeserializeSettings,
                     mongo::NullValue::SorterDeserializeSettings>(
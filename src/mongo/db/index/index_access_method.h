@@ -235,8 +235,11 @@ public:
      *
      * maxMemoryUsageBytes: amount of memory consumed before the external sorter starts spilling to
      *                      disk
+     * sortParallelism: maximum number of threads the external sorter may use, including the thread
+     *                  inserting into the BulkBuilder
      */
-    virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) = 0;
+    virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes,
+                                                      size_t sortParallelism) = 0;
 
     /**
      * Call this when you are ready to finish your bulk work.
@@ -504,7 +507,8 @@ public:
 
     void setIndexIsMultikey(OperationContext* opCtx, MultikeyPaths paths) final;
 
-    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) final;
+    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes,
+                                              size_t sortParallelism) final;
 
     Status commitBulk(OperationContext* opCtx,
                       BulkBuilder* bulk,
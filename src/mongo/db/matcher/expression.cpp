@@ -134,6 +134,16 @@ bool MatchExpression::matchesBSONElement(BSONElement elem, MatchDetails* details
     return matches(&matchableDoc, details);
 }
 
+void MatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    auto out = selection->begin();
+    for (auto i : *selection) {
+        if (matchesBSON(batch->getDocument(i))) {
+            *out++ = i;
+        }
+    }
+    selection->erase(out, selection->end());
+}
+
 void MatchExpression::setCollator(const CollatorInterface* collator) {
     for (size_t i = 0; i < numChildren(); ++i) {
         getChild(i)->setCollator(collator);
@@ -36,6 +36,7 @@
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/matcher/match_batch.h"
 #include "mongo/db/matcher/match_details.h"
 #include "mongo/db/matcher/matchable.h"
 #include "mongo/db/pipeline/dependencies.h"
@@ -257,6 +258,14 @@ public:
      */
     virtual bool matchesBSONElement(BSONElement elem, MatchDetails* details = nullptr) const;
 
+    /**
+     * Narrows 'selection' down to the documents of 'batch' which satisfy the tree-predicate. This
+     * is equivalent to calling matchesBSON() on each selected document in turn. The default
+     * implementation does exactly that; leaf and logical nodes override it to process the batch
+     * a predicate at a time, so that the path lookups of each leaf are done in one pass.
+     */
+    virtual void matchesBatch(MatchBatch* batch, SelectionVector* selection) const;
+
     /**
      * Determines if the element satisfies the tree-predicate.
      * Not valid for all expressions (e.g. $where); in those cases, returns false.
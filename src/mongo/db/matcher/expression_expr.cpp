@@ -59,7 +59,8 @@ bool ExprMatchExpression::matches(const MatchableDocument* doc, MatchDetails* de
     // 'Variables' object per-caller.
     Variables variables = _expCtx->variables;
     try {
-        auto value = _expression->evaluate(document, &variables);
+        auto value = _program ? _program->evaluate(document, &variables)
+                              : _expression->evaluate(document, &variables);
         return value.coerceToBool();
     } catch (const DBException&) {
         if (MONGO_unlikely(ExprMatchExpressionMatchesReturnsFalseOnException.shouldFail())) {
@@ -112,6 +113,10 @@ std::unique_ptr<MatchExpression> ExprMatchExpression::shallowClone() const {
         Expression::parseOperand(_expCtx, bob.obj().firstElement(), _expCtx->variablesParseState);
 
     auto clone = std::make_unique<ExprMatchExpression>(std::move(clonedExpr), _expCtx);
+    if (_program) {
+        // The clone's expression is parsed from the optimized one, so it can be compiled as is.
+        clone->_program = ExpressionBytecode::compile(clone->_expression);
+    }
     if (_rewriteResult) {
         clone->_rewriteResult = _rewriteResult->clone();
     }
@@ -131,6 +136,7 @@ MatchExpression::ExpressionOptimizerFunc ExprMatchExpression::getOptimizer() con
         }
 
         exprMatchExpr._expression = exprMatchExpr._expression->optimize();
+        exprMatchExpr._program = ExpressionBytecode::compile(exprMatchExpr._expression);
         exprMatchExpr._rewriteResult =
             RewriteExpr::rewrite(exprMatchExpr._expression, exprMatchExpr._expCtx->getCollator());
 
@@ -36,6 +36,7 @@
 #include "mongo/db/matcher/expression_tree.h"
 #include "mongo/db/matcher/rewrite_expr.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_bytecode.h"
 #include "mongo/db/pipeline/expression_context.h"
 
 namespace mongo {
@@ -107,6 +108,9 @@ private:
 
     boost::intrusive_ptr<Expression> _expression;
 
+    // The compiled form of '_expression' once it has been optimized, if it could be compiled.
+    std::unique_ptr<ExpressionBytecode> _program;
+
     boost::optional<RewriteExpr::RewriteResult> _rewriteResult;
 };
 
@@ -191,6 +191,12 @@ bool ComparisonMatchExpression::matchesSingleElement(const BSONElement& e,
     }
 }
 
+void ComparisonMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    filterBatch(batch, selection, [this](const BSONElement& elem) {
+        return ComparisonMatchExpression::matchesSingleElement(elem);
+    });
+}
+
 constexpr StringData EqualityMatchExpression::kName;
 constexpr StringData LTMatchExpression::kName;
 constexpr StringData LTEMatchExpression::kName;
@@ -336,6 +342,12 @@ bool ExistsMatchExpression::matchesSingleElement(const BSONElement& e,
     return !e.eoo();
 }
 
+void ExistsMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    filterBatch(batch, selection, [this](const BSONElement& elem) {
+        return ExistsMatchExpression::matchesSingleElement(elem);
+    });
+}
+
 void ExistsMatchExpression::debugString(StringBuilder& debug, int indentationLevel) const {
     _debugAddSpace(debug, indentationLevel);
     debug << path() << " exists";
@@ -403,6 +415,12 @@ bool InMatchExpression::matchesSingleElement(const BSONElement& e, MatchDetails*
     return false;
 }
 
+void InMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    filterBatch(batch, selection, [this](const BSONElement& elem) {
+        return InMatchExpression::matchesSingleElement(elem);
+    });
+}
+
 void InMatchExpression::debugString(StringBuilder& debug, int indentationLevel) const {
     _debugAddSpace(debug, indentationLevel);
     debug << path() << " $in ";
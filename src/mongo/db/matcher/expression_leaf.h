@@ -178,6 +178,8 @@ public:
     virtual ~ComparisonMatchExpression() = default;
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
+
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
 };
 
 class EqualityMatchExpression final : public ComparisonMatchExpression {
@@ -390,6 +392,8 @@ public:
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
+
     virtual void debugString(StringBuilder& debug, int indentationLevel) const;
 
     BSONObj getSerializedRightHandSide() const final;
@@ -413,6 +417,8 @@ public:
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
+
     virtual void debugString(StringBuilder& debug, int indentationLevel) const;
 
     BSONObj getSerializedRightHandSide() const final;
@@ -69,6 +69,12 @@ public:
         return false;
     }
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const override {
+        filterBatch(batch, selection, [this](const BSONElement& elem) {
+            return matchesSingleElement(elem);
+        });
+    }
+
     const StringData path() const final {
         return _path;
     }
@@ -135,6 +141,28 @@ public:
     virtual BSONObj getSerializedRightHandSide() const = 0;
 
 protected:
+    /**
+     * Implements matchesBatch() in terms of 'predicate', which must behave like
+     * matchesSingleElement(). Documents for which the path does not cross an array are decided by
+     * applying 'predicate' to the single element found at the path. The rest go through the full
+     * path traversal in matches(). Subclasses with a final matchesSingleElement() can pass a
+     * qualified call to it, so that the predicate is not dispatched virtually for every document.
+     */
+    template <typename Predicate>
+    void filterBatch(MatchBatch* batch, SelectionVector* selection, Predicate predicate) const {
+        const auto& column = batch->getColumn(_elementPath.fieldRef(), *selection);
+
+        auto out = selection->begin();
+        for (auto i : *selection) {
+            const BSONElement& elem = column[i];
+            if (elem.type() == BSONType::Array ? matchesBSON(batch->getDocument(i))
+                                               : predicate(elem)) {
+                *out++ = i;
+            }
+        }
+        selection->erase(out, selection->end());
+    }
+
     void _doAddDependencies(DepsTracker* deps) const final {
         if (!_path.empty()) {
             deps->fields.insert(_path.toString());
@@ -29,6 +29,8 @@
 
 #include "mongo/db/matcher/expression_tree.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
@@ -37,6 +39,26 @@
 #include "mongo/db/matcher/expression_text_base.h"
 
 namespace mongo {
+namespace {
+
+/**
+ * Removes from 'selection' every index which appears in 'matched', which must be a subsequence of
+ * 'selection'.
+ */
+void removeMatched(SelectionVector* selection, const SelectionVector& matched) {
+    auto matchedIt = matched.begin();
+    auto out = selection->begin();
+    for (auto i : *selection) {
+        if (matchedIt != matched.end() && *matchedIt == i) {
+            ++matchedIt;
+        } else {
+            *out++ = i;
+        }
+    }
+    selection->erase(out, selection->end());
+}
+
+}  // namespace
 
 ListOfMatchExpression::~ListOfMatchExpression() {
     for (unsigned i = 0; i < _expressions.size(); i++) {
@@ -214,6 +236,12 @@ bool AndMatchExpression::matchesSingleElement(const BSONElement& e, MatchDetails
     return true;
 }
 
+void AndMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    for (size_t i = 0; i < numChildren() && !selection->empty(); i++) {
+        getChild(i)->matchesBatch(batch, selection);
+    }
+}
+
 
 void AndMatchExpression::debugString(StringBuilder& debug, int indentationLevel) const {
     _debugAddSpace(debug, indentationLevel);
@@ -263,6 +291,25 @@ bool OrMatchExpression::matchesSingleElement(const BSONElement& e, MatchDetails*
     return false;
 }
 
+void OrMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    // Each child only needs to look at the documents which none of the earlier children matched.
+    SelectionVector unmatched = std::move(*selection);
+    SelectionVector childSelection;
+    selection->clear();
+    for (size_t i = 0; i < numChildren() && !unmatched.empty(); i++) {
+        childSelection = unmatched;
+        getChild(i)->matchesBatch(batch, &childSelection);
+        if (childSelection.empty()) {
+            continue;
+        }
+
+        removeMatched(&unmatched, childSelection);
+        const auto middle =
+            selection->insert(selection->end(), childSelection.begin(), childSelection.end());
+        std::inplace_merge(selection->begin(), middle, selection->end());
+    }
+}
+
 
 void OrMatchExpression::debugString(StringBuilder& debug, int indentationLevel) const {
     _debugAddSpace(debug, indentationLevel);
@@ -312,6 +359,15 @@ bool NorMatchExpression::matchesSingleElement(const BSONElement& e, MatchDetails
     return true;
 }
 
+void NorMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    SelectionVector childSelection;
+    for (size_t i = 0; i < numChildren() && !selection->empty(); i++) {
+        childSelection = *selection;
+        getChild(i)->matchesBatch(batch, &childSelection);
+        removeMatched(selection, childSelection);
+    }
+}
+
 void NorMatchExpression::debugString(StringBuilder& debug, int indentationLevel) const {
     _debugAddSpace(debug, indentationLevel);
     debug << "$nor\n";
@@ -325,6 +381,12 @@ void NorMatchExpression::serialize(BSONObjBuilder* out, bool includePath) const
 
 // -------
 
+void NotMatchExpression::matchesBatch(MatchBatch* batch, SelectionVector* selection) const {
+    SelectionVector childSelection = *selection;
+    _exp->matchesBatch(batch, &childSelection);
+    removeMatched(selection, childSelection);
+}
+
 void NotMatchExpression::debugString(StringBuilder& debug, int indentationLevel) const {
     _debugAddSpace(debug, indentationLevel);
     debug << "$not\n";
@@ -115,6 +115,8 @@ public:
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
+
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<AndMatchExpression> self = std::make_unique<AndMatchExpression>();
         for (size_t i = 0; i < numChildren(); ++i) {
@@ -144,6 +146,8 @@ public:
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
+
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<OrMatchExpression> self = std::make_unique<OrMatchExpression>();
         for (size_t i = 0; i < numChildren(); ++i) {
@@ -173,6 +177,8 @@ public:
 
     bool matchesSingleElement(const BSONElement&, MatchDetails* details = nullptr) const final;
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
+
     virtual std::unique_ptr<MatchExpression> shallowClone() const {
         std::unique_ptr<NorMatchExpression> self = std::make_unique<NorMatchExpression>();
         for (size_t i = 0; i < numChildren(); ++i) {
@@ -210,6 +216,8 @@ public:
         return !_exp->matchesSingleElement(elt, details);
     }
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final;
+
     virtual void debugString(StringBuilder& debug, int indentationLevel = 0) const;
 
     virtual void serialize(BSONObjBuilder* out, bool includePath) const;
@@ -78,6 +78,12 @@ public:
         return _typeSet.hasType(elem.type());
     }
 
+    void matchesBatch(MatchBatch* batch, SelectionVector* selection) const final {
+        this->filterBatch(batch, selection, [this](const BSONElement& elem) {
+            return _typeSet.hasType(elem.type());
+        });
+    }
+
     void debugString(StringBuilder& debug, int indentationLevel) const final {
         _debugAddSpace(debug, indentationLevel);
         debug << path() << " " << name() << ": " << _typeSet.toBSONArray().toString();
@@ -0,0 +1,67 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/match_batch.h"
+
+#include <numeric>
+
+#include "mongo/db/matcher/path_internal.h"
+
+namespace mongo {
+
+SelectionVector MatchBatch::selectAll() const {
+    SelectionVector selection(_docs.size());
+    std::iota(selection.begin(), selection.end(), 0);
+    return selection;
+}
+
+const std::vector<BSONElement>& MatchBatch::getColumn(const FieldRef& path,
+                                                      const SelectionVector& selection) {
+    const auto key = path.dottedField();
+    auto it = _columns.find(key);
+    if (it == _columns.end()) {
+        it = _columns.emplace(key.toString(), Column{}).first;
+        it->second.elements.resize(_docs.size());
+        it->second.resolved.resize(_docs.size(), false);
+    }
+
+    auto& column = it->second;
+    for (auto i : selection) {
+        if (!column.resolved[i]) {
+            size_t idxPath;
+            column.elements[i] = getFieldDottedOrArray(_docs[i], path, &idxPath);
+            column.resolved[i] = true;
+        }
+    }
+    return column.elements;
+}
+
+}  // namespace mongo
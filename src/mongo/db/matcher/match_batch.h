@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/field_ref.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * The indexes into a MatchBatch of the documents still under consideration, in increasing order.
+ */
+using SelectionVector = std::vector<uint32_t>;
+
+/**
+ * A block of documents filtered together by MatchExpression::matchesBatch().
+ *
+ * Leaf predicates look up their path through getColumn(), which resolves it at most once per
+ * document in the batch no matter how many predicates share the path, and hands back the results
+ * as a contiguous column.
+ */
+class MatchBatch {
+public:
+    MatchBatch() = default;
+
+    MatchBatch(const MatchBatch&) = delete;
+    MatchBatch& operator=(const MatchBatch&) = delete;
+
+    void append(BSONObj doc) {
+        _docs.push_back(std::move(doc));
+    }
+
+    /**
+     * Removes all documents along with any paths resolved against them.
+     */
+    void clear() {
+        _docs.clear();
+        _columns.clear();
+    }
+
+    size_t size() const {
+        return _docs.size();
+    }
+
+    bool empty() const {
+        return _docs.empty();
+    }
+
+    const BSONObj& getDocument(size_t i) const {
+        return _docs[i];
+    }
+
+    /**
+     * Returns a selection which holds every document in the batch.
+     */
+    SelectionVector selectAll() const;
+
+    /**
+     * Returns a column, indexed by position in the batch, holding the element found at 'path' in
+     * each document named by 'selection'. Entries for documents outside 'selection' are
+     * unspecified.
+     *
+     * As with getFieldDottedOrArray(), an entry is EOO if the path does not exist, and is the
+     * first array encountered along the path if there is one. In the latter case the caller must
+     * fall back to a full path traversal of the document.
+     *
+     * The returned reference is only valid until the next call to getColumn() or clear().
+     */
+    const std::vector<BSONElement>& getColumn(const FieldRef& path,
+                                              const SelectionVector& selection);
+
+private:
+    struct Column {
+        std::vector<BSONElement> elements;
+
+        // Whether the corresponding entry of 'elements' has been looked up yet.
+        std::vector<uint8_t> resolved;
+    };
+
+    std::vector<BSONObj> _docs;
+    StringMap<Column> _columns;
+};
+
+}  // namespace mongo
@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/match_batch.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Documents covering missing fields, nulls, scalars of several types, nested objects and arrays
+ * both at and above the leaf of the paths used below.
+ */
+std::vector<BSONObj> makeDocuments() {
+    return {
+        fromjson("{}"),
+        fromjson("{a: null}"),
+        fromjson("{a: 1}"),
+        fromjson("{a: 5, b: 'x'}"),
+        fromjson("{a: 10.5, b: 'y'}"),
+        fromjson("{a: 'str', b: 1}"),
+        fromjson("{a: [1, 7]}"),
+        fromjson("{a: [], b: null}"),
+        fromjson("{a: {b: 3}}"),
+        fromjson("{a: {b: [2, 9]}}"),
+        fromjson("{a: [{b: 4}, {b: 'x'}]}"),
+        fromjson("{a: {b: {c: 1}}, b: 7}"),
+        fromjson("{a: {'0': 6}}"),
+        fromjson("{a: [[5]], b: 5}"),
+        fromjson("{a: 3, b: [1, 2, 3]}"),
+    };
+}
+
+/**
+ * Asserts that filtering the documents above with matchesBatch() selects exactly those for which
+ * matchesBSON() returns true.
+ */
+void assertBatchMatchesEachDocument(const BSONObj& filter) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = unittest::assertGet(MatchExpressionParser::parse(filter, expCtx));
+
+    MatchBatch batch;
+    SelectionVector expected;
+    for (auto&& doc : makeDocuments()) {
+        if (expr->matchesBSON(doc)) {
+            expected.push_back(batch.size());
+        }
+        batch.append(doc);
+    }
+
+    auto selection = batch.selectAll();
+    expr->matchesBatch(&batch, &selection);
+    ASSERT_TRUE(selection == expected) << "filter: " << filter;
+}
+
+TEST(MatchBatchTest, SelectAllSelectsEveryDocument) {
+    MatchBatch batch;
+    ASSERT_TRUE(batch.selectAll().empty());
+
+    batch.append(BSON("a" << 1));
+    batch.append(BSON("a" << 2));
+    ASSERT_TRUE(batch.selectAll() == (SelectionVector{0, 1}));
+
+    batch.clear();
+    ASSERT_TRUE(batch.empty());
+}
+
+TEST(MatchBatchTest, ColumnResolvesOnlySelectedDocuments) {
+    MatchBatch batch;
+    batch.append(fromjson("{a: {b: 1}}"));
+    batch.append(fromjson("{a: {b: 2}}"));
+    batch.append(fromjson("{a: [{b: 3}]}"));
+
+    FieldRef path("a.b");
+    const auto& column = batch.getColumn(path, SelectionVector{0, 2});
+    ASSERT_EQ(column.size(), 3U);
+    ASSERT_EQ(column[0].numberInt(), 1);
+    ASSERT_EQ(column[2].type(), BSONType::Array);
+
+    const auto& resolved = batch.getColumn(path, SelectionVector{1});
+    ASSERT_EQ(resolved[0].numberInt(), 1);
+    ASSERT_EQ(resolved[1].numberInt(), 2);
+}
+
+TEST(MatchBatchTest, ComparisonMatchesEachDocument) {
+    assertBatchMatchesEachDocument(fromjson("{a: 5}"));
+    assertBatchMatchesEachDocument(fromjson("{a: null}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$gt: 2}}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$lte: 5}}"));
+    assertBatchMatchesEachDocument(fromjson("{'a.b': {$gte: 3}}"));
+    assertBatchMatchesEachDocument(fromjson("{'a.b': 'x'}"));
+    assertBatchMatchesEachDocument(fromjson("{'a.0': {$gt: 5}}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$lt: 'z'}}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$ne: 1}}"));
+}
+
+TEST(MatchBatchTest, InMatchesEachDocument) {
+    assertBatchMatchesEachDocument(fromjson("{a: {$in: [1, 5, 'str']}}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$in: [null, 7]}}"));
+    assertBatchMatchesEachDocument(fromjson("{'a.b': {$in: [3, 9, /^x/]}}"));
+    assertBatchMatchesEachDocument(fromjson("{b: {$nin: [1, 'x']}}"));
+}
+
+TEST(MatchBatchTest, ExistsAndTypeMatchEachDocument) {
+    assertBatchMatchesEachDocument(fromjson("{a: {$exists: true}}"));
+    assertBatchMatchesEachDocument(fromjson("{b: {$exists: false}}"));
+    assertBatchMatchesEachDocument(fromjson("{'a.b': {$exists: true}}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$type: 'number'}}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$type: 'array'}}"));
+    assertBatchMatchesEachDocument(fromjson("{'a.b': {$type: ['string', 'object']}}"));
+}
+
+TEST(MatchBatchTest, LogicalOperatorsMatchEachDocument) {
+    assertBatchMatchesEachDocument(fromjson("{a: {$gt: 1, $lt: 10}, b: {$exists: true}}"));
+    assertBatchMatchesEachDocument(fromjson("{$or: [{a: 1}, {b: 'x'}, {'a.b': {$gt: 2}}]}"));
+    assertBatchMatchesEachDocument(fromjson("{$or: [{a: 5}, {a: {$type: 'string'}}]}"));
+    assertBatchMatchesEachDocument(fromjson("{$nor: [{a: 1}, {b: {$exists: true}}]}"));
+    assertBatchMatchesEachDocument(fromjson("{a: {$not: {$gt: 3}}}"));
+    assertBatchMatchesEachDocument(
+        fromjson("{$and: [{$or: [{a: {$lt: 6}}, {b: 7}]}, {$nor: [{b: 'x'}]}]}"));
+    assertBatchMatchesEachDocument(fromjson("{$or: [{a: {$size: 2}}, {b: {$mod: [2, 1]}}]}"));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,123 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/match_batch.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+
+namespace mongo {
+namespace {
+
+constexpr int kBatchSize = 1024;
+
+/**
+ * Builds documents shaped like those of a typical collection scan: a few scalar fields, a
+ * subdocument and a short string, with values spread so that the filters below are selective.
+ */
+std::vector<BSONObj> makeDocuments() {
+    std::vector<BSONObj> docs;
+    docs.reserve(kBatchSize);
+    for (int i = 0; i < kBatchSize; ++i) {
+        BSONObjBuilder bob;
+        bob.append("_id", i);
+        bob.append("a", i % 100);
+        bob.append("status", (i % 10 == 0) ? "archived" : "active");
+        {
+            BSONObjBuilder sub(bob.subobjStart("b"));
+            sub.append("c", i % 7);
+            sub.append("d", static_cast<double>(i) / 3);
+        }
+        if (i % 4 == 0) {
+            bob.append("optional", true);
+        }
+        bob.append("payload", std::string(64, 'x'));
+        docs.push_back(bob.obj());
+    }
+    return docs;
+}
+
+std::unique_ptr<MatchExpression> parseFilter(const char* filter) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = MatchExpressionParser::parse(fromjson(filter), expCtx);
+    invariant(expr.isOK());
+    return std::move(expr.getValue());
+}
+
+void BM_MatchesBSON(benchmark::State& state, const char* filter) {
+    auto expr = parseFilter(filter);
+    const auto docs = makeDocuments();
+
+    for (auto _ : state) {
+        size_t nMatched = 0;
+        for (auto&& doc : docs) {
+            nMatched += expr->matchesBSON(doc);
+        }
+        benchmark::DoNotOptimize(nMatched);
+    }
+    state.SetItemsProcessed(state.iterations() * docs.size());
+}
+
+void BM_MatchesBatch(benchmark::State& state, const char* filter) {
+    auto expr = parseFilter(filter);
+    const auto docs = makeDocuments();
+
+    MatchBatch batch;
+    for (auto _ : state) {
+        // Refilling the batch is part of the cost that a collection scan pays for each batch.
+        batch.clear();
+        for (auto&& doc : docs) {
+            batch.append(doc);
+        }
+        auto selection = batch.selectAll();
+        expr->matchesBatch(&batch, &selection);
+        benchmark::DoNotOptimize(selection.data());
+    }
+    state.SetItemsProcessed(state.iterations() * docs.size());
+}
+
+#define MATCHER_BENCHMARKS(name, filter)              \
+    BENCHMARK_CAPTURE(BM_MatchesBSON, name, filter); \
+    BENCHMARK_CAPTURE(BM_MatchesBatch, name, filter);
+
+MATCHER_BENCHMARKS(Equality, "{a: 42}");
+MATCHER_BENCHMARKS(Range, "{a: {$gte: 10, $lt: 12}}");
+MATCHER_BENCHMARKS(NestedPath, "{'b.c': 3, 'b.d': {$gt: 100}}");
+MATCHER_BENCHMARKS(In, "{status: {$in: ['archived', 'deleted']}}");
+MATCHER_BENCHMARKS(ExistsAndType, "{optional: {$exists: true}, 'b.d': {$type: 'double'}}");
+MATCHER_BENCHMARKS(Or, "{$or: [{a: 1}, {'b.c': 6, status: 'archived'}]}");
+
+}  // namespace
+}  // namespace mongo
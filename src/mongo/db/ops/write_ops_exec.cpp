@@ -579,8 +579,10 @@ WriteResult performInserts(OperationContext* opCtx,
                 }
             }
 
+            // Documents that need no fixing up are inserted straight from the request, which for
+            // OP_MSG document sequences means from the received message without a copy.
             BSONObj toInsert = fixedDoc.getValue().isEmpty() ? doc : std::move(fixedDoc.getValue());
-            batch.emplace_back(stmtId, toInsert);
+            batch.emplace_back(stmtId, std::move(toInsert));
             bytesInBatch += batch.back().doc.objsize();
             if (!isLastDoc && batch.size() < maxBatchSize && bytesInBatch < maxBatchBytes)
                 continue;  // Add more to batch before inserting.
@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/accumulator.h"
 
+#include "mongo/base/data_view.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
@@ -53,9 +54,40 @@ namespace {
 const char subTotalName[] = "subTotal";
 const char subTotalErrorName[] = "subTotalError";  // Used for extra precision
 const char countName[] = "count";
+
+// The compact partial state is a BinData holding one of these format bytes followed by the
+// little-endian fields listed beside it.
+const uint8_t kCompactDoubleFormat = 1;   // double subTotal, double subTotalError, int64 count
+const uint8_t kCompactDecimalFormat = 2;  // Decimal128 subTotal (low 64 bits first), int64 count
+const size_t kCompactDoubleSize = 1 + sizeof(double) + sizeof(double) + sizeof(int64_t);
+const size_t kCompactDecimalSize = 1 + 2 * sizeof(uint64_t) + sizeof(int64_t);
 }  // namespace
 
 void AccumulatorAvg::processInternal(const Value& input, bool merging) {
+    if (merging && input.getType() == BinData) {
+        // 'input' is the compact state produced by getValue(true) below.
+        const BSONBinData binData = input.getBinData();
+        ConstDataView state(static_cast<const char*>(binData.data));
+        const size_t length = binData.length;
+        const uint8_t format = length > 0 ? state.read<uint8_t>() : 0;
+        if (format == kCompactDoubleFormat && length == kCompactDoubleSize) {
+            _nonDecimalTotal.addDouble(state.read<LittleEndian<double>>(1));
+            _nonDecimalTotal.addDouble(state.read<LittleEndian<double>>(1 + sizeof(double)));
+            _count += state.read<LittleEndian<int64_t>>(1 + 2 * sizeof(double));
+            return;
+        }
+        uassert(4910000,
+                "Invalid compact partial state for $avg",
+                format == kCompactDecimalFormat && length == kCompactDecimalSize);
+        const Decimal128 subTotal(
+            Decimal128::Value{state.read<LittleEndian<uint64_t>>(1),
+                              state.read<LittleEndian<uint64_t>>(1 + sizeof(uint64_t))});
+        _decimalTotal = _decimalTotal.add(subTotal);
+        _isDecimal = true;
+        _count += state.read<LittleEndian<int64_t>>(1 + 2 * sizeof(uint64_t));
+        return;
+    }
+
     if (merging) {
         // We expect an object that contains both a subtotal and a count. Additionally there may
         // be an error value, that allows for additional precision.
@@ -103,6 +135,29 @@ Decimal128 AccumulatorAvg::_getDecimalTotal() const {
 }
 
 Value AccumulatorAvg::getValue(bool toBeMerged) {
+    if (toBeMerged && getExpressionContext()->compactPartialAggregates) {
+        if (_isDecimal) {
+            const Decimal128::Value total = _getDecimalTotal().getValue();
+            char state[kCompactDecimalSize];
+            DataView(state)
+                .write<uint8_t>(kCompactDecimalFormat)
+                .write<LittleEndian<uint64_t>>(total.low64, 1)
+                .write<LittleEndian<uint64_t>>(total.high64, 1 + sizeof(uint64_t))
+                .write<LittleEndian<int64_t>>(_count, 1 + 2 * sizeof(uint64_t));
+            return Value(BSONBinData(state, sizeof(state), BinDataGeneral));
+        }
+
+        double total, error;
+        std::tie(total, error) = _nonDecimalTotal.getDoubleDouble();
+        char state[kCompactDoubleSize];
+        DataView(state)
+            .write<uint8_t>(kCompactDoubleFormat)
+            .write<LittleEndian<double>>(total, 1)
+            .write<LittleEndian<double>>(error, 1 + sizeof(double))
+            .write<LittleEndian<int64_t>>(_count, 1 + 2 * sizeof(double));
+        return Value(BSONBinData(state, sizeof(state), BinDataGeneral));
+    }
+
     if (toBeMerged) {
         if (_isDecimal)
             return Value(Document{{subTotalName, _getDecimalTotal()}, {countName, _count}});
@@ -31,11 +31,13 @@
 
 #include "mongo/db/pipeline/accumulator.h"
 
+#include "mongo/base/data_view.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
+#include "mongo/util/str.h"
 
 namespace mongo {
 using boost::intrusive_ptr;
@@ -49,6 +51,13 @@ const char* AccumulatorStdDev::getOpName() const {
     return (_isSamp ? "$stdDevSamp" : "$stdDevPop");
 }
 
+namespace {
+// The compact partial state is a BinData holding this format byte followed by the little-endian
+// double m2, double mean and int64 count.
+const uint8_t kCompactFormat = 1;
+const size_t kCompactSize = 1 + sizeof(double) + sizeof(double) + sizeof(int64_t);
+}  // namespace
+
 void AccumulatorStdDev::processInternal(const Value& input, bool merging) {
     if (!merging) {
         // non numeric types have no impact on standard deviation
@@ -65,10 +74,24 @@ void AccumulatorStdDev::processInternal(const Value& input, bool merging) {
         _m2 += delta * (val - _mean);
     } else {
         // This is what getValue(true) produced below.
-        verify(input.getType() == Object);
-        const double m2 = input["m2"].getDouble();
-        const double mean = input["mean"].getDouble();
-        const long long count = input["count"].getLong();
+        double m2, mean;
+        long long count;
+        if (input.getType() == BinData) {
+            const BSONBinData binData = input.getBinData();
+            ConstDataView state(static_cast<const char*>(binData.data));
+            uassert(4910001,
+                    str::stream() << "Invalid compact partial state for " << getOpName(),
+                    static_cast<size_t>(binData.length) == kCompactSize &&
+                        state.read<uint8_t>() == kCompactFormat);
+            m2 = state.read<LittleEndian<double>>(1);
+            mean = state.read<LittleEndian<double>>(1 + sizeof(double));
+            count = state.read<LittleEndian<int64_t>>(1 + 2 * sizeof(double));
+        } else {
+            verify(input.getType() == Object);
+            m2 = input["m2"].getDouble();
+            mean = input["mean"].getDouble();
+            count = input["count"].getLong();
+        }
 
         if (count == 0)
             return;  // This partition had no data to contribute.
@@ -91,6 +114,14 @@ Value AccumulatorStdDev::getValue(bool toBeMerged) {
             return Value(BSONNULL);  // standard deviation not well defined in this case
 
         return Value(sqrt(_m2 / adjustedCount));
+    } else if (getExpressionContext()->compactPartialAggregates) {
+        char state[kCompactSize];
+        DataView(state)
+            .write<uint8_t>(kCompactFormat)
+            .write<LittleEndian<double>>(_m2, 1)
+            .write<LittleEndian<double>>(_mean, 1 + sizeof(double))
+            .write<LittleEndian<int64_t>>(_count, 1 + 2 * sizeof(double));
+        return Value(BSONBinData(state, sizeof(state), BinDataGeneral));
     } else {
         return Value(DOC("m2" << _m2 << "mean" << _mean << "count" << _count));
     }
@@ -34,9 +34,11 @@
 
 #include "mongo/db/pipeline/accumulator.h"
 
+#include "mongo/base/data_view.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_context.h"
 #include "mongo/util/summation.h"
 
 namespace mongo {
@@ -53,6 +55,11 @@ const char* AccumulatorSum::getOpName() const {
 namespace {
 const char subTotalName[] = "subTotal";
 const char subTotalErrorName[] = "subTotalError";  // Used for extra precision.
+
+// The compact form of the merge document is a BinData holding this format byte followed by the
+// little-endian double subTotal and int64 subTotalError.
+const uint8_t kCompactFormat = 1;
+const size_t kCompactSize = 1 + sizeof(double) + sizeof(int64_t);
 }  // namespace
 
 
@@ -63,6 +70,18 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
             nonDecimalTotal.addDouble(
                 input[subTotalName].getDouble());              // Sum without adjusting type.
             processInternal(input[subTotalErrorName], false);  // Sum adjusting for type of error.
+        } else if (merging && input.getType() == BinData) {
+            // Process the compact form of the merge document the same way.
+            const BSONBinData binData = input.getBinData();
+            ConstDataView state(static_cast<const char*>(binData.data));
+            uassert(4910002,
+                    "Invalid compact partial state for $sum",
+                    static_cast<size_t>(binData.length) == kCompactSize &&
+                        state.read<uint8_t>() == kCompactFormat);
+            nonDecimalTotal.addDouble(state.read<LittleEndian<double>>(1));
+            processInternal(Value(static_cast<long long>(
+                                state.read<LittleEndian<int64_t>>(1 + sizeof(double)))),
+                            false);
         }
         return;
     }
@@ -112,6 +131,14 @@ Value AccumulatorSum::getValue(bool toBeMerged) {
                 double error;
                 std::tie(total, error) = nonDecimalTotal.getDoubleDouble();
                 long long llerror = static_cast<long long>(error);
+                if (getExpressionContext()->compactPartialAggregates) {
+                    char state[kCompactSize];
+                    DataView(state)
+                        .write<uint8_t>(kCompactFormat)
+                        .write<LittleEndian<double>>(total, 1)
+                        .write<LittleEndian<int64_t>>(llerror, 1 + sizeof(double));
+                    return Value(BSONBinData(state, sizeof(state), BinDataGeneral));
+                }
                 return Value(DOC(subTotalName << total << subTotalErrorName << llerror));
             }
             // Sum doesn't fit a NumberLong, so return a NumberDouble instead.
@@ -336,6 +336,88 @@ TEST(Accumulators, Sum) {
          {{Value(9), Value()}, Value(9)}});
 }
 
+/**
+ * Asserts that merging the compact partial state of AccName, as produced when
+ * 'compactPartialAggregates' is set, gives the same result as merging the document form, both when
+ * all input is on one shard and when each input is on a separate shard.
+ */
+template <typename AccName>
+static void assertCompactPartialStateMerges(std::initializer_list<std::vector<Value>> inputs) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    intrusive_ptr<ExpressionContext> compactExpCtx(new ExpressionContextForTest());
+    compactExpCtx->compactPartialAggregates = true;
+
+    for (auto&& input : inputs) {
+        auto expected = AccName::create(expCtx);
+        auto oneShard = AccName::create(expCtx);
+        auto compactShard = AccName::create(compactExpCtx);
+        auto manyShards = AccName::create(expCtx);
+        for (auto&& val : input) {
+            expected->process(val, false);
+            compactShard->process(val, false);
+
+            auto shard = AccName::create(compactExpCtx);
+            shard->process(val, false);
+            manyShards->process(shard->getValue(true), true);
+        }
+        oneShard->process(compactShard->getValue(true), true);
+
+        Value expectedResult = expected->getValue(false);
+        for (auto&& result : {oneShard->getValue(false), manyShards->getValue(false)}) {
+            ASSERT_VALUE_EQ(expectedResult, result);
+            ASSERT_EQUALS(expectedResult.getType(), result.getType());
+        }
+    }
+}
+
+TEST(Accumulators, AvgMergesCompactPartialState) {
+    assertCompactPartialStateMerges<AccumulatorAvg>({
+        {},
+        {Value(3)},
+        {Value(10), Value(11LL), Value(12.5)},
+        {Value(numeric_limits<long long>::max()), Value(numeric_limits<long long>::max())},
+        {Value(1.0), Value(Decimal128("2.5")), Value(-4)},
+    });
+
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    expCtx->compactPartialAggregates = true;
+    auto accum = AccumulatorAvg::create(expCtx);
+    accum->process(Value(1), false);
+    ASSERT_EQUALS(BinData, accum->getValue(true).getType());
+}
+
+TEST(Accumulators, SumMergesCompactPartialState) {
+    assertCompactPartialStateMerges<AccumulatorSum>({
+        {},
+        {Value(10), Value(5LL)},
+        {Value(numeric_limits<long long>::max()), Value(10LL)},
+        {Value(numeric_limits<long long>::max()),
+         Value(1.5),
+         Value(numeric_limits<long long>::max())},
+        {Value(1), Value(Decimal128("2.5"))},
+    });
+}
+
+TEST(Accumulators, StdDevMergesCompactPartialState) {
+    assertCompactPartialStateMerges<AccumulatorStdDevPop>({
+        {},
+        {Value(4)},
+        {Value(2), Value(4LL), Value(4.0), Value(4), Value(5), Value(5), Value(7), Value(9)},
+    });
+}
+
+TEST(Accumulators, MergingInvalidCompactPartialStateFails) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    const char state[] = {9, 0, 0};
+    const Value invalid(BSONBinData(state, sizeof(state), BinDataGeneral));
+    ASSERT_THROWS_CODE(
+        AccumulatorAvg::create(expCtx)->process(invalid, true), AssertionException, 4910000);
+    ASSERT_THROWS_CODE(
+        AccumulatorStdDevPop::create(expCtx)->process(invalid, true), AssertionException, 4910001);
+    ASSERT_THROWS_CODE(
+        AccumulatorSum::create(expCtx)->process(invalid, true), AssertionException, 4910002);
+}
+
 TEST(Accumulators, AddToSetRespectsCollation) {
     intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
     auto collator =
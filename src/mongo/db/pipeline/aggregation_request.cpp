@@ -160,6 +160,14 @@ StatusWith<AggregationRequest> AggregationRequest::parseFromBSON(
 
             hasNeedsMergeElem = true;
             request.setNeedsMerge(elem.Bool());
+        } else if (kCompactPartialAggregatesName == fieldName) {
+            if (elem.type() != BSONType::Bool) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << kCompactPartialAggregatesName
+                                      << " must be a boolean, not a " << typeName(elem.type())};
+            }
+
+            request.setCompactPartialAggregates(elem.Bool());
         } else if (kAllowDiskUseName == fieldName) {
             if (storageGlobalParams.readOnly) {
                 return {ErrorCodes::IllegalOperation,
@@ -264,6 +272,12 @@ StatusWith<AggregationRequest> AggregationRequest::parseFromBSON(
                               << kFromMongosName << "'"};
     }
 
+    if (request.compactPartialAggregates() && !request.needsMerge()) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "Cannot specify '" << kCompactPartialAggregatesName
+                              << "' without '" << kNeedsMergeName << "'"};
+    }
+
     return request;
 }  // namespace mongo
 
@@ -301,6 +315,7 @@ Document AggregationRequest::serializeToCommandObj() const {
         {kAllowDiskUseName, _allowDiskUse ? Value(true) : Value()},
         {kFromMongosName, _fromMongos ? Value(true) : Value()},
         {kNeedsMergeName, _needsMerge ? Value(true) : Value()},
+        {kCompactPartialAggregatesName, _compactPartialAggregates ? Value(true) : Value()},
         {bypassDocumentValidationCommandOption(),
          _bypassDocumentValidation ? Value(true) : Value()},
         // Only serialize a collation if one was specified.
@@ -56,6 +56,7 @@ public:
     static constexpr StringData kBatchSizeName = "batchSize"_sd;
     static constexpr StringData kFromMongosName = "fromMongos"_sd;
     static constexpr StringData kNeedsMergeName = "needsMerge"_sd;
+    static constexpr StringData kCompactPartialAggregatesName = "compactPartialAggregates"_sd;
     static constexpr StringData kPipelineName = "pipeline"_sd;
     static constexpr StringData kCollationName = "collation"_sd;
     static constexpr StringData kExplainName = "explain"_sd;
@@ -172,6 +173,14 @@ public:
         return _needsMerge;
     }
 
+    /**
+     * Returns true if the node merging the output of this request can decode the compact binary
+     * partial state of accumulators, which may then be used in place of BSON documents.
+     */
+    bool compactPartialAggregates() const {
+        return _compactPartialAggregates;
+    }
+
     bool shouldAllowDiskUse() const {
         return _allowDiskUse;
     }
@@ -259,6 +268,10 @@ public:
         _needsMerge = needsMerge;
     }
 
+    void setCompactPartialAggregates(bool compactPartialAggregates) {
+        _compactPartialAggregates = compactPartialAggregates;
+    }
+
     void setBypassDocumentValidation(bool shouldBypassDocumentValidation) {
         _bypassDocumentValidation = shouldBypassDocumentValidation;
     }
@@ -328,6 +341,7 @@ private:
     bool _allowDiskUse = false;
     bool _fromMongos = false;
     bool _needsMerge = false;
+    bool _compactPartialAggregates = false;
     bool _bypassDocumentValidation = false;
 
     // A user-specified maxTimeMS limit, or a value of '0' if not specified.
@@ -29,8 +29,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 #include <memory>
+#include <numeric>
 
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
@@ -140,79 +142,63 @@ DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
         invariant(initializationResult.isEOF());
     }
 
-    for (auto&& accum : _currentAccumulators) {
-        accum->reset();  // Prep accumulators for a new group.
+    return getNextStandard();
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
+    // Not streaming. Once the resident groups run out, move on to the next spilled partition.
+    while (groupsIterator == _groups->end() && !_nextSortedPair) {
+        if (_pendingPartitions.empty())
+            return GetNextResult::makeEOF();
+        readSpilledPartition();
     }
 
-    if (_spilled) {
-        return getNextSpilled();
+    Document out;
+    if (_nextSortedPair) {
+        out = getNextSortedGroup();
     } else {
-        return getNextStandard();
+        out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+        ++groupsIterator;
     }
-}
-
-DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
-    // We aren't streaming, and we have spilled to disk.
-    if (!_sorterIterator)
-        return GetNextResult::makeEOF();
 
-    _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
-
-    // Call startNewGroup on every accumulator.
-    Value expandedId = expandId(_currentId);
-    Document idDoc =
-        expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
-    for (size_t i = 0; i < numAccumulators; ++i) {
-        Value initializerValue =
-            _accumulatedFields[i].expr.initializer->evaluate(idDoc, &pExpCtx->variables);
-        _currentAccumulators[i]->startNewGroup(initializerValue);
-    }
-
-    while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
-        // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
-        // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
-
-        if (!_sorterIterator->more()) {
-            dispose();
-            break;
-        }
-
-        _firstPartOfNextGroup = _sorterIterator->next();
-    }
+    if (groupsIterator == _groups->end() && !_nextSortedPair && _pendingPartitions.empty())
+        dispose();
 
-    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    return std::move(out);
 }
 
-DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
-    // Not spilled, and not streaming.
-    if (_groups->empty())
-        return GetNextResult::makeEOF();
+Document DocumentSourceGroup::getNextSortedGroup() {
+    const Value id = _nextSortedPair->first;
+    initializeAccumulators(id, &_sortedGroupAccumulators);
 
-    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    do {
+        decodePartialAggregate(_nextSortedPair->second, &_inputs);
+        for (size_t i = 0; i < _sortedGroupAccumulators.size(); i++) {
+            _sortedGroupAccumulators[i]->process(_inputs[i], /*merging=*/true);
+        }
 
-    if (++groupsIterator == _groups->end())
-        dispose();
+        if (_sortedPartition->more()) {
+            _nextSortedPair = _sortedPartition->next();
+        } else {
+            _nextSortedPair = boost::none;
+            _sortedPartition.reset();
+            _partitionSorter.reset();
+        }
+    } while (_nextSortedPair &&
+             pExpCtx->getValueComparator().evaluate(id == _nextSortedPair->first));
 
-    return std::move(out);
+    return makeDocument(id, _sortedGroupAccumulators, pExpCtx->needsMerge);
 }
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-    _sorterIterator.reset();
+    _spilledPartitions.clear();
+    _numSpilledPartitions = 0;
+    _pendingPartitions.clear();
+    _nextSortedPair = boost::none;
+    _sortedPartition.reset();
+    _partitionSorter.reset();
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -224,11 +210,14 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
     // table.
     for (size_t i = 0; i < _idExpressions.size(); i++) {
         _idExpressions[i] = _idExpressions[i]->optimize();
+        _idPrograms[i] = ExpressionBytecode::compile(_idExpressions[i]);
     }
 
-    for (auto&& accumulatedField : _accumulatedFields) {
+    for (size_t i = 0; i < _accumulatedFields.size(); i++) {
+        auto& accumulatedField = _accumulatedFields[i];
         accumulatedField.expr.initializer = accumulatedField.expr.initializer->optimize();
         accumulatedField.expr.argument = accumulatedField.expr.argument->optimize();
+        _argumentPrograms[i] = ExpressionBytecode::compile(accumulatedField.expr.argument);
     }
 
     return this;
@@ -346,22 +335,17 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
                                                : internalDocumentSourceGroupMaxMemoryBytes.load()),
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
-      _spilled(false),
-      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
-    if (!pExpCtx->inMongos && (pExpCtx->allowDiskUse || kDebugBuild)) {
-        // We spill to disk in debug mode, regardless of allowDiskUse, to stress the system.
-        _fileName = pExpCtx->tempDir + "/" + nextFileName();
-    }
-}
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
 
-DocumentSourceGroup::~DocumentSourceGroup() {
-    if (_ownsFileDeletion) {
-        DESTRUCTOR_GUARD(boost::filesystem::remove(_fileName));
-    }
+DocumentSourceGroup::~DocumentSourceGroup() = default;
+
+DocumentSourceGroup::SpilledPartition::~SpilledPartition() {
+    DESTRUCTOR_GUARD(boost::filesystem::remove(fileName));
 }
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
     _accumulatedFields.push_back(accumulationStatement);
+    _argumentPrograms.push_back(nullptr);
 }
 
 namespace {
@@ -407,9 +391,11 @@ void DocumentSourceGroup::setIdExpression(const boost::intrusive_ptr<Expression>
         for (auto&& childExpPair : childExpressions) {
             _idFieldNames.push_back(childExpPair.first);
             _idExpressions.push_back(childExpPair.second);
+            _idPrograms.push_back(nullptr);
         }
     } else {
         _idExpressions.push_back(idExpression);
+        _idPrograms.push_back(nullptr);
     }
 }
 
@@ -449,102 +435,40 @@ namespace {
 
 using GroupsMap = DocumentSourceGroup::GroupsMap;
 
-class SorterComparator {
-public:
-    typedef pair<Value, Value> Data;
-
-    SorterComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    int operator()(const Data& lhs, const Data& rhs) const {
-        return _valueComparator.compare(lhs.first, rhs.first);
-    }
-
-private:
-    ValueComparator _valueComparator;
-};
-
-class SpillSTLComparator {
-public:
-    SpillSTLComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return _valueComparator.evaluate(lhs->first < rhs->first);
+/**
+ * Returns the approximate memory used by a group, as tracked in '_memoryUsageBytes'.
+ */
+size_t groupMemUsage(const GroupsMap::value_type& group) {
+    size_t bytes = group.first.getApproximateSize();
+    for (auto&& accum : group.second) {
+        bytes += accum->memUsageForSorter();
     }
-
-private:
-    ValueComparator _valueComparator;
-};
+    return bytes;
+}
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
+    _inputs.resize(numAccumulators);
 
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
-        }
-
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
 
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Initialize and add the accumulators
-            Value expandedId = expandId(id);
-            Document idDoc =
-                expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                auto accum = accumulatedField.makeAccumulator();
-                Value initializerValue =
-                    accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
-                accum->startNewGroup(initializerValue);
-                group.push_back(accum);
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
         for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(
-                _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
-                _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
+            _inputs[i] = _argumentPrograms[i]
+                ? _argumentPrograms[i]->evaluate(rootDocument, &pExpCtx->variables)
+                : _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables);
         }
+        processInput(id, _inputs, _doingMerge);
 
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
+        // For the same reason, do not hold on to the evaluated arguments either.
+        for (auto&& value : _inputs) {
+            value = Value();
         }
     }
 
@@ -556,35 +480,10 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             return input;  // Propagate pause.
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
-            // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
-
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles,
-                    _fileName,
-                    SortOptions(),
-                    SorterComparator(pExpCtx->getValueComparator())));
-                _ownsFileDeletion = false;
-
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator());
-                }
-
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
-            }
+            // Do any final steps necessary to prepare to output results. The resident groups are
+            // returned first, followed by the groups of each spilled partition.
+            finishPartitioningPass();
+            groupsIterator = _groups->begin();
 
             // This must happen last so that, unless control gets here, we will re-enter
             // initialization after getting a GetNextResult::ResultState::kPauseExecution.
@@ -599,54 +498,343 @@ bool DocumentSourceGroup::usedDisk() {
     return _usedDisk;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+void DocumentSourceGroup::processInput(const Value& id,
+                                       const vector<Value>& inputs,
+                                       bool merging) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        freeMemory();
+    }
+
+    if (_numSpilledPartitions > 0) {
+        if (auto& spilled = _spilledPartitions[partitionOf(id)]) {
+            // The group lives on disk, so record this input as a partial aggregate of its own to be
+            // merged with the rest of the group when the partition is read back.
+            Value partialAggregate;
+            if (merging) {
+                partialAggregate = encodePartialAggregate(inputs);
+            } else {
+                initializeAccumulators(id, &_spillAccumulators);
+                vector<Value> states;
+                states.reserve(numAccumulators);
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    _spillAccumulators[i]->process(inputs[i], false);
+                    states.push_back(_spillAccumulators[i]->getValue(/*toBeMerged=*/true));
+                }
+                partialAggregate = encodePartialAggregate(std::move(states));
+            }
+
+            addToSpilledPartition(spilled.get(), id, std::move(partialAggregate));
+            return;
+        }
+    }
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Initialize and add the accumulators
+        group.reserve(numAccumulators);
+        initializeAccumulators(id, &group);
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(inputs[i], merging);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                  // is a dup
+            !pExpCtx->inMongos &&         // can't spill to disk in mongos
+            !_allowDiskUse &&             // don't change behavior when testing external sort
+            _depth < kMaxDepth &&         // there are hash bits left to partition on
+            _numSpilledRuns < 20) {       // don't write too many runs
+            spillPartitions({partitionOf(id)});
+        }
+    }
+}
+
+size_t DocumentSourceGroup::partitionOf(const Value& id) const {
+    invariant(_depth < kMaxDepth);
+
+    // Mix the hash so that every slice of it is well distributed, even for small integer keys.
+    uint64_t hash = pExpCtx->getValueComparator().hash(id);
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+
+    return (hash >> (_depth * kPartitionBits)) & (kNumPartitions - 1);
+}
+
+void DocumentSourceGroup::freeMemory() {
+    // Inputs for groups which already live on disk can always be written out.
+    for (auto&& partition : _spilledPartitions) {
+        if (partition) {
+            writeSpilledRun(partition.get());
+        }
+    }
+
+    if (_memoryUsageBytes <= _maxMemoryUsageBytes) {
+        return;
+    }
+
+    uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+            "Exceeded memory limit for $group, but didn't allow external sort."
+            " Pass allowDiskUse:true to opt in.",
+            _allowDiskUse);
+
+    std::vector<size_t> partitionBytes(kNumPartitions, 0);
+    for (auto&& group : *_groups) {
+        partitionBytes[partitionOf(group.first)] += groupMemUsage(group);
+    }
+
+    std::vector<size_t> largestFirst(kNumPartitions);
+    std::iota(largestFirst.begin(), largestFirst.end(), 0);
+    std::sort(largestFirst.begin(), largestFirst.end(), [&](size_t lhs, size_t rhs) {
+        return partitionBytes[lhs] > partitionBytes[rhs];
+    });
+
+    std::vector<size_t> toSpill;
+    size_t remainingBytes = _memoryUsageBytes;
+    for (size_t partition : largestFirst) {
+        if (remainingBytes <= _maxMemoryUsageBytes / 2 || partitionBytes[partition] == 0) {
+            break;
+        }
+        toSpill.push_back(partition);
+        remainingBytes -= std::min(remainingBytes, partitionBytes[partition]);
+    }
+
+    spillPartitions(toSpill);
+}
+
+void DocumentSourceGroup::spillPartitions(const std::vector<size_t>& partitions) {
+    if (partitions.empty()) {
+        return;
+    }
+
     _usedDisk = true;
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+    _spilledPartitions.resize(kNumPartitions);
+    for (size_t partition : partitions) {
+        invariant(!_spilledPartitions[partition]);
+        _spilledPartitions[partition] =
+            std::make_unique<SpilledPartition>(pExpCtx->tempDir + "/" + nextFileName(), _depth);
+        ++_numSpilledPartitions;
+    }
+
+    // Partitions which were spilled earlier have no resident groups, so every group found in a
+    // spilled partition here belongs to one of 'partitions'.
+    for (auto it = _groups->begin(); it != _groups->end();) {
+        auto& spilled = _spilledPartitions[partitionOf(it->first)];
+        if (!spilled) {
+            ++it;
+            continue;
+        }
+
+        vector<Value> states;
+        states.reserve(it->second.size());
+        for (auto&& accum : it->second) {
+            states.push_back(accum->getValue(/*toBeMerged=*/true));
+        }
+        _memoryUsageBytes -= std::min(_memoryUsageBytes, groupMemUsage(*it));
+        addToSpilledPartition(spilled.get(), it->first, encodePartialAggregate(std::move(states)));
+
+        _groups->erase(it++);
+    }
+
+    for (size_t partition : partitions) {
+        writeSpilledRun(_spilledPartitions[partition].get());
+    }
+}
+
+void DocumentSourceGroup::addToSpilledPartition(SpilledPartition* partition,
+                                                const Value& id,
+                                                Value partialAggregate) {
+    if (!partition->firstKey) {
+        partition->firstKey = id;
+    } else if (!partition->hasMultipleKeys) {
+        partition->hasMultipleKeys =
+            pExpCtx->getValueComparator().evaluate(id != *partition->firstKey);
     }
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+    const size_t bytes = id.getApproximateSize() + partialAggregate.getApproximateSize();
+    partition->buffer.emplace_back(id, std::move(partialAggregate));
+    partition->bufferBytes += bytes;
+    _memoryUsageBytes += bytes;
+}
+
+void DocumentSourceGroup::writeSpilledRun(SpilledPartition* partition) {
+    if (partition->buffer.empty()) {
+        return;
+    }
 
+    // Runs are not sorted. The SortedFileWriter is only used to append them to the file.
     SortedFileWriter<Value, Value> writer(
-        SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+        SortOptions().TempDir(pExpCtx->tempDir), partition->fileName, partition->nextRunOffset);
+    for (auto&& record : partition->buffer) {
+        writer.addAlreadySorted(record.first, record.second);
+    }
+    partition->runs.emplace_back(writer.done());
+    partition->nextRunOffset = writer.getFileEndOffset();
+    ++_numSpilledRuns;
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
-            }
-            break;
+    _memoryUsageBytes -= std::min(_memoryUsageBytes, partition->bufferBytes);
+    std::vector<std::pair<Value, Value>>().swap(partition->buffer);
+    partition->bufferBytes = 0;
+}
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
-                }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
-            }
+void DocumentSourceGroup::finishPartitioningPass() {
+    for (auto&& partition : _spilledPartitions) {
+        if (partition) {
+            writeSpilledRun(partition.get());
+            _pendingPartitions.push_back(std::move(partition));
+        }
+    }
+    _spilledPartitions.clear();
+    _numSpilledPartitions = 0;
+}
+
+void DocumentSourceGroup::readSpilledPartition() {
+    invariant(!_pendingPartitions.empty());
+    std::unique_ptr<SpilledPartition> partition = std::move(_pendingPartitions.back());
+    _pendingPartitions.pop_back();
+
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    groupsIterator = _groups->end();
+    _memoryUsageBytes = 0;
+    _depth = partition->depth + 1;
+    _inputs.resize(_accumulatedFields.size());
+
+    // Partitioning again cannot help once every group left shares the whole hash, or when there
+    // is only one group to begin with, so merge the partial aggregates in key order instead.
+    if (_depth >= kMaxDepth || !partition->hasMultipleKeys) {
+        sortSpilledPartition(std::move(partition));
+        return;
+    }
+
+    // Every pair in the partition is a partial aggregate, so they are all merged. Groups which do
+    // not fit are partitioned again using the next slice of the hash.
+    for (auto&& run : partition->runs) {
+        run->openSource();
+        while (run->more()) {
+            auto record = run->next();
+            decodePartialAggregate(record.second, &_inputs);
+            processInput(record.first, _inputs, /*merging=*/true);
+        }
+        run->closeSource();
+    }
+
+    // Everything has been read back, so the partition's file can go before any of its groups are
+    // spilled again to files of their own.
+    partition.reset();
+
+    finishPartitioningPass();
+    groupsIterator = _groups->begin();
+}
+
+void DocumentSourceGroup::sortSpilledPartition(std::unique_ptr<SpilledPartition> partition) {
+    const auto& valueCmp = pExpCtx->getValueComparator();
+    auto comparator = [valueCmp](const Sorter<Value, Value>::Data& lhs,
+                                 const Sorter<Value, Value>::Data& rhs) {
+        return valueCmp.compare(lhs.first, rhs.first);
+    };
+    _partitionSorter.reset(Sorter<Value, Value>::make(SortOptions()
+                                                          .TempDir(pExpCtx->tempDir)
+                                                          .MaxMemoryUsageBytes(_maxMemoryUsageBytes)
+                                                          .ExtSortAllowed(),
+                                                      comparator));
+
+    for (auto&& run : partition->runs) {
+        run->openSource();
+        while (run->more()) {
+            auto record = run->next();
+            _partitionSorter->add(record.first, record.second);
+        }
+        run->closeSource();
+    }
+    partition.reset();
+
+    _sortedPartition.reset(_partitionSorter->done());
+    if (_sortedPartition->more()) {
+        _nextSortedPair = _sortedPartition->next();
+    } else {
+        _sortedPartition.reset();
+        _partitionSorter.reset();
+    }
+}
+
+Value DocumentSourceGroup::encodePartialAggregate(vector<Value> states) const {
+    switch (states.size()) {
+        case 0:  // No accumulators, essentially a distinct.
+            return Value();
+        case 1:  // Single accumulators serialize as a single Value.
+            return std::move(states[0]);
+        default:  // Multiple accumulators serialize as an array of Values.
+            return Value(std::move(states));
+    }
+}
+
+void DocumentSourceGroup::decodePartialAggregate(const Value& encoded,
+                                                 vector<Value>* states) const {
+    switch (states->size()) {  // mirrors switch in encodePartialAggregate()
+        case 0:
+            break;
+        case 1:
+            (*states)[0] = encoded;
+            break;
+        default:
+            *states = encoded.getArray();
+            invariant(states->size() == _accumulatedFields.size());
             break;
     }
+}
+
+void DocumentSourceGroup::initializeAccumulators(const Value& id, Accumulators* accums) {
+    if (accums->empty()) {
+        for (auto&& accumulatedField : _accumulatedFields) {
+            accums->push_back(accumulatedField.makeAccumulator());
+        }
+    } else {
+        for (auto&& accum : *accums) {
+            accum->reset();
+        }
+    }
 
-    _groups->clear();
+    Value expandedId = expandId(id);
+    Document idDoc =
+        expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+    for (size_t i = 0; i < _accumulatedFields.size(); i++) {
+        Value initializerValue =
+            _accumulatedFields[i].expr.initializer->evaluate(idDoc, &pExpCtx->variables);
+        (*accums)[i]->startNewGroup(initializerValue);
+    }
+}
 
-    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
-    _nextSortedFileWriterOffset = writer.getFileEndOffset();
-    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+Value DocumentSourceGroup::evaluateIdExpression(size_t i, const Document& root) {
+    return _idPrograms[i] ? _idPrograms[i]->evaluate(root, &pExpCtx->variables)
+                          : _idExpressions[i]->evaluate(root, &pExpCtx->variables);
 }
 
 Value DocumentSourceGroup::computeId(const Document& root) {
     // If only one expression, return result directly
     if (_idExpressions.size() == 1) {
-        Value retValue = _idExpressions[0]->evaluate(root, &pExpCtx->variables);
+        Value retValue = evaluateIdExpression(0, root);
         return retValue.missing() ? Value(BSONNULL) : std::move(retValue);
     }
 
@@ -654,7 +842,7 @@ Value DocumentSourceGroup::computeId(const Document& root) {
     vector<Value> vals;
     vals.reserve(_idExpressions.size());
     for (size_t i = 0; i < _idExpressions.size(); i++) {
-        vals.push_back(_idExpressions[i]->evaluate(root, &pExpCtx->variables));
+        vals.push_back(evaluateIdExpression(i, root));
     }
     return Value(std::move(vals));
 }
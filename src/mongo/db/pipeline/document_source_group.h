@@ -31,10 +31,12 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_bytecode.h"
 #include "mongo/db/pipeline/transformer_interface.h"
 #include "mongo/db/sorter/sorter.h"
 
@@ -188,13 +190,65 @@ private:
     ~DocumentSourceGroup();
 
     /**
-     * getNext() dispatches to one of these three depending on what type of $group it is. These
-     * methods expect '_currentAccumulators' to have been reset before being called, and also expect
-     * initialize() to have been called already.
+     * A hash partition of the groups which has been evicted to disk. Once evicted, every input for
+     * a group in the partition is written out as a partial aggregate rather than being aggregated
+     * in memory. After the resident groups have been returned, the partition is read back and
+     * re-aggregated using the next slice of hash bits, spilling again if it still does not fit.
+     *
+     * Each partition has a file of its own, which is removed when the partition is destroyed. A
+     * partition is destroyed as soon as it has been read back, so re-partitioning passes never
+     * grow the files of earlier passes.
+     *
+     * A partition which holds a single group key, or which has used up the hash bits, cannot be
+     * split any further. It is instead sorted by key and its groups are merged one at a time.
+     */
+    struct SpilledPartition {
+        SpilledPartition(const SpilledPartition&) = delete;
+        SpilledPartition& operator=(const SpilledPartition&) = delete;
+
+        SpilledPartition(std::string fileName, size_t depth)
+            : fileName(std::move(fileName)), depth(depth) {}
+        ~SpilledPartition();
+
+        const std::string fileName;
+
+        // The partitioning depth of the pass which evicted this partition.
+        const size_t depth;
+
+        // Runs of (group key, partial aggregate) pairs already written to 'fileName', and the
+        // offset at which the next run starts.
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> runs;
+        std::streampos nextRunOffset = 0;
+
+        // The first group key added to the partition, and whether any other key has been added.
+        boost::optional<Value> firstKey;
+        bool hasMultipleKeys = false;
+
+        // Pairs waiting to be appended to 'runs', and their approximate size.
+        std::vector<std::pair<Value, Value>> buffer;
+        size_t bufferBytes = 0;
+    };
+
+    // The number of partitions groups are hashed into at each depth, and the number of hash bits
+    // used to select a partition.
+    static constexpr size_t kPartitionBits = 4;
+    static constexpr size_t kNumPartitions = size_t{1} << kPartitionBits;
+
+    // Partitioning stops once every bit of the 64-bit hash has been used.
+    static constexpr size_t kMaxDepth = 64 / kPartitionBits;
+
+    /**
+     * Returns the next group, reading back the next spilled partition once all resident groups
+     * have been returned. Expects initialize() to have been called already.
      */
-    GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Merges all of the consecutive pairs with the same key from '_sortedPartition' into one group,
+     * and returns it.
+     */
+    Document getNextSortedGroup();
+
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
      * initialize() requests the first document from the previous source, and uses it to prepare the
@@ -208,11 +262,69 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
-     * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * Adds one input to the group identified by 'id'. 'inputs' holds one value per accumulator,
+     * which is either an evaluated argument or, if 'merging' is true, a partial aggregate. Inputs
+     * for groups in a spilled partition are appended to that partition instead.
+     */
+    void processInput(const Value& id, const std::vector<Value>& inputs, bool merging);
+
+    /**
+     * Returns which of the 'kNumPartitions' partitions at the current depth 'id' belongs to.
+     */
+    size_t partitionOf(const Value& id) const;
+
+    /**
+     * Called when the groups exceed the memory limit. Writes out the inputs buffered for spilled
+     * partitions and then evicts the largest resident partitions until at most half of the limit is
+     * in use, leaving the rest for buffering.
+     */
+    void freeMemory();
+
+    /**
+     * Evicts every group in the given resident partitions to disk as a partial aggregate.
+     */
+    void spillPartitions(const std::vector<size_t>& partitions);
+
+    /**
+     * Buffers the partial aggregate 'partialAggregate' for the group 'id' in 'partition'.
+     */
+    void addToSpilledPartition(SpilledPartition* partition,
+                               const Value& id,
+                               Value partialAggregate);
+
+    /**
+     * Appends the buffered inputs of 'partition' to its file as a new run.
+     */
+    void writeSpilledRun(SpilledPartition* partition);
+
+    /**
+     * Finishes the current partitioning pass by writing out all spilled partitions and queueing
+     * them to be read back after the resident groups.
+     */
+    void finishPartitioningPass();
+
+    /**
+     * Replaces the resident groups with those re-aggregated from the most recently queued spilled
+     * partition, or sorts that partition by key if it cannot be split any further.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    void readSpilledPartition();
+
+    /**
+     * Sorts the pairs in 'partition' by group key into '_sortedPartition'.
+     */
+    void sortSpilledPartition(std::unique_ptr<SpilledPartition> partition);
+
+    /**
+     * Encodes one partial aggregate per accumulator in the format stored in spilled runs, and
+     * decodes it back into 'states', which must hold one element per accumulator.
+     */
+    Value encodePartialAggregate(std::vector<Value> states) const;
+    void decodePartialAggregate(const Value& encoded, std::vector<Value>* states) const;
+
+    /**
+     * Starts a new group for 'id' in 'accums', one accumulator per accumulated field.
+     */
+    void initializeAccumulators(const Value& id, Accumulators* accums);
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
@@ -221,6 +333,11 @@ private:
      */
     Value computeId(const Document& root);
 
+    /**
+     * Evaluates the i-th group key expression against 'root'.
+     */
+    Value evaluateIdExpression(size_t i, const Document& root);
+
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
      * user.
@@ -234,38 +351,52 @@ private:
 
     std::vector<AccumulationStatement> _accumulatedFields;
 
+    // The compiled form of each accumulator's argument, or nullptr where the argument is evaluated
+    // by walking its tree. Compiled by optimize().
+    std::vector<std::unique_ptr<ExpressionBytecode>> _argumentPrograms;
+
     bool _usedDisk;  // Keeps track of whether this $group spilled to disk.
     bool _doingMerge;
     size_t _memoryUsageBytes = 0;
     size_t _maxMemoryUsageBytes;
-    std::string _fileName;
-    std::streampos _nextSortedFileWriterOffset = 0;
-    bool _ownsFileDeletion = true;  // unless a MergeIterator is made that takes over.
 
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
+    std::vector<std::unique_ptr<ExpressionBytecode>> _idPrograms;  // Parallel to '_idExpressions'.
 
     bool _initialized;
 
-    Value _currentId;
-    Accumulators _currentAccumulators;
-
     // We use boost::optional to defer initialization until the ExpressionContext containing the
     // correct comparator is injected, since the groups must be built using the comparator's
     // definition of equality.
     boost::optional<GroupsMap> _groups;
 
-    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
-    bool _spilled;
-
-    // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
 
-    // Only used when '_spilled' is true.
-    std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
-    const bool _allowDiskUse;
+    // The partitioning depth of the resident groups. Each depth selects partitions using the next
+    // 'kPartitionBits' bits of the group key's hash.
+    size_t _depth = 0;
+
+    // Indexed by partition at the current depth. Null for partitions whose groups are resident.
+    std::vector<std::unique_ptr<SpilledPartition>> _spilledPartitions;
+    size_t _numSpilledPartitions = 0;
+    size_t _numSpilledRuns = 0;
+
+    // Spilled partitions from earlier passes, waiting to be read back and re-aggregated.
+    std::vector<std::unique_ptr<SpilledPartition>> _pendingPartitions;
 
-    std::pair<Value, Value> _firstPartOfNextGroup;
+    // The partition currently being returned in key order, if any, and the next pair to be read
+    // from it. The sorter owns the files backing the iterator, so must outlive it.
+    std::unique_ptr<Sorter<Value, Value>> _partitionSorter;
+    std::unique_ptr<Sorter<Value, Value>::Iterator> _sortedPartition;
+    boost::optional<std::pair<Value, Value>> _nextSortedPair;
+    Accumulators _sortedGroupAccumulators;
+
+    // Scratch space reused for every input, to avoid allocating per document.
+    std::vector<Value> _inputs;
+    Accumulators _spillAccumulators;
+
+    const bool _allowDiskUse;
 };
 
 }  // namespace mongo
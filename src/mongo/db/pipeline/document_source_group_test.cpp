@@ -29,10 +29,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/intrusive_ptr.hpp>
 #include <deque>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -147,6 +149,110 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldMergePartialAggregatesOfSpilledPartitions) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 10 * 1024;
+
+    auto&& sumParser = AccumulationStatement::getParser("$sum", boost::none);
+    auto sumArg = BSON("" << 1);
+    auto sumExpr = sumParser(expCtx, sumArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement countStatement{"count", sumExpr};
+    auto&& pushParser = AccumulationStatement::getParser("$push", boost::none);
+    auto pushArg = BSON(""
+                        << "$round");
+    auto pushExpr = pushParser(expCtx, pushArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement pushStatement{"rounds", pushExpr};
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx, "$_id", expCtx->variablesParseState);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {countStatement, pushStatement}, maxMemoryUsageBytes);
+
+    // Far more groups than fit in memory, each of which receives inputs both before and after its
+    // partition is spilled.
+    const int numGroups = 5000;
+    const int numRounds = 3;
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int round = 0; round < numRounds; ++round) {
+        for (int id = 0; id < numGroups; ++id) {
+            inputs.emplace_back(Document{{"_id", id}, {"round", round}});
+        }
+    }
+    auto mock = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+    group->setSource(mock.get());
+
+    stdx::unordered_set<int> idSet;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(idSet.insert(doc["_id"].coerceToInt()).second);
+        ASSERT_VALUE_EQ(doc["count"], Value(numRounds));
+
+        // Each round's input is seen exactly once, though not necessarily in order.
+        ASSERT_EQ(doc["rounds"].getArray().size(), static_cast<size_t>(numRounds));
+        std::set<int> rounds;
+        for (auto&& round : doc["rounds"].getArray()) {
+            rounds.insert(round.coerceToInt());
+        }
+        ASSERT_TRUE(rounds == (std::set<int>{0, 1, 2}));
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    ASSERT_EQ(idSet.size(), static_cast<size_t>(numGroups));
+    ASSERT_TRUE(group->usedDisk());
+
+    // Each spilled partition's file is removed once it has been read back.
+    ASSERT_TRUE(boost::filesystem::is_empty(tempDir.path()));
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldMergeAGroupLargerThanTheMemoryLimitInKeyOrder) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    auto&& parser = AccumulationStatement::getParser("$push", boost::none);
+    auto accumulatorArg = BSON(""
+                               << "$str");
+    auto accExpr = parser(expCtx, accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement pushStatement{"strs", accExpr};
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx, "$_id", expCtx->variablesParseState);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    // A group which is larger than the limit can never be split into partitions that fit, so its
+    // partition is merged in key order instead. A second, small group shares the input.
+    const int numInputs = 20;
+    string str(100, 'x');
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < numInputs; ++i) {
+        inputs.emplace_back(Document{{"_id", 0}, {"str", str}});
+        if (i % 10 == 0) {
+            inputs.emplace_back(Document{{"_id", 1}, {"str", "y"_sd}});
+        }
+    }
+    auto mock = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+    group->setSource(mock.get());
+
+    map<int, size_t> sizes;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(sizes.emplace(doc["_id"].coerceToInt(), doc["strs"].getArray().size()).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    ASSERT_TRUE(sizes == (map<int, size_t>{{0, numInputs}, {1, 2}}));
+    ASSERT_TRUE(group->usedDisk());
+    ASSERT_TRUE(boost::filesystem::is_empty(tempDir.path()));
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -266,20 +266,20 @@ const char* ExpressionAbs::getOpName() const {
 
 /* ------------------------- ExpressionAdd ----------------------------- */
 
-Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const {
-    // We'll try to return the narrowest possible result value while avoiding overflow, loss
-    // of precision due to intermediate rounding or implicit use of decimal types. To do that,
-    // compute a compensated sum for non-decimal values and a separate decimal sum for decimal
-    // values, and track the current narrowest type.
-    DoubleDoubleSummation nonDecimalTotal;
-    Decimal128 decimalTotal;
-    BSONType totalType = NumberInt;
-    bool haveDate = false;
-
-    const size_t n = _children.size();
-    for (size_t i = 0; i < n; ++i) {
-        Value val = _children[i]->evaluate(root, variables);
-
+namespace {
+/**
+ * Accumulates the operands of $add. We'll try to return the narrowest possible result value while
+ * avoiding overflow, loss of precision due to intermediate rounding or implicit use of decimal
+ * types. To do that, compute a compensated sum for non-decimal values and a separate decimal sum
+ * for decimal values, and track the current narrowest type.
+ */
+class AddState {
+public:
+    /**
+     * Adds 'val' to the running total. Returns false if 'val' is nullish, in which case the result
+     * of the $add is null.
+     */
+    bool add(const Value& val) {
         switch (val.getType()) {
             case NumberDecimal:
                 decimalTotal = decimalTotal.add(val.getDecimal());
@@ -308,37 +308,66 @@ Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const
                         str::stream() << "$add only supports numeric or date types, not "
                                       << typeName(val.getType()),
                         val.nullish());
-                return Value(BSONNULL);
+                return false;
         }
+        return true;
     }
 
-    if (haveDate) {
-        int64_t longTotal;
-        if (totalType == NumberDecimal) {
-            longTotal = decimalTotal.add(nonDecimalTotal.getDecimal()).toLong();
-        } else {
-            uassert(ErrorCodes::Overflow, "date overflow in $add", nonDecimalTotal.fitsLong());
-            longTotal = nonDecimalTotal.getLong();
+    Value getValue() const {
+        if (haveDate) {
+            int64_t longTotal;
+            if (totalType == NumberDecimal) {
+                longTotal = decimalTotal.add(nonDecimalTotal.getDecimal()).toLong();
+            } else {
+                uassert(ErrorCodes::Overflow, "date overflow in $add", nonDecimalTotal.fitsLong());
+                longTotal = nonDecimalTotal.getLong();
+            }
+            return Value(Date_t::fromMillisSinceEpoch(longTotal));
+        }
+        switch (totalType) {
+            case NumberDecimal:
+                return Value(decimalTotal.add(nonDecimalTotal.getDecimal()));
+            case NumberLong:
+                dassert(nonDecimalTotal.isInteger());
+                if (nonDecimalTotal.fitsLong())
+                    return Value(nonDecimalTotal.getLong());
+            // Fallthrough.
+            case NumberInt:
+                if (nonDecimalTotal.fitsLong())
+                    return Value::createIntOrLong(nonDecimalTotal.getLong());
+            // Fallthrough.
+            case NumberDouble:
+                return Value(nonDecimalTotal.getDouble());
+            default:
+                massert(16417, "$add resulted in a non-numeric type", false);
         }
-        return Value(Date_t::fromMillisSinceEpoch(longTotal));
     }
-    switch (totalType) {
-        case NumberDecimal:
-            return Value(decimalTotal.add(nonDecimalTotal.getDecimal()));
-        case NumberLong:
-            dassert(nonDecimalTotal.isInteger());
-            if (nonDecimalTotal.fitsLong())
-                return Value(nonDecimalTotal.getLong());
-        // Fallthrough.
-        case NumberInt:
-            if (nonDecimalTotal.fitsLong())
-                return Value::createIntOrLong(nonDecimalTotal.getLong());
-        // Fallthrough.
-        case NumberDouble:
-            return Value(nonDecimalTotal.getDouble());
-        default:
-            massert(16417, "$add resulted in a non-numeric type", false);
+
+private:
+    DoubleDoubleSummation nonDecimalTotal;
+    Decimal128 decimalTotal;
+    BSONType totalType = NumberInt;
+    bool haveDate = false;
+};
+}  // namespace
+
+Value ExpressionAdd::apply(const Value* operands, size_t numOperands) {
+    AddState state;
+    for (size_t i = 0; i < numOperands; ++i) {
+        if (!state.add(operands[i]))
+            return Value(BSONNULL);
+    }
+    return state.getValue();
+}
+
+Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const {
+    AddState state;
+    const size_t n = _children.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (!state.add(_children[i]->evaluate(root, variables)))
+            return Value(BSONNULL);
     }
+    return state.getValue();
 }
 
 REGISTER_EXPRESSION(add, ExpressionAdd::parse);
@@ -861,12 +890,7 @@ static const CmpLookup cmpLookup[7] = {
 };
 }  // namespace
 
-Value ExpressionCompare::evaluate(const Document& root, Variables* variables) const {
-    Value pLeft(_children[0]->evaluate(root, variables));
-    Value pRight(_children[1]->evaluate(root, variables));
-
-    int cmp = getExpressionContext()->getValueComparator().compare(pLeft, pRight);
-
+Value ExpressionCompare::resultFromCmp(CmpOp cmpOp, int cmp) {
     // Make cmp one of 1, 0, or -1.
     if (cmp == 0) {
         // leave as 0
@@ -883,6 +907,16 @@ Value ExpressionCompare::evaluate(const Document& root, Variables* variables) co
     return Value(returnValue);
 }
 
+Value ExpressionCompare::apply(const Value& lhs, const Value& rhs) const {
+    return resultFromCmp(cmpOp, getExpressionContext()->getValueComparator().compare(lhs, rhs));
+}
+
+Value ExpressionCompare::evaluate(const Document& root, Variables* variables) const {
+    Value pLeft(_children[0]->evaluate(root, variables));
+    Value pRight(_children[1]->evaluate(root, variables));
+    return apply(pLeft, pRight);
+}
+
 const char* ExpressionCompare::getOpName() const {
     return cmpLookup[cmpOp].name;
 }
@@ -2757,23 +2791,19 @@ const char* ExpressionMod::getOpName() const {
 
 /* ------------------------- ExpressionMultiply ----------------------------- */
 
-Value ExpressionMultiply::evaluate(const Document& root, Variables* variables) const {
-    /*
-      We'll try to return the narrowest possible result value.  To do that
-      without creating intermediate Values, do the arithmetic for double
-      and integral types in parallel, tracking the current narrowest
-      type.
+namespace {
+/**
+ * Accumulates the operands of $multiply. We'll try to return the narrowest possible result value.
+ * To do that without creating intermediate Values, do the arithmetic for double and integral types
+ * in parallel, tracking the current narrowest type.
+ */
+class MultiplyState {
+public:
+    /**
+     * Multiplies the running product by 'val'. Returns false if 'val' is nullish, in which case the
+     * result of the $multiply is null.
      */
-    double doubleProduct = 1;
-    long long longProduct = 1;
-    Decimal128 decimalProduct;  // This will be initialized on encountering the first decimal.
-
-    BSONType productType = NumberInt;
-
-    const size_t n = _children.size();
-    for (size_t i = 0; i < n; ++i) {
-        Value val = _children[i]->evaluate(root, variables);
-
+    bool multiply(const Value& val) {
         if (val.numeric()) {
             BSONType oldProductType = productType;
             productType = Value::getWidestNumeric(productType, val.getType());
@@ -2796,24 +2826,54 @@ Value ExpressionMultiply::evaluate(const Document& root, Variables* variables) c
                 }
             }
         } else if (val.nullish()) {
-            return Value(BSONNULL);
+            return false;
         } else {
             uasserted(16555,
                       str::stream() << "$multiply only supports numeric types, not "
                                     << typeName(val.getType()));
         }
+        return true;
     }
 
-    if (productType == NumberDouble)
-        return Value(doubleProduct);
-    else if (productType == NumberLong)
-        return Value(longProduct);
-    else if (productType == NumberInt)
-        return Value::createIntOrLong(longProduct);
-    else if (productType == NumberDecimal)
-        return Value(decimalProduct);
-    else
-        massert(16418, "$multiply resulted in a non-numeric type", false);
+    Value getValue() const {
+        if (productType == NumberDouble)
+            return Value(doubleProduct);
+        else if (productType == NumberLong)
+            return Value(longProduct);
+        else if (productType == NumberInt)
+            return Value::createIntOrLong(longProduct);
+        else if (productType == NumberDecimal)
+            return Value(decimalProduct);
+        else
+            massert(16418, "$multiply resulted in a non-numeric type", false);
+    }
+
+private:
+    double doubleProduct = 1;
+    long long longProduct = 1;
+    Decimal128 decimalProduct;  // This will be initialized on encountering the first decimal.
+
+    BSONType productType = NumberInt;
+};
+}  // namespace
+
+Value ExpressionMultiply::apply(const Value* operands, size_t numOperands) {
+    MultiplyState state;
+    for (size_t i = 0; i < numOperands; ++i) {
+        if (!state.multiply(operands[i]))
+            return Value(BSONNULL);
+    }
+    return state.getValue();
+}
+
+Value ExpressionMultiply::evaluate(const Document& root, Variables* variables) const {
+    MultiplyState state;
+    const size_t n = _children.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (!state.multiply(_children[i]->evaluate(root, variables)))
+            return Value(BSONNULL);
+    }
+    return state.getValue();
 }
 
 REGISTER_EXPRESSION(multiply, ExpressionMultiply::parse);
@@ -4697,7 +4757,10 @@ const char* ExpressionStrLenCP::getOpName() const {
 Value ExpressionSubtract::evaluate(const Document& root, Variables* variables) const {
     Value lhs = _children[0]->evaluate(root, variables);
     Value rhs = _children[1]->evaluate(root, variables);
+    return apply(lhs, rhs);
+}
 
+Value ExpressionSubtract::apply(const Value& lhs, const Value& rhs) {
     BSONType diffType = Value::getWidestNumeric(rhs.getType(), lhs.getType());
 
     if (diffType == NumberDecimal) {
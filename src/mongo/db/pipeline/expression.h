@@ -754,6 +754,12 @@ public:
     explicit ExpressionAdd(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionVariadic<ExpressionAdd>(expCtx) {}
 
+    /**
+     * Adds the 'numOperands' values starting at 'operands' with the same type promotion and error
+     * reporting as evaluate() uses for the values of its children.
+     */
+    static Value apply(const Value* operands, size_t numOperands);
+
     Value evaluate(const Document& root, Variables* variables) const final;
     const char* getOpName() const final;
 
@@ -989,6 +995,17 @@ public:
     ExpressionCompare(const boost::intrusive_ptr<ExpressionContext>& expCtx, CmpOp cmpOp)
         : ExpressionFixedArity<ExpressionCompare, 2>(expCtx), cmpOp(cmpOp) {}
 
+    /**
+     * Returns the result of this comparison given the result 'cmp' of comparing its left operand
+     * with its right operand, where 'cmp' is negative, zero or positive.
+     */
+    static Value resultFromCmp(CmpOp cmpOp, int cmp);
+
+    /**
+     * Compares the already evaluated operands 'lhs' and 'rhs' as evaluate() does.
+     */
+    Value apply(const Value& lhs, const Value& rhs) const;
+
     Value evaluate(const Document& root, Variables* variables) const final;
     const char* getOpName() const final;
 
@@ -1782,6 +1799,12 @@ public:
     explicit ExpressionMultiply(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionVariadic<ExpressionMultiply>(expCtx) {}
 
+    /**
+     * Multiplies the 'numOperands' values starting at 'operands' with the same type promotion and
+     * error reporting as evaluate() uses for the values of its children.
+     */
+    static Value apply(const Value* operands, size_t numOperands);
+
     Value evaluate(const Document& root, Variables* variables) const final;
     const char* getOpName() const final;
 
@@ -2349,6 +2372,11 @@ public:
     explicit ExpressionSubtract(const boost::intrusive_ptr<ExpressionContext>& expCtx)
         : ExpressionFixedArity<ExpressionSubtract, 2>(expCtx) {}
 
+    /**
+     * Subtracts 'rhs' from 'lhs' as evaluate() does for the values of its children.
+     */
+    static Value apply(const Value& lhs, const Value& rhs);
+
     Value evaluate(const Document& root, Variables* variables) const final;
     const char* getOpName() const final;
 
@@ -0,0 +1,724 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_bytecode.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "mongo/db/pipeline/expression_visitor.h"
+#include "mongo/db/pipeline/expression_walker.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/platform/overflow_arithmetic.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * The Expression types which the compiler lowers to dedicated instructions.
+ */
+enum class NodeKind {
+    kUnsupported,
+    kConstant,
+    kFieldPath,
+    kAdd,
+    kAnd,
+    kCoerceToBool,
+    kCompare,
+    kCond,
+    kIfNull,
+    kMultiply,
+    kNot,
+    kOr,
+    kSubtract,
+};
+
+/**
+ * Maps an Expression to its NodeKind.
+ */
+class NodeClassifier final : public ExpressionVisitor {
+public:
+    NodeKind classify(Expression* expr) {
+        _kind = NodeKind::kUnsupported;
+        expr->acceptVisitor(this);
+        return _kind;
+    }
+
+    void visit(ExpressionConstant*) final {
+        _kind = NodeKind::kConstant;
+    }
+
+    void visit(ExpressionAdd*) final {
+        _kind = NodeKind::kAdd;
+    }
+
+    void visit(ExpressionAnd*) final {
+        _kind = NodeKind::kAnd;
+    }
+
+    void visit(ExpressionCoerceToBool*) final {
+        _kind = NodeKind::kCoerceToBool;
+    }
+
+    void visit(ExpressionCompare*) final {
+        _kind = NodeKind::kCompare;
+    }
+
+    void visit(ExpressionCond*) final {
+        _kind = NodeKind::kCond;
+    }
+
+    void visit(ExpressionFieldPath* expr) final {
+        // Only paths into $$ROOT have a dedicated instruction. Paths into other variables, and
+        // $$ROOT itself, are evaluated by the tree.
+        if (expr->isRootFieldPath() && expr->getFieldPath().getPathLength() > 1) {
+            _kind = NodeKind::kFieldPath;
+        }
+    }
+
+    void visit(ExpressionIfNull*) final {
+        _kind = NodeKind::kIfNull;
+    }
+
+    void visit(ExpressionMultiply*) final {
+        _kind = NodeKind::kMultiply;
+    }
+
+    void visit(ExpressionNot*) final {
+        _kind = NodeKind::kNot;
+    }
+
+    void visit(ExpressionOr*) final {
+        _kind = NodeKind::kOr;
+    }
+
+    void visit(ExpressionSubtract*) final {
+        _kind = NodeKind::kSubtract;
+    }
+
+    // Every other expression is evaluated by the tree.
+    void visit(ExpressionAbs*) final {}
+    void visit(ExpressionAllElementsTrue*) final {}
+    void visit(ExpressionAnyElementTrue*) final {}
+    void visit(ExpressionArray*) final {}
+    void visit(ExpressionArrayElemAt*) final {}
+    void visit(ExpressionFirst*) final {}
+    void visit(ExpressionLast*) final {}
+    void visit(ExpressionObjectToArray*) final {}
+    void visit(ExpressionArrayToObject*) final {}
+    void visit(ExpressionBsonSize*) final {}
+    void visit(ExpressionCeil*) final {}
+    void visit(ExpressionConcat*) final {}
+    void visit(ExpressionConcatArrays*) final {}
+    void visit(ExpressionDateFromString*) final {}
+    void visit(ExpressionDateFromParts*) final {}
+    void visit(ExpressionDateToParts*) final {}
+    void visit(ExpressionDateToString*) final {}
+    void visit(ExpressionDivide*) final {}
+    void visit(ExpressionExp*) final {}
+    void visit(ExpressionFilter*) final {}
+    void visit(ExpressionFloor*) final {}
+    void visit(ExpressionIn*) final {}
+    void visit(ExpressionIndexOfArray*) final {}
+    void visit(ExpressionIndexOfBytes*) final {}
+    void visit(ExpressionIndexOfCP*) final {}
+    void visit(ExpressionInternalRemoveFieldTombstones*) final {}
+    void visit(ExpressionIsNumber*) final {}
+    void visit(ExpressionLet*) final {}
+    void visit(ExpressionLn*) final {}
+    void visit(ExpressionLog*) final {}
+    void visit(ExpressionLog10*) final {}
+    void visit(ExpressionMap*) final {}
+    void visit(ExpressionMeta*) final {}
+    void visit(ExpressionMod*) final {}
+    void visit(ExpressionObject*) final {}
+    void visit(ExpressionPow*) final {}
+    void visit(ExpressionRange*) final {}
+    void visit(ExpressionReduce*) final {}
+    void visit(ExpressionReplaceOne*) final {}
+    void visit(ExpressionReplaceAll*) final {}
+    void visit(ExpressionSetDifference*) final {}
+    void visit(ExpressionSetEquals*) final {}
+    void visit(ExpressionSetIntersection*) final {}
+    void visit(ExpressionSetIsSubset*) final {}
+    void visit(ExpressionSetUnion*) final {}
+    void visit(ExpressionSize*) final {}
+    void visit(ExpressionReverseArray*) final {}
+    void visit(ExpressionSlice*) final {}
+    void visit(ExpressionIsArray*) final {}
+    void visit(ExpressionRound*) final {}
+    void visit(ExpressionSplit*) final {}
+    void visit(ExpressionSqrt*) final {}
+    void visit(ExpressionStrcasecmp*) final {}
+    void visit(ExpressionSubstrBytes*) final {}
+    void visit(ExpressionSubstrCP*) final {}
+    void visit(ExpressionStrLenBytes*) final {}
+    void visit(ExpressionBinarySize*) final {}
+    void visit(ExpressionStrLenCP*) final {}
+    void visit(ExpressionSwitch*) final {}
+    void visit(ExpressionToLower*) final {}
+    void visit(ExpressionToUpper*) final {}
+    void visit(ExpressionTrim*) final {}
+    void visit(ExpressionTrunc*) final {}
+    void visit(ExpressionType*) final {}
+    void visit(ExpressionZip*) final {}
+    void visit(ExpressionConvert*) final {}
+    void visit(ExpressionRegexFind*) final {}
+    void visit(ExpressionRegexFindAll*) final {}
+    void visit(ExpressionRegexMatch*) final {}
+    void visit(ExpressionCosine*) final {}
+    void visit(ExpressionSine*) final {}
+    void visit(ExpressionTangent*) final {}
+    void visit(ExpressionArcCosine*) final {}
+    void visit(ExpressionArcSine*) final {}
+    void visit(ExpressionArcTangent*) final {}
+    void visit(ExpressionArcTangent2*) final {}
+    void visit(ExpressionHyperbolicArcTangent*) final {}
+    void visit(ExpressionHyperbolicArcCosine*) final {}
+    void visit(ExpressionHyperbolicArcSine*) final {}
+    void visit(ExpressionHyperbolicTangent*) final {}
+    void visit(ExpressionHyperbolicCosine*) final {}
+    void visit(ExpressionHyperbolicSine*) final {}
+    void visit(ExpressionDegreesToRadians*) final {}
+    void visit(ExpressionRadiansToDegrees*) final {}
+    void visit(ExpressionDayOfMonth*) final {}
+    void visit(ExpressionDayOfWeek*) final {}
+    void visit(ExpressionDayOfYear*) final {}
+    void visit(ExpressionHour*) final {}
+    void visit(ExpressionMillisecond*) final {}
+    void visit(ExpressionMinute*) final {}
+    void visit(ExpressionMonth*) final {}
+    void visit(ExpressionSecond*) final {}
+    void visit(ExpressionWeek*) final {}
+    void visit(ExpressionIsoWeekYear*) final {}
+    void visit(ExpressionIsoDayOfWeek*) final {}
+    void visit(ExpressionIsoWeek*) final {}
+    void visit(ExpressionYear*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorAvg>*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorMax>*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorMin>*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorStdDevPop>*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorStdDevSamp>*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorSum>*) final {}
+    void visit(ExpressionFromAccumulator<AccumulatorMergeObjects>*) final {}
+    void visit(ExpressionTests::Testable*) final {}
+    void visit(ExpressionInternalJsEmit*) final {}
+    void visit(ExpressionFunction*) final {}
+    void visit(ExpressionInternalFindSlice*) final {}
+    void visit(ExpressionInternalFindPositional*) final {}
+    void visit(ExpressionInternalFindElemMatch*) final {}
+
+private:
+    NodeKind _kind = NodeKind::kUnsupported;
+};
+
+/**
+ * Returns true for the NodeKinds whose instructions cannot fail or observe anything but the input
+ * document, so evaluating them earlier than the tree would is indistinguishable from evaluating
+ * them in order.
+ */
+bool isPureLoad(NodeKind kind) {
+    return kind == NodeKind::kConstant || kind == NodeKind::kFieldPath;
+}
+
+/**
+ * Returns the value of the $$ROOT field path 'expr' within 'root'. Walks embedded documents
+ * directly and leaves the traversal of arrays to the tree.
+ */
+Value loadField(const ExpressionFieldPath* expr, const Document& root, Variables* variables) {
+    const FieldPath& path = expr->getFieldPath();
+    const size_t length = path.getPathLength();
+
+    // Index 0 is the name of the variable.
+    Value val = root[path.getFieldName(1)];
+    for (size_t i = 2; i < length; ++i) {
+        switch (val.getType()) {
+            case Object:
+                val = val.getDocument()[path.getFieldName(i)];
+                break;
+            case Array:
+                return expr->evaluate(root, variables);
+            default:
+                return Value();
+        }
+    }
+    return val;
+}
+
+Value add(const Value* operands, size_t numOperands) {
+    if (numOperands == 2) {
+        const Value& lhs = operands[0];
+        const Value& rhs = operands[1];
+        if (lhs.getType() == NumberInt && rhs.getType() == NumberInt) {
+            return Value::createIntOrLong(static_cast<long long>(lhs.getInt()) + rhs.getInt());
+        }
+        if (lhs.getType() == NumberLong && rhs.getType() == NumberLong) {
+            long long sum;
+            if (!overflow::add(lhs.getLong(), rhs.getLong(), &sum)) {
+                return Value(sum);
+            }
+        } else if (lhs.getType() == NumberDouble && rhs.getType() == NumberDouble) {
+            // A finite sum of two doubles is exactly what the compensated summation produces. That
+            // summation starts from +0.0, which turns the sum of two negative zeros into +0.0.
+            const double sum = 0.0 + lhs.getDouble() + rhs.getDouble();
+            if (std::isfinite(sum)) {
+                return Value(sum);
+            }
+        }
+    }
+    return ExpressionAdd::apply(operands, numOperands);
+}
+
+Value multiply(const Value* operands, size_t numOperands) {
+    if (numOperands == 2) {
+        const Value& lhs = operands[0];
+        const Value& rhs = operands[1];
+        if (lhs.getType() == NumberInt && rhs.getType() == NumberInt) {
+            return Value::createIntOrLong(static_cast<long long>(lhs.getInt()) * rhs.getInt());
+        }
+        if (lhs.getType() == NumberLong && rhs.getType() == NumberLong) {
+            long long product;
+            if (!overflow::mul(lhs.getLong(), rhs.getLong(), &product)) {
+                return Value(product);
+            }
+        } else if (lhs.getType() == NumberDouble && rhs.getType() == NumberDouble) {
+            return Value(lhs.getDouble() * rhs.getDouble());
+        }
+    }
+    return ExpressionMultiply::apply(operands, numOperands);
+}
+
+Value subtract(const Value& lhs, const Value& rhs) {
+    if (lhs.getType() == NumberInt && rhs.getType() == NumberInt) {
+        return Value::createIntOrLong(static_cast<long long>(lhs.getInt()) - rhs.getInt());
+    }
+    if (lhs.getType() == NumberDouble && rhs.getType() == NumberDouble) {
+        return Value(lhs.getDouble() - rhs.getDouble());
+    }
+    return ExpressionSubtract::apply(lhs, rhs);
+}
+
+template <typename T>
+int compareNumbers(T lhs, T rhs) {
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+Value compare(const ExpressionCompare* expr, const Value& lhs, const Value& rhs) {
+    // Numbers compare the same way under every collation. NaN has its own place in the BSON
+    // order, so leave it to the comparator.
+    if (lhs.getType() == rhs.getType()) {
+        switch (lhs.getType()) {
+            case NumberInt:
+                return ExpressionCompare::resultFromCmp(expr->getOp(),
+                                                        compareNumbers(lhs.getInt(), rhs.getInt()));
+            case NumberLong:
+                return ExpressionCompare::resultFromCmp(
+                    expr->getOp(), compareNumbers(lhs.getLong(), rhs.getLong()));
+            case NumberDouble:
+                if (!std::isnan(lhs.getDouble()) && !std::isnan(rhs.getDouble())) {
+                    return ExpressionCompare::resultFromCmp(
+                        expr->getOp(), compareNumbers(lhs.getDouble(), rhs.getDouble()));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return expr->apply(lhs, rhs);
+}
+
+}  // namespace
+
+/**
+ * Generates the program for an Expression tree. Driven by expression_walker::walk(), which calls
+ * preVisit() on each node, inVisit() between each pair of its children and postVisit() once all
+ * of its children have been walked.
+ *
+ * Every node writes its result to the register chosen by its parent, so the parent tells the next
+ * child where to put its result before that child is walked. Operators taking several operands
+ * have their children write to consecutive registers.
+ */
+class ExpressionBytecode::Compiler {
+public:
+    explicit Compiler(ExpressionBytecode* program) : _program(program) {}
+
+    void preVisit(Expression* expr) {
+        if (_fallbackRoot) {
+            // This node belongs to a subtree evaluated by the tree.
+            return;
+        }
+
+        Frame frame{_classifier.classify(expr), _nextDst};
+        const size_t numChildren = expr->getChildren().size();
+        switch (frame.kind) {
+            case NodeKind::kUnsupported:
+                emit(OpCode::kEvaluateTree, frame.dst, addNode(expr));
+                _fallbackRoot = expr;
+                return;
+            case NodeKind::kConstant:
+                emit(OpCode::kLoadConstant,
+                     frame.dst,
+                     addConstant(static_cast<ExpressionConstant*>(expr)->getValue()));
+                break;
+            case NodeKind::kFieldPath:
+                emit(OpCode::kLoadField, frame.dst, addNode(expr));
+                break;
+            case NodeKind::kAdd:
+            case NodeKind::kMultiply:
+                // Operands must be evaluated in order, stopping at the first nullish one, unless
+                // every remaining operand is a pure load. Track the last operand which isn't, so
+                // that the operands before it are checked as soon as they are evaluated.
+                for (size_t i = 0; i < numChildren; ++i) {
+                    if (!isPureLoad(_classifier.classify(expr->getChildren()[i].get()))) {
+                        frame.lastImpureOperand = i;
+                    }
+                }
+                frame.operands = allocateRegisters(numChildren);
+                break;
+            case NodeKind::kSubtract:
+            case NodeKind::kCompare:
+                frame.operands = allocateRegisters(2);
+                break;
+            case NodeKind::kAnd:
+            case NodeKind::kOr:
+            case NodeKind::kNot:
+            case NodeKind::kCoerceToBool:
+            case NodeKind::kCond:
+                frame.operands = allocateRegisters(1);
+                break;
+            case NodeKind::kIfNull:
+                frame.operands = frame.dst;
+                break;
+        }
+        _nextDst = frame.operands;
+        _frames.push_back(std::move(frame));
+    }
+
+    void inVisit(unsigned long long count, Expression* expr) {
+        if (_fallbackRoot) {
+            return;
+        }
+
+        auto& frame = _frames.back();
+        switch (frame.kind) {
+            case NodeKind::kAdd:
+            case NodeKind::kMultiply:
+                if (count - 1 < frame.lastImpureOperand) {
+                    frame.jumps.push_back(emit(frame.kind == NodeKind::kAdd
+                                                   ? OpCode::kAddGuard
+                                                   : OpCode::kMultiplyGuard,
+                                               frame.operands,
+                                               frame.operands + count - 1));
+                }
+                _nextDst = frame.operands + count;
+                break;
+            case NodeKind::kSubtract:
+            case NodeKind::kCompare:
+                _nextDst = frame.operands + count;
+                break;
+            case NodeKind::kAnd:
+            case NodeKind::kOr:
+                frame.jumps.push_back(emitShortCircuit(frame));
+                _nextDst = frame.operands;
+                break;
+            case NodeKind::kCond:
+                if (count == 1) {
+                    // Evaluate 'then' unless the condition is false.
+                    frame.branch = emit(OpCode::kJumpIfFalse, 0, frame.operands);
+                } else {
+                    // Skip 'else' after evaluating 'then'.
+                    frame.jumps.push_back(emit(OpCode::kJump, 0, 0));
+                    patchJumpToHere(frame.branch);
+                }
+                _nextDst = frame.dst;
+                break;
+            case NodeKind::kIfNull:
+                frame.jumps.push_back(emit(OpCode::kJumpIfNotNullish, 0, frame.dst));
+                _nextDst = frame.dst;
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+    void postVisit(Expression* expr) {
+        if (_fallbackRoot) {
+            if (_fallbackRoot == expr) {
+                _fallbackRoot = nullptr;
+            }
+            return;
+        }
+
+        auto frame = std::move(_frames.back());
+        _frames.pop_back();
+        const size_t numChildren = expr->getChildren().size();
+        switch (frame.kind) {
+            case NodeKind::kConstant:
+            case NodeKind::kFieldPath:
+                break;
+            case NodeKind::kAdd:
+            case NodeKind::kMultiply: {
+                emit(frame.kind == NodeKind::kAdd ? OpCode::kAdd : OpCode::kMultiply,
+                     frame.dst,
+                     frame.operands,
+                     numChildren);
+                if (!frame.jumps.empty()) {
+                    // The guards jump here when an operand is nullish.
+                    const size_t done = emit(OpCode::kJump, 0, 0);
+                    for (auto jump : frame.jumps) {
+                        patchJumpToHere(jump);
+                    }
+                    emit(OpCode::kLoadConstant, frame.dst, addConstant(Value(BSONNULL)));
+                    patchJumpToHere(done);
+                }
+                break;
+            }
+            case NodeKind::kSubtract:
+                emit(OpCode::kSubtract, frame.dst, frame.operands);
+                break;
+            case NodeKind::kCompare:
+                emit(OpCode::kCompare, frame.dst, frame.operands, addNode(expr));
+                break;
+            case NodeKind::kNot:
+                emit(OpCode::kNot, frame.dst, frame.operands);
+                break;
+            case NodeKind::kCoerceToBool:
+                emit(OpCode::kCoerceToBool, frame.dst, frame.operands);
+                break;
+            case NodeKind::kAnd:
+            case NodeKind::kOr: {
+                // $and is true unless some operand is false, and $or is false unless some operand
+                // is true.
+                const bool isAnd = frame.kind == NodeKind::kAnd;
+                if (numChildren > 0) {
+                    frame.jumps.push_back(emitShortCircuit(frame));
+                }
+                emit(OpCode::kLoadConstant, frame.dst, addConstant(Value(isAnd)));
+                if (!frame.jumps.empty()) {
+                    const size_t done = emit(OpCode::kJump, 0, 0);
+                    for (auto jump : frame.jumps) {
+                        patchJumpToHere(jump);
+                    }
+                    emit(OpCode::kLoadConstant, frame.dst, addConstant(Value(!isAnd)));
+                    patchJumpToHere(done);
+                }
+                break;
+            }
+            case NodeKind::kCond:
+            case NodeKind::kIfNull:
+                for (auto jump : frame.jumps) {
+                    patchJumpToHere(jump);
+                }
+                break;
+            case NodeKind::kUnsupported:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+private:
+    struct Frame {
+        NodeKind kind;
+
+        // The register receiving the result of the node.
+        uint32_t dst;
+
+        // The first register receiving the results of the node's children.
+        uint32_t operands = 0;
+
+        // For $add and $multiply, the index of the last operand which is not a pure load.
+        size_t lastImpureOperand = 0;
+
+        // Forward jumps to patch once the node's code is complete.
+        std::vector<size_t> jumps;
+
+        // For $cond, the jump over the 'then' branch.
+        size_t branch = 0;
+    };
+
+    size_t emit(OpCode op, uint32_t dst, uint32_t a, uint32_t b = 0) {
+        _program->_code.push_back({op, dst, a, b});
+        return _program->_code.size() - 1;
+    }
+
+    size_t emitShortCircuit(const Frame& frame) {
+        return emit(frame.kind == NodeKind::kAnd ? OpCode::kJumpIfFalse : OpCode::kJumpIfTrue,
+                    0,
+                    frame.operands);
+    }
+
+    void patchJumpToHere(size_t jump) {
+        _program->_code[jump].b = _program->_code.size();
+    }
+
+    uint32_t addConstant(Value value) {
+        _program->_constants.push_back(std::move(value));
+        return _program->_constants.size() - 1;
+    }
+
+    uint32_t addNode(const Expression* expr) {
+        _program->_nodes.push_back(expr);
+        return _program->_nodes.size() - 1;
+    }
+
+    uint32_t allocateRegisters(size_t count) {
+        const uint32_t first = _program->_numRegisters;
+        _program->_numRegisters += count;
+        return first;
+    }
+
+    ExpressionBytecode* const _program;
+    NodeClassifier _classifier;
+    std::vector<Frame> _frames;
+
+    // The register the next node to be visited writes its result to.
+    uint32_t _nextDst = 0;
+
+    // The root of the subtree being skipped because it is evaluated by the tree, if any.
+    const Expression* _fallbackRoot = nullptr;
+};
+
+std::unique_ptr<ExpressionBytecode> ExpressionBytecode::compile(
+    boost::intrusive_ptr<Expression> expression) {
+    if (!expression || !internalQueryEnableExpressionBytecode.load()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ExpressionBytecode> program(new ExpressionBytecode(std::move(expression)));
+    Compiler compiler(program.get());
+    expression_walker::walk(&compiler, program->_root.get());
+
+    // A lone constant, or a tree which could not be lowered at all, is cheaper to evaluate
+    // directly.
+    if (program->_code.size() == 1 && program->_code.front().op != OpCode::kLoadField) {
+        return nullptr;
+    }
+    return program;
+}
+
+size_t ExpressionBytecode::getNumTreeFallbacks() const {
+    return std::count_if(_code.begin(), _code.end(), [](const Instruction& instruction) {
+        return instruction.op == OpCode::kEvaluateTree;
+    });
+}
+
+Value ExpressionBytecode::evaluate(const Document& root, Variables* variables) const {
+    if (_numRegisters <= kNumInlineRegisters) {
+        std::array<Value, kNumInlineRegisters> registers;
+        return run(registers.data(), root, variables);
+    }
+    std::vector<Value> registers(_numRegisters);
+    return run(registers.data(), root, variables);
+}
+
+Value ExpressionBytecode::run(Value* registers, const Document& root, Variables* variables) const {
+    const size_t numInstructions = _code.size();
+    size_t pc = 0;
+    while (pc < numInstructions) {
+        const Instruction& instruction = _code[pc++];
+        switch (instruction.op) {
+            case OpCode::kLoadConstant:
+                registers[instruction.dst] = _constants[instruction.a];
+                break;
+            case OpCode::kLoadField:
+                registers[instruction.dst] =
+                    loadField(static_cast<const ExpressionFieldPath*>(_nodes[instruction.a]),
+                              root,
+                              variables);
+                break;
+            case OpCode::kEvaluateTree:
+                registers[instruction.dst] = _nodes[instruction.a]->evaluate(root, variables);
+                break;
+            case OpCode::kAdd:
+                registers[instruction.dst] = add(&registers[instruction.a], instruction.b);
+                break;
+            case OpCode::kMultiply:
+                registers[instruction.dst] = multiply(&registers[instruction.a], instruction.b);
+                break;
+            case OpCode::kSubtract:
+                registers[instruction.dst] =
+                    subtract(registers[instruction.a], registers[instruction.a + 1]);
+                break;
+            case OpCode::kCompare:
+                registers[instruction.dst] =
+                    compare(static_cast<const ExpressionCompare*>(_nodes[instruction.b]),
+                            registers[instruction.a],
+                            registers[instruction.a + 1]);
+                break;
+            case OpCode::kNot:
+                registers[instruction.dst] = Value(!registers[instruction.a].coerceToBool());
+                break;
+            case OpCode::kCoerceToBool:
+                registers[instruction.dst] = Value(registers[instruction.a].coerceToBool());
+                break;
+            case OpCode::kAddGuard:
+            case OpCode::kMultiplyGuard: {
+                const Value& operand = registers[instruction.a];
+                if (operand.nullish()) {
+                    pc = instruction.b;
+                } else if (!operand.numeric()) {
+                    // Let the operator report an invalid operand, or a second date for $add, with
+                    // the same error the tree would. A first date is a valid $add operand.
+                    const size_t numOperands = instruction.a - instruction.dst + 1;
+                    if (instruction.op == OpCode::kAddGuard) {
+                        ExpressionAdd::apply(&registers[instruction.dst], numOperands);
+                    } else {
+                        ExpressionMultiply::apply(&registers[instruction.dst], numOperands);
+                    }
+                }
+                break;
+            }
+            case OpCode::kJump:
+                pc = instruction.b;
+                break;
+            case OpCode::kJumpIfFalse:
+                if (!registers[instruction.a].coerceToBool()) {
+                    pc = instruction.b;
+                }
+                break;
+            case OpCode::kJumpIfTrue:
+                if (registers[instruction.a].coerceToBool()) {
+                    pc = instruction.b;
+                }
+                break;
+            case OpCode::kJumpIfNotNullish:
+                if (!registers[instruction.a].nullish()) {
+                    pc = instruction.b;
+                }
+                break;
+        }
+    }
+    return std::move(registers[0]);
+}
+
+}  // namespace mongo
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/variables.h"
+
+namespace mongo {
+
+/**
+ * A flat, register-based program compiled from an Expression tree.
+ *
+ * Evaluating an Expression tree makes a virtual call per node and hands every intermediate result
+ * back up the tree in a Value. The compiler lowers the operators that dominate typical $project,
+ * $addFields, $expr and $group workloads (constants, field paths, arithmetic, comparisons, boolean
+ * logic, $cond and $ifNull) into a sequence of instructions over a small register file, with
+ * typed fast paths for the common numeric cases. Any other operator is compiled into a single
+ * instruction which evaluates that subtree with Expression::evaluate(), so every tree can be
+ * compiled and the program always produces the same results, and raises the same errors, as
+ * evaluating the tree would.
+ *
+ * The program keeps the tree alive and refers to its nodes, so the tree must not be modified
+ * after compilation; callers recompile after optimizing. A program holds no state between calls
+ * to evaluate(), so it may be evaluated concurrently.
+ */
+class ExpressionBytecode {
+public:
+    /**
+     * Compiles 'expression'. Returns nullptr if compilation is disabled, or if the program would
+     * do no less work than evaluating the tree, in which case callers should keep evaluating the
+     * tree.
+     */
+    static std::unique_ptr<ExpressionBytecode> compile(boost::intrusive_ptr<Expression> expression);
+
+    /**
+     * Evaluates the program against 'root'. Equivalent to calling evaluate() on the compiled
+     * Expression.
+     */
+    Value evaluate(const Document& root, Variables* variables) const;
+
+    /**
+     * Returns the number of instructions in the program.
+     */
+    size_t getNumInstructions() const {
+        return _code.size();
+    }
+
+    /**
+     * Returns the number of subtrees which the program evaluates by walking the tree.
+     */
+    size_t getNumTreeFallbacks() const;
+
+private:
+    class Compiler;
+
+    enum class OpCode : uint8_t {
+        kLoadConstant,      // r[dst] = constants[a]
+        kLoadField,         // r[dst] = value of the $$ROOT field path nodes[a]
+        kEvaluateTree,      // r[dst] = nodes[a]->evaluate()
+        kAdd,               // r[dst] = $add of the b registers starting at r[a]
+        kMultiply,          // r[dst] = $multiply of the b registers starting at r[a]
+        kSubtract,          // r[dst] = r[a] - r[a + 1]
+        kCompare,           // r[dst] = the comparison nodes[b] applied to r[a] and r[a + 1]
+        kNot,               // r[dst] = !r[a]
+        kCoerceToBool,      // r[dst] = bool(r[a])
+        kAddGuard,          // validates $add operand r[a] of those starting at r[dst]; jump to b
+                            // if it is nullish
+        kMultiplyGuard,     // as kAddGuard, for $multiply
+        kJump,              // jump to b
+        kJumpIfFalse,       // jump to b if !r[a]
+        kJumpIfTrue,        // jump to b if r[a]
+        kJumpIfNotNullish,  // jump to b if r[a] is not nullish
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint32_t dst;
+        uint32_t a;
+        uint32_t b;
+    };
+
+    // Programs using at most this many registers keep them on the stack during evaluate().
+    static constexpr size_t kNumInlineRegisters = 16;
+
+    explicit ExpressionBytecode(boost::intrusive_ptr<Expression> root) : _root(std::move(root)) {}
+
+    /**
+     * Runs the program using 'registers', which must hold at least '_numRegisters' values, and
+     * returns the contents of the result register.
+     */
+    Value run(Value* registers, const Document& root, Variables* variables) const;
+
+    // The compiled tree, which owns every node referenced from '_nodes'.
+    boost::intrusive_ptr<Expression> _root;
+
+    std::vector<Instruction> _code;
+    std::vector<Value> _constants;
+    std::vector<const Expression*> _nodes;
+
+    // Register 0 holds the result.
+    size_t _numRegisters = 1;
+};
+
+}  // namespace mongo
@@ -0,0 +1,216 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_bytecode.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class ExpressionBytecodeTest : public unittest::Test {
+protected:
+    // Compilation is off by default, so enable it for the duration of each test.
+    void setUp() override {
+        internalQueryEnableExpressionBytecode.store(true);
+    }
+
+    void tearDown() override {
+        internalQueryEnableExpressionBytecode.store(false);
+    }
+
+    boost::intrusive_ptr<Expression> parse(const std::string& json) {
+        return Expression::parseOperand(_expCtx,
+                                        BSON("" << fromjson(json)).firstElement(),
+                                        _expCtx->variablesParseState)
+            ->optimize();
+    }
+
+    std::unique_ptr<ExpressionBytecode> compile(const std::string& json) {
+        return ExpressionBytecode::compile(parse(json));
+    }
+
+    /**
+     * Asserts that the compiled form of 'json' returns the same value as the tree for each of
+     * 'docs'.
+     */
+    void assertSameResults(const std::string& json, const std::vector<std::string>& docs) {
+        auto expression = parse(json);
+        auto program = ExpressionBytecode::compile(expression);
+        ASSERT(program) << json;
+        for (auto&& doc : docs) {
+            const Document root(fromjson(doc));
+            const Value expected = expression->evaluate(root, &_expCtx->variables);
+            const Value actual = program->evaluate(root, &_expCtx->variables);
+            ASSERT_VALUE_EQ(expected, actual);
+            ASSERT_EQ(expected.getType(), actual.getType()) << json << " on " << doc;
+            if (expected.getType() == NumberDouble) {
+                ASSERT_EQ(std::signbit(expected.getDouble()), std::signbit(actual.getDouble()))
+                    << json << " on " << doc;
+            }
+        }
+    }
+
+    boost::intrusive_ptr<ExpressionContextForTest> _expCtx = new ExpressionContextForTest();
+};
+
+TEST_F(ExpressionBytecodeTest, DoesNotCompileTreesWhichCannotBeLowered) {
+    ASSERT_FALSE(compile("{$const: 5}"));
+    ASSERT_FALSE(compile("{$concat: ['$a', '$b']}"));
+    ASSERT_FALSE(compile("'$$ROOT'"));
+}
+
+TEST_F(ExpressionBytecodeTest, DoesNotCompileWhenDisabled) {
+    internalQueryEnableExpressionBytecode.store(false);
+    ASSERT_FALSE(compile("{$add: ['$a', '$b']}"));
+}
+
+TEST_F(ExpressionBytecodeTest, EvaluatesUnsupportedSubtreesWithTheTree) {
+    auto program = compile("{$add: [{$strLenBytes: '$s'}, '$n']}");
+    ASSERT(program);
+    ASSERT_EQ(1U, program->getNumTreeFallbacks());
+    ASSERT_VALUE_EQ(Value(7),
+                    program->evaluate(Document{{"s", "abcd"_sd}, {"n", 3}}, &_expCtx->variables));
+}
+
+TEST_F(ExpressionBytecodeTest, FieldPaths) {
+    assertSameResults("'$a.b.c'",
+                      {"{}",
+                       "{a: 1}",
+                       "{a: {b: {c: 5}}}",
+                       "{a: {b: [{c: 1}, {d: 2}, {c: 3}]}}",
+                       "{a: [{b: {c: 1}}, {b: 2}, [{b: {c: 3}}]]}"});
+}
+
+TEST_F(ExpressionBytecodeTest, Arithmetic) {
+    const std::vector<std::string> docs = {
+        "{a: 1, b: 2}",
+        "{a: 2147483647, b: 2147483647}",
+        "{a: NumberLong('9223372036854775807'), b: NumberLong(1)}",
+        "{a: NumberLong(-5), b: NumberLong(7)}",
+        "{a: 1.5, b: 2.25}",
+        "{a: -0.0, b: -0.0}",
+        "{a: -0.0, b: 0.0}",
+        "{a: 1e308, b: 1e308}",
+        "{a: NaN, b: 1.0}",
+        "{a: 1, b: 2.5}",
+        "{a: NumberDecimal('1.1'), b: 2}",
+        "{a: new Date(1000), b: 5}",
+        "{a: null, b: 1}",
+        "{b: 1}",
+    };
+    assertSameResults("{$add: ['$a', '$b']}", docs);
+    assertSameResults("{$add: ['$a', '$b', 1, 2.5]}", docs);
+    assertSameResults("{$subtract: ['$a', '$b']}", docs);
+    assertSameResults("{$multiply: ['$a', '$b']}", docs);
+    assertSameResults("{$multiply: [{$add: ['$a', 1]}, {$subtract: ['$b', 1]}]}", docs);
+}
+
+TEST_F(ExpressionBytecodeTest, Comparisons) {
+    const std::vector<std::string> docs = {
+        "{a: 1, b: 2}",
+        "{a: 2, b: 2}",
+        "{a: NumberLong(3), b: NumberLong(2)}",
+        "{a: 1.5, b: 1.5}",
+        "{a: NaN, b: 1.0}",
+        "{a: NaN, b: NaN}",
+        "{a: 1, b: 1.0}",
+        "{a: 'x', b: 'y'}",
+        "{a: null}",
+        "{}",
+    };
+    for (auto op : {"$eq", "$ne", "$gt", "$gte", "$lt", "$lte", "$cmp"}) {
+        assertSameResults(std::string("{") + op + ": ['$a', '$b']}", docs);
+    }
+}
+
+TEST_F(ExpressionBytecodeTest, LogicalOperatorsAndConditionals) {
+    const std::vector<std::string> docs = {
+        "{a: 1, b: 0}", "{a: 0, b: 1}", "{a: null, b: true}", "{b: 'x'}", "{a: [], b: false}"};
+    assertSameResults("{$and: ['$a', '$b']}", docs);
+    assertSameResults("{$or: ['$a', '$b']}", docs);
+    assertSameResults("{$not: ['$a']}", docs);
+    assertSameResults("{$and: ['$a', {$or: ['$b', {$not: ['$a']}]}, {$gt: ['$a', 0]}]}", docs);
+    assertSameResults("{$cond: ['$a', '$b', {$add: ['$b', 1]}]}", docs);
+    assertSameResults("{$cond: [{$gt: ['$a', 0]}, {$cond: ['$b', 1, 2]}, 3]}", docs);
+    assertSameResults("{$ifNull: ['$a', '$b']}", docs);
+    assertSameResults("{$ifNull: [{$add: ['$a', 1]}, {$ifNull: ['$c', 'default']}]}", docs);
+}
+
+TEST_F(ExpressionBytecodeTest, StopsEvaluatingArithmeticOperandsAtTheFirstNullishOne) {
+    // The tree returns null without evaluating the $divide, which would fail.
+    auto program = compile("{$add: ['$a', {$divide: [1, '$zero']}]}");
+    ASSERT(program);
+    ASSERT_VALUE_EQ(Value(BSONNULL),
+                    program->evaluate(Document{{"zero", 0}}, &_expCtx->variables));
+
+    program = compile("{$multiply: ['$a', {$divide: [1, '$zero']}, '$b']}");
+    ASSERT(program);
+    ASSERT_VALUE_EQ(Value(BSONNULL),
+                    program->evaluate(Document{{"a", BSONNULL}, {"zero", 0}}, &_expCtx->variables));
+}
+
+TEST_F(ExpressionBytecodeTest, ReportsTheSameErrorsAsTheTree) {
+    auto program = compile("{$add: ['$a', {$divide: [1, '$zero']}]}");
+    ASSERT(program);
+    ASSERT_THROWS_CODE(program->evaluate(Document{{"a", "str"_sd}, {"zero", 0}},
+                                         &_expCtx->variables),
+                       AssertionException,
+                       16554);
+
+    program = compile("{$add: ['$a', '$b', {$divide: [1, '$zero']}]}");
+    ASSERT(program);
+    ASSERT_THROWS_CODE(
+        program->evaluate(Document{{"a", Date_t::fromMillisSinceEpoch(1)},
+                                   {"b", Date_t::fromMillisSinceEpoch(2)},
+                                   {"zero", 0}},
+                          &_expCtx->variables),
+        AssertionException,
+        16612);
+
+    program = compile("{$multiply: ['$a', {$divide: [1, '$zero']}]}");
+    ASSERT(program);
+    ASSERT_THROWS_CODE(program->evaluate(Document{{"a", "str"_sd}, {"zero", 0}},
+                                         &_expCtx->variables),
+                       AssertionException,
+                       16555);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
 #include "mongo/db/query/collation/collation_spec.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/server_options.h"
 #include "mongo/util/intrusive_counter.h"
 #include "mongo/util/scopeguard.h"
 
@@ -74,6 +75,13 @@ ExpressionContext::ExpressionContext(OperationContext* opCtx,
         // 'jsHeapLimitMB' limit.
         jsHeapLimitMB = boost::none;
     }
+
+    // A router which is not yet aware of a downgrade may still ask for compact partial state, so
+    // it is only produced while this node's FCV guarantees that every merging node can read it.
+    compactPartialAggregates = request.compactPartialAggregates() &&
+        serverGlobalParams.featureCompatibility.isVersionInitialized() &&
+        serverGlobalParams.featureCompatibility.getVersion() ==
+            ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo46;
 }
 
 ExpressionContext::ExpressionContext(
@@ -222,6 +230,7 @@ intrusive_ptr<ExpressionContext> ExpressionContext::copyWith(
                                                     uuid);
 
     expCtx->inMongos = inMongos;
+    expCtx->compactPartialAggregates = compactPartialAggregates;
     expCtx->maxFeatureCompatibilityVersion = maxFeatureCompatibilityVersion;
     expCtx->subPipelineDepth = subPipelineDepth;
     expCtx->tempDir = tempDir;
@@ -307,6 +307,9 @@ public:
 
     bool fromMongos = false;
     bool needsMerge = false;
+    // When true, $sum, $avg and $stdDev produce compact binary partial state for the merging node.
+    // The partial state of other accumulators is already just the values they have seen.
+    bool compactPartialAggregates = false;
     bool inMongos = false;
     bool allowDiskUse = false;
     bool bypassDocumentValidation = false;
@@ -48,6 +48,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
 #include "mongo/db/pipeline/semantic_analysis.h"
+#include "mongo/db/server_options.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/catalog/type_shard.h"
@@ -731,6 +732,16 @@ BSONObj createCommandForTargetedShards(const boost::intrusive_ptr<ExpressionCont
     if (needsMerge) {
         targetedCmd[AggregationRequest::kNeedsMergeName] = Value(true);
 
+        // Ask the shards for compact partial accumulator state only once the cluster is fully
+        // upgraded to 4.6, so that neither the shards nor whichever node runs the merging half
+        // can be an older binary which does not understand it. Each shard checks its own FCV
+        // again before honoring the request.
+        if (serverGlobalParams.featureCompatibility.isVersionInitialized() &&
+            serverGlobalParams.featureCompatibility.getVersion() ==
+                ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo46) {
+            targetedCmd[AggregationRequest::kCompactPartialAggregatesName] = Value(true);
+        }
+
         // If there aren't any stages like $out in the pipeline being sent to the shards, remove the
         // write concern. The write concern should only be applied when there are writes performed
         // to avoid mistakenly waiting for writes which didn't happen.
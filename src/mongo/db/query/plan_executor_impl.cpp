@@ -51,9 +51,11 @@
 #include "mongo/db/exec/trial_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/operation_arena.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/logv2/log.h"
@@ -194,6 +196,14 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PlanExecutorImpl::ma
         return status;
     }
 
+    // Plan selection is complete, so the shape of the tree is now fixed and we can decide whether
+    // it may be executed a batch at a time. Each stage answers for the children it will work,
+    // which for MULTI_PLAN is only the winning plan.
+    const int batchSize = internalQueryExecBatchSize.load();
+    if (batchSize > 0 && execImpl->_root->supportsBatchedExecution()) {
+        execImpl->_batchSize = static_cast<size_t>(batchSize);
+    }
+
     return std::move(exec);
 }
 
@@ -325,6 +335,11 @@ void PlanExecutorImpl::saveState() {
     if (!isMarkedAsKilled()) {
         _root->saveState();
     }
+
+    // Buffered results may outlive the storage engine snapshot that produced them.
+    for (auto&& id : _batchedResults) {
+        _workingSet->get(id)->makeObjOwnedIfNeeded();
+    }
     _currentState = kSaved;
 }
 
@@ -507,6 +522,7 @@ PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* ob
     }
 
     invariant(_currentState == kUsable);
+
     if (isMarkedAsKilled()) {
         if (nullptr != objOut) {
             *objOut = Snapshotted<Document>(SnapshotId(),
@@ -533,13 +549,19 @@ PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* ob
         // We always construct the CappedInsertNotifier for awaitData cursors.
         cappedInsertNotifierData.notifier = _getCappedInsertNotifier();
     }
+    Arena* const arena =
+        internalQueryEnableOperationArena.load() ? &OperationArena::get(_opCtx) : nullptr;
+
     for (;;) {
         // These are the conditions which can cause us to yield:
         //   1) The yield policy's timer elapsed, or
         //   2) some stage requested a yield, or
         //   3) we need to yield and retry due to a WriteConflictException.
         // In all cases, the actual yielding happens here.
-        if (_yieldPolicy->shouldYieldOrInterrupt()) {
+        //
+        // We never yield while holding batched results, both to amortize the yield check across
+        // the batch and because those results may point into storage engine memory.
+        if (_batchedResults.empty() && _yieldPolicy->shouldYieldOrInterrupt()) {
             auto yieldStatus = _yieldPolicy->yieldOrInterrupt();
             if (!yieldStatus.isOK()) {
                 if (objOut) {
@@ -551,7 +573,17 @@ PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* ob
         }
 
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code;
+        {
+            // Only the documents built by the plan while producing a result are drawn from the
+            // operation's arena, not the executor's own state or anything it sets up to yield.
+            // Any which are still referenced when the operation ends simply keep their blocks.
+            boost::optional<Arena::CurrentScope> arenaScope;
+            if (arena) {
+                arenaScope.emplace(arena);
+            }
+            code = _workRoot(&id);
+        }
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
@@ -654,9 +686,30 @@ PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* ob
     }
 }
 
+PlanStage::StageState PlanExecutorImpl::_workRoot(WorkingSetID* out) {
+    if (_batchedResults.empty()) {
+        if (!_batchSize) {
+            return _root->work(out);
+        }
+
+        WorkingSetIDBatch batch;
+        batch.reserve(_batchSize);
+        const PlanStage::StageState code = _root->workBatch(_batchSize, &batch);
+        if (PlanStage::ADVANCED != code) {
+            *out = batch.empty() ? WorkingSet::INVALID_ID : batch.front();
+            return code;
+        }
+        _batchedResults.insert(_batchedResults.end(), batch.begin(), batch.end());
+    }
+
+    *out = _batchedResults.front();
+    _batchedResults.pop_front();
+    return PlanStage::ADVANCED;
+}
+
 bool PlanExecutorImpl::isEOF() {
     invariant(_currentState == kUsable);
-    return isMarkedAsKilled() || (_stash.empty() && _root->isEOF());
+    return isMarkedAsKilled() || (_stash.empty() && _batchedResults.empty() && _root->isEOF());
 }
 
 void PlanExecutorImpl::markAsKilled(Status killStatus) {
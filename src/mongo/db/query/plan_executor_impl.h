@@ -30,8 +30,11 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 #include <queue>
 
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/working_set.h"
 #include "mongo/db/query/plan_executor.h"
 
 namespace mongo {
@@ -155,6 +158,13 @@ private:
      */
     ExecState _getNextImpl(Snapshotted<Document>* objOut, RecordId* dlOut);
 
+    /**
+     * Obtains the next unit of output from the plan. When batched execution is enabled, results
+     * are pulled from the root stage a batch at a time and handed out one at a time from
+     * '_batchedResults'; otherwise this simply calls work() on the root stage.
+     */
+    PlanStage::StageState _workRoot(WorkingSetID* out);
+
     // The OperationContext that we're executing within. This can be updated if necessary by using
     // detachFromOperationContext() and reattachToOperationContext().
     OperationContext* _opCtx;
@@ -189,6 +199,15 @@ private:
     // stages.
     std::queue<Document> _stash;
 
+    // The maximum number of units of work requested from '_root' per call to workBatch(), or zero
+    // if the plan is executed one result at a time. Batched execution is only used if every stage
+    // in the plan supports it.
+    size_t _batchSize = 0;
+
+    // Results produced by the most recent call to workBatch() on '_root' which have not yet been
+    // returned to the caller. Always empty when '_batchSize' is zero.
+    std::deque<WorkingSetID> _batchedResults;
+
     // The output document that is used by getNext BSON API. This allows us to avoid constantly
     // allocating and freeing DocumentStorage.
     Document _docOutput;
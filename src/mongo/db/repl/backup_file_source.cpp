@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/backup_file_source.h"
+
+#include <boost/filesystem/path.hpp>
+#include <fstream>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const auto getBackupFileSource = ServiceContext::declareDecoration<BackupFileSource>();
+
+}  // namespace
+
+constexpr Minutes BackupFileSource::kBackupIdleTimeout;
+constexpr std::size_t BackupFileSource::kMaxReadBytes;
+
+// static
+BackupFileSource* BackupFileSource::get(ServiceContext* service) {
+    return &getBackupFileSource(service);
+}
+
+// static
+BackupFileSource* BackupFileSource::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+BackupFileSource::Backup BackupFileSource::openBackup(OperationContext* opCtx) {
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    const auto now = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_backup) {
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Backup " << _backup->backupId
+                              << " is already open for a syncing node",
+                now - _backup->lastUsed >= kBackupIdleTimeout);
+        LOGV2(5097149,
+              "Closing idle backup to open a new one",
+              "backupId"_attr = _backup->backupId,
+              "lastUsed"_attr = _backup->lastUsed);
+        _closeBackup(lk, opCtx);
+    }
+
+    // A checkpoint taken after this read could only be newer than the one the backup opens, so
+    // applying the oplog from here on never misses an operation the files lack.
+    Backup backup{UUID::gen(), storageEngine->getLastStableRecoveryTimestamp(), {}};
+    auto backupInformation = uassertStatusOK(
+        storageEngine->beginNonBlockingBackup(opCtx, StorageEngine::BackupOptions()));
+
+    OpenBackup openBackup{backup.backupId, now, {}};
+    const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+    for (auto&& [path, file] : backupInformation) {
+        auto filename = boost::filesystem::path(path).lexically_relative(dbpath).generic_string();
+        backup.files.push_back({filename, file.fileSize});
+        openBackup.files.emplace(std::move(filename), std::make_pair(path, file.fileSize));
+    }
+    _backup = std::move(openBackup);
+
+    LOGV2(5097150,
+          "Opened backup for a syncing node",
+          "backupId"_attr = backup.backupId,
+          "checkpointTimestamp"_attr = backup.checkpointTimestamp,
+          "files"_attr = backup.files.size());
+    return backup;
+}
+
+std::string BackupFileSource::readFile(OperationContext* opCtx,
+                                       const UUID& backupId,
+                                       StringData filename,
+                                       std::uint64_t offset,
+                                       std::size_t length) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    uassert(ErrorCodes::NoSuchKey,
+            str::stream() << "Backup " << backupId << " is not open",
+            _backup && _backup->backupId == backupId);
+
+    // Only the files listed by the storage engine can be read, whatever the filename names.
+    auto it = _backup->files.find(filename.toString());
+    uassert(ErrorCodes::NoSuchKey,
+            str::stream() << "File '" << filename << "' is not part of backup " << backupId,
+            it != _backup->files.end());
+    _backup->lastUsed = opCtx->getServiceContext()->getFastClockSource()->now();
+
+    const auto& [path, fileSize] = it->second;
+    if (offset >= fileSize) {
+        return {};
+    }
+    length = std::min<std::uint64_t>({length, kMaxReadBytes, fileSize - offset});
+
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    uassert(ErrorCodes::FileOpenFailed,
+            str::stream() << "Failed to open backup file '" << path << "'",
+            stream.is_open());
+
+    std::string data(length, '\0');
+    stream.seekg(offset);
+    stream.read(&data[0], length);
+    uassert(ErrorCodes::FileStreamFailed,
+            str::stream() << "Failed to read " << length << " bytes at offset " << offset
+                          << " of backup file '" << path << "'",
+            stream.gcount() == static_cast<std::streamsize>(length));
+    return data;
+}
+
+void BackupFileSource::closeBackup(OperationContext* opCtx, const UUID& backupId) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_backup && _backup->backupId == backupId) {
+        _closeBackup(lk, opCtx);
+    }
+}
+
+void BackupFileSource::_closeBackup(WithLock, OperationContext* opCtx) {
+    opCtx->getServiceContext()->getStorageEngine()->endNonBlockingBackup(opCtx);
+    _backup = boost::none;
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,129 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+namespace repl {
+
+/**
+ * Serves the files of a non-blocking backup of this node's storage engine to a node syncing from
+ * it, so that the syncing node can copy the data files instead of cloning every collection.
+ *
+ * At most one backup is open at a time, as the storage engine supports no more. A backup that has
+ * not been used for 'kBackupIdleTimeout' is closed when another one is requested, so that a
+ * syncing node which went away does not keep the backup's checkpoint and oplog pinned for good.
+ */
+class BackupFileSource {
+    BackupFileSource(const BackupFileSource&) = delete;
+    BackupFileSource& operator=(const BackupFileSource&) = delete;
+
+public:
+    static constexpr Minutes kBackupIdleTimeout{10};
+
+    // The most bytes returned by a single readFile() call.
+    static constexpr std::size_t kMaxReadBytes = 4 * 1024 * 1024;
+
+    struct File {
+        // Relative to the dbpath.
+        std::string filename;
+        std::uint64_t fileSize;
+    };
+
+    struct Backup {
+        UUID backupId;
+
+        // The oplog must be applied from this timestamp on to make the copied files consistent.
+        // Unset if the storage engine has not taken a stable checkpoint.
+        boost::optional<Timestamp> checkpointTimestamp;
+
+        std::vector<File> files;
+    };
+
+    BackupFileSource() = default;
+
+    static BackupFileSource* get(ServiceContext* service);
+    static BackupFileSource* get(OperationContext* opCtx);
+
+    /**
+     * Opens a non-blocking backup of the storage engine. Throws ConflictingOperationInProgress if
+     * a backup is already open and has been used within 'kBackupIdleTimeout'.
+     */
+    Backup openBackup(OperationContext* opCtx);
+
+    /**
+     * Returns up to 'length' bytes of 'filename' from 'offset' on, and nothing past the size the
+     * file had when the backup was opened. Only files of the open backup 'backupId' can be read.
+     */
+    std::string readFile(OperationContext* opCtx,
+                         const UUID& backupId,
+                         StringData filename,
+                         std::uint64_t offset,
+                         std::size_t length);
+
+    /**
+     * Closes the open backup 'backupId'. Does nothing if that backup is no longer open.
+     */
+    void closeBackup(OperationContext* opCtx, const UUID& backupId);
+
+private:
+    struct OpenBackup {
+        UUID backupId;
+        Date_t lastUsed;
+
+        // The absolute path and size of each file of the backup, by filename.
+        stdx::unordered_map<std::string, std::pair<std::string, std::uint64_t>> files;
+    };
+
+    void _closeBackup(WithLock, OperationContext* opCtx);
+
+    // Held while reading a file, so that the backup cannot be closed in the meantime.
+    Mutex _mutex = MONGO_MAKE_LATCH("BackupFileSource::_mutex");
+    boost::optional<OpenBackup> _backup;
+};
+
+}  // namespace repl
+}  // namespace mongo
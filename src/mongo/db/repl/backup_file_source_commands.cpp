@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/repl/backup_file_source.h"
+#include "mongo/db/repl/repl_set_command.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * Opens a backup of this node's files for a node syncing from it.
+ *
+ * {_openSyncSourceBackup: 1} returns
+ * {backupId: <UUID>, checkpointTimestamp: <Timestamp>, files: [{filename, fileSize}, ...]}
+ */
+class CmdOpenSyncSourceBackup : public ReplSetCommand {
+public:
+    CmdOpenSyncSourceBackup() : ReplSetCommand("_openSyncSourceBackup") {}
+
+    std::string help() const override {
+        return "Internal command to open a backup of this node's files for a syncing node.";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        auto backup = BackupFileSource::get(opCtx)->openBackup(opCtx);
+
+        backup.backupId.appendToBuilder(&result, "backupId");
+        if (backup.checkpointTimestamp) {
+            result.append("checkpointTimestamp", *backup.checkpointTimestamp);
+        }
+        BSONArrayBuilder files(result.subarrayStart("files"));
+        for (auto&& file : backup.files) {
+            files.append(BSON("filename" << file.filename << "fileSize"
+                                         << static_cast<long long>(file.fileSize)));
+        }
+        return true;
+    }
+} cmdOpenSyncSourceBackup;
+
+/**
+ * Reads a chunk of a file of the open backup.
+ *
+ * {_readSyncSourceBackupFile: <backupId>, filename: <string>, offset: <number>, length: <number>}
+ * returns {data: <BinData>} of at most BackupFileSource::kMaxReadBytes, which is empty past the end
+ * of the file.
+ */
+class CmdReadSyncSourceBackupFile : public ReplSetCommand {
+public:
+    CmdReadSyncSourceBackupFile() : ReplSetCommand("_readSyncSourceBackupFile") {}
+
+    std::string help() const override {
+        return "Internal command to read a file of a backup opened by _openSyncSourceBackup.";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        auto backupId = uassertStatusOK(UUID::parse(cmdObj.firstElement()));
+        std::string filename;
+        uassertStatusOK(bsonExtractStringField(cmdObj, "filename", &filename));
+        long long offset;
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "offset", &offset));
+        long long length;
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "length", &length));
+        uassert(ErrorCodes::BadValue,
+                "'offset' and 'length' must not be negative",
+                offset >= 0 && length >= 0);
+
+        auto data =
+            BackupFileSource::get(opCtx)->readFile(opCtx, backupId, filename, offset, length);
+        result.appendBinData("data", data.size(), BinDataGeneral, data.data());
+        return true;
+    }
+} cmdReadSyncSourceBackupFile;
+
+/**
+ * Closes the backup opened by _openSyncSourceBackup.
+ *
+ * {_closeSyncSourceBackup: <backupId>}
+ */
+class CmdCloseSyncSourceBackup : public ReplSetCommand {
+public:
+    CmdCloseSyncSourceBackup() : ReplSetCommand("_closeSyncSourceBackup") {}
+
+    std::string help() const override {
+        return "Internal command to close a backup opened by _openSyncSourceBackup.";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        auto backupId = uassertStatusOK(UUID::parse(cmdObj.firstElement()));
+        BackupFileSource::get(opCtx)->closeBackup(opCtx, backupId);
+        return true;
+    }
+} cmdCloseSyncSourceBackup;
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
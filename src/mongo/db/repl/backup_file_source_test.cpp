@@ -0,0 +1,247 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <fstream>
+#include <map>
+
+#include "mongo/db/commands.h"
+#include "mongo/db/repl/backup_file_source.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/storage/storage_engine_mock.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source_mock.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * A storage engine whose non-blocking backup consists of the files it is given.
+ */
+class BackupStorageEngineMock : public StorageEngineMock {
+public:
+    StatusWith<StorageEngine::BackupInformation> beginNonBlockingBackup(
+        OperationContext* opCtx, const StorageEngine::BackupOptions& options) override {
+        ASSERT_FALSE(backupOpen);
+        backupOpen = true;
+        return backupInformation;
+    }
+
+    void endNonBlockingBackup(OperationContext* opCtx) override {
+        ASSERT_TRUE(backupOpen);
+        backupOpen = false;
+        ++backupsEnded;
+    }
+
+    boost::optional<Timestamp> getLastStableRecoveryTimestamp() const override {
+        return Timestamp(10, 1);
+    }
+
+    StorageEngine::BackupInformation backupInformation;
+    bool backupOpen = false;
+    int backupsEnded = 0;
+};
+
+class BackupFileSourceTest : public ServiceContextTest {
+protected:
+    static constexpr StringData kDataFile = "collection-0.wt"_sd;
+    static constexpr StringData kLogFile = "journal/WiredTigerLog.0000000001"_sd;
+
+    // The log file grows past the size it had when the backup was opened.
+    static constexpr std::size_t kLogFileBackupSize = 3000;
+
+    void setUp() override {
+        ServiceContextTest::setUp();
+
+        auto engine = std::make_unique<BackupStorageEngineMock>();
+        _engine = engine.get();
+        getServiceContext()->setStorageEngine(std::move(engine));
+
+        auto clock = std::make_unique<ClockSourceMock>();
+        _clock = clock.get();
+        getServiceContext()->setFastClockSource(std::move(clock));
+
+        _savedDbpath = storageGlobalParams.dbpath;
+        storageGlobalParams.dbpath = _sourceDir.path();
+        boost::filesystem::create_directory(boost::filesystem::path(_sourceDir.path()) / "journal");
+        writeSourceFile(kDataFile, 10000, 10000);
+        writeSourceFile(kLogFile, 5000, kLogFileBackupSize);
+
+        _opCtx = makeOperationContext();
+    }
+
+    void tearDown() override {
+        storageGlobalParams.dbpath = _savedDbpath;
+        ServiceContextTest::tearDown();
+    }
+
+    void writeSourceFile(StringData filename, std::size_t size, std::uint64_t backupSize) {
+        std::string contents;
+        for (std::size_t i = 0; i < size; ++i) {
+            contents.push_back(static_cast<char>((i * 31 + filename.size()) % 251));
+        }
+        const auto path = (boost::filesystem::path(_sourceDir.path()) / filename.toString());
+        std::ofstream(path.string(), std::ios::out | std::ios::binary) << contents;
+
+        _engine->backupInformation.emplace(path.string(), StorageEngine::BackupFile(backupSize));
+        _sourceContents[filename.toString()] = contents.substr(0, backupSize);
+    }
+
+    BSONObj runCommand(const BSONObj& cmdObj) {
+        return CommandHelpers::runCommandDirectly(_opCtx.get(),
+                                                  OpMsgRequest::fromDBAndBody("admin", cmdObj));
+    }
+
+    UUID openBackup() {
+        auto reply = runCommand(BSON("_openSyncSourceBackup" << 1));
+        ASSERT_OK(getStatusFromCommandResult(reply));
+        return unittest::assertGet(UUID::parse(reply["backupId"]));
+    }
+
+    BSONObj readFile(const UUID& backupId,
+                     StringData filename,
+                     long long offset,
+                     long long length) {
+        BSONObjBuilder cmd;
+        backupId.appendToBuilder(&cmd, "_readSyncSourceBackupFile");
+        cmd.append("filename", filename);
+        cmd.append("offset", offset);
+        cmd.append("length", length);
+        return runCommand(cmd.obj());
+    }
+
+    void closeBackup(const UUID& backupId) {
+        BSONObjBuilder cmd;
+        backupId.appendToBuilder(&cmd, "_closeSyncSourceBackup");
+        ASSERT_OK(getStatusFromCommandResult(runCommand(cmd.obj())));
+    }
+
+    unittest::TempDir _sourceDir{"backup_file_source_test"};
+    std::map<std::string, std::string> _sourceContents;
+    BackupStorageEngineMock* _engine = nullptr;
+    ClockSourceMock* _clock = nullptr;
+    ServiceContext::UniqueOperationContext _opCtx;
+
+private:
+    std::string _savedDbpath;
+};
+
+TEST_F(BackupFileSourceTest, CopiesTheFilesOfTheBackup) {
+    auto reply = runCommand(BSON("_openSyncSourceBackup" << 1));
+    ASSERT_OK(getStatusFromCommandResult(reply));
+    ASSERT_EQ(Timestamp(10, 1), reply["checkpointTimestamp"].timestamp());
+    auto backupId = unittest::assertGet(UUID::parse(reply["backupId"]));
+    ASSERT_TRUE(_engine->backupOpen);
+
+    // Copy every file in chunks, the way a syncing node would.
+    std::map<std::string, std::string> copiedContents;
+    for (auto&& file : reply["files"].Array()) {
+        const auto filename = file["filename"].String();
+        std::string contents;
+        while (true) {
+            auto chunk = readFile(backupId, filename, contents.size(), 1024);
+            ASSERT_OK(getStatusFromCommandResult(chunk));
+            int length;
+            const char* data = chunk["data"].binData(length);
+            if (length == 0) {
+                break;
+            }
+            contents.append(data, length);
+        }
+        ASSERT_EQ(file["fileSize"].numberLong(), static_cast<long long>(contents.size()));
+        copiedContents.emplace(filename, std::move(contents));
+    }
+    ASSERT(_sourceContents == copiedContents);
+
+    closeBackup(backupId);
+    ASSERT_FALSE(_engine->backupOpen);
+    ASSERT_EQ(1, _engine->backupsEnded);
+}
+
+TEST_F(BackupFileSourceTest, OnlyReadsFilesOfTheOpenBackup) {
+    auto backupId = openBackup();
+    ASSERT_OK(getStatusFromCommandResult(readFile(backupId, kDataFile, 0, 1)));
+
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              getStatusFromCommandResult(readFile(backupId, "../collection-0.wt", 0, 1)));
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              getStatusFromCommandResult(readFile(UUID::gen(), kDataFile, 0, 1)));
+    ASSERT_EQ(ErrorCodes::BadValue,
+              getStatusFromCommandResult(readFile(backupId, kDataFile, -1, 1)));
+
+    closeBackup(backupId);
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              getStatusFromCommandResult(readFile(backupId, kDataFile, 0, 1)));
+}
+
+TEST_F(BackupFileSourceTest, OpensOneBackupAtATime) {
+    auto backupId = openBackup();
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              getStatusFromCommandResult(runCommand(BSON("_openSyncSourceBackup" << 1))));
+
+    // Reading keeps the backup from going idle.
+    _clock->advance(BackupFileSource::kBackupIdleTimeout - Seconds(1));
+    ASSERT_OK(getStatusFromCommandResult(readFile(backupId, kDataFile, 0, 1)));
+    _clock->advance(Seconds(2));
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              getStatusFromCommandResult(runCommand(BSON("_openSyncSourceBackup" << 1))));
+
+    closeBackup(backupId);
+    closeBackup(openBackup());
+    ASSERT_EQ(2, _engine->backupsEnded);
+}
+
+TEST_F(BackupFileSourceTest, ReplacesAnIdleBackup) {
+    auto idleBackupId = openBackup();
+    _clock->advance(BackupFileSource::kBackupIdleTimeout);
+
+    auto backupId = openBackup();
+    ASSERT_EQ(1, _engine->backupsEnded);
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              getStatusFromCommandResult(readFile(idleBackupId, kDataFile, 0, 1)));
+    ASSERT_OK(getStatusFromCommandResult(readFile(backupId, kDataFile, 0, 1)));
+
+    // Closing the replaced backup leaves the new one open.
+    closeBackup(idleBackupId);
+    ASSERT_TRUE(_engine->backupOpen);
+    closeBackup(backupId);
+    ASSERT_FALSE(_engine->backupOpen);
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
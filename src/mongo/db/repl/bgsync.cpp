@@ -113,6 +113,7 @@ public:
                             const rpc::ReplSetMetadata& replMetadata,
                             const rpc::OplogQueryMetadata& oqMetadata,
                             const OpTime& lastOpTimeFetched) override;
+    boost::optional<std::size_t> getOplogBufferSpaceAvailable() const override;
 
 private:
     BackgroundSync* _bgsync;
@@ -138,6 +139,11 @@ bool DataReplicatorExternalStateBackgroundSync::shouldStopFetching(
         source, replMetadata, oqMetadata, lastOpTimeFetched);
 }
 
+boost::optional<std::size_t>
+DataReplicatorExternalStateBackgroundSync::getOplogBufferSpaceAvailable() const {
+    return _bgsync->getBufferSpaceAvailable();
+}
+
 size_t getSize(const BSONObj& o) {
     // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
     return static_cast<size_t>(o.objsize());
@@ -919,6 +925,16 @@ OpTime BackgroundSync::_readLastAppliedOpTime(OperationContext* opCtx) {
     return parsedEntry.getOpTime();
 }
 
+boost::optional<std::size_t> BackgroundSync::getBufferSpaceAvailable() const {
+    auto buffer = _oplogApplier->getBuffer();
+    auto maxSize = buffer->getMaxSize();
+    if (maxSize == 0) {
+        return boost::none;
+    }
+    auto size = buffer->getSize();
+    return size < maxSize ? maxSize - size : 0;
+}
+
 bool BackgroundSync::shouldStopFetching() const {
     // Check if we have been stopped.
     if (getState() != ProducerState::Running) {
@@ -141,6 +141,12 @@ public:
      */
     bool shouldStopFetching() const;
 
+    /**
+     * Returns how many more bytes of oplog entries fit in the oplog buffer before enqueueing
+     * blocks, or boost::none if the buffer has no size limit.
+     */
+    boost::optional<std::size_t> getBufferSpaceAvailable() const;
+
     ProducerState getState() const;
     // Starts the producer if it's stopped. Otherwise, let it keep running.
     void startProducerIfStopped();
@@ -32,6 +32,9 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/list_collections_filter.h"
 #include "mongo/db/index_build_entry_helpers.h"
 #include "mongo/db/index_builds_coordinator.h"
@@ -39,12 +42,24 @@
 #include "mongo/db/repl/collection_cloner.h"
 #include "mongo/db/repl/database_cloner_gen.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/logv2/log.h"
+#include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 namespace repl {
+namespace {
+
+// Collections with fewer documents per partition than this are cloned with a single cursor.
+const long long kMinDocumentsPerPartition = 10 * 1000;
+
+// The number of _id values sampled per partition to choose the partition bounds.
+const int kSamplesPerPartition = 10;
+
+}  // namespace
 
 // Failpoint which causes initial sync to hang when it has cloned 'numDocsToClone' documents to
 // collection 'namespace'.
@@ -69,6 +84,7 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
       _countStage("count", this, &CollectionCloner::countStage),
       _listIndexesStage("listIndexes", this, &CollectionCloner::listIndexesStage),
       _createCollectionStage("createCollection", this, &CollectionCloner::createCollectionStage),
+      _partitionStage("partition", this, &CollectionCloner::partitionStage),
       _queryStage("query", this, &CollectionCloner::queryStage),
       _setupIndexBuildersForUnfinishedIndexesStage(
           "setupIndexBuildersForUnfinishedIndexes",
@@ -93,6 +109,14 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
           _dbWorkTaskRunner.schedule(std::move(task));
           return executor::TaskExecutor::CallbackHandle();
       }),
+      _createClientFn([this] {
+          auto client = std::make_unique<DBClientConnection>(true /* autoReconnect */);
+          uassertStatusOK(client->connect(getSource(), StringData()));
+          uassertStatusOK(replAuthenticate(client.get())
+                              .withContext(str::stream()
+                                           << "Failed to authenticate to " << getSource()));
+          return client;
+      }),
       _dbWorkTaskRunner(dbPool) {
     invariant(sourceNss.isValid());
     invariant(collectionOptions.uuid);
@@ -107,6 +131,7 @@ BaseCloner::ClonerStages CollectionCloner::getStages() {
     return {&_countStage,
             &_listIndexesStage,
             &_createCollectionStage,
+            &_partitionStage,
             &_queryStage,
             &_setupIndexBuildersForUnfinishedIndexesStage};
 }
@@ -214,8 +239,112 @@ BaseCloner::AfterStageBehavior CollectionCloner::createCollectionStage() {
     return kContinueNormally;
 }
 
+BaseCloner::AfterStageBehavior CollectionCloner::partitionStage() {
+    const int numPartitions = collectionClonerPartitions;
+    // Partitions are fetched in _id order, so capped collections, whose documents must be inserted
+    // in natural order, are never partitioned. Neither are collections whose _id index uses a
+    // collation, as the sampled _id values could not be used as bounds of the index directly.
+    if (numPartitions <= 1 || !_resumeSupported || _collectionOptions.capped ||
+        !_collectionOptions.collation.isEmpty() || _idIndexSpec.isEmpty()) {
+        return kContinueNormally;
+    }
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (!_partitions.empty() ||
+            static_cast<long long>(_stats.documentToCopy) <
+                numPartitions * kMinDocumentsPerPartition) {
+            return kContinueNormally;
+        }
+    }
+
+    const int sampleSize = numPartitions * kSamplesPerPartition;
+    BSONObj result;
+    getClient()->runCommand(
+        _sourceNss.db().toString(),
+        BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                         << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                       << BSON("$project" << BSON("_id" << 1)))
+                         << "cursor" << BSON("batchSize" << sampleSize)),
+        result,
+        QueryOption_SlaveOk);
+    auto status = getStatusFromCommandResult(result);
+    if (status == ErrorCodes::NamespaceNotFound) {
+        uassertStatusOK(status);
+    }
+    if (!status.isOK()) {
+        // The partitions only balance the work, a single cursor clones the collection just as well.
+        LOGV2(5097139,
+              "Cloning collection with a single cursor because sampling its _id values failed",
+              "namespace"_attr = _sourceNss,
+              "error"_attr = status);
+        return kContinueNormally;
+    }
+
+    std::vector<BSONObj> sampledIds;
+    for (auto&& doc : result["cursor"]["firstBatch"].Array()) {
+        if (auto id = doc["_id"]) {
+            sampledIds.push_back(id.wrap());
+        }
+    }
+    if (auto cursorId = result["cursor"]["id"].safeNumberLong()) {
+        getClient()->killCursor(_sourceNss, cursorId);
+    }
+
+    auto splitPoints = choosePartitionSplitPoints(std::move(sampledIds), numPartitions);
+    if (splitPoints.empty()) {
+        return kContinueNormally;
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    BSONObj min;
+    for (auto&& splitPoint : splitPoints) {
+        _partitions.push_back({min, splitPoint, boost::none});
+        min = splitPoint;
+    }
+    _partitions.push_back({min, BSONObj(), boost::none});
+    _stats.partitions.resize(_partitions.size());
+
+    LOGV2(5097140,
+          "Cloning collection in partitions",
+          "namespace"_attr = _sourceNss,
+          "partitions"_attr = _partitions.size());
+    return kContinueNormally;
+}
+
+std::vector<BSONObj> CollectionCloner::choosePartitionSplitPoints(std::vector<BSONObj> sampledIds,
+                                                                  int numPartitions) {
+    std::sort(sampledIds.begin(),
+              sampledIds.end(),
+              SimpleBSONObjComparator::kInstance.makeLessThan());
+
+    std::vector<BSONObj> splitPoints;
+    for (int i = 1; i < numPartitions; ++i) {
+        auto index = i * sampledIds.size() / numPartitions;
+        if (index == 0) {
+            continue;
+        }
+
+        // Skip repeated values, which would make for empty partitions.
+        const auto& splitPoint = sampledIds[index];
+        if (splitPoints.empty() ||
+            SimpleBSONObjComparator::kInstance.evaluate(splitPoints.back() < splitPoint)) {
+            splitPoints.push_back(splitPoint.getOwned());
+        }
+    }
+    return splitPoints;
+}
+
 BaseCloner::AfterStageBehavior CollectionCloner::queryStage() {
-    runQuery();
+    bool partitioned;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        partitioned = !_partitions.empty();
+    }
+    if (partitioned) {
+        runPartitionedQuery();
+    } else {
+        runQuery();
+    }
     waitForDatabaseWorkToComplete();
     // We want to free the _collLoader regardless of whether the commit succeeds.
     std::unique_ptr<CollectionBulkLoader> loader = std::move(_collLoader);
@@ -350,19 +479,161 @@ void CollectionCloner::runQuery() {
     }
 }
 
-void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
+void CollectionCloner::runPartitionedQuery() {
+    std::vector<size_t> remainingPartitions;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        for (size_t i = 0; i < _stats.partitions.size(); ++i) {
+            if (!_stats.partitions[i].done) {
+                remainingPartitions.push_back(i);
+            }
+        }
+    }
+    if (remainingPartitions.empty()) {
+        return;
+    }
+
+    ThreadPool::Options options;
+    options.threadNamePrefix = "CollectionClonerPartition-";
+    options.poolName = "CollectionClonerPartitionThreadPool";
+    options.minThreads = 0;
+    options.maxThreads = remainingPartitions.size();
+    options.onCreateThread = [](const std::string& threadName) {
+        Client::initThread(threadName.c_str());
+    };
+    ThreadPool pool(options);
+    pool.startup();
+
+    std::vector<Status> statuses(remainingPartitions.size(), Status::OK());
+    for (size_t i = 0; i < remainingPartitions.size(); ++i) {
+        pool.schedule([this, &status = statuses[i], partitionIndex = remainingPartitions[i]](
+                          auto scheduleStatus) {
+            invariant(scheduleStatus);
+            try {
+                runPartitionQuery(partitionIndex);
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+        });
+    }
+    pool.shutdown();
+    pool.join();
+
+    // If the collection was dropped, report that rather than whatever else went wrong meanwhile.
+    for (auto&& status : statuses) {
+        if (status == ErrorCodes::NamespaceNotFound) {
+            uassertStatusOK(status);
+        }
+    }
+    for (auto&& status : statuses) {
+        uassertStatusOK(status);
+    }
+}
+
+void CollectionCloner::runPartitionQuery(size_t partitionIndex) {
+    Query query;
     {
-        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
-        if (!getSharedData()->getInitialSyncStatus(lk).isOK()) {
-            static constexpr char message[] =
-                "Collection cloning cancelled due to initial sync failure";
-            LOGV2(21136, message, "error"_attr = getSharedData()->getInitialSyncStatus(lk));
-            uasserted(ErrorCodes::CallbackCanceled,
-                      str::stream()
-                          << message << ": " << getSharedData()->getInitialSyncStatus(lk));
+        stdx::lock_guard<Latch> lk(_mutex);
+        const auto& partition = _partitions[partitionIndex];
+        // A retried query starts at the last document fetched, which handleNextPartitionBatch()
+        // then skips.
+        const auto& min = partition.lastId ? *partition.lastId : partition.min;
+        if (!min.isEmpty()) {
+            query.minKey(min);
+        }
+        if (!partition.max.isEmpty()) {
+            query.maxKey(partition.max);
+        }
+    }
+    query.hint(BSON("_id" << 1));
+
+    auto client = _createClientFn();
+    client->query(
+        [this, partitionIndex](DBClientCursorBatchIterator& iter) {
+            handleNextPartitionBatch(partitionIndex, iter);
+        },
+        _sourceDbAndUuid,
+        query,
+        nullptr /* fieldsToReturn */,
+        QueryOption_NoCursorTimeout | QueryOption_SlaveOk |
+            (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+        _collectionClonerBatchSize,
+        ReadConcernArgs::kImplicitDefault);
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _stats.partitions[partitionIndex].done = true;
+}
+
+void CollectionCloner::handleNextPartitionBatch(size_t partitionIndex,
+                                                DBClientCursorBatchIterator& iter) {
+    checkInitialSyncNotFailed();
+
+    // Don't let the partitions' cursors get arbitrarily far ahead of the inserts.
+    waitForBufferSpace();
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stats.receivedBatches++;
+        auto& partition = _partitions[partitionIndex];
+        auto& partitionStats = _stats.partitions[partitionIndex];
+        while (iter.moreInCurrentBatch()) {
+            auto doc = iter.nextSafe();
+            auto id = doc["_id"];
+            if (partition.lastId &&
+                SimpleBSONElementComparator::kInstance.evaluate(id ==
+                                                                partition.lastId->firstElement())) {
+                // This document was fetched before the query was retried.
+                continue;
+            }
+            partition.lastId = id.wrap();
+            ++partitionStats.documentsFetched;
+            _bufferedBytes += doc.objsize();
+            _documentsToInsert.emplace_back(std::move(doc));
         }
     }
 
+    auto&& scheduleResult = _scheduleDbWorkFn(
+        [=](const executor::TaskExecutor::CallbackArgs& cbd) { insertDocumentsCallback(cbd); });
+    if (!scheduleResult.isOK()) {
+        uassertStatusOK(scheduleResult.getStatus().withContext(
+            str::stream() << "Error cloning collection '" << _sourceNss.ns() << "'"));
+    }
+
+    hangAfterHandlingBatchIfRequested();
+}
+
+void CollectionCloner::checkInitialSyncNotFailed() {
+    stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+    if (!getSharedData()->getInitialSyncStatus(lk).isOK()) {
+        static constexpr char message[] =
+            "Collection cloning cancelled due to initial sync failure";
+        LOGV2(21136, message, "error"_attr = getSharedData()->getInitialSyncStatus(lk));
+        uasserted(ErrorCodes::CallbackCanceled,
+                  str::stream() << message << ": " << getSharedData()->getInitialSyncStatus(lk));
+    }
+}
+
+void CollectionCloner::waitForBufferSpace() {
+    while (true) {
+        {
+            stdx::unique_lock<Latch> lk(_mutex);
+            if (_bufferedBytes < collectionClonerPartitionBufferBytes) {
+                return;
+            }
+            _bufferSpaceAvailable.wait_for(lk, Seconds(1).toSystemDuration());
+            if (_bufferedBytes < collectionClonerPartitionBufferBytes) {
+                return;
+            }
+        }
+
+        // The inserts stop if initial sync fails, so check for that while waiting for them.
+        checkInitialSyncNotFailed();
+    }
+}
+
+void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
+    checkInitialSyncNotFailed();
+
     // If this is 'true', it means that something happened to our remote cursor for a reason other
     // than the collection being dropped, all while we were running a non-resumable (4.2) clone.
     // We must abort initial sync in that case.
@@ -382,6 +653,7 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         _stats.receivedBatches++;
         while (iter.moreInCurrentBatch()) {
             _documentsToInsert.emplace_back(iter.nextSafe());
+            _bufferedBytes += _documentsToInsert.back().objsize();
         }
     }
 
@@ -401,6 +673,10 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         _resumeToken = iter.getPostBatchResumeToken();
     }
 
+    hangAfterHandlingBatchIfRequested();
+}
+
+void CollectionCloner::hangAfterHandlingBatchIfRequested() {
     initialSyncHangCollectionClonerAfterHandlingBatchResponse.executeIf(
         [&](const BSONObj&) {
             while (MONGO_unlikely(
@@ -444,6 +720,11 @@ void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::Cal
         // The insert must be done within the lock, because CollectionBulkLoader is not
         // thread safe.
         uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+
+        for (auto&& doc : docs) {
+            _bufferedBytes -= doc.objsize();
+        }
+        _bufferSpaceAvailable.notify_all();
     }
 
     initialSyncHangDuringCollectionClone.executeIf(
@@ -515,6 +796,14 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", receivedBatches);
+    if (!partitions.empty()) {
+        BSONArrayBuilder partitionsBuilder(builder->subarrayStart("partitions"));
+        for (auto&& partition : partitions) {
+            BSONObjBuilder partitionBuilder(partitionsBuilder.subobjStart());
+            partitionBuilder.appendNumber("documentsFetched", partition.documentsFetched);
+            partitionBuilder.appendBool("done", partition.done);
+        }
+    }
 }
 
 }  // namespace repl
@@ -34,6 +34,7 @@
 
 #include "mongo/db/repl/base_cloner.h"
 #include "mongo/db/repl/task_runner.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/progress_meter.h"
 
 namespace mongo {
@@ -46,6 +47,11 @@ const int kProgressMeterCheckInterval = 128;
 
 class CollectionCloner final : public BaseCloner {
 public:
+    struct PartitionStats {
+        size_t documentsFetched{0};
+        bool done{false};
+    };
+
     struct Stats {
         static constexpr StringData kDocumentsToCopyFieldName = "documentsToCopy"_sd;
         static constexpr StringData kDocumentsCopiedFieldName = "documentsCopied"_sd;
@@ -58,6 +64,8 @@ public:
         size_t indexes{0};
         size_t fetchedBatches{0};  // This is actually inserted batches.
         size_t receivedBatches{0};
+        // Empty unless the collection is cloned in partitions.
+        std::vector<PartitionStats> partitions;
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -72,6 +80,12 @@ public:
     using ScheduleDbWorkFn = unique_function<StatusWith<executor::TaskExecutor::CallbackHandle>(
         executor::TaskExecutor::CallbackFn)>;
 
+    /**
+     * Type of function to create the connections to the sync source used by the cursors of a
+     * partitioned clone.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
     CollectionCloner(const NamespaceString& ns,
                      const CollectionOptions& collectionOptions,
                      InitialSyncSharedData* sharedData,
@@ -117,6 +131,23 @@ public:
         _scheduleDbWorkFn = std::move(scheduleDbWorkFn);
     }
 
+    /**
+     * Overrides how the connections of a partitioned clone are created.
+     *
+     * For testing only.
+     */
+    void setCreateClientFn_forTest(CreateClientFn createClientFn) {
+        _createClientFn = std::move(createClientFn);
+    }
+
+    /**
+     * Returns the split points that divide the _id index into at most 'numPartitions' ranges
+     * holding roughly the same number of documents, given a random sample of the collection's
+     * _id values as {_id: <value>} objects. The split points are in ascending order and distinct.
+     */
+    static std::vector<BSONObj> choosePartitionSplitPoints(std::vector<BSONObj> sampledIds,
+                                                           int numPartitions);
+
 protected:
     ClonerStages getStages() final;
 
@@ -189,6 +220,13 @@ private:
      */
     AfterStageBehavior createCollectionStage();
 
+    /**
+     * Stage function that, for a large collection and if enabled by 'collectionClonerPartitions',
+     * samples the collection's _id values on the source to split it into ranges that are then
+     * fetched concurrently by the query stage.
+     */
+    AfterStageBehavior partitionStage();
+
     /**
      * Stage function that executes a query to retrieve all documents in the collection.  For each
      * batch returned by the upstream node, handleNextBatch will be called with the data.  This
@@ -221,6 +259,40 @@ private:
      */
     void runQuery();
 
+    /**
+     * Fetches every partition that is not done yet over its own connection, concurrently.
+     * Throws the error of a failed partition once all of them have stopped; on retry, each
+     * partition resumes after the last document it fetched.
+     */
+    void runPartitionedQuery();
+
+    /**
+     * Fetches the documents of a single partition. Called on a thread of runPartitionedQuery().
+     */
+    void runPartitionQuery(size_t partitionIndex);
+
+    /**
+     * Like handleNextBatch(), for a batch of the partition at 'partitionIndex'.
+     */
+    void handleNextPartitionBatch(size_t partitionIndex, DBClientCursorBatchIterator& iter);
+
+    /**
+     * Blocks while the 'initialSyncHangCollectionClonerAfterHandlingBatchResponse' failpoint is
+     * enabled for this collection.
+     */
+    void hangAfterHandlingBatchIfRequested();
+
+    /**
+     * Throws if initial sync has failed, to stop fetching documents.
+     */
+    void checkInitialSyncNotFailed();
+
+    /**
+     * Blocks until fewer than 'collectionClonerPartitionBufferBytes' of fetched documents are
+     * waiting to be inserted.
+     */
+    void waitForBufferSpace();
+
     /**
      * Used to terminate the clone when we encounter a fatal error during a non-resumable query.
      * Throws.
@@ -244,6 +316,7 @@ private:
     CollectionClonerStage _countStage;                                   // (R)
     CollectionClonerStage _listIndexesStage;                             // (R)
     CollectionClonerStage _createCollectionStage;                        // (R)
+    CollectionClonerStage _partitionStage;                               // (R)
     CollectionClonerQueryStage _queryStage;                              // (R)
     CollectionClonerStage _setupIndexBuildersForUnfinishedIndexesStage;  // (R)
 
@@ -254,9 +327,14 @@ private:
     std::unique_ptr<CollectionBulkLoader> _collLoader;  // (X)
     //  Function for scheduling database work using the executor.
     ScheduleDbWorkFn _scheduleDbWorkFn;  // (R)
+    // Function for creating the connections of a partitioned clone.
+    CreateClientFn _createClientFn;  // (R)
     // Documents read from source to insert.
     std::vector<BSONObj> _documentsToInsert;  // (M)
-    Stats _stats;                             // (M)
+    // The total size of '_documentsToInsert' and of the documents being inserted.
+    long long _bufferedBytes = 0;                     // (M)
+    stdx::condition_variable _bufferSpaceAvailable;  // (M)
+    Stats _stats;                                     // (M)
     // Putting _dbWorkTaskRunner last ensures anything the database work threads depend on,
     // like _documentsToInsert, is destroyed after those threads exit.
     TaskRunner _dbWorkTaskRunner;  // (R)
@@ -277,6 +355,22 @@ private:
     // Signifies that there were changes to the collection on the sync source that resulted in
     // our remote cursor getting killed.
     bool _lostNonResumableCursor = false;  // (X)
+
+    // A range of the _id index fetched by its own cursor in a partitioned clone.
+    struct Partition {
+        // The bounds of the range as {_id: <value>}, inclusive and exclusive respectively. An empty
+        // bound leaves the range open on that side.
+        BSONObj min;
+        BSONObj max;
+
+        // The _id of the last document fetched, as {_id: <value>}, after which a retried query
+        // resumes.
+        boost::optional<BSONObj> lastId;
+    };
+
+    // Empty unless the collection is cloned in partitions. The progress of each partition is
+    // tracked in '_stats.partitions'.
+    std::vector<Partition> _partitions;  // (M)
 };
 
 }  // namespace repl
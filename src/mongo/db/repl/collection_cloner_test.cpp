@@ -32,14 +32,18 @@
 #include <vector>
 
 #include "mongo/bson/bsonmisc.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/repl/cloner_test_fixture.h"
 #include "mongo/db/repl/collection_cloner.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace repl {
@@ -1148,5 +1152,233 @@ TEST_F(CollectionClonerTestNonResumable, NonResumableCursorErrorThenSuccessEqual
     clonerThread.join();
 }
 
+class CollectionClonerTestPartitioned : public CollectionClonerTest {
+protected:
+    static constexpr int kNumDocuments = 20;
+
+    void setUp() final {
+        CollectionClonerTest::setUp();
+        setInitialSyncId();
+        _savedPartitions = collectionClonerPartitions;
+        collectionClonerPartitions = 2;
+
+        _storageInterface.createCollectionForBulkFn =
+            [this](const NamespaceString& nss,
+                   const CollectionOptions& options,
+                   const BSONObj idIndexSpec,
+                   const std::vector<BSONObj>& nonIdIndexSpecs) {
+                auto loader =
+                    _standardCreateCollectionFn(nss, options, idIndexSpec, nonIdIndexSpecs);
+                if (loader.isOK()) {
+                    // The cloner serializes the inserts.
+                    _loader->insertDocsFn = [this](std::vector<BSONObj>::const_iterator begin,
+                                                   std::vector<BSONObj>::const_iterator end) {
+                        _insertedDocs.insert(_insertedDocs.end(), begin, end);
+                        return Status::OK();
+                    };
+                }
+                return loader;
+            };
+
+        // Claim enough documents for two partitions, while the mock remote only holds a few.
+        _mockServer->setCommandReply("count", createCountResponse(20 * 1000));
+        _mockServer->setCommandReply("listIndexes",
+                                     createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+        BSONArrayBuilder sampledIds;
+        for (int i = kNumDocuments; i > 0; --i) {
+            sampledIds.append(BSON("_id" << i));
+        }
+        _mockServer->setCommandReply("aggregate",
+                                     createCursorResponse(_nss.ns(), sampledIds.arr()));
+        for (int i = 1; i <= kNumDocuments; ++i) {
+            _mockServer->insert(_nss.ns(), makeDocument(i));
+        }
+    }
+
+    void tearDown() final {
+        collectionClonerPartitions = _savedPartitions;
+        CollectionClonerTest::tearDown();
+    }
+
+    static BSONObj makeDocument(int id) {
+        return BSON("_id" << id << "a" << id * 10);
+    }
+
+    std::unique_ptr<CollectionCloner> makePartitionedCollectionCloner() {
+        auto cloner = makeCollectionCloner();
+        cloner->setCreateClientFn_forTest([this] {
+            return std::unique_ptr<DBClientConnection>(
+                new MockDBClientConnection(_mockServer.get(), true /* autoReconnect */));
+        });
+        cloner->setBatchSize_forTest(2);
+        return cloner;
+    }
+
+    void assertClonedAllDocuments(CollectionCloner* cloner) {
+        ASSERT_TRUE(_collectionStats->commitCalled);
+        ASSERT_EQUALS(kNumDocuments, _collectionStats->insertCount);
+
+        auto stats = cloner->getStats();
+        ASSERT_EQUALS(static_cast<size_t>(kNumDocuments), stats.documentsCopied);
+        ASSERT_EQUALS(2U, stats.partitions.size());
+        for (auto&& partition : stats.partitions) {
+            ASSERT_EQUALS(static_cast<size_t>(kNumDocuments / 2), partition.documentsFetched);
+            ASSERT_TRUE(partition.done);
+        }
+
+        std::sort(_insertedDocs.begin(),
+                  _insertedDocs.end(),
+                  SimpleBSONObjComparator::kInstance.makeLessThan());
+        ASSERT_EQUALS(static_cast<size_t>(kNumDocuments), _insertedDocs.size());
+        for (int i = 0; i < kNumDocuments; ++i) {
+            ASSERT_BSONOBJ_EQ(makeDocument(i + 1), _insertedDocs[i]);
+        }
+    }
+
+    std::vector<BSONObj> _insertedDocs;
+
+private:
+    int _savedPartitions;
+};
+
+TEST_F(CollectionClonerTestPartitioned, ClonesAllPartitions) {
+    auto cloner = makePartitionedCollectionCloner();
+    ASSERT_OK(cloner->run());
+
+    // The sampled _id values split the collection at {_id: 11}, so each partition holds half of
+    // the documents.
+    assertClonedAllDocuments(cloner.get());
+}
+
+TEST_F(CollectionClonerTestPartitioned, PartitionResumesAfterLastIdOnTransientError) {
+    auto afterBatchFailpoint =
+        globalFailPointRegistry().find("initialSyncHangCollectionClonerAfterHandlingBatchResponse");
+    auto timesEnteredAfterBatch = afterBatchFailpoint->setMode(FailPoint::alwaysOn, 0);
+
+    auto cloner = makePartitionedCollectionCloner();
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    // Wait for both partitions to handle their first batch, so that whichever of them fails next
+    // has a last _id to resume from.
+    afterBatchFailpoint->waitForTimesEntered(timesEnteredAfterBatch + 2);
+    auto stats = cloner->getStats();
+    ASSERT_EQUALS(2U, stats.receivedBatches);
+
+    auto failNextBatch = globalFailPointRegistry().find("mockCursorThrowErrorOnGetMore");
+    failNextBatch->setMode(FailPoint::nTimes, 1, fromjson("{errorType: 'HostUnreachable'}"));
+
+    afterBatchFailpoint->setMode(FailPoint::off, 0);
+    clonerThread.join();
+
+    // The CollectionMockStats class does not de-duplicate inserts, so refetching the failed
+    // partition from its lower bound instead of from its last _id would insert too many documents.
+    assertClonedAllDocuments(cloner.get());
+}
+
+TEST_F(CollectionClonerTestPartitioned, PartitionsWaitForBufferedDocumentsToBeInserted) {
+    const auto savedBufferBytes = collectionClonerPartitionBufferBytes;
+    ON_BLOCK_EXIT([&] { collectionClonerPartitionBufferBytes = savedBufferBytes; });
+    collectionClonerPartitionBufferBytes = 1;
+
+    auto mutex = MONGO_MAKE_LATCH();
+    stdx::condition_variable cond;
+    std::vector<executor::TaskExecutor::CallbackFn> deferredInserts;
+    bool runInserts = false;
+
+    auto cloner = makePartitionedCollectionCloner();
+    cloner->setScheduleDbWorkFn_forTest([&](executor::TaskExecutor::CallbackFn work) {
+        stdx::unique_lock<Latch> lk(mutex);
+        if (runInserts) {
+            lk.unlock();
+            work(executor::TaskExecutor::CallbackArgs(nullptr, {}, Status::OK()));
+        } else {
+            deferredInserts.push_back(std::move(work));
+            cond.notify_all();
+        }
+        return StatusWith<executor::TaskExecutor::CallbackHandle>(
+            executor::TaskExecutor::CallbackHandle());
+    });
+
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    {
+        stdx::unique_lock<Latch> lk(mutex);
+        cond.wait(lk, [&] { return !deferredInserts.empty(); });
+    }
+
+    // With nothing inserted, every partition stops before its second batch.
+    sleepmillis(100);
+    auto stats = cloner->getStats();
+    ASSERT_LTE(stats.receivedBatches, 2U);
+    for (auto&& partition : stats.partitions) {
+        ASSERT_LTE(partition.documentsFetched, 2U);
+        ASSERT_FALSE(partition.done);
+    }
+
+    std::vector<executor::TaskExecutor::CallbackFn> inserts;
+    {
+        stdx::lock_guard<Latch> lk(mutex);
+        runInserts = true;
+        inserts.swap(deferredInserts);
+    }
+    for (auto&& work : inserts) {
+        work(executor::TaskExecutor::CallbackArgs(nullptr, {}, Status::OK()));
+    }
+    clonerThread.join();
+
+    assertClonedAllDocuments(cloner.get());
+}
+
+TEST(CollectionClonerPartitionTest, ChoosePartitionSplitPoints) {
+    std::vector<BSONObj> sampledIds;
+    for (int i = 11; i >= 0; --i) {
+        sampledIds.push_back(BSON("_id" << i));
+    }
+    auto splitPoints = CollectionCloner::choosePartitionSplitPoints(sampledIds, 4);
+    ASSERT_EQ(3U, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 3), splitPoints[0]);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 6), splitPoints[1]);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 9), splitPoints[2]);
+
+    // Mixed types are ordered as the _id index orders them.
+    splitPoints = CollectionCloner::choosePartitionSplitPoints(
+        {BSON("_id"
+              << "a"),
+         BSON("_id" << 2),
+         BSON("_id" << OID()),
+         BSON("_id" << 1)},
+        2);
+    ASSERT_EQ(1U, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id"
+                           << "a"),
+                      splitPoints[0]);
+}
+
+TEST(CollectionClonerPartitionTest, ChoosePartitionSplitPointsSkipsRepeatedValues) {
+    std::vector<BSONObj> sampledIds;
+    for (int i = 0; i < 9; ++i) {
+        sampledIds.push_back(BSON("_id" << (i < 7 ? 0 : 1)));
+    }
+    auto splitPoints = CollectionCloner::choosePartitionSplitPoints(sampledIds, 3);
+    ASSERT_EQ(1U, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 0), splitPoints[0]);
+}
+
+TEST(CollectionClonerPartitionTest, ChoosePartitionSplitPointsFromSmallSample) {
+    ASSERT(CollectionCloner::choosePartitionSplitPoints({}, 4).empty());
+    ASSERT(CollectionCloner::choosePartitionSplitPoints({BSON("_id" << 1)}, 4).empty());
+
+    auto splitPoints =
+        CollectionCloner::choosePartitionSplitPoints({BSON("_id" << 2), BSON("_id" << 1)}, 4);
+    ASSERT_EQ(1U, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), splitPoints[0]);
+}
+
 }  // namespace repl
 }  // namespace mongo
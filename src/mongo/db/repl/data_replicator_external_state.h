@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <cstddef>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/repl/multiapplier.h"
 #include "mongo/db/repl/oplog_applier.h"
@@ -106,6 +109,12 @@ public:
     virtual std::unique_ptr<OplogBuffer> makeInitialSyncOplogBuffer(
         OperationContext* opCtx) const = 0;
 
+    /**
+     * Returns how many more bytes of oplog entries fit in the buffer that fetched entries are
+     * queued in, or boost::none if that buffer is not bounded.
+     */
+    virtual boost::optional<std::size_t> getOplogBufferSpaceAvailable() const = 0;
+
     /**
      * Creates an OplogApplier using the provided options.
      */
@@ -126,6 +126,11 @@ std::unique_ptr<OplogBuffer> DataReplicatorExternalStateImpl::makeInitialSyncOpl
     }
 }
 
+boost::optional<std::size_t> DataReplicatorExternalStateImpl::getOplogBufferSpaceAvailable()
+    const {
+    return boost::none;
+}
+
 std::unique_ptr<OplogApplier> DataReplicatorExternalStateImpl::makeOplogApplier(
     OplogBuffer* oplogBuffer,
     OplogApplier::Observer* observer,
@@ -61,6 +61,8 @@ public:
 
     std::unique_ptr<OplogBuffer> makeInitialSyncOplogBuffer(OperationContext* opCtx) const override;
 
+    boost::optional<std::size_t> getOplogBufferSpaceAvailable() const override;
+
     /**
      * These arguments are passed directly to OplogApplierImpl's constructor along with some other
      * parameters owned by this DataReplicationExternalStateImpl.
@@ -104,6 +104,10 @@ std::unique_ptr<OplogBuffer> DataReplicatorExternalStateMock::makeInitialSyncOpl
     return std::make_unique<OplogBufferBlockingQueue>();
 }
 
+boost::optional<std::size_t> DataReplicatorExternalStateMock::getOplogBufferSpaceAvailable() const {
+    return oplogBufferSpaceAvailable;
+}
+
 std::unique_ptr<OplogApplier> DataReplicatorExternalStateMock::makeOplogApplier(
     OplogBuffer* oplogBuffer,
     OplogApplier::Observer* observer,
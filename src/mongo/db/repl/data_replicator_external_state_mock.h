@@ -58,6 +58,8 @@ public:
 
     std::unique_ptr<OplogBuffer> makeInitialSyncOplogBuffer(OperationContext* opCtx) const override;
 
+    boost::optional<std::size_t> getOplogBufferSpaceAvailable() const override;
+
     std::unique_ptr<OplogApplier> makeOplogApplier(
         OplogBuffer* oplogBuffer,
         OplogApplier::Observer* observer,
@@ -88,6 +90,9 @@ public:
     // Returned by shouldStopFetching.
     bool shouldStopFetchingResult = false;
 
+    // Returned by getOplogBufferSpaceAvailable.
+    boost::optional<std::size_t> oplogBufferSpaceAvailable;
+
     // Override to change applyOplogBatch behavior.
     using ApplyOplogBatchFn = std::function<StatusWith<OpTime>(
         OperationContext*, std::vector<OplogEntry>, OplogApplier::Observer*)>;
@@ -52,6 +52,7 @@
 #include "mongo/platform/basic.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log_with_sampling.h"
+#include "mongo/util/timer.h"
 #include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
@@ -74,6 +75,49 @@ ServerStatusMetricField<Counter64> displayOplogApplicationBatchSize("repl.apply.
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+/**
+ * Reports the work done by each oplog writer as an array indexed by writer, so that the time each
+ * writer was busy can be compared with repl.apply.batches.totalMillis to find idle writers.
+ */
+class WriterStats final : public ServerStatusMetric {
+public:
+    WriterStats() : ServerStatusMetric("repl.apply.writers") {}
+
+    void record(size_t writerId, long long partitions, long long ops, long long busyMicros) {
+        if (writerId >= kMaxWriters) {
+            return;
+        }
+        auto& stats = _writers[writerId];
+        stats.partitions.increment(partitions);
+        stats.ops.increment(ops);
+        stats.busyMicros.increment(busyMicros);
+    }
+
+    void appendAtLeaf(BSONObjBuilder& b) const final {
+        BSONArrayBuilder writersBuilder(b.subarrayStart(_leafName));
+        const auto numWriters = std::min(static_cast<size_t>(replWriterThreadCount), kMaxWriters);
+        for (size_t i = 0; i < numWriters; ++i) {
+            const auto& stats = _writers[i];
+            BSONObjBuilder writerBuilder(writersBuilder.subobjStart());
+            writerBuilder.appendNumber("partitions", stats.partitions.get());
+            writerBuilder.appendNumber("ops", stats.ops.get());
+            writerBuilder.appendNumber("busyMicros", stats.busyMicros.get());
+        }
+    }
+
+private:
+    // The upper bound of replWriterThreadCount.
+    static constexpr size_t kMaxWriters = 256;
+
+    struct Stats {
+        Counter64 partitions;
+        Counter64 ops;
+        Counter64 busyMicros;
+    };
+
+    std::array<Stats, kMaxWriters> _writers;
+} writerStats;
+
 NamespaceString parseUUIDOrNs(OperationContext* opCtx, const OplogEntry& oplogEntry) {
     auto optionalUuid = oplogEntry.getUuid();
     if (!optionalUuid) {
@@ -625,7 +669,11 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
     // Increment the batch size stat.
     oplogApplicationBatchSize.increment(ops.size());
 
-    std::vector<WorkerMultikeyPathInfo> multikeyVector(_writerPool->getStats().numThreads);
+    // Each writer thread applies any number of partitions of the batch, see below.
+    const size_t numWriters = _writerPool->getStats().numThreads;
+    const size_t numPartitions = numWriters * replWriterPartitionsPerThread.load();
+
+    std::vector<WorkerMultikeyPathInfo> multikeyVector(numPartitions);
     {
         // Each node records cumulative batch application stats for itself using this timer.
         TimerHolder timer(&applyBatchStats);
@@ -650,8 +698,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         //   and create a pseudo oplog.
         std::vector<std::vector<OplogEntry>> derivedOps;
 
-        std::vector<std::vector<const OplogEntry*>> writerVectors(
-            _writerPool->getStats().numThreads);
+        std::vector<std::vector<const OplogEntry*>> writerVectors(numPartitions);
         fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
 
         // Wait for writes to finish before applying ops.
@@ -673,21 +720,48 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         }
 
         {
-            std::vector<Status> statusVector(_writerPool->getStats().numThreads, Status::OK());
+            std::vector<Status> statusVector(numPartitions, Status::OK());
+
+            // Operations that must be applied in order always hash to the same partition, so the
+            // partitions can be applied in any order and on any writer thread. Rather than tying
+            // each partition to a writer thread, the writers claim partitions largest first until
+            // none are left. With more partitions than writers, a partition holding a hot document
+            // or a capped collection then runs alongside the rest of the batch instead of holding
+            // back everything else that happened to hash to the same writer.
+            std::vector<size_t> partitionOrder;
+            for (size_t i = 0; i < writerVectors.size(); i++) {
+                if (!writerVectors[i].empty()) {
+                    partitionOrder.push_back(i);
+                }
+            }
+            std::stable_sort(partitionOrder.begin(), partitionOrder.end(), [&](size_t l, size_t r) {
+                return writerVectors[l].size() > writerVectors[r].size();
+            });
+            AtomicWord<size_t> nextPartition{0};
 
             // Doles out all the work to the writer pool threads. writerVectors is not modified,
             // but  applyOplogBatchPerWorker will modify the vectors that it contains.
             invariant(writerVectors.size() == statusVector.size());
-            for (size_t i = 0; i < writerVectors.size(); i++) {
-                if (writerVectors[i].empty())
-                    continue;
-
-                _writerPool->schedule(
-                    [this,
-                     &writer = writerVectors.at(i),
-                     &status = statusVector.at(i),
-                     &multikeyVector = multikeyVector.at(i)](auto scheduleStatus) {
-                        invariant(scheduleStatus);
+            const size_t numActiveWriters = std::min(numWriters, partitionOrder.size());
+            for (size_t writerId = 0; writerId < numActiveWriters; writerId++) {
+                _writerPool->schedule([this,
+                                       writerId,
+                                       &writerVectors,
+                                       &statusVector,
+                                       &multikeyVector,
+                                       &partitionOrder,
+                                       &nextPartition](auto scheduleStatus) {
+                    invariant(scheduleStatus);
+
+                    Timer timer;
+                    long long partitionsApplied = 0;
+                    long long opsApplied = 0;
+                    for (auto next = nextPartition.fetchAndAdd(1); next < partitionOrder.size();
+                         next = nextPartition.fetchAndAdd(1)) {
+                        const auto i = partitionOrder[next];
+                        auto& writer = writerVectors[i];
+                        ++partitionsApplied;
+                        opsApplied += writer.size();
 
                         auto opCtx = cc().makeOperationContext();
 
@@ -695,10 +769,13 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                         // so it is safe to exclude any writes from Flow Control.
                         opCtx->setShouldParticipateInFlowControl(false);
 
-                        status = opCtx->runWithoutInterruptionExceptAtGlobalShutdown([&] {
-                            return applyOplogBatchPerWorker(opCtx.get(), &writer, &multikeyVector);
+                        statusVector[i] = opCtx->runWithoutInterruptionExceptAtGlobalShutdown([&] {
+                            return applyOplogBatchPerWorker(
+                                opCtx.get(), &writer, &multikeyVector[i]);
                         });
-                    });
+                    }
+                    writerStats.record(writerId, partitionsApplied, opsApplied, timer.micros());
+                });
             }
 
             _writerPool->waitForIdle();
@@ -557,6 +557,53 @@ TEST_F(OplogApplierImplTest,
                                                      createOplogCollectionOptions()));
 }
 
+TEST_F(OplogApplierImplTest, MultiApplyWithMorePartitionsThanWriters) {
+    auto originalPartitionsPerThread = replWriterPartitionsPerThread.load();
+    replWriterPartitionsPerThread.store(8);
+    ON_BLOCK_EXIT([&] { replWriterPartitionsPerThread.store(originalPartitionsPerThread); });
+
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollection(_opCtx.get(), nss, CollectionOptions());
+
+    // Every document is inserted, replaced and, for even _ids, deleted within the same batch, so
+    // the batch only applies correctly if the operations on each document stay in order.
+    const int numDocs = 100;
+    std::vector<OplogEntry> ops;
+    unsigned int seconds = 1;
+    for (int i = 0; i < numDocs; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+    for (int i = 0; i < numDocs; ++i) {
+        ops.push_back(makeUpdateDocumentOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL},
+                                                   nss,
+                                                   BSON("_id" << i),
+                                                   BSON("_id" << i << "x" << i)));
+    }
+    for (int i = 0; i < numDocs; i += 2) {
+        ops.push_back(makeDeleteDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    auto writerPool = makeReplWriterPool(4);
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+    ASSERT_EQUALS(ops.back().getOpTime(),
+                  unittest::assertGet(oplogApplier.applyOplogBatch(_opCtx.get(), ops)));
+
+    for (int i = 0; i < numDocs; ++i) {
+        ASSERT_EQUALS(i % 2 == 1, docExists(_opCtx.get(), nss, BSON("_id" << i << "x" << i)));
+    }
+}
+
 TEST_F(OplogApplierImplTest,
        OplogApplicationThreadFuncUsesApplyOplogEntryOrGroupedInsertsToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
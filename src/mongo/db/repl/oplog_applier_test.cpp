@@ -509,6 +509,60 @@ TEST_F(OplogApplierTest, LastOpInLargeTransactionIsProcessedIndividually) {
     ASSERT_EQUALS(srcOps[4], batch[0]);
 }
 
+/**
+ * Generates an update or delete oplog entry on the document with _id 't'.
+ */
+OplogEntry makeUpdateOrDeleteOplogEntry(int t,
+                                        OpTypeEnum opType,
+                                        const NamespaceString& nss,
+                                        boost::optional<UUID> uuid) {
+    auto isUpdate = opType == OpTypeEnum::kUpdate;
+    BSONObj oField = isUpdate ? BSON("$set" << BSON("a" << t)) : BSON("_id" << t);
+    boost::optional<BSONObj> o2Field;
+    if (isUpdate) {
+        o2Field = BSON("_id" << t);
+    }
+    return OplogEntry(OpTime(Timestamp(t, 1), 1),  // optime
+                      boost::none,                 // hash
+                      opType,                      // op type
+                      nss,                         // namespace
+                      uuid,                        // uuid
+                      boost::none,                 // fromMigrate
+                      OplogEntry::kOplogVersion,   // version
+                      oField,                      // o
+                      o2Field,                     // o2
+                      {},                          // sessionInfo
+                      boost::none,                 // upsert
+                      Date_t() + Seconds(t),       // wall clock time
+                      boost::none,                 // statement id
+                      boost::none,   // optime of previous write within same transaction
+                      boost::none,   // pre-image optime
+                      boost::none);  // post-image optime
+}
+
+TEST_F(OplogApplierTest, GetPrefetchTargetsReturnsDocumentsOfUpdatesAndDeletes) {
+    NamespaceString nss("test.foo");
+    auto uuid = UUID::gen();
+    std::vector<OplogEntry> ops;
+    ops.push_back(makeInsertOplogEntry(1, nss));
+    ops.push_back(makeUpdateOrDeleteOplogEntry(2, OpTypeEnum::kUpdate, nss, uuid));
+    ops.push_back(makeApplyOpsOplogEntry(3, false));
+    ops.push_back(makeUpdateOrDeleteOplogEntry(4, OpTypeEnum::kDelete, nss, boost::none));
+
+    auto targets = OplogBatcher::getPrefetchTargets(ops);
+    ASSERT_EQUALS(2U, targets.size());
+
+    // Entries with a collection UUID are looked up by it.
+    ASSERT(targets[0].nsOrUUID.uuid());
+    ASSERT_EQUALS(uuid, *targets[0].nsOrUUID.uuid());
+    ASSERT_EQUALS(nss.db(), targets[0].nsOrUUID.dbname());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), targets[0].id);
+
+    ASSERT(targets[1].nsOrUUID.nss());
+    ASSERT_EQUALS(nss, *targets[1].nsOrUUID.nss());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 4), targets[1].id);
+}
+
 }  // namespace
 }  // namespace repl
 }  // namespace mongo
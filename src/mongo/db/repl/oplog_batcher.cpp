@@ -31,7 +31,9 @@
 
 #include "mongo/db/repl/oplog_batcher.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/db/catalog_raii.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/commands/txn_cmds_gen.h"
 #include "mongo/db/repl/oplog_applier.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
@@ -41,6 +43,20 @@ namespace mongo {
 namespace repl {
 MONGO_FAIL_POINT_DEFINE(skipOplogBatcherWaitForData);
 
+namespace {
+// Documents read ahead of application, and how many of those exist. Documents the applier got to
+// before the batcher did are counted as skipped.
+Counter64 prefetchDocumentsStats;
+ServerStatusMetricField<Counter64> displayPrefetchDocuments("repl.apply.prefetch.documents",
+                                                            &prefetchDocumentsStats);
+Counter64 prefetchFoundStats;
+ServerStatusMetricField<Counter64> displayPrefetchFound("repl.apply.prefetch.found",
+                                                        &prefetchFoundStats);
+Counter64 prefetchSkippedStats;
+ServerStatusMetricField<Counter64> displayPrefetchSkipped("repl.apply.prefetch.skipped",
+                                                          &prefetchSkippedStats);
+}  // namespace
+
 OplogBatcher::OplogBatcher(OplogApplier* oplogApplier, OplogBuffer* oplogBuffer)
     : _oplogApplier(oplogApplier), _oplogBuffer(oplogBuffer), _ops(0) {}
 OplogBatcher::~OplogBatcher() {
@@ -240,6 +256,25 @@ StatusWith<std::vector<OplogEntry>> OplogBatcher::getNextApplierBatch(
     return std::move(ops);
 }
 
+std::vector<OplogBatcher::PrefetchTarget> OplogBatcher::getPrefetchTargets(
+    const std::vector<OplogEntry>& ops) {
+    std::vector<PrefetchTarget> targets;
+    for (const auto& op : ops) {
+        if (op.getOpType() != OpTypeEnum::kUpdate && op.getOpType() != OpTypeEnum::kDelete) {
+            continue;
+        }
+        auto id = op.getIdElement();
+        if (id.eoo()) {
+            continue;
+        }
+        auto uuid = op.getUuid();
+        targets.push_back({uuid ? NamespaceStringOrUUID(op.getNss().db().toString(), *uuid)
+                                : NamespaceStringOrUUID(op.getNss()),
+                           id.wrap()});
+    }
+    return targets;
+}
+
 /**
  * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
  * entries that can be be returned in a batch.
@@ -266,6 +301,44 @@ void OplogBatcher::_consume(OperationContext* opCtx, OplogBuffer* oplogBuffer) {
     invariant(oplogBuffer->tryPop(opCtx, &opToPopAndDiscard) || _oplogApplier->inShutdown());
 }
 
+void OplogBatcher::_prefetch(StorageInterface* storageInterface,
+                             const std::vector<PrefetchTarget>& targets) {
+    auto opCtx = cc().makeOperationContext();
+
+    // The applier holds the ParallelBatchWriterMode lock while it applies the previous batch. The
+    // documents are only read to bring them into cache, so the timestamp doesn't matter either.
+    ShouldNotConflictWithSecondaryBatchApplicationBlock shouldNotConflictBlock(opCtx->lockState());
+    ReadSourceScope readSourceScope(opCtx.get(), RecoveryUnit::ReadSource::kNoTimestamp);
+
+    for (auto it = targets.begin(); it != targets.end(); ++it) {
+        bool batchTaken;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            batchTaken = _ops.empty();
+        }
+        if (batchTaken || _oplogApplier->inShutdown()) {
+            prefetchSkippedStats.increment(targets.end() - it);
+            return;
+        }
+
+        try {
+            auto doc = storageInterface->findById(opCtx.get(), it->nsOrUUID, it->id.firstElement());
+            prefetchDocumentsStats.increment();
+            if (doc.isOK()) {
+                prefetchFoundStats.increment();
+            }
+        } catch (const DBException& ex) {
+            // Prefetching is only an optimization, application will read the documents anyway.
+            LOGV2_DEBUG(5097147,
+                        2,
+                        "Stopped prefetching documents for the next oplog batch",
+                        "error"_attr = ex.toStatus());
+            prefetchSkippedStats.increment(targets.end() - it);
+            return;
+        }
+    }
+}
+
 void OplogBatcher::_run(StorageInterface* storageInterface) {
     Client::initThread("ReplBatcher");
 
@@ -344,13 +417,27 @@ void OplogBatcher::_run(StorageInterface* storageInterface) {
             }
         }
 
-        stdx::unique_lock<Latch> lk(_mutex);
-        // Block until the previous batch has been taken.
-        _cv.wait(lk, [&] { return _ops.empty() && !_ops.termWhenExhausted(); });
-        _ops = std::move(ops);
-        _cv.notify_all();
-        if (_ops.mustShutdown()) {
-            return;
+        // Collect what to prefetch now, since the applier owns the batch once it is handed off.
+        std::vector<PrefetchTarget> prefetchTargets;
+        if (oplogBatcherPrefetchDocuments.load()) {
+            prefetchTargets = getPrefetchTargets(ops.getBatch());
+        }
+
+        {
+            stdx::unique_lock<Latch> lk(_mutex);
+            // Block until the previous batch has been taken.
+            _cv.wait(lk, [&] { return _ops.empty() && !_ops.termWhenExhausted(); });
+            _ops = std::move(ops);
+            _cv.notify_all();
+            if (_ops.mustShutdown()) {
+                return;
+            }
+        }
+
+        // The applier has just taken the previous batch, so read what this one touches while that
+        // batch is applied.
+        if (!prefetchTargets.empty()) {
+            _prefetch(storageInterface, prefetchTargets);
         }
     }
 }
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <vector>
+
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/oplog_buffer.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -139,6 +142,17 @@ public:
         Timestamp forceBatchBoundaryAfter;
     };
 
+    /**
+     * A document that an update or delete in a batch will touch, to be read into cache before the
+     * batch is applied.
+     */
+    struct PrefetchTarget {
+        NamespaceStringOrUUID nsOrUUID;
+
+        // Owned object holding the document's _id as its only element.
+        BSONObj id;
+    };
+
     /**
      * Constructs an OplogBatcher
      */
@@ -173,6 +187,11 @@ public:
     StatusWith<std::vector<OplogEntry>> getNextApplierBatch(OperationContext* opCtx,
                                                             const BatchLimits& batchLimits);
 
+    /**
+     * Returns the documents touched by the updates and deletes in 'ops', in batch order.
+     */
+    static std::vector<PrefetchTarget> getPrefetchTargets(const std::vector<OplogEntry>& ops);
+
 private:
     /**
      * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
@@ -185,6 +204,13 @@ private:
      */
     void _consume(OperationContext* opCtx, OplogBuffer* oplogBuffer);
 
+    /**
+     * Reads the documents in 'targets' into cache while the batch they belong to waits for the
+     * applier. Stops as soon as the applier takes that batch, since its writer threads will be
+     * reading the same documents from then on.
+     */
+    void _prefetch(StorageInterface* storageInterface, const std::vector<PrefetchTarget>& targets);
+
     void _run(StorageInterface* storageInterface);
 
     OplogApplier* _oplogApplier;
@@ -31,6 +31,8 @@
 
 #include "mongo/db/repl/oplog_fetcher.h"
 
+#include <algorithm>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
@@ -272,6 +274,17 @@ StatusWith<OplogFetcher::DocumentsInfo> OplogFetcher::validateDocuments(
     return info;
 }
 
+int OplogFetcher::getBatchSizeForBufferSpace(int batchSize,
+                                             std::size_t spaceAvailableBytes,
+                                             std::size_t averageDocumentBytes) {
+    invariant(averageDocumentBytes > 0);
+    auto documentsThatFit = spaceAvailableBytes / averageDocumentBytes;
+    if (documentsThatFit >= static_cast<std::size_t>(batchSize)) {
+        return batchSize;
+    }
+    return std::max(static_cast<int>(documentsThatFit), 1);
+}
+
 OplogFetcher::OplogFetcher(executor::TaskExecutor* executor,
                            OpTime lastFetched,
                            HostAndPort source,
@@ -653,6 +666,17 @@ StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
                 _cursor->setCurrentTermAndLastCommittedOpTime(lastCommittedWithCurrentTerm.value,
                                                               lastCommittedWithCurrentTerm.opTime);
             }
+
+            // Without exhaust each getMore can ask for a different batchSize, so don't ask for
+            // more than the oplog buffer has room for. A lagging applier then slows down the sync
+            // source rather than leaving a full batch blocked on enqueueing.
+            if (!oplogFetcherUsesExhaust) {
+                auto spaceAvailable = _dataReplicatorExternalState->getOplogBufferSpaceAvailable();
+                if (spaceAvailable && _averageDocumentBytes > 0) {
+                    _cursor->setBatchSize(getBatchSizeForBufferSpace(
+                        _batchSize, *spaceAvailable, _averageDocumentBytes));
+                }
+            }
             _cursor->more();
         }
 
@@ -791,6 +815,9 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
         return validateResult.getStatus();
     }
     auto info = validateResult.getValue();
+    if (info.networkDocumentCount > 0) {
+        _averageDocumentBytes = info.networkDocumentBytes / info.networkDocumentCount;
+    }
 
     // Process replset metadata.  It is important that this happen after we've validated the
     // first batch, so we don't progress our knowledge of the commit point from a
@@ -189,6 +189,14 @@ public:
         Timestamp lastTS,
         StartingPoint startingPoint = StartingPoint::kSkipFirstDoc);
 
+    /**
+     * Returns the batchSize for a getMore so that the batch fits in 'spaceAvailableBytes' of the
+     * oplog buffer, given the average size of the documents fetched so far. The result is never
+     * more than 'batchSize' and never less than 1, so that fetching keeps making progress.
+     */
+    static int getBatchSizeForBufferSpace(int batchSize,
+                                          std::size_t spaceAvailableBytes,
+                                          std::size_t averageDocumentBytes);
 
     /**
      * Prints out the status and settings of the oplog fetcher.
@@ -409,6 +417,10 @@ private:
     executor::TaskExecutor::CallbackHandle _runQueryHandle;
 
     int _lastBatchElapsedMS;
+
+    // Average size of the documents in the last non-empty batch, used to size getMores by how much
+    // room is left in the oplog buffer. Zero until a batch has been fetched.
+    std::size_t _averageDocumentBytes = 0;
 };
 
 }  // namespace repl
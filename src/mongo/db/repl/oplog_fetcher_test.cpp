@@ -1406,6 +1406,61 @@ TEST_F(OplogFetcherTest, OplogFetcherWorksWithoutExhaust) {
     ASSERT_EQUALS(ErrorCodes::CallbackCanceled, shutdownState.getStatus());
 }
 
+TEST_F(OplogFetcherTest, GetMoreBatchSizeIsLimitedByOplogBufferSpaceWithoutExhaust) {
+    ShutdownState shutdownState;
+
+    oplogFetcherUsesExhaust = false;
+
+    auto oplogFetcher = getOplogFetcherAfterConnectionCreated(std::ref(shutdownState), 1);
+
+    CursorId cursorId = 22LL;
+    auto firstEntry = makeNoopOplogEntry(lastFetched);
+    auto secondEntry = makeNoopOplogEntry({{Seconds(456), 0}, lastFetched.getTerm()});
+    auto metadataObj = makeOplogBatchMetadata(replSetMetadata, oqMetadata);
+    auto firstBatch = {firstEntry, secondEntry};
+
+    // Leave room for about three more entries in the oplog buffer.
+    const auto averageDocumentBytes = (firstEntry.objsize() + secondEntry.objsize()) / 2;
+    dataReplicatorExternalState->oplogBufferSpaceAvailable = averageDocumentBytes * 3;
+
+    auto m = processSingleRequestResponse(oplogFetcher->getDBClientConnection_forTest(),
+                                          makeFirstBatch(cursorId, firstBatch, metadataObj),
+                                          true);
+    validateFindCommand(
+        m, lastFetched, durationCount<Milliseconds>(oplogFetcher->getInitialFindMaxTime_forTest()));
+    lastFetched = oplogFetcher->getLastOpTimeFetched_forTest();
+
+    auto thirdEntry = makeNoopOplogEntry({{Seconds(457), 0}, lastFetched.getTerm()});
+    m = processSingleRequestResponse(
+        oplogFetcher->getDBClientConnection_forTest(),
+        makeSubsequentBatch(cursorId, {thirdEntry}, metadataObj, false /* moreToCome */),
+        true);
+
+    // The getMore asks for no more documents than fit in the oplog buffer.
+    auto msg = mongo::OpMsg::parse(m);
+    ASSERT_EQ(mongo::StringData(msg.body.firstElement().fieldName()), "getMore");
+    ASSERT_EQUALS(3, msg.body["batchSize"].numberInt());
+
+    oplogFetcher->shutdown();
+    oplogFetcher->join();
+
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled, shutdownState.getStatus());
+}
+
+TEST(OplogFetcherBatchSizeTest, GetBatchSizeForBufferSpace) {
+    // Plenty of room leaves the configured batchSize alone.
+    ASSERT_EQUALS(100, OplogFetcher::getBatchSizeForBufferSpace(100, 1024 * 1024, 100));
+    ASSERT_EQUALS(100, OplogFetcher::getBatchSizeForBufferSpace(100, 100 * 100, 100));
+
+    // Otherwise ask for only as many documents as fit.
+    ASSERT_EQUALS(99, OplogFetcher::getBatchSizeForBufferSpace(100, 100 * 100 - 1, 100));
+    ASSERT_EQUALS(10, OplogFetcher::getBatchSizeForBufferSpace(100, 1050, 100));
+
+    // A full buffer still fetches one document at a time.
+    ASSERT_EQUALS(1, OplogFetcher::getBatchSizeForBufferSpace(100, 50, 100));
+    ASSERT_EQUALS(1, OplogFetcher::getBatchSizeForBufferSpace(100, 0, 100));
+}
+
 TEST_F(OplogFetcherTest, CursorIsDeadShutsDownOplogFetcherWithSuccessfulStatus) {
     ShutdownState shutdownState;
 
@@ -48,7 +48,9 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
+#include <exception>
 #include <snappy.h>
 #include <vector>
 
@@ -59,10 +61,14 @@
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 #include "mongo/util/unowned_ptr.h"
 
@@ -117,6 +123,190 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+// Below this many elements per thread, the cost of handing work to other threads outweighs the
+// benefit of sorting in parallel.
+const size_t kMinParallelSortElementsPerThread = 16 * 1024;
+
+/**
+ * Whether a Sorter over 'Key' and 'Value' may honor SortOptions::parallelism. See sorter.h.
+ */
+template <typename T, typename = void>
+struct AllowsParallelism : std::false_type {};
+
+template <typename T>
+struct AllowsParallelism<T, std::void_t<decltype(T::kSorterAllowsParallelism)>>
+    : std::bool_constant<T::kSorterAllowsParallelism> {};
+
+template <typename Key, typename Value>
+constexpr bool kAllowsParallelism =
+    AllowsParallelism<Key>::value && AllowsParallelism<Value>::value;
+
+/**
+ * The threads shared by every parallel Sorter in the process. Threads are started on demand and
+ * exit once idle. The pool is never destroyed, so Sorters may schedule work on it at any time.
+ */
+inline ThreadPool& sorterThreadPool() {
+    static ThreadPool* pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "SorterThreadPool";
+        options.threadNamePrefix = "Sorter-";
+        options.minThreads = 0;
+        // The most threads a single Sorter may ask for.
+        options.maxThreads = 64;
+
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return *pool;
+}
+
+/**
+ * Invokes 'task(i)' for every i in [0, nTasks) using the calling thread and up to 'nTasks - 1'
+ * threads of the sorter thread pool. Waits for all tasks to finish and rethrows the first exception
+ * thrown by any of them.
+ *
+ * Tasks are claimed in order by whichever thread is free first, and the calling thread works
+ * through them too, so every task runs even if all of the pool's threads are busy. This also makes
+ * it safe to call from a task which is itself running on the pool.
+ */
+template <typename Task>
+void runInParallel(size_t nTasks, const Task& task) {
+    struct State {
+        explicit State(size_t nTasks) : nTasks(nTasks), errors(nTasks) {}
+
+        const size_t nTasks;
+        AtomicWord<size_t> nextTask{0};
+        std::vector<std::exception_ptr> errors;
+
+        Mutex mutex = MONGO_MAKE_LATCH("runInParallel::State::mutex");
+        stdx::condition_variable allFinished;
+        size_t nFinished = 0;
+    };
+    auto state = std::make_shared<State>(nTasks);
+
+    // Pool threads which only get to run after every task has been claimed never touch 'task', so
+    // it need only outlive this function.
+    auto runTasks = [state, &task] {
+        for (size_t i; (i = state->nextTask.fetchAndAdd(1)) < state->nTasks;) {
+            try {
+                task(i);
+            } catch (...) {
+                state->errors[i] = std::current_exception();
+            }
+
+            stdx::lock_guard<Latch> lk(state->mutex);
+            if (++state->nFinished == state->nTasks) {
+                state->allFinished.notify_all();
+            }
+        }
+    };
+
+    for (size_t i = 1; i < nTasks; ++i) {
+        sorterThreadPool().schedule([runTasks](Status status) {
+            if (status.isOK()) {
+                runTasks();
+            }
+        });
+    }
+    runTasks();
+
+    {
+        stdx::unique_lock<Latch> lk(state->mutex);
+        state->allFinished.wait(lk, [&] { return state->nFinished == state->nTasks; });
+    }
+
+    for (auto&& error : state->errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * Stable sort of 'data' using up to 'parallelism' threads. Equal-sized chunks are sorted
+ * concurrently, the chunks are then cut into key ranges at splitters sampled from every chunk, and
+ * each key range is merged concurrently into its final position. Ties are broken by chunk order, so
+ * the result is identical to that of std::stable_sort().
+ *
+ * Elements are compared by several threads at once, so this must only be used for types which
+ * declare kSorterAllowsParallelism.
+ */
+template <typename Data, typename Less>
+void parallelStableSort(std::deque<Data>* data, const Less& less, size_t parallelism) {
+    const size_t nElements = data->size();
+    const size_t nChunks = std::min(parallelism, nElements / kMinParallelSortElementsPerThread);
+    if (nChunks < 2) {
+        std::stable_sort(data->begin(), data->end(), less);
+        return;
+    }
+
+    std::vector<size_t> chunkStart(nChunks + 1);
+    for (size_t chunk = 0; chunk <= nChunks; ++chunk) {
+        chunkStart[chunk] = nElements * chunk / nChunks;
+    }
+    auto chunkBegin = [&](size_t chunk) { return data->begin() + chunkStart[chunk]; };
+
+    runInParallel(nChunks, [&](size_t chunk) {
+        std::stable_sort(chunkBegin(chunk), chunkBegin(chunk + 1), less);
+    });
+
+    // Take 'nChunks' evenly spaced samples from every sorted chunk and use every 'nChunks'th sample
+    // of the combined set as the lower bound of a key range.
+    std::vector<const Data*> samples;
+    samples.reserve(nChunks * nChunks);
+    for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+        const size_t chunkSize = chunkStart[chunk + 1] - chunkStart[chunk];
+        for (size_t sample = 0; sample < nChunks; ++sample) {
+            samples.push_back(&*(chunkBegin(chunk) + chunkSize * sample / nChunks));
+        }
+    }
+    std::stable_sort(samples.begin(), samples.end(), [&](const Data* lhs, const Data* rhs) {
+        return less(*lhs, *rhs);
+    });
+
+    // 'cuts[range][chunk]' is the position in 'data' at which 'range' begins within 'chunk'.
+    std::vector<std::vector<size_t>> cuts(nChunks + 1, std::vector<size_t>(nChunks));
+    for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+        cuts[0][chunk] = chunkStart[chunk];
+        cuts[nChunks][chunk] = chunkStart[chunk + 1];
+    }
+    for (size_t range = 1; range < nChunks; ++range) {
+        const Data& splitter = *samples[range * nChunks];
+        for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+            cuts[range][chunk] =
+                std::lower_bound(chunkBegin(chunk), chunkBegin(chunk + 1), splitter, less) -
+                data->begin();
+        }
+    }
+
+    std::vector<size_t> rangeOutputStart(nChunks + 1, 0);
+    for (size_t range = 0; range < nChunks; ++range) {
+        rangeOutputStart[range + 1] = rangeOutputStart[range];
+        for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+            rangeOutputStart[range + 1] += cuts[range + 1][chunk] - cuts[range][chunk];
+        }
+    }
+
+    std::vector<Data> sorted(nElements);
+    runInParallel(nChunks, [&](size_t range) {
+        std::vector<size_t> next = cuts[range];
+        const std::vector<size_t>& end = cuts[range + 1];
+        for (size_t out = rangeOutputStart[range]; out < rangeOutputStart[range + 1]; ++out) {
+            size_t best = nChunks;
+            for (size_t chunk = 0; chunk < nChunks; ++chunk) {
+                if (next[chunk] != end[chunk] &&
+                    (best == nChunks || less((*data)[next[chunk]], (*data)[next[best]]))) {
+                    best = chunk;
+                }
+            }
+            sorted[out] = std::move((*data)[next[best]++]);
+        }
+    });
+
+    std::move(sorted.begin(), sorted.end(), data->begin());
+}
+
 /**
  * Returns results from sorted in-memory storage.
  */
@@ -524,7 +714,11 @@ public:
     NoLimitSorter(const SortOptions& opts,
                   const Comparator& comp,
                   const Settings& settings = Settings())
-        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
+        : _comp(comp),
+          _settings(settings),
+          _opts(opts),
+          _parallelism(kAllowsParallelism<Key, Value> ? opts.parallelism : 1),
+          _memUsed(0) {
         verify(_opts.limit == 0);
         if (_opts.extSortAllowed) {
             _fileName = _opts.tempDir + "/" + nextFileName();
@@ -532,6 +726,11 @@ public:
     }
 
     ~NoLimitSorter() {
+        if (_backgroundSpill && !_backgroundSpill->claim()) {
+            // The background spill may still be writing to the file, so let it finish first.
+            _backgroundSpill->waitUntilFinished();
+        }
+
         if (!_done) {
             // If done() was never called to return a MergeIterator, then this Sorter still owns
             // file deletion.
@@ -547,19 +746,22 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > spillThresholdBytes())
             spill();
     }
 
     Iterator* done() {
         invariant(!_done);
 
+        waitForBackgroundSpill();
+
         if (_iters.empty()) {
             sort();
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        waitForBackgroundSpill();
         Iterator* mergeIt = Iterator::merge(_iters, _fileName, _opts, _comp);
         _done = true;
         return mergeIt;
@@ -578,15 +780,151 @@ private:
         const Comparator& _comp;
     };
 
+    /**
+     * A run which is being sorted and written to the file by a thread of the sorter thread pool.
+     * Whichever thread claims the run first writes it: if no pool thread has got to it by the time
+     * the Sorter needs the run, the thread adding data to the Sorter writes it instead.
+     */
+    struct BackgroundSpill {
+        /**
+         * Returns true if the caller is the first to claim this run, and so must write it and then
+         * call markFinished().
+         */
+        bool claim() {
+            return !claimed.swap(true);
+        }
+
+        void markFinished() {
+            stdx::lock_guard<Latch> lk(mutex);
+            finished = true;
+            finishedCondition.notify_all();
+        }
+
+        void waitUntilFinished() {
+            stdx::unique_lock<Latch> lk(mutex);
+            finishedCondition.wait(lk, [&] { return finished; });
+        }
+
+        std::deque<Data> data;
+        std::streampos startOffset;
+        std::streampos endOffset;
+        std::shared_ptr<Iterator> iterator;
+        std::exception_ptr error;
+
+        AtomicWord<bool> claimed{false};
+        Mutex mutex = MONGO_MAKE_LATCH("NoLimitSorter::BackgroundSpill::mutex");
+        stdx::condition_variable finishedCondition;
+        bool finished = false;
+    };
+
+    /**
+     * When sorting in parallel, a run is spilled in the background while the next one is being
+     * buffered, so each of the two only gets half of the memory budget.
+     */
+    size_t spillThresholdBytes() const {
+        if (_parallelism > 1 && _opts.extSortAllowed)
+            return _opts.maxMemoryUsageBytes / 2;
+        return _opts.maxMemoryUsageBytes;
+    }
+
     void sort() {
+        sort(&_data, _parallelism);
+    }
+
+    void sort(std::deque<Data>* data, size_t parallelism) const {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        if constexpr (kAllowsParallelism<Key, Value>) {
+            if (parallelism > 1) {
+                parallelStableSort(data, less, parallelism);
+                return;
+            }
+        }
+
+        std::stable_sort(data->begin(), data->end(), less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
         // std::sort(_data.begin(), _data.end(), comp);
     }
 
+    /**
+     * Sorts 'data' using up to 'parallelism' threads and appends it to the file at 'startOffset',
+     * leaving 'data' empty. Sets 'endOffset' to the offset just past the written run and returns an
+     * iterator over the run.
+     */
+    std::shared_ptr<Iterator> sortAndWriteRun(std::deque<Data>* data,
+                                              size_t parallelism,
+                                              std::streampos startOffset,
+                                              std::streampos* endOffset) const {
+        sort(data, parallelism);
+
+        SortedFileWriter<Key, Value> writer(_opts, _fileName, startOffset, _settings);
+        for (; !data->empty(); data->pop_front()) {
+            writer.addAlreadySorted(data->front().first, data->front().second);
+        }
+        Iterator* iteratorPtr = writer.done();
+        *endOffset = writer.getFileEndOffset();
+
+        return std::shared_ptr<Iterator>(iteratorPtr);
+    }
+
+    /**
+     * Writes the run of 'job', which the calling thread must have claimed.
+     */
+    void runBackgroundSpill(BackgroundSpill* job, size_t parallelism) const {
+        try {
+            job->iterator =
+                sortAndWriteRun(&job->data, parallelism, job->startOffset, &job->endOffset);
+        } catch (...) {
+            job->error = std::current_exception();
+        }
+        job->markFinished();
+    }
+
+    /**
+     * Waits for the in-flight background spill, if any, and adds its run to '_iters'. Rethrows any
+     * error the background spill encountered.
+     */
+    void waitForBackgroundSpill() {
+        if (!_backgroundSpill)
+            return;
+
+        if (_backgroundSpill->claim()) {
+            runBackgroundSpill(_backgroundSpill.get(), _parallelism);
+        }
+        _backgroundSpill->waitUntilFinished();
+        auto job = std::move(_backgroundSpill);
+        if (job->error) {
+            std::rethrow_exception(job->error);
+        }
+
+        _iters.push_back(std::move(job->iterator));
+        _nextSortedFileWriterOffset = job->endOffset;
+    }
+
+    /**
+     * Hands the buffered data off to the sorter thread pool to be sorted and written to disk. Runs
+     * are appended to the shared file one at a time, so any previous background spill is waited
+     * for first.
+     */
+    void spillInBackground() {
+        waitForBackgroundSpill();
+
+        auto job = std::make_shared<BackgroundSpill>();
+        job->data.swap(_data);
+        job->startOffset = _nextSortedFileWriterOffset;
+
+        // The Sorter claims the run before it is destroyed, so 'this' is only used by a pool thread
+        // which claimed the run first and which the Sorter therefore waits for.
+        sorterThreadPool().schedule([this, job](Status status) {
+            if (status.isOK() && job->claim()) {
+                // The thread adding data to the Sorter counts towards the parallelism limit.
+                runBackgroundSpill(job.get(), _parallelism - 1);
+            }
+        });
+        _backgroundSpill = std::move(job);
+    }
+
     void spill() {
         invariant(!_done);
 
@@ -604,17 +942,16 @@ private:
                                     << " bytes, but did not opt in to external sorting.");
         }
 
-        sort();
-
-        SortedFileWriter<Key, Value> writer(
-            _opts, _fileName, _nextSortedFileWriterOffset, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        if constexpr (kAllowsParallelism<Key, Value>) {
+            if (_parallelism > 1) {
+                spillInBackground();
+                _memUsed = 0;
+                return;
+            }
         }
-        Iterator* iteratorPtr = writer.done();
-        _nextSortedFileWriterOffset = writer.getFileEndOffset();
 
-        _iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
+        _iters.push_back(sortAndWriteRun(
+            &_data, 1, _nextSortedFileWriterOffset, &_nextSortedFileWriterOffset));
 
         _memUsed = 0;
     }
@@ -622,12 +959,17 @@ private:
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
+    // The number of threads this Sorter may use, which is 1 unless both Key and Value allow it.
+    const size_t _parallelism;
     std::string _fileName;
     std::streampos _nextSortedFileWriterOffset = 0;
     bool _done = false;
     size_t _memUsed;
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+
+    // The run being sorted and spilled by the sorter thread pool, if any.
+    std::shared_ptr<BackgroundSpill> _backgroundSpill;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -66,6 +66,11 @@
  * // Return *this if your type doesn't have an unowned state.
  * Type getOwned() const;
  *
+ * // Optional. Declare this as true only if the owned objects returned by getOwned() may be
+ * // compared, copied and serialized by several threads at once, such as types which never cache
+ * // state lazily. A Sorter only uses SortOptions::parallelism if both its Key and Value do so.
+ * static constexpr bool kSorterAllowsParallelism = true;
+ *
  * Comparators are functors that that compare std::pair<Key, Value> and return an
  * int less than, equal to, or greater than 0 depending on how the two pairs
  * compare with the same semantics as memcmp.
@@ -107,7 +112,14 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The maximum number of threads, including the calling thread, that an unlimited sort may use
+    // to sort buffered data and to spill it to disk. A value of 1 keeps all sorting on the thread
+    // calling into the Sorter. Sorts with a limit, and Sorters whose Key or Value type does not
+    // declare kSorterAllowsParallelism, ignore this option.
+    size_t parallelism;
+
+    SortOptions()
+        : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false), parallelism(1) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -130,6 +142,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& Parallelism(size_t newParallelism) {
+        parallelism = newParallelism > 0 ? newParallelism : 1;
+        return *this;
+    }
 };
 
 /**
@@ -150,6 +167,7 @@ public:
     NullValue getOwned() const {
         return {};
     }
+    static constexpr bool kSorterAllowsParallelism = true;
 };
 
 /**
@@ -101,6 +101,7 @@ public:
     IntWrapper getOwned() const {
         return *this;
     }
+    static constexpr bool kSorterAllowsParallelism = true;
 
 private:
     int _i;
@@ -581,6 +582,56 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+template <bool Random = true>
+class LotsOfDataLittleMemoryParallel : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return Parent::adjustSortOptions(opts).Parallelism(4);
+    }
+};
+
+/**
+ * Sorts enough data with few distinct keys for the work to be split across threads, and checks
+ * that values with equal keys are returned in the order they were added.
+ */
+template <bool ExtSort>
+class ParallelStability : public Basic {
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        if (ExtSort)
+            opts.MaxMemoryUsageBytes(MEM_LIMIT).ExtSortAllowed();
+        return opts.Parallelism(4);
+    }
+
+    void addData(unowned_ptr<IWSorter> sorter) override {
+        for (int i = 0; i < NUM_ITEMS; i++)
+            sorter->add(i % NUM_KEYS, i);
+    }
+
+    std::shared_ptr<IWIterator> correct() override {
+        return expected(ASC);
+    }
+    std::shared_ptr<IWIterator> correctReverse() override {
+        return expected(DESC);
+    }
+
+    std::shared_ptr<IWIterator> expected(Direction dir) {
+        std::vector<IWPair> vec;
+        for (int i = 0; i < NUM_KEYS; i++) {
+            const int key = dir == ASC ? i : NUM_KEYS - 1 - i;
+            for (int value = key; value < NUM_ITEMS; value += NUM_KEYS)
+                vec.push_back(IWPair(key, value));
+        }
+        return std::make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(vec);
+    }
+
+    enum Constants {
+        NUM_ITEMS = 500 * 1000,
+        NUM_KEYS = 7,
+        // Each spilled run is large enough to be sorted by more than one thread.
+        MEM_LIMIT = 2 * 1024 * 1024,
+    };
+};
 }  // namespace SorterTests
 
 class SorterSuite : public mongo::unittest::OldStyleSuiteSpecification {
@@ -599,6 +650,10 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallel</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallel</*random=*/true>>();
+        add<SorterTests::ParallelStability</*extSort=*/false>>();
+        add<SorterTests::ParallelStability</*extSort=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -36,6 +36,12 @@
 #include <cmath>
 #include <type_traits>
 
+// x86_64 always has SSE2, so no runtime detection is needed to use it.
+#if defined(_M_AMD64) || defined(__amd64__)
+#include <emmintrin.h>
+#define MONGO_KEY_STRING_HAVE_SSE2
+#endif
+
 #include "mongo/base/data_cursor.h"
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_depth.h"
@@ -240,10 +246,33 @@ const uint8_t kGreater = 254;
 // some utility functions
 namespace {
 
+/**
+ * Copies 'bytes' bytes from 'src' to 'dst', inverting every bit. 'dst' and 'src' may be the same
+ * location, but must not otherwise overlap.
+ *
+ * Descending index fields are stored inverted, so this is on the hot path for every string, OID
+ * and binary value in a descending key.
+ */
 void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
     const char* const end = input + bytes;
+
+#ifdef MONGO_KEY_STRING_HAVE_SSE2
+    const __m128i allOnes = _mm_set1_epi8(-1);
+    for (; end - input >= static_cast<ptrdiff_t>(sizeof(__m128i));
+         input += sizeof(__m128i), output += sizeof(__m128i)) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_xor_si128(block, allOnes));
+    }
+#endif
+
+    // Without vector support, or for the tail of the input, flip a machine word at a time.
+    for (; end - input >= static_cast<ptrdiff_t>(sizeof(uint64_t));
+         input += sizeof(uint64_t), output += sizeof(uint64_t)) {
+        DataView(output).write<uint64_t>(~ConstDataView(input).read<uint64_t>());
+    }
+
     while (input != end) {
         *output++ = ~(*input++);
     }
@@ -295,10 +324,8 @@ string readInvertedCString(BufReader* reader) {
     const char* end = static_cast<const char*>(memchr(start, 0xFF, reader->remaining()));
     keyStringAssert(50817, "Failed to find '0xFF' in inverted string.", end);
     size_t actualBytes = end - start;
-    string s(start, actualBytes);
-    for (size_t i = 0; i < s.size(); i++) {
-        s[i] = ~s[i];
-    }
+    string s(actualBytes, '\0');
+    memcpy_flipBits(s.data(), start, actualBytes);
     reader->skip(1 + actualBytes);
     return s;
 }
@@ -325,9 +352,7 @@ string readInvertedCStringWithNuls(BufReader* reader) {
         reader->skip(1 + actualBytes);
     } while (reader->peek<unsigned char>() == 0x00);
 
-    for (size_t i = 0; i < out.size(); i++) {
-        out[i] = ~out[i];
-    }
+    memcpy_flipBits(out.data(), out.data(), out.size());
 
     return out;
 }
@@ -2539,6 +2564,11 @@ RecordId decodeRecordId(BufReader* reader) {
     return RecordId(repr);
 }
 
+namespace {
+// The number of leading bytes which compare() examines inline before deferring to memcmp.
+constexpr size_t kInlineCompareBytes = 16;
+}  // namespace
+
 int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t rightSize) {
     // memcmp has undefined behavior if either leftBuf or rightBuf is a null pointer.
     if (MONGO_unlikely(leftSize == 0))
@@ -2546,9 +2576,23 @@ int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t r
     else if (MONGO_unlikely(rightSize == 0))
         return 1;
 
-    int min = std::min(leftSize, rightSize);
+    const size_t min = std::min(leftSize, rightSize);
+
+    // Most keys which differ do so within their first few bytes (the type byte and the start of
+    // the first field), so compare the leading bytes a word at a time before calling out to
+    // memcmp. Loading the words as big-endian makes integer order match byte order.
+    size_t offset = 0;
+    for (; offset < kInlineCompareBytes && offset + sizeof(uint64_t) <= min;
+         offset += sizeof(uint64_t)) {
+        const uint64_t left = endian::bigToNative(ConstDataView(leftBuf + offset).read<uint64_t>());
+        const uint64_t right =
+            endian::bigToNative(ConstDataView(rightBuf + offset).read<uint64_t>());
+        if (left != right) {
+            return left < right ? -1 : 1;
+        }
+    }
 
-    int cmp = memcmp(leftBuf, rightBuf, min);
+    int cmp = memcmp(leftBuf + offset, rightBuf + offset, min - offset);
 
     if (cmp) {
         if (cmp < 0)
@@ -419,6 +419,10 @@ public:
         return *this;
     }
 
+    // The buffer is never modified once built, so Sorters may compare and serialize Values on
+    // several threads at once.
+    static constexpr bool kSorterAllowsParallelism = true;
+
 private:
     Version _version;
     // _ksSize is the total length that the KeyString takes up in the buffer.
@@ -46,8 +46,12 @@ std::mt19937_64 seedGen(1234);
 const int kSampleSize = 500;
 const int kStrLenMultiplier = 100;
 const int kArrLenMultiplier = 40;
+const int kLongStrLen = 2048;
+const int kCompoundKeyFields = 4;
 
 const Ordering ALL_ASCENDING = Ordering::make(BSONObj());
+const Ordering ALL_DESCENDING = Ordering::make(BSON("a" << -1 << "b" << -1 << "c" << -1 << "d"
+                                                       << -1));
 
 struct BsonsAndKeyStrings {
     int bsonSize = 0;
@@ -65,6 +69,8 @@ enum BsonValueType {
     STRING,
     ARRAY,
     DECIMAL,
+    LONG_STRING,
+    COMPOUND,
 };
 
 BSONObj generateBson(BsonValueType bsonValueType) {
@@ -92,18 +98,40 @@ BSONObj generateBson(BsonValueType bsonValueType) {
                                          Decimal128::kRoundTo34Digits,
                                          Decimal128::kRoundTiesToAway)
                                   .quantize(Decimal128("0.01", Decimal128::kRoundTiesToAway)));
+        case LONG_STRING: {
+            // Random printable characters with the occasional NUL byte, which must be escaped.
+            std::uniform_int_distribution<int> charDist(0, 95);
+            std::string str(kLongStrLen, '\0');
+            for (auto&& c : str) {
+                const int val = charDist(gen);
+                c = val == 0 ? '\0' : static_cast<char>(' ' + val);
+            }
+            return BSON("" << str);
+        }
+        case COMPOUND: {
+            BSONObjBuilder bob;
+            for (int i = 0; i < kCompoundKeyFields; i++) {
+                if (i % 2 == 0) {
+                    bob.append("", std::string(expDist(gen) * kStrLenMultiplier, 'x'));
+                } else {
+                    bob.append("", expReal(gen));
+                }
+            }
+            return bob.obj();
+        }
     }
     MONGO_UNREACHABLE;
 }
 
 static BsonsAndKeyStrings generateBsonsAndKeyStrings(BsonValueType bsonValueType,
-                                                     KeyString::Version version) {
+                                                     KeyString::Version version,
+                                                     Ordering ord = ALL_ASCENDING) {
     BsonsAndKeyStrings result;
     result.bsonSize = 0;
     result.keystringSize = 0;
     for (int i = 0; i < kSampleSize; i++) {
         BSONObj bson = generateBson(bsonValueType);
-        KeyString::Builder ks(version, bson, ALL_ASCENDING);
+        KeyString::Builder ks(version, bson, ord);
         result.bsonSize += bson.objsize();
         result.keystringSize += ks.getSize();
         result.bsons[i] = bson;
@@ -133,10 +161,27 @@ void BM_BSONToKeyString(benchmark::State& state,
     state.SetItemsProcessed(state.iterations() * kSampleSize);
 }
 
+void BM_BSONToKeyStringDescending(benchmark::State& state,
+                                  const KeyString::Version version,
+                                  BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings =
+        generateBsonsAndKeyStrings(bsonType, version, ALL_DESCENDING);
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (auto bson : bsonsAndKeyStrings.bsons) {
+            benchmark::DoNotOptimize(KeyString::Builder(version, bson, ALL_DESCENDING));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
+    state.SetItemsProcessed(state.iterations() * kSampleSize);
+}
+
 void BM_KeyStringToBSON(benchmark::State& state,
                         const KeyString::Version version,
-                        BsonValueType bsonType) {
-    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+                        BsonValueType bsonType,
+                        Ordering ord = ALL_ASCENDING) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings =
+        generateBsonsAndKeyStrings(bsonType, version, ord);
     for (auto _ : state) {
         benchmark::ClobberMemory();
         for (size_t i = 0; i < kSampleSize; i++) {
@@ -144,7 +189,7 @@ void BM_KeyStringToBSON(benchmark::State& state,
             benchmark::DoNotOptimize(
                 KeyString::toBson(bsonsAndKeyStrings.keystrings[i].get(),
                                   bsonsAndKeyStrings.keystringLens[i],
-                                  ALL_ASCENDING,
+                                  ord,
                                   KeyString::TypeBits::fromBuffer(version, &buf)));
         }
     }
@@ -152,6 +197,28 @@ void BM_KeyStringToBSON(benchmark::State& state,
     state.SetItemsProcessed(state.iterations() * kSampleSize);
 }
 
+void BM_KeyStringCompare(benchmark::State& state,
+                         BsonValueType bsonType,
+                         Ordering ord = ALL_ASCENDING) {
+    // The KeyString version does not matter for this test.
+    const auto version = KeyString::Version::V1;
+    const BsonsAndKeyStrings bsonsAndKeyStrings =
+        generateBsonsAndKeyStrings(bsonType, version, ord);
+
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (size_t i = 1; i < kSampleSize; i++) {
+            benchmark::DoNotOptimize(
+                KeyString::compare(bsonsAndKeyStrings.keystrings[i - 1].get(),
+                                   bsonsAndKeyStrings.keystrings[i].get(),
+                                   bsonsAndKeyStrings.keystringLens[i - 1],
+                                   bsonsAndKeyStrings.keystringLens[i]));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.keystringSize);
+    state.SetItemsProcessed(state.iterations() * (kSampleSize - 1));
+}
+
 void BM_KeyStringValueAssign(benchmark::State& state, BsonValueType bsonType) {
     // The KeyString version does not matter for this test.
     const auto version = KeyString::Version::V1;
@@ -244,6 +311,39 @@ BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_LongString, KeyString::Version::V1, LONG_STRING);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_LongString, KeyString::Version::V1, LONG_STRING);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_Double, KeyString::Version::V1, DOUBLE);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_Decimal, KeyString::Version::V1, DECIMAL);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending,
+                  V1_LongString,
+                  KeyString::Version::V1,
+                  LONG_STRING);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(
+    BM_KeyStringToBSON, V1_Descending_Double, KeyString::Version::V1, DOUBLE, ALL_DESCENDING);
+BENCHMARK_CAPTURE(
+    BM_KeyStringToBSON, V1_Descending_Decimal, KeyString::Version::V1, DECIMAL, ALL_DESCENDING);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON,
+                  V1_Descending_LongString,
+                  KeyString::Version::V1,
+                  LONG_STRING,
+                  ALL_DESCENDING);
+BENCHMARK_CAPTURE(
+    BM_KeyStringToBSON, V1_Descending_Compound, KeyString::Version::V1, COMPOUND, ALL_DESCENDING);
+
+BENCHMARK_CAPTURE(BM_KeyStringCompare, Double, DOUBLE);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, Decimal, DECIMAL);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, String, STRING);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, LongString, LONG_STRING);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, Compound, COMPOUND);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, CompoundDescending, COMPOUND, ALL_DESCENDING);
 
 }  // namespace
 }  // namespace mongo
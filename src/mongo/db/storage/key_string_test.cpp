@@ -1664,6 +1664,39 @@ TEST_F(KeyStringBuilderTest, VeryLargeString) {
     ROUNDTRIP(version, obj);
 }
 
+TEST_F(KeyStringBuilderTest, StringsOfEveryLengthAroundVectorWidths) {
+    // Strings are inverted and escaped in blocks, so exercise every length up to a few blocks,
+    // with and without embedded NUL bytes at various positions.
+    for (size_t len = 0; len <= 70; len++) {
+        std::string str;
+        for (size_t i = 0; i < len; i++) {
+            str += static_cast<char>('a' + (i % 26));
+        }
+        ROUNDTRIP(version, BSON("" << str));
+
+        for (size_t nulPos = 0; nulPos < len; nulPos += 7) {
+            std::string withNul = str;
+            withNul[nulPos] = '\0';
+            ROUNDTRIP(version, BSON("" << withNul));
+            ROUNDTRIP(version, BSON("" << BSONSymbol(withNul)));
+        }
+    }
+}
+
+TEST_F(KeyStringBuilderTest, CompareMatchesByteOrderAcrossWordBoundaries) {
+    // Keys which share prefixes of every length up to and beyond the inline comparison window
+    // must order the same way as a plain byte comparison.
+    const std::string base(40, 'm');
+    for (size_t diffPos = 0; diffPos < base.size(); diffPos++) {
+        std::string lower = base;
+        std::string higher = base;
+        lower[diffPos] = 'a';
+        higher[diffPos] = 'z';
+        COMPARES_SAME(version, BSON("" << lower), BSON("" << higher));
+        COMPARES_SAME(version, BSON("" << base.substr(0, diffPos)), BSON("" << base));
+    }
+}
+
 TEST_F(KeyStringBuilderTest, ToBsonSafeShouldNotTerminate) {
     KeyString::TypeBits typeBits(KeyString::Version::V1);
 
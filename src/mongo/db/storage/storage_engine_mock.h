@@ -82,11 +82,11 @@ public:
                       "The current storage engine doesn't support backup mode");
     }
     StatusWith<StorageEngine::BackupInformation> beginNonBlockingBackup(
-        OperationContext* opCtx, const StorageEngine::BackupOptions& options) final {
+        OperationContext* opCtx, const StorageEngine::BackupOptions& options) override {
         return Status(ErrorCodes::CommandNotSupported,
                       "The current storage engine doesn't support backup mode");
     }
-    void endNonBlockingBackup(OperationContext* opCtx) final {}
+    void endNonBlockingBackup(OperationContext* opCtx) override {}
     StatusWith<std::vector<std::string>> extendBackupCursor(OperationContext* opCtx) final {
         return Status(ErrorCodes::CommandNotSupported,
                       "The current storage engine doesn't support backup mode");
@@ -129,7 +129,7 @@ public:
     boost::optional<Timestamp> getRecoveryTimestamp() const final {
         MONGO_UNREACHABLE;
     }
-    boost::optional<Timestamp> getLastStableRecoveryTimestamp() const final {
+    boost::optional<Timestamp> getLastStableRecoveryTimestamp() const override {
         MONGO_UNREACHABLE;
     }
     void setStableTimestamp(Timestamp stableTimestamp, bool force = false) final {}
@@ -88,6 +88,7 @@
 #include "mongo/logv2/log.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/debug_util.h"
@@ -456,8 +457,147 @@ private:
 namespace {
 TicketHolder openWriteTransaction(128);
 TicketHolder openReadTransaction(128);
+
+AdaptiveTicketController writeTicketController(&openWriteTransaction);
+AdaptiveTicketController readTicketController(&openReadTransaction);
+
+// The ticket tuner idles on this condition variable between samples, and indefinitely while
+// wiredTigerAdaptiveConcurrentTransactions is off. It is notified when that parameter changes and
+// to expedite shutdown.
+Mutex ticketTunerMutex = MONGO_MAKE_LATCH("WiredTigerTicketTuner::_mutex");
+stdx::condition_variable ticketTunerCondvar;
 }  // namespace
 
+Status onUpdateWiredTigerAdaptiveConcurrentTransactions(const bool& newValue) {
+    stdx::lock_guard<Latch> lock(ticketTunerMutex);
+    ticketTunerCondvar.notify_all();
+    return Status::OK();
+}
+
+/**
+ * Resizes the read and write ticket pools while wiredTigerAdaptiveConcurrentTransactions is set,
+ * using the cache statistics as the resource pressure signal. See AdaptiveTicketController.
+ */
+class WiredTigerKVEngine::WiredTigerTicketTuner : public BackgroundJob {
+public:
+    explicit WiredTigerTicketTuner(WiredTigerSessionCache* sessionCache)
+        : BackgroundJob(false /* deleteSelf */), _sessionCache(sessionCache) {}
+
+    virtual string name() const {
+        return "WTTicketTuner";
+    }
+
+    virtual void run() {
+        ThreadClient tc(name(), getGlobalServiceContext());
+        LOGV2_DEBUG(5097101, 1, "starting {name} thread", "name"_attr = name());
+
+        bool enabled = false;
+        Date_t lastAdjustment;
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<Latch> lock(ticketTunerMutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                if (enabled) {
+                    ticketTunerCondvar.wait_for(lock, kSampleInterval.toSystemDuration());
+                } else {
+                    ticketTunerCondvar.wait(lock, [&] {
+                        return _shuttingDown.load() ||
+                            gWiredTigerAdaptiveConcurrentTransactions.load();
+                    });
+                }
+            }
+
+            if (_shuttingDown.load()) {
+                break;
+            }
+
+            if (!gWiredTigerAdaptiveConcurrentTransactions.load()) {
+                enabled = false;
+                continue;
+            }
+
+            // Whatever was learned before being disabled may no longer apply
+            if (!enabled) {
+                writeTicketController.reset();
+                readTicketController.reset();
+                lastAdjustment = Date_t::now();
+                _lastAppEvictions = boost::none;
+                enabled = true;
+            }
+
+            writeTicketController.sample();
+            readTicketController.sample();
+
+            const Date_t now = Date_t::now();
+            if (now - lastAdjustment < kAdjustmentInterval) {
+                continue;
+            }
+
+            const bool cachePressure = _isCacheUnderPressure();
+            const int minTickets = gWiredTigerAdaptiveConcurrentTransactionsMin.load();
+            const int maxTickets =
+                std::max(minTickets, gWiredTigerAdaptiveConcurrentTransactionsMax.load());
+            writeTicketController.adjust(now - lastAdjustment, cachePressure, minTickets, maxTickets);
+            readTicketController.adjust(now - lastAdjustment, cachePressure, minTickets, maxTickets);
+            lastAdjustment = now;
+        }
+        LOGV2_DEBUG(5097102, 1, "stopping {name} thread", "name"_attr = name());
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        {
+            stdx::unique_lock<Latch> lock(ticketTunerMutex);
+            ticketTunerCondvar.notify_all();
+        }
+        wait();
+    }
+
+private:
+    static constexpr Milliseconds kSampleInterval{10};
+    static constexpr Milliseconds kAdjustmentInterval{1000};
+
+    // WiredTiger's default eviction_trigger and eviction_dirty_trigger, as fractions of the cache
+    // size. Beyond these, application threads are drawn into eviction and operations stall.
+    static constexpr double kEvictionTrigger = 0.95;
+    static constexpr double kEvictionDirtyTrigger = 0.20;
+
+    /**
+     * Returns true if the cache is so full or dirty that application threads had to help with
+     * eviction since the previous call.
+     */
+    bool _isCacheUnderPressure() {
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        auto getStatistic = [&](int key) {
+            return WiredTigerUtil::getStatisticsValue(
+                session->getSession(), "statistics:", "statistics=(fast)", key);
+        };
+
+        auto bytesMax = getStatistic(WT_STAT_CONN_CACHE_BYTES_MAX);
+        auto bytesInUse = getStatistic(WT_STAT_CONN_CACHE_BYTES_INUSE);
+        auto bytesDirty = getStatistic(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+        auto appEvictions = getStatistic(WT_STAT_CONN_CACHE_EVICTION_APP);
+        if (!bytesMax.isOK() || !bytesInUse.isOK() || !bytesDirty.isOK() ||
+            !appEvictions.isOK()) {
+            return false;
+        }
+
+        const bool appThreadsEvicted =
+            _lastAppEvictions && appEvictions.getValue() > *_lastAppEvictions;
+        _lastAppEvictions = appEvictions.getValue();
+
+        const double cacheSize = bytesMax.getValue();
+        return appThreadsEvicted || bytesInUse.getValue() >= cacheSize * kEvictionTrigger ||
+            bytesDirty.getValue() >= cacheSize * kEvictionDirtyTrigger;
+    }
+
+    WiredTigerSessionCache* _sessionCache;
+    AtomicWord<bool> _shuttingDown{false};
+
+    // Value of the statistic for pages evicted by application threads at the previous adjustment
+    boost::optional<int64_t> _lastAppEvictions;
+};
+
 OpenWriteTransactionParam::OpenWriteTransactionParam(StringData name, ServerParameterType spt)
     : ServerParameter(name, spt), _data(&openWriteTransaction) {}
 
@@ -748,6 +888,9 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sessionSweeper = std::make_unique<WiredTigerSessionSweeper>(_sessionCache.get());
     _sessionSweeper->go();
 
+    _ticketTuner = std::make_unique<WiredTigerTicketTuner>(_sessionCache.get());
+    _ticketTuner->go();
+
     // Until the Replication layer installs a real callback, prevent truncating the oplog.
     setOldestActiveTransactionTimestampCallback(
         [](Timestamp) { return StatusWith(boost::make_optional(Timestamp::min())); });
@@ -813,6 +956,10 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        if (gWiredTigerAdaptiveConcurrentTransactions.load()) {
+            BSONObjBuilder adaptive(bbb.subobjStart("adaptive"));
+            writeTicketController.appendStats(&adaptive);
+        }
         bbb.done();
     }
     {
@@ -820,6 +967,10 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        if (gWiredTigerAdaptiveConcurrentTransactions.load()) {
+            BSONObjBuilder adaptive(bbb.subobjStart("adaptive"));
+            readTicketController.appendStats(&adaptive);
+        }
         bbb.done();
     }
     bb.done();
@@ -909,6 +1060,9 @@ void WiredTigerKVEngine::cleanShutdown() {
     }
 
     // these must be the last things we do before _conn->close();
+    if (_ticketTuner) {
+        _ticketTuner->shutdown();
+    }
     if (_sessionSweeper) {
         LOGV2(22318, "Shutting down session sweeper thread");
         _sessionSweeper->shutdown();
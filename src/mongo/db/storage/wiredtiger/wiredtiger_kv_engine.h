@@ -349,6 +349,7 @@ public:
 private:
     class WiredTigerSessionSweeper;
     class WiredTigerCheckpointThread;
+    class WiredTigerTicketTuner;
 
     /**
      * Opens a connection on the WiredTiger database 'path' with the configuration 'wtOpenConfig'.
@@ -437,6 +438,7 @@ private:
     const bool _keepDataHistory = true;
 
     std::unique_ptr<WiredTigerSessionSweeper> _sessionSweeper;
+    std::unique_ptr<WiredTigerTicketTuner> _ticketTuner;
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
 
     std::string _rsOptions;
@@ -469,4 +471,11 @@ private:
         MONGO_MAKE_LATCH("WiredTigerKVEngine::_highestDurableTimestampMutex");
     mutable unsigned long long _highestSeenDurableTimestamp = StorageEngine::kMinimumTimestamp;
 };
+
+/**
+ * Wakes the ticket tuner when wiredTigerAdaptiveConcurrentTransactions changes, since it does not
+ * sample anything while the parameter is off.
+ */
+Status onUpdateWiredTigerAdaptiveConcurrentTransactions(const bool& newValue);
+
 }  // namespace mongo
@@ -196,8 +196,17 @@ mongo::BSONArray MockRemoteDBServer::query(MockRemoteDBServer::InstanceID id,
 
     auto ns = nsOrUuid.uuid() ? _uuidToNs[*nsOrUuid.uuid()] : nsOrUuid.nss()->ns();
     const vector<BSONObj>& coll = _dataMgr[ns];
+    const auto min = query.obj["$min"];
+    const auto max = query.obj["$max"];
+    auto compareToBound = [](const BSONObj& doc, const BSONObj& bound) {
+        return doc.extractFieldsUndotted(bound).woCompare(bound, BSONObj(), false);
+    };
     BSONArrayBuilder result;
     for (vector<BSONObj>::const_iterator iter = coll.begin(); iter != coll.end(); ++iter) {
+        if ((min.isABSONObj() && compareToBound(*iter, min.Obj()) < 0) ||
+            (max.isABSONObj() && compareToBound(*iter, max.Obj()) >= 0)) {
+            continue;
+        }
         result.append(iter->copy());
     }
 
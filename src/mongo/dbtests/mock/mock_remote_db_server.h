@@ -161,6 +161,11 @@ public:
     //
     rpc::UniqueReply runCommand(InstanceID id, const OpMsgRequest& request);
 
+    /**
+     * Returns the documents of the collection in insertion order. The filter is ignored, but the
+     * $min (inclusive) and $max (exclusive) bounds of the query are applied to the fields they
+     * name.
+     */
     mongo::BSONArray query(InstanceID id,
                            const NamespaceStringOrUUID& nsOrUuid,
                            mongo::Query query = mongo::Query(),
@@ -273,6 +273,55 @@ TEST_F(QueryStageMultiPlanTest, MPSCollectionScanVsHighlySelectiveIXScan) {
     ASSERT_EQUALS(results, N / 10);
 }
 
+// Once a plan has been chosen, the MPS can be worked a batch at a time through the winner,
+// starting with the results buffered during the trial period.
+TEST_F(QueryStageMultiPlanTest, MPSPassesBatchesThroughToTheBestPlan) {
+    const int N = 5000;
+    for (int i = 0; i < N; ++i) {
+        insert(BSON("foo" << (i % 10)));
+    }
+
+    addIndex(BSON("foo" << 1));
+
+    AutoGetCollectionForReadCommand ctx(_opCtx.get(), nss);
+    const Collection* coll = ctx.getCollection();
+
+    unique_ptr<WorkingSet> sharedWs(new WorkingSet());
+    unique_ptr<PlanStage> ixScanRoot = getIxScanPlan(_expCtx.get(), coll, sharedWs.get(), 7);
+
+    BSONObj filterObj = BSON("foo" << 7);
+    unique_ptr<MatchExpression> filter = makeMatchExpressionFromFilter(_expCtx.get(), filterObj);
+    unique_ptr<PlanStage> collScanRoot =
+        getCollScanPlan(_expCtx.get(), coll, sharedWs.get(), filter.get());
+
+    auto cq = makeCanonicalQuery(_opCtx.get(), nss, filterObj);
+    auto mps = std::make_unique<MultiPlanStage>(_expCtx.get(), coll, cq.get());
+    mps->addPlan(createQuerySolution(), std::move(ixScanRoot), sharedWs.get());
+    mps->addPlan(createQuerySolution(), std::move(collScanRoot), sharedWs.get());
+
+    ASSERT_FALSE(mps->supportsBatchedExecution());
+
+    PlanYieldPolicy yieldPolicy(PlanExecutor::NO_YIELD, _clock);
+    ASSERT_OK(mps->pickBestPlan(&yieldPolicy));
+    ASSERT_EQUALS(0, mps->bestPlanIdx());
+    ASSERT_TRUE(mps->supportsBatchedExecution());
+
+    int results = 0;
+    PlanStage::StageState state;
+    WorkingSetIDBatch batch;
+    while ((state = mps->workBatch(64, &batch)) != PlanStage::IS_EOF) {
+        ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+        ASSERT_LTE(batch.size(), 64U);
+        for (auto id : batch) {
+            ASSERT_EQUALS(sharedWs->get(id)->doc.value()["foo"].getInt(), 7);
+            sharedWs->free(id);
+            ++results;
+        }
+        batch.clear();
+    }
+    ASSERT_EQUALS(results, N / 10);
+}
+
 TEST_F(QueryStageMultiPlanTest, MPSDoesNotCreateActiveCacheEntryImmediately) {
     const int N = 100;
     for (int i = 0; i < N; ++i) {
@@ -33,6 +33,7 @@
 
 #include "mongo/executor/connection_pool.h"
 
+#include <absl/hash/hash.h>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
@@ -241,7 +242,7 @@ public:
     auto guardCallback(Callback&& cb) {
         return
             [this, cb = std::forward<Callback>(cb), anchor = shared_from_this()](auto&&... args) {
-                stdx::lock_guard lk(_parent->_mutex);
+                stdx::lock_guard lk(_stripe.mutex);
                 cb(std::forward<decltype(args)>(args)...);
                 updateState();
             };
@@ -390,12 +391,21 @@ private:
     // Update the event timer for this host pool
     void updateEventTimer();
 
-    // Update the controller and potentially change the controls
-    void updateController();
+    // Update the controller and potentially change the controls. Returns the hosts of the group
+    // of this host which belong to other stripes, for which updateHostGroupMember() must be called
+    // once the lock of this stripe is released.
+    HostGroupState updateController();
+
+    // Shut down the pool for a host of the group of this host, or make sure it exists, as directed
+    // by the controller. The lock of the stripe of that host must be held.
+    void updateHostGroupMember(const HostAndPort& host, bool canShutdown);
 
 private:
     const std::shared_ptr<ConnectionPool> _parent;
 
+    // The stripe of _parent this pool belongs to, whose mutex guards this pool
+    Stripe& _stripe;
+
     const transport::ConnectSSLMode _sslMode;
     const HostAndPort _hostAndPort;
 
@@ -458,6 +468,11 @@ ConnectionPool::ConnectionPool(std::shared_ptr<DependentTypeFactoryInterface> im
       _options(std::move(options)),
       _controller(_options.controllerFactory()),
       _manager(options.egressTagCloserManager) {
+    invariant(_options.stripes > 0);
+    for (size_t i = 0; i < _options.stripes; ++i) {
+        _stripes.push_back(std::make_unique<Stripe>());
+    }
+
     if (_manager) {
         _manager->add(this);
     }
@@ -476,28 +491,39 @@ ConnectionPool::~ConnectionPool() {
     shutdown();
 }
 
+auto ConnectionPool::_getStripe(const HostAndPort& hostAndPort) const -> Stripe& {
+    if (_stripes.size() == 1) {
+        return *_stripes.front();
+    }
+
+    return *_stripes[absl::Hash<HostAndPort>{}(hostAndPort) % _stripes.size()];
+}
+
 void ConnectionPool::shutdown() {
     _factory->shutdown();
 
-    // Grab all current pools (under the lock)
-    auto pools = [&] {
-        stdx::lock_guard lk(_mutex);
-        return _pools;
-    }();
-
-    for (const auto& pair : pools) {
-        stdx::lock_guard lk(_mutex);
-        pair.second->triggerShutdown(
-            Status(ErrorCodes::ShutdownInProgress, "Shutting down the connection pool"));
+    for (const auto& stripe : _stripes) {
+        // Grab all current pools (under the lock)
+        auto pools = [&] {
+            stdx::lock_guard lk(stripe->mutex);
+            return stripe->pools;
+        }();
+
+        for (const auto& pair : pools) {
+            stdx::lock_guard lk(stripe->mutex);
+            pair.second->triggerShutdown(
+                Status(ErrorCodes::ShutdownInProgress, "Shutting down the connection pool"));
+        }
     }
 }
 
 void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
-    stdx::lock_guard lk(_mutex);
+    auto& stripe = _getStripe(hostAndPort);
+    stdx::lock_guard lk(stripe.mutex);
 
-    auto iter = _pools.find(hostAndPort);
+    auto iter = stripe.pools.find(hostAndPort);
 
-    if (iter == _pools.end())
+    if (iter == stripe.pools.end())
         return;
 
     auto& pool = iter->second;
@@ -506,27 +532,32 @@ void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
 }
 
 void ConnectionPool::dropConnections(transport::Session::TagMask tags) {
-    stdx::lock_guard lk(_mutex);
+    for (const auto& stripe : _stripes) {
+        stdx::lock_guard lk(stripe->mutex);
 
-    for (const auto& pair : _pools) {
-        auto& pool = pair.second;
+        // Shutting down a pool removes it from the stripe, so iterate over a copy
+        auto pools = stripe->pools;
+        for (const auto& pair : pools) {
+            auto& pool = pair.second;
 
-        if (pool->matchesTags(tags))
-            continue;
+            if (pool->matchesTags(tags))
+                continue;
 
-        pool->triggerShutdown(
-            Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"));
+            pool->triggerShutdown(
+                Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"));
+        }
     }
 }
 
 void ConnectionPool::mutateTags(
     const HostAndPort& hostAndPort,
     const std::function<transport::Session::TagMask(transport::Session::TagMask)>& mutateFunc) {
-    stdx::lock_guard lk(_mutex);
+    auto& stripe = _getStripe(hostAndPort);
+    stdx::lock_guard lk(stripe.mutex);
 
-    auto iter = _pools.find(hostAndPort);
+    auto iter = stripe.pools.find(hostAndPort);
 
-    if (iter == _pools.end())
+    if (iter == stripe.pools.end())
         return;
 
     auto pool = iter->second;
@@ -548,9 +579,10 @@ void ConnectionPool::get_forTest(const HostAndPort& hostAndPort,
 SemiFuture<ConnectionPool::ConnectionHandle> ConnectionPool::get(const HostAndPort& hostAndPort,
                                                                  transport::ConnectSSLMode sslMode,
                                                                  Milliseconds timeout) {
-    stdx::lock_guard lk(_mutex);
+    auto& stripe = _getStripe(hostAndPort);
+    stdx::lock_guard lk(stripe.mutex);
 
-    auto& pool = _pools[hostAndPort];
+    auto& pool = stripe.pools[hostAndPort];
     if (!pool) {
         pool = SpecificPool::make(shared_from_this(), hostAndPort, sslMode);
     } else {
@@ -566,24 +598,32 @@ SemiFuture<ConnectionPool::ConnectionHandle> ConnectionPool::get(const HostAndPo
 }
 
 void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
-    stdx::lock_guard lk(_mutex);
-
-    for (const auto& kv : _pools) {
-        HostAndPort host = kv.first;
-
-        auto& pool = kv.second;
-        ConnectionStatsPer hostStats{pool->inUseConnections(),
-                                     pool->availableConnections(),
-                                     pool->createdConnections(),
-                                     pool->refreshingConnections()};
-        stats->updateStatsForHost(_name, host, hostStats);
+    for (size_t i = 0; i < _stripes.size(); ++i) {
+        const auto& stripe = *_stripes[i];
+        stdx::lock_guard lk(stripe.mutex);
+
+        for (const auto& kv : stripe.pools) {
+            HostAndPort host = kv.first;
+
+            auto& pool = kv.second;
+            ConnectionStatsPer hostStats{pool->inUseConnections(),
+                                         pool->availableConnections(),
+                                         pool->createdConnections(),
+                                         pool->refreshingConnections()};
+            stats->updateStatsForHost(_name, host, hostStats);
+
+            if (_stripes.size() > 1) {
+                stats->updateStatsForStripe(_name, i, _stripes.size(), hostStats);
+            }
+        }
     }
 }
 
 size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort) const {
-    stdx::lock_guard lk(_mutex);
-    auto iter = _pools.find(hostAndPort);
-    if (iter != _pools.end()) {
+    auto& stripe = _getStripe(hostAndPort);
+    stdx::lock_guard lk(stripe.mutex);
+    auto iter = stripe.pools.find(hostAndPort);
+    if (iter != stripe.pools.end()) {
         return iter->second->openConnections();
     }
 
@@ -594,9 +634,10 @@ ConnectionPool::SpecificPool::SpecificPool(std::shared_ptr<ConnectionPool> paren
                                            const HostAndPort& hostAndPort,
                                            transport::ConnectSSLMode sslMode)
     : _parent(std::move(parent)),
+      _stripe(_parent->_getStripe(hostAndPort)),
       _sslMode(sslMode),
       _hostAndPort(hostAndPort),
-      _id(_parent->_nextPoolId++),
+      _id(_parent->_nextPoolId.fetchAndAdd(1)),
       _readyPool(std::numeric_limits<size_t>::max()) {
     invariant(_parent);
     _eventTimer = _parent->_factory->makeTimer();
@@ -678,7 +719,7 @@ Future<ConnectionPool::ConnectionHandle> ConnectionPool::SpecificPool::getConnec
 
 auto ConnectionPool::SpecificPool::makeHandle(ConnectionInterface* connection) -> ConnectionHandle {
     auto deleter = [this, anchor = shared_from_this()](ConnectionInterface* connection) {
-        stdx::lock_guard lk(_parent->_mutex);
+        stdx::lock_guard lk(_stripe.mutex);
         returnConnection(connection);
         _lastActiveTime = _parent->_factory->now();
         updateState();
@@ -902,7 +943,7 @@ void ConnectionPool::SpecificPool::triggerShutdown(const Status& status) {
     // it could be only in the map of pools
     auto anchor = shared_from_this();
     _parent->_controller->removeHost(_id);
-    _parent->_pools.erase(_hostAndPort);
+    _stripe.pools.erase(_hostAndPort);
 
     processFailure(status);
 
@@ -1145,9 +1186,9 @@ void ConnectionPool::SpecificPool::updateEventTimer() {
     _eventTimer->setTimeout(timeout, std::move(deferredStateUpdateFunc));
 }
 
-void ConnectionPool::SpecificPool::updateController() {
+auto ConnectionPool::SpecificPool::updateController() -> HostGroupState {
     if (_health.isShutdown) {
-        return;
+        return {};
     }
 
     auto& controller = *_parent->_controller;
@@ -1168,52 +1209,68 @@ void ConnectionPool::SpecificPool::updateController() {
                 "poolState"_attr = state);
     auto hostGroup = controller.updateHost(_id, std::move(state));
 
-    // If we can shutdown, then do so
-    if (hostGroup.canShutdown) {
-        for (const auto& host : hostGroup.hosts) {
-            auto it = _parent->_pools.find(host);
-            if (it == _parent->_pools.end()) {
-                continue;
-            }
+    // Hosts in other stripes can only be updated once our own lock is released
+    std::vector<HostAndPort> otherStripeHosts;
+    for (const auto& host : hostGroup.hosts) {
+        if (&_parent->_getStripe(host) != &_stripe) {
+            otherStripeHosts.push_back(host);
+            continue;
+        }
 
-            auto& pool = it->second;
-            if (!pool->_health.isExpired) {
-                // Just because a HostGroup "canShutdown" doesn't mean that a SpecificPool should
-                // shutdown. For example, it is always inappropriate to shutdown a SpecificPool with
-                // connections in use or requests outstanding unless its parent ConnectionPool is
-                // also shutting down.
-                LOGV2_WARNING(4293001,
-                              "Controller requested shutdown but connections still in use, "
-                              "connection pool will stay active.",
-                              "hostAndPort"_attr = pool->_hostAndPort);
-                continue;
-            }
+        updateHostGroupMember(host, hostGroup.canShutdown);
+    }
+
+    if (!hostGroup.canShutdown) {
+        spawnConnections();
+    }
 
-            // At the moment, controllers will never mark for shutdown a pool with active
-            // connections or pending requests. isExpired is never true if these invariants are
-            // false. That's not to say that it's a terrible idea, but if this happens then we
-            // should review what it means to be expired.
+    hostGroup.hosts = std::move(otherStripeHosts);
+    return hostGroup;
+}
 
-            if (shouldInvariantOnPoolCorrectness()) {
-                invariant(pool->_checkedOutPool.empty());
-                invariant(pool->_requests.empty());
-            }
+void ConnectionPool::SpecificPool::updateHostGroupMember(const HostAndPort& host,
+                                                         bool canShutdown) {
+    auto& pools = _parent->_getStripe(host).pools;
 
-            pool->triggerShutdown(Status(ErrorCodes::ShutdownInProgress,
-                                         str::stream() << "Pool for " << host << " has expired."));
+    // If we can shutdown, then do so
+    if (canShutdown) {
+        auto it = pools.find(host);
+        if (it == pools.end()) {
+            return;
+        }
+
+        auto& pool = it->second;
+        if (!pool->_health.isExpired) {
+            // Just because a HostGroup "canShutdown" doesn't mean that a SpecificPool should
+            // shutdown. For example, it is always inappropriate to shutdown a SpecificPool with
+            // connections in use or requests outstanding unless its parent ConnectionPool is
+            // also shutting down.
+            LOGV2_WARNING(4293001,
+                          "Controller requested shutdown but connections still in use, "
+                          "connection pool will stay active.",
+                          "hostAndPort"_attr = pool->_hostAndPort);
+            return;
         }
-        return;
-    }
 
+        // At the moment, controllers will never mark for shutdown a pool with active
+        // connections or pending requests. isExpired is never true if these invariants are
+        // false. That's not to say that it's a terrible idea, but if this happens then we
+        // should review what it means to be expired.
 
-    // Make sure all related hosts exist
-    for (const auto& host : hostGroup.hosts) {
-        if (auto& pool = _parent->_pools[host]; !pool) {
-            pool = SpecificPool::make(_parent, host, _sslMode);
+        if (shouldInvariantOnPoolCorrectness()) {
+            invariant(pool->_checkedOutPool.empty());
+            invariant(pool->_requests.empty());
         }
+
+        pool->triggerShutdown(Status(ErrorCodes::ShutdownInProgress,
+                                     str::stream() << "Pool for " << host << " has expired."));
+        return;
     }
 
-    spawnConnections();
+    // Make sure all related hosts exist
+    if (auto& pool = pools[host]; !pool) {
+        pool = SpecificPool::make(_parent, host, _sslMode);
+    }
 }
 
 // Updates our state and manages the request timer
@@ -1239,9 +1296,16 @@ void ConnectionPool::SpecificPool::updateState() {
         .getAsync([this, anchor = shared_from_this()](Status&& status) mutable {
             invariant(status);
 
-            stdx::lock_guard lk(_parent->_mutex);
-            _updateScheduled = false;
-            updateController();
+            auto hostGroup = [&] {
+                stdx::lock_guard lk(_stripe.mutex);
+                _updateScheduled = false;
+                return updateController();
+            }();
+
+            for (const auto& host : hostGroup.hosts) {
+                stdx::lock_guard lk(_parent->_getStripe(host).mutex);
+                updateHostGroupMember(host, hostGroup.canShutdown);
+            }
         });
 }
 
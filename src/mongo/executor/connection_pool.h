@@ -32,9 +32,11 @@
 #include <functional>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "mongo/executor/egress_tag_closer.h"
 #include "mongo/executor/egress_tag_closer_manager.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/transport/session.h"
@@ -84,6 +86,7 @@ public:
     static constexpr size_t kDefaultMaxConns = std::numeric_limits<size_t>::max();
     static constexpr size_t kDefaultMinConns = 1;
     static constexpr size_t kDefaultMaxConnecting = 2;
+    static constexpr size_t kDefaultStripes = 1;
     static constexpr Milliseconds kDefaultHostTimeout = Minutes(5);
     static constexpr Milliseconds kDefaultRefreshRequirement = Minutes(1);
     static constexpr Milliseconds kDefaultRefreshTimeout = Seconds(20);
@@ -150,6 +153,13 @@ public:
          */
         bool skipAuthentication = false;
 
+        /**
+         * The number of stripes across which the hosts of this pool are partitioned. Each stripe
+         * has its own mutex, so getting and returning connections to hosts in different stripes
+         * does not contend. A host always belongs to the same stripe.
+         */
+        size_t stripes = kDefaultStripes;
+
         std::function<std::shared_ptr<ControllerInterface>(void)> controllerFactory =
             &ConnectionPool::makeLimitController;
     };
@@ -254,6 +264,20 @@ public:
     size_t getNumConnectionsPerHost(const HostAndPort& hostAndPort) const;
 
 private:
+    /**
+     * A partition of the hosts of this pool, along with the mutex guarding their specific pools
+     */
+    struct Stripe {
+        mutable Mutex mutex =
+            MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(1), "ExecutorConnectionPool::_mutex");
+        stdx::unordered_map<HostAndPort, std::shared_ptr<SpecificPool>> pools;
+    };
+
+    /**
+     * Returns the stripe to which the specific pool for "hostAndPort" belongs
+     */
+    Stripe& _getStripe(const HostAndPort& hostAndPort) const;
+
     std::string _name;
 
     const std::shared_ptr<DependentTypeFactoryInterface> _factory;
@@ -261,11 +285,10 @@ private:
 
     std::shared_ptr<ControllerInterface> _controller;
 
-    // The global mutex for specific pool access and the generation counter
-    mutable Mutex _mutex =
-        MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(1), "ExecutorConnectionPool::_mutex");
-    PoolId _nextPoolId = 0;
-    stdx::unordered_map<HostAndPort, std::shared_ptr<SpecificPool>> _pools;
+    AtomicWord<PoolId> _nextPoolId{0};
+
+    // The stripes are never added or removed after construction
+    std::vector<std::unique_ptr<Stripe>> _stripes;
 
     EgressTagCloserManager* _manager;
 };
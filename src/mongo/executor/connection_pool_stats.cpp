@@ -76,6 +76,21 @@ void ConnectionPoolStats::updateStatsForHost(std::string pool,
     totalRefreshing += newStats.refreshing;
 }
 
+void ConnectionPoolStats::updateStatsForStripe(std::string pool,
+                                               size_t stripe,
+                                               size_t numStripes,
+                                               ConnectionStatsPer newStats) {
+    if (newStats.created == 0) {
+        return;
+    }
+
+    auto& byStripe = statsByPool[pool].statsByStripe;
+    if (byStripe.size() < numStripes) {
+        byStripe.resize(numStripes);
+    }
+    byStripe[stripe] += newStats;
+}
+
 void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result, bool forFTDC) {
     result.appendNumber("totalInUse", totalInUse);
     result.appendNumber("totalAvailable", totalAvailable);
@@ -107,6 +122,17 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result, bool forFT
             poolInfo.appendNumber("poolCreated", poolStats.created);
             poolInfo.appendNumber("poolRefreshing", poolStats.refreshing);
 
+            if (!poolStats.statsByStripe.empty()) {
+                BSONArrayBuilder stripesBuilder(poolInfo.subarrayStart("poolStripes"));
+                for (const auto& stripeStats : poolStats.statsByStripe) {
+                    BSONObjBuilder stripeInfo(stripesBuilder.subobjStart());
+                    stripeInfo.appendNumber("inUse", stripeStats.inUse);
+                    stripeInfo.appendNumber("available", stripeStats.available);
+                    stripeInfo.appendNumber("created", stripeStats.created);
+                    stripeInfo.appendNumber("refreshing", stripeStats.refreshing);
+                }
+            }
+
             for (const auto& host : poolStats.statsByHost) {
                 BSONObjBuilder hostInfo(poolInfo.subobjStart(host.first.toString()));
                 auto& hostStats = host.second;
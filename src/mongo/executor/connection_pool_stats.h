@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/net/hostandport.h"
 
@@ -60,6 +62,15 @@ struct ConnectionStatsPer {
 struct ConnectionPoolStats {
     void updateStatsForHost(std::string pool, HostAndPort host, ConnectionStatsPer newStats);
 
+    /**
+     * Pools which partition their hosts across several stripes additionally report the stats of
+     * each host under its stripe, out of "numStripes". These do not count towards the totals.
+     */
+    void updateStatsForStripe(std::string pool,
+                              size_t stripe,
+                              size_t numStripes,
+                              ConnectionStatsPer newStats);
+
     void appendToBSON(mongo::BSONObjBuilder& result, bool forFTDC = false);
 
     size_t totalInUse = 0u;
@@ -71,6 +82,7 @@ struct ConnectionPoolStats {
 
     struct PoolStats final : public ConnectionStatsPer {
         StatsByHost statsByHost;
+        std::vector<ConnectionStatsPer> statsByStripe;
     };
     using StatsByPool = std::map<std::string, PoolStats>;
 
@@ -41,6 +41,7 @@
 #include <fmt/ostream.h>
 
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/scopeguard.h"
@@ -1441,6 +1442,64 @@ TEST_F(ConnectionPoolTest, DropConnectionsInMultipleViaManager) {
     dropConnectionsTest(pool, &manager);
 }
 
+TEST_F(ConnectionPoolTest, DropConnectionsWithStripes) {
+    ConnectionPool::Options options;
+    options.minConnections = 0;
+    options.stripes = 4;
+    auto pool = makePool(options);
+
+    dropConnectionsTest(pool, pool);
+}
+
+/**
+ * Verify that a striped pool reports the connections to each host under the stripe of that host.
+ */
+TEST_F(ConnectionPoolTest, StatsByStripe) {
+    ConnectionPool::Options options;
+    options.minConnections = 0;
+    options.stripes = 4;
+    auto pool = makePool(options);
+
+    constexpr size_t kNumHosts = 16;
+    std::vector<ConnectionPool::ConnectionHandle> conns;
+    for (size_t i = 0; i < kNumHosts; ++i) {
+        ConnectionImpl::pushSetup(Status::OK());
+        pool->get_forTest(HostAndPort("localhost", 30000 + i),
+                          Milliseconds(5000),
+                          [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                              ASSERT(swConn.isOK());
+                              conns.push_back(std::move(swConn.getValue()));
+                          });
+    }
+    ASSERT_EQ(conns.size(), kNumHosts);
+
+    // Return half of the connections
+    for (size_t i = 0; i < kNumHosts / 2; ++i) {
+        doneWith(conns[i]);
+    }
+
+    ConnectionPoolStats stats;
+    pool->appendConnectionStats(&stats);
+    ASSERT_EQ(stats.totalCreated, kNumHosts);
+    ASSERT_EQ(stats.totalInUse, kNumHosts / 2);
+    ASSERT_EQ(stats.totalAvailable, kNumHosts / 2);
+
+    const auto& byStripe = stats.statsByPool["test pool"].statsByStripe;
+    ASSERT_EQ(byStripe.size(), options.stripes);
+
+    ConnectionStatsPer stripeTotals;
+    for (const auto& stripeStats : byStripe) {
+        stripeTotals += stripeStats;
+    }
+    ASSERT_EQ(stripeTotals.created, kNumHosts);
+    ASSERT_EQ(stripeTotals.inUse, kNumHosts / 2);
+    ASSERT_EQ(stripeTotals.available, kNumHosts / 2);
+
+    for (size_t i = kNumHosts / 2; i < kNumHosts; ++i) {
+        doneWith(conns[i]);
+    }
+}
+
 TEST_F(ConnectionPoolTest, AsyncGet) {
     ConnectionPool::Options options;
     options.maxConnections = 1;
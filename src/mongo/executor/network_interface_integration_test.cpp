@@ -42,6 +42,7 @@
 #include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/network_connection_hook.h"
 #include "mongo/executor/network_interface_integration_fixture.h"
+#include "mongo/executor/network_interface_tl_gen.h"
 #include "mongo/executor/test_network_connection_hook.h"
 #include "mongo/rpc/factory.h"
 #include "mongo/rpc/get_status_from_command_result.h"
@@ -188,6 +189,12 @@ public:
                            << "bar");
     }
 
+    BSONObj makeFindCmdObj() {
+        return BSON("find"
+                    << "coalesce"
+                    << "singleBatch" << true);
+    }
+
     BSONObj makeSleepCmdObj() {
         return BSON("sleep" << 1 << "lock"
                             << "none"
@@ -327,6 +334,92 @@ TEST_F(NetworkInterfaceTest, CancelLocally) {
     assertNumOps(1u, 0u, 0u, 0u);
 }
 
+TEST_F(NetworkInterfaceTest, CoalesceIdenticalCommands) {
+    auto originalCoalesce = gCoalesceIdenticalCommands.load();
+    gCoalesceIdenticalCommands.store(true);
+    ON_BLOCK_EXIT([&] { gCoalesceIdenticalCommands.store(originalCoalesce); });
+
+    const size_t numFollowers = 4;
+    auto canceledCbh = makeCallbackHandle();
+
+    auto [leader, followers, canceled] = [&] {
+        // Hold the first command after it acquires its connection so that the others join it
+        FailPointEnableBlock fpb("networkInterfaceHangCommandsAfterAcquireConn");
+
+        auto leader = runCommand(makeCallbackHandle(), makeTestCommand(kMaxWait, makeFindCmdObj()));
+
+        waitForIsMaster();
+
+        fpb->waitForTimesEntered(fpb.initialTimesEntered() + 1);
+
+        std::vector<Future<RemoteCommandResponse>> followers;
+        for (size_t i = 0; i < numFollowers; ++i) {
+            followers.push_back(
+                runCommand(makeCallbackHandle(), makeTestCommand(kMaxWait, makeFindCmdObj())));
+        }
+
+        auto canceled = runCommand(canceledCbh, makeTestCommand(kMaxWait, makeFindCmdObj()));
+        net().cancelCommand(canceledCbh);
+
+        return std::make_tuple(std::move(leader), std::move(followers), std::move(canceled));
+    }();
+
+    auto leaderResult = leader.get();
+    uassertStatusOK(leaderResult.status);
+    ASSERT_EQ(1, leaderResult.data.getIntField("ok"));
+
+    for (auto& follower : followers) {
+        auto result = follower.get();
+        uassertStatusOK(result.status);
+        ASSERT_BSONOBJ_EQ(leaderResult.data, result.data);
+    }
+
+    ASSERT_EQ(ErrorCodes::CallbackCanceled, canceled.get().status);
+
+    // Only the first command went over the network
+    ASSERT_EQ(net().getCounters().sent, 1);
+    assertNumOps(1u, 0u, 0u, 1u + numFollowers);
+}
+
+TEST_F(NetworkInterfaceTest, DoNotCoalesceCommandsWithSideEffects) {
+    auto originalCoalesce = gCoalesceIdenticalCommands.load();
+    gCoalesceIdenticalCommands.store(true);
+    ON_BLOCK_EXIT([&] { gCoalesceIdenticalCommands.store(originalCoalesce); });
+
+    const size_t numCommands = 3;
+    const auto insertCmdObj = BSON("insert"
+                                   << "coalesce"
+                                   << "documents" << BSON_ARRAY(BSON("x" << 1)));
+
+    auto results = [&] {
+        FailPointEnableBlock fpb("networkInterfaceHangCommandsAfterAcquireConn");
+
+        std::vector<Future<RemoteCommandResponse>> results;
+        results.push_back(
+            runCommand(makeCallbackHandle(), makeTestCommand(kMaxWait, insertCmdObj)));
+
+        waitForIsMaster();
+
+        fpb->waitForTimesEntered(fpb.initialTimesEntered() + 1);
+
+        for (size_t i = 1; i < numCommands; ++i) {
+            results.push_back(
+                runCommand(makeCallbackHandle(), makeTestCommand(kMaxWait, insertCmdObj)));
+        }
+        return results;
+    }();
+
+    // Every insert is sent and applied on its own
+    for (auto& result : results) {
+        auto response = result.get();
+        uassertStatusOK(response.status);
+        ASSERT_EQ(1, response.data.getIntField("n"));
+    }
+
+    ASSERT_EQ(net().getCounters().sent, numCommands);
+    assertNumOps(0u, 0u, 0u, numCommands);
+}
+
 TEST_F(NetworkInterfaceTest, CancelRemotely) {
     // Enable blockConnection for "echo".
     assertCommandOK("admin",
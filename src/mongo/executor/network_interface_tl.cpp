@@ -37,6 +37,7 @@
 #include "mongo/db/server_options.h"
 #include "mongo/executor/connection_pool_tl.h"
 #include "mongo/executor/hedging_metrics.h"
+#include "mongo/executor/network_interface_tl_gen.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/transport/transport_layer_manager.h"
@@ -48,6 +49,54 @@ namespace executor {
 
 namespace {
 static inline const std::string kMaxTimeMSOpOnlyField = "maxTimeMSOpOnly";
+
+/**
+ * Returns true if "cmdObj" is on the list of reads without side effects whose response may be
+ * given to several identical commands: find, count, distinct and aggregate without $out or $merge.
+ * This covers the reads of sharding metadata from the config servers. Commands in a session are
+ * excluded, since they read and update the session's state.
+ */
+bool isCoalescableCommand(const BSONObj& cmdObj) {
+    if (cmdObj.hasField("lsid") || cmdObj.hasField("txnNumber")) {
+        return false;
+    }
+
+    const auto commandName = cmdObj.firstElementFieldNameStringData();
+    if (commandName == "find"_sd || commandName == "count"_sd || commandName == "distinct"_sd) {
+        return true;
+    }
+
+    if (commandName != "aggregate"_sd) {
+        return false;
+    }
+
+    const auto pipeline = cmdObj["pipeline"];
+    if (pipeline.type() != Array) {
+        return false;
+    }
+    for (const auto& stage : pipeline.Obj()) {
+        if (stage.type() != Object) {
+            return false;
+        }
+        const auto stageName = stage.Obj().firstElementFieldNameStringData();
+        if (stageName == "$out"_sd || stageName == "$merge"_sd) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns true if "response" leaves a cursor open on the remote host. Only one command can iterate
+ * a cursor, so such a response can't be shared.
+ */
+bool hasOpenCursor(const RemoteCommandOnAnyResponse& response) {
+    if (!response.isOK()) {
+        return false;
+    }
+    const auto cursor = response.data["cursor"];
+    return cursor.type() == Object && cursor.Obj()["id"].safeNumberLong() != 0;
+}
 }  // unnamed namespace
 
 /**
@@ -400,6 +449,11 @@ void NetworkInterfaceTL::CommandStateBase::tryFinish(Status status) noexcept {
         interface->_inProgress.erase(cbHandle);
     }
 
+    if (coalesced) {
+        // If the response wasn't passed on already, the commands waiting for it send their own
+        interface->_finishCoalescedCommand(coalesced, boost::none);
+    }
+
     if (operationKey && requestManager) {
         // Kill operations for requests that we didn't use to fulfill the promise.
         requestManager->killOperationsForPendingRequests();
@@ -476,11 +530,6 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
     cmdState->baton = baton;
     cmdState->requestManager = std::make_unique<RequestManager>(cmdState->hedgeCount, cmdState);
 
-    std::vector<std::shared_ptr<NetworkInterfaceTL::RequestState>> requestStates;
-    for (size_t i = 0; i < cmdState->hedgeCount; i++) {
-        requestStates.emplace_back(cmdState->requestManager->makeRequest());
-    }
-
     if (_svcCtx && cmdState->requestOnAny.hedgeOptions) {
         auto hm = HedgingMetrics::get(_svcCtx);
         invariant(hm);
@@ -536,7 +585,26 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
         return Status::OK();
     }
 
+    if (_joinCoalescedCommand(cmdState)) {
+        return Status::OK();
+    }
+
+    _sendCommand(std::move(cmdState), targetHostsInAlphabeticalOrder);
+
+    return Status::OK();
+} catch (const DBException& ex) {
+    return ex.toStatus();
+}
+
+void NetworkInterfaceTL::_sendCommand(std::shared_ptr<CommandState> cmdState,
+                                      bool targetHostsInOrder) {
     RequestManager* rm = cmdState->requestManager.get();
+    const auto& request = cmdState->requestOnAny;
+
+    std::vector<std::shared_ptr<NetworkInterfaceTL::RequestState>> requestStates;
+    for (size_t i = 0; i < cmdState->hedgeCount; i++) {
+        requestStates.emplace_back(rm->makeRequest());
+    }
 
     // Attempt to get a connection to every target host
     for (size_t idx = 0; idx < request.target.size() && !rm->usedAllConn(); ++idx) {
@@ -544,7 +612,7 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
 
         // If connection future is ready or requests should be sent in order, send the request
         // immediately.
-        if (connFuture.isReady() || targetHostsInAlphabeticalOrder) {
+        if (connFuture.isReady() || targetHostsInOrder) {
             rm->trySend(std::move(connFuture).getNoThrow(), idx);
             continue;
         }
@@ -554,10 +622,118 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
             rm->trySend(std::move(swConn), idx);
         });
     }
+}
 
-    return Status::OK();
-} catch (const DBException& ex) {
-    return ex.toStatus();
+bool NetworkInterfaceTL::_joinCoalescedCommand(const std::shared_ptr<CommandState>& cmdState) {
+    const auto& request = cmdState->requestOnAny;
+
+    // Only plain reads to a single host can share a response, and only if each can still be sent
+    // on its own should the one whose response it waits for fail locally
+    if (!gCoalesceIdenticalCommands.load() || request.target.size() != 1 ||
+        request.hedgeOptions || request.operationKey ||
+        request.fireAndForgetMode == RemoteCommandRequest::FireAndForgetMode::kOn ||
+        request.timeout == Milliseconds(0) || !isCoalescableCommand(request.cmdObj)) {
+        return false;
+    }
+
+    std::string key = request.target.front().toString();
+    key.push_back('\0');
+    key.append(std::to_string(request.sslMode));
+    key.push_back('\0');
+    key.append(request.dbname);
+    key.push_back('\0');
+    key.append(request.cmdObj.objdata(), request.cmdObj.objsize());
+    key.append(request.metadata.objdata(), request.metadata.objsize());
+
+    {
+        stdx::lock_guard lk(_coalescedCommandsMutex);
+        auto& coalesced = _coalescedCommands[key];
+        if (!coalesced) {
+            coalesced = std::make_shared<CoalescedCommand>(std::move(key));
+            cmdState->coalesced = coalesced;
+            return false;
+        }
+
+        coalesced->followers.push_back(cmdState);
+    }
+
+    LOGV2_DEBUG(5097138,
+                kDiagnosticLogLevel,
+                "Command waits for the response to an identical command",
+                "requestId"_attr = request.id,
+                "target"_attr = request.target.front());
+
+    // The command no longer acquires a connection, which is where its timeout would otherwise
+    // start to be enforced
+    try {
+        cmdState->setTimer();
+    } catch (const DBException& ex) {
+        if (cmdState->finishLine.arriveStrongly()) {
+            ExecutorFuture<void>(_reactor, ex.toStatus())
+                .getAsync([cmdState](Status status) {
+                    cmdState->fulfillFinalPromise(std::move(status));
+                });
+        }
+    }
+
+    return true;
+}
+
+void NetworkInterfaceTL::_closeCoalescedCommand(
+    const std::shared_ptr<CoalescedCommand>& coalesced) {
+    stdx::lock_guard lk(_coalescedCommandsMutex);
+    auto it = _coalescedCommands.find(coalesced->key);
+    if (it != _coalescedCommands.end() && it->second == coalesced) {
+        _coalescedCommands.erase(it);
+    }
+}
+
+void NetworkInterfaceTL::_finishCoalescedCommand(
+    const std::shared_ptr<CoalescedCommand>& coalesced,
+    boost::optional<RemoteCommandOnAnyResponse> response) {
+    std::vector<std::weak_ptr<CommandState>> followers;
+    {
+        stdx::lock_guard lk(_coalescedCommandsMutex);
+        if (std::exchange(coalesced->finished, true)) {
+            return;
+        }
+
+        auto it = _coalescedCommands.find(coalesced->key);
+        if (it != _coalescedCommands.end() && it->second == coalesced) {
+            _coalescedCommands.erase(it);
+        }
+        followers = std::move(coalesced->followers);
+    }
+
+    if (response && hasOpenCursor(*response)) {
+        response = boost::none;
+    }
+
+    for (const auto& weakFollower : followers) {
+        auto follower = weakFollower.lock();
+        if (!follower || follower->finishLine.isReady()) {
+            // The command was canceled or timed out
+            continue;
+        }
+
+        if (!response) {
+            try {
+                _sendCommand(follower, false);
+            } catch (const DBException& ex) {
+                if (follower->finishLine.arriveStrongly()) {
+                    ExecutorFuture<void>(_reactor, ex.toStatus())
+                        .getAsync([follower](Status status) {
+                            follower->fulfillFinalPromise(std::move(status));
+                        });
+                }
+            }
+            continue;
+        }
+
+        if (follower->finishLine.arriveStrongly()) {
+            follower->fulfillFinalPromise(*response);
+        }
+    }
 }
 
 void NetworkInterfaceTL::testEgress(const HostAndPort& hostAndPort,
@@ -583,6 +759,11 @@ Future<RemoteCommandResponse> NetworkInterfaceTL::CommandState::sendRequest(size
            })
         .then([this, requestState](RemoteCommandResponse response) {
             doMetadataHook(RemoteCommandOnAnyResponse(requestState->host, response));
+
+            if (coalesced) {
+                interface->_finishCoalescedCommand(
+                    coalesced, RemoteCommandOnAnyResponse(requestState->host, response));
+            }
             return response;
         });
 }
@@ -804,6 +985,10 @@ void NetworkInterfaceTL::RequestState::send(StatusWith<ConnectionPool::Connectio
 
     networkInterfaceHangCommandsAfterAcquireConn.pauseWhileSet();
 
+    if (cmdState->coalesced) {
+        interface()->_closeCoalescedCommand(cmdState->coalesced);
+    }
+
     LOGV2_DEBUG(4630601,
                 2,
                 "Request acquired a connection",
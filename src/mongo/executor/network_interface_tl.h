@@ -104,6 +104,22 @@ public:
 private:
     struct RequestState;
     struct RequestManager;
+    struct CommandState;
+
+    /**
+     * A command which is sent on behalf of the requests of several identical commands to the same
+     * host. Commands which arrive while it is waiting for a connection wait for its response
+     * instead of sending their own request.
+     */
+    struct CoalescedCommand {
+        explicit CoalescedCommand(std::string key_) : key(std::move(key_)) {}
+
+        const std::string key;
+
+        // Guarded by _coalescedCommandsMutex
+        std::vector<std::weak_ptr<CommandState>> followers;
+        bool finished = false;
+    };
 
     struct CommandStateBase : public std::enable_shared_from_this<CommandStateBase> {
         CommandStateBase(NetworkInterfaceTL* interface_,
@@ -164,6 +180,9 @@ private:
         StrongWeakFinishLine finishLine;
 
         boost::optional<UUID> operationKey;
+
+        // Set if other identical commands may wait for the response to this one
+        std::shared_ptr<CoalescedCommand> coalesced;
     };
 
     struct CommandState final : public CommandStateBase {
@@ -341,6 +360,33 @@ private:
 
     Status _killOperation(std::shared_ptr<RequestState> requestStateToKill);
 
+    /**
+     * Acquires connections to the targets of the command and sends its requests.
+     */
+    void _sendCommand(std::shared_ptr<CommandState> cmdState, bool targetHostsInOrder);
+
+    /**
+     * Makes the command wait for the response to an identical command which is waiting for a
+     * connection, if coalescing is enabled and there is one, and returns true. Otherwise, if the
+     * command is eligible for coalescing, lets later identical commands wait for its response.
+     * Only reads without side effects are eligible.
+     */
+    bool _joinCoalescedCommand(const std::shared_ptr<CommandState>& cmdState);
+
+    /**
+     * Stops commands from waiting for the response to the coalesced command once its request is
+     * about to be sent, so that none of them gets a response which may predate it.
+     */
+    void _closeCoalescedCommand(const std::shared_ptr<CoalescedCommand>& coalesced);
+
+    /**
+     * Gives "response" to the commands waiting for the coalesced command. Without a response, the
+     * coalesced command failed locally and each of the commands waiting for it is sent on its own.
+     * The same happens if the response left a cursor open, since the cursor can't be shared.
+     */
+    void _finishCoalescedCommand(const std::shared_ptr<CoalescedCommand>& coalesced,
+                                 boost::optional<RemoteCommandOnAnyResponse> response);
+
     std::string _instanceName;
     ServiceContext* _svcCtx = nullptr;
     transport::TransportLayer* _tl = nullptr;
@@ -373,6 +419,10 @@ private:
         MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "NetworkInterfaceTL::_inProgressMutex");
     stdx::unordered_map<TaskExecutor::CallbackHandle, std::weak_ptr<CommandStateBase>> _inProgress;
 
+    Mutex _coalescedCommandsMutex = MONGO_MAKE_LATCH(
+        HierarchicalAcquisitionLevel(0), "NetworkInterfaceTL::_coalescedCommandsMutex");
+    stdx::unordered_map<std::string, std::shared_ptr<CoalescedCommand>> _coalescedCommands;
+
     bool _inProgressAlarmsInShutdown = false;
     stdx::unordered_map<TaskExecutor::CallbackHandle, std::shared_ptr<AlarmState>>
         _inProgressAlarms;
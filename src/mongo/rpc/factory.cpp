@@ -72,7 +72,7 @@ std::unique_ptr<ReplyInterface> makeReply(const Message* unownedMessage) {
 OpMsgRequest opMsgRequestFromAnyProtocol(const Message& unownedMessage) {
     switch (unownedMessage.operation()) {
         case mongo::dbMsg:
-            return OpMsgRequest::parseOwned(unownedMessage);
+            return OpMsgRequest::parseOwnedBody(unownedMessage);
         case mongo::dbQuery:
             return opMsgRequestFromLegacyRequest(unownedMessage);
         default:
@@ -63,6 +63,10 @@ inline Message messageFromOpMsgRequest(ProtocolSet clientProtos,
 
 /**
  * Parses the message (from any protocol) into an OpMsgRequest.
+ *
+ * The documents of OP_MSG document sequences are unowned views into the message, which the body
+ * of the returned request keeps alive. Callers that hold on to them past the lifetime of the
+ * request must call getOwned().
  */
 OpMsgRequest opMsgRequestFromAnyProtocol(const Message& unownedMessage);
 
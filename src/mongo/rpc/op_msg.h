@@ -118,6 +118,18 @@ struct OpMsg {
         return msg;
     }
 
+    /**
+     * Like parseOwned(), but only the body takes a reference on the message buffer. The documents
+     * of the sequences are left as unowned views into the message, just like the sub-objects of
+     * the body, and stay valid for as long as the message or the body is alive. This saves a
+     * reference count update per document when parsing large batched writes.
+     */
+    static OpMsg parseOwnedBody(const Message& message) {
+        auto msg = parse(message);
+        msg.body.shareOwnershipWith(message.sharedBuffer());
+        return msg;
+    }
+
     Message serialize() const;
 
     /**
@@ -164,6 +176,10 @@ struct OpMsgRequest : public OpMsg {
         return OpMsgRequest(OpMsg::parseOwned(message));
     }
 
+    static OpMsgRequest parseOwnedBody(const Message& message) {
+        return OpMsgRequest(OpMsg::parseOwnedBody(message));
+    }
+
     static OpMsgRequest fromDBAndBody(StringData db,
                                       BSONObj body,
                                       const BSONObj& extraFields = {}) {
@@ -219,6 +219,42 @@ TEST_F(OpMsgParser, SucceedsWithBodyThenSequence) {
     ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[1], fromjson("{a: 2}"));
 }
 
+TEST_F(OpMsgParser, ParseOwnedBodyLeavesSequencesAsViewsIntoTheMessage) {
+    OpMsg msg;
+    const char* messageStart;
+    const char* messageEnd;
+    {
+        auto message = OpMsgBytes{
+            kNoFlags,  //
+            kBodySection,
+            fromjson("{insert: 'coll'}"),
+
+            kDocSequenceSection,
+            Sized{
+                "documents",  //
+                fromjson("{a: 1}"),
+                fromjson("{a: 2}"),
+            },
+        }
+                           .done();
+        messageStart = message.buf();
+        messageEnd = messageStart + message.size();
+        msg = OpMsg::parseOwnedBody(message);
+    }
+
+    ASSERT(msg.body.isOwned());
+    ASSERT_EQ(msg.sequences.size(), 1u);
+    ASSERT_EQ(msg.sequences[0].objs.size(), 2u);
+    for (auto&& obj : msg.sequences[0].objs) {
+        ASSERT_FALSE(obj.isOwned());
+        ASSERT(obj.objdata() > messageStart && obj.objdata() < messageEnd);
+    }
+
+    // The body keeps the message alive after the message itself has gone away.
+    ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[0], fromjson("{a: 1}"));
+    ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[1], fromjson("{a: 2}"));
+}
+
 TEST_F(OpMsgParser, SucceedsWithSequenceThenBody) {
     auto msg =
         OpMsgBytes{
@@ -81,13 +81,14 @@ std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering orde
 
 ShardVersionMap ChunkMap::constructShardVersionMap(const OID& epoch) const {
     ShardVersionMap shardVersions;
-    ChunkInfoMap::const_iterator current = _chunkMap.cbegin();
+    auto current = _begin();
 
     boost::optional<BSONObj> firstMin = boost::none;
     boost::optional<BSONObj> lastMax = boost::none;
+    const ChunkInfo* lastChunk = nullptr;
 
-    while (current != _chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
+    while (current != _end()) {
+        const auto& firstChunkInRange = _at(current);
         const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
 
         // Tracks the max shard version for the shard on which the current range will reside
@@ -98,60 +99,48 @@ ShardVersionMap ChunkMap::constructShardVersionMap(const OID& epoch) const {
 
         auto& maxShardVersion = shardVersionIt->second.shardVersion;
 
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId,
-                          &maxShardVersion](const ChunkInfoMap::value_type& chunkMapEntry) {
-                             const auto& currentChunk = chunkMapEntry.second;
+        const ChunkInfo* rangeLast = nullptr;
+        for (; current != _end(); _advance(&current)) {
+            const auto& currentChunk = _at(current);
 
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
+            if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
+                break;
 
-                             if (currentChunk->getLastmod() > maxShardVersion)
-                                 maxShardVersion = currentChunk->getLastmod();
+            if (currentChunk->getLastmod() > maxShardVersion)
+                maxShardVersion = currentChunk->getLastmod();
 
-                             return false;
-                         });
-
-        const auto rangeLast = std::prev(current);
+            rangeLast = currentChunk.get();
+        }
 
         const auto& rangeMin = firstChunkInRange->getMin();
-        const auto& rangeMax = rangeLast->second->getMax();
+        const auto& rangeMax = rangeLast->getMax();
 
         // Check the continuity of the chunks map
         if (lastMax && !SimpleBSONObjComparator::kInstance.evaluate(*lastMax == rangeMin)) {
             if (SimpleBSONObjComparator::kInstance.evaluate(*lastMax < rangeMin))
                 uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Gap exists in the routing table between chunks "
-                              << _chunkMap
-                                     .at(extractKeyStringInternal(*lastMax, _shardKeyOrdering))
-                                     ->getRange()
-                                     .toString()
-                              << " and " << rangeLast->second->getRange().toString());
+                          str::stream() << "Gap exists in the routing table between chunks "
+                                        << lastChunk->getRange().toString() << " and "
+                                        << rangeLast->getRange().toString());
             else
                 uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Overlap exists in the routing table between chunks "
-                              << _chunkMap
-                                     .at(extractKeyStringInternal(*lastMax, _shardKeyOrdering))
-                                     ->getRange()
-                                     .toString()
-                              << " and " << rangeLast->second->getRange().toString());
+                          str::stream() << "Overlap exists in the routing table between chunks "
+                                        << lastChunk->getRange().toString() << " and "
+                                        << rangeLast->getRange().toString());
         }
 
         if (!firstMin)
             firstMin = rangeMin;
 
         lastMax = rangeMax;
+        lastChunk = rangeLast;
 
         // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
         // somewhere, which should have been caught at chunk load time
         invariant(maxShardVersion.isSet());
     }
 
-    if (!_chunkMap.empty()) {
+    if (_size > 0) {
         invariant(!shardVersions.empty());
         invariant(firstMin.is_initialized());
         invariant(lastMax.is_initialized());
@@ -163,72 +152,356 @@ ShardVersionMap ChunkMap::constructShardVersionMap(const OID& epoch) const {
     return shardVersions;
 }
 
-void ChunkMap::addChunk(const ChunkType& chunk) {
-    const auto chunkMinKeyString = extractKeyStringInternal(chunk.getMin(), _shardKeyOrdering);
-    const auto chunkMaxKeyString = extractKeyStringInternal(chunk.getMax(), _shardKeyOrdering);
+ShardVersionMap ChunkMap::updateShardVersionMap(const ChunkMap& previous,
+                                                const ShardVersionMap& previousShardVersions,
+                                                const std::vector<ChunkType>& changedChunks,
+                                                const OID& epoch) const {
+    if (previous.size() == 0 || _size == 0) {
+        return constructShardVersionMap(epoch);
+    }
+
+    // The max version of the chunks which now cover the changed ranges, per shard
+    std::map<ShardId, ChunkVersion> changedShardVersions;
+
+    // Shards which lost a chunk whose version is their shard version
+    std::set<ShardId> shardsWhichLostMaxVersion;
 
-    // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-    // min
-    const auto low = _chunkMap.upper_bound(chunkMinKeyString);
+    for (const auto& chunk : changedChunks) {
+        previous.forEachOverlappingChunk(
+            chunk.getMin(), chunk.getMax(), false, [&](const auto& replacedChunk) {
+                const auto& shardId = replacedChunk->getShardIdAt(boost::none);
+                const auto it = previousShardVersions.find(shardId);
+                invariant(it != previousShardVersions.end());
+
+                if (replacedChunk->getLastmod() == it->second.shardVersion)
+                    shardsWhichLostMaxVersion.insert(shardId);
+                return true;
+            });
+
+        auto [first, last] = _overlappingBounds(chunk.getMin(), chunk.getMax(), false);
+        for (auto pos = first; pos != last; _advance(&pos)) {
+            const auto& currentChunk = _at(pos);
+            auto it = changedShardVersions.emplace(currentChunk->getShardIdAt(boost::none),
+                                                   currentChunk->getLastmod())
+                          .first;
+            if (currentChunk->getLastmod() > it->second)
+                it->second = currentChunk->getLastmod();
+        }
+
+        // Check the continuity of the chunks map around the changed range, including the chunks
+        // on either side of it
+        if (first != _begin())
+            _retreat(&first);
+        if (last != _end())
+            _advance(&last);
+
+        for (auto pos = first, next = first; pos != last; pos = next) {
+            _advance(&next);
+            if (next == last)
+                break;
+
+            const auto& left = _at(pos);
+            const auto& right = _at(next);
+            if (SimpleBSONObjComparator::kInstance.evaluate(left->getMax() == right->getMin()))
+                continue;
+
+            uasserted(ErrorCodes::ConflictingOperationInProgress,
+                      str::stream()
+                          << (SimpleBSONObjComparator::kInstance.evaluate(left->getMax() <
+                                                                          right->getMin())
+                                  ? "Gap"
+                                  : "Overlap")
+                          << " exists in the routing table between chunks "
+                          << left->getRange().toString() << " and "
+                          << right->getRange().toString());
+        }
+    }
 
-    // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-    // not overlap max
-    const auto high = _chunkMap.upper_bound(chunkMaxKeyString);
+    checkAllElementsAreOfType(MinKey, _at(_begin())->getMin());
+    checkAllElementsAreOfType(MaxKey, _blocks.back()->chunks.back()->getMax());
 
-    // If we are in the middle of splitting a chunk, for the first few
-    // chunks inserted, low == high, because both lookups will point to the
-    // same chunk (the one being split). If we're inserting the last chunk
-    // for the current chunk being split, low will point to the chunk that
-    // we're splitting, and high will point to the next chunk past the one
-    // we're splitting (which could be chunkMap.end()). In this case,
-    // std::distance(low, high) == 1. Lastly, this does not apply during
-    // the creation of the original routing table, in which case the map is
-    // empty and the first chunk that is inserted will find that low ==
-    // high, but low == chunkMap.end(), and we aren't doing a split in that
-    // case.
-    auto foundSingleChunk =
-        ((low == high || std::distance(low, high) == 1) && low != _chunkMap.end());
+    // A shard which lost the chunk carrying its shard version still has it, unless it received a
+    // chunk at least as new. Otherwise its shard version can only be found by a full scan.
+    for (const auto& shardId : shardsWhichLostMaxVersion) {
+        const auto it = changedShardVersions.find(shardId);
+        if (it == changedShardVersions.end() ||
+            it->second < previousShardVersions.at(shardId).shardVersion) {
+            return constructShardVersionMap(epoch);
+        }
+    }
 
-    auto newChunk = std::make_shared<ChunkInfo>(chunk);
-    if (foundSingleChunk) {
-        auto chunkBeingReplacedBySplit = low->second;
-        auto bytesInReplacedChunk =
-            chunkBeingReplacedBySplit->getWritesTracker()->getBytesWritten();
-        newChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
+    ShardVersionMap shardVersions;
+    for (const auto& [shardId, targetingInfo] : previousShardVersions) {
+        shardVersions.emplace(shardId, epoch).first->second.shardVersion =
+            targetingInfo.shardVersion;
     }
 
-    // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-    _chunkMap.erase(low, high);
+    for (const auto& [shardId, changedShardVersion] : changedShardVersions) {
+        auto& shardVersion = shardVersions.emplace(shardId, epoch).first->second.shardVersion;
+        if (changedShardVersion > shardVersion)
+            shardVersion = changedShardVersion;
+    }
 
-    // Insert only the chunk itself
-    _chunkMap.insert(std::make_pair(chunkMaxKeyString, newChunk));
+    return shardVersions;
+}
+
+ChunkMap ChunkMap::createMerged(const std::vector<ChunkType>& changedChunks) const {
+    if (changedChunks.empty()) {
+        return *this;
+    }
+
+    // First apply the changes amongst themselves, keyed by the KeyString of each chunk's max,
+    // keeping track of the range of max keys each change replaces in this map. Chunks are
+    // replaced in the same way as when they are applied one at a time.
+    std::map<std::string, std::shared_ptr<ChunkInfo>> updates;
+    std::vector<std::pair<std::string, std::string>> replacedRanges;
+
+    for (const auto& chunk : changedChunks) {
+        auto chunkMinKeyString = extractKeyStringInternal(chunk.getMin(), _shardKeyOrdering);
+        auto chunkMaxKeyString = extractKeyStringInternal(chunk.getMax(), _shardKeyOrdering);
+
+        // If we are in the middle of splitting a chunk, the new chunk lies within the chunk being
+        // split, which is either one of the earlier changes or still in this map. The new chunk
+        // inherits its write statistics.
+        auto newChunk = std::make_shared<ChunkInfo>(chunk);
+        const auto containsNewChunk = [&](const std::shared_ptr<ChunkInfo>& other) {
+            return extractKeyStringInternal(other->getMin(), _shardKeyOrdering) <=
+                chunkMinKeyString &&
+                chunkMaxKeyString <=
+                extractKeyStringInternal(other->getMax(), _shardKeyOrdering);
+        };
+
+        std::shared_ptr<ChunkInfo> chunkBeingReplacedBySplit;
+        const auto updatesIt = updates.upper_bound(chunkMinKeyString);
+        if (updatesIt != updates.end() && containsNewChunk(updatesIt->second)) {
+            chunkBeingReplacedBySplit = updatesIt->second;
+        } else if (const auto pos = _upperBound(chunkMinKeyString);
+                   pos != _end() && containsNewChunk(_at(pos))) {
+            chunkBeingReplacedBySplit = _at(pos);
+        }
+
+        if (chunkBeingReplacedBySplit) {
+            newChunk->getWritesTracker()->addBytesWritten(
+                chunkBeingReplacedBySplit->getWritesTracker()->getBytesWritten());
+        }
+
+        // Erase all chunks which overlap the chunk we got from the persistent store and insert
+        // only the chunk itself
+        updates.erase(updates.upper_bound(chunkMinKeyString),
+                      updates.upper_bound(chunkMaxKeyString));
+        updates.emplace(chunkMaxKeyString, std::move(newChunk));
+
+        replacedRanges.emplace_back(std::move(chunkMinKeyString), std::move(chunkMaxKeyString));
+    }
+
+    // Coalesce the replaced ranges, each of which covers the max keys in (min, max].
+    std::sort(replacedRanges.begin(), replacedRanges.end());
+    std::vector<std::pair<std::string, std::string>> replaced;
+    for (auto& range : replacedRanges) {
+        if (!replaced.empty() && range.first <= replaced.back().second) {
+            replaced.back().second = std::max(replaced.back().second, range.second);
+        } else {
+            replaced.push_back(std::move(range));
+        }
+    }
+
+    // Mark the blocks whose chunks may be replaced, or among which the changes will be inserted.
+    std::vector<bool> affected(_blocks.size());
+    if (!_blocks.empty()) {
+        for (const auto& range : replaced) {
+            const size_t first = std::min<size_t>(
+                std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), range.first) -
+                    _blockMaxKeys.begin(),
+                _blocks.size() - 1);
+            const size_t last = std::min<size_t>(
+                std::lower_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), range.second) -
+                    _blockMaxKeys.begin(),
+                _blocks.size() - 1);
+            std::fill(affected.begin() + first, affected.begin() + last + 1, true);
+        }
+    }
+
+    auto replacedIt = replaced.cbegin();
+    const auto isReplaced = [&](StringData keyString) {
+        // Keys are checked in increasing order, so skip ranges which end before this one.
+        while (replacedIt != replaced.cend() && StringData(replacedIt->second) < keyString) {
+            ++replacedIt;
+        }
+        return replacedIt != replaced.cend() && StringData(replacedIt->first) < keyString;
+    };
+
+    ChunkMap merged(_shardKeyOrdering);
+    auto updatesIt = updates.cbegin();
+    std::vector<Entry> entries;
+
+    for (size_t block = 0; block < _blocks.size(); ++block) {
+        if (!affected[block]) {
+            merged._appendBlock(_blocks[block], _blockMaxKeys[block]);
+            continue;
+        }
+
+        // Rebuild each run of consecutive affected blocks, merging in the changes which sort
+        // within it. Changes which sort after the last block belong to the last run.
+        size_t runEnd = block;
+        while (runEnd < _blocks.size() && affected[runEnd]) {
+            ++runEnd;
+        }
+
+        entries.clear();
+        for (; block < runEnd; ++block) {
+            const auto& current = *_blocks[block];
+            for (size_t i = 0; i < current.size(); ++i) {
+                const auto keyString = current.maxKeyString(i);
+                for (; updatesIt != updates.cend() && StringData(updatesIt->first) < keyString;
+                     ++updatesIt) {
+                    entries.emplace_back(updatesIt->first, updatesIt->second);
+                }
+
+                if (!isReplaced(keyString)) {
+                    entries.emplace_back(keyString, current.chunks[i]);
+                }
+            }
+        }
+
+        const StringData runMaxKeyString = _blockMaxKeys[runEnd - 1];
+        for (; updatesIt != updates.cend() &&
+             (runEnd == _blocks.size() || StringData(updatesIt->first) <= runMaxKeyString);
+             ++updatesIt) {
+            entries.emplace_back(updatesIt->first, updatesIt->second);
+        }
+
+        merged._appendEntries(entries);
+        block = runEnd - 1;
+    }
+
+    // If this map was empty, the changes make up the whole new map.
+    if (_blocks.empty()) {
+        for (; updatesIt != updates.cend(); ++updatesIt) {
+            entries.emplace_back(updatesIt->first, updatesIt->second);
+        }
+        merged._appendEntries(entries);
+    }
+
+    invariant(updatesIt == updates.cend());
+    return merged;
+}
+
+void ChunkMap::_appendBlock(std::shared_ptr<const Block> block, const std::string& maxKeyString) {
+    _size += block->size();
+    _blocks.push_back(std::move(block));
+    _blockMaxKeys.push_back(maxKeyString);
+}
+
+void ChunkMap::_appendEntries(const std::vector<Entry>& entries) {
+    const size_t numBlocks = (entries.size() + kMaxChunksPerBlock - 1) / kMaxChunksPerBlock;
+
+    size_t begin = 0;
+    for (size_t i = 1; i <= numBlocks; ++i) {
+        const size_t end = entries.size() * i / numBlocks;
+
+        auto block = std::make_shared<Block>();
+        block->keyEnds.reserve(end - begin);
+        block->chunks.reserve(end - begin);
+        for (size_t j = begin; j < end; ++j) {
+            block->keys.append(entries[j].first.rawData(), entries[j].first.size());
+            block->keyEnds.push_back(block->keys.size());
+            block->chunks.push_back(entries[j].second);
+        }
+
+        _appendBlock(std::move(block), entries[end - 1].first.toString());
+        begin = end;
+    }
 }
 
 std::shared_ptr<ChunkInfo> ChunkMap::findIntersectingChunk(const BSONObj& shardKey) const {
-    const auto it = _findIntersectingChunk(shardKey);
+    const auto pos = _findIntersectingChunk(shardKey);
 
-    if (it != _chunkMap.end())
-        return it->second;
+    if (pos != _end())
+        return _at(pos);
 
     return std::shared_ptr<ChunkInfo>();
 }
 
-ChunkMap::ChunkInfoMap::const_iterator ChunkMap::_findIntersectingChunk(
-    const BSONObj& shardKey) const {
-    return _chunkMap.upper_bound(extractKeyStringInternal(shardKey, _shardKeyOrdering));
+size_t ChunkMap::getApproximateMemoryUsage() const {
+    size_t size = sizeof(ChunkMap) +
+        _blocks.capacity() * sizeof(decltype(_blocks)::value_type) +
+        _blockMaxKeys.capacity() * sizeof(decltype(_blockMaxKeys)::value_type);
+    for (size_t i = 0; i < _blocks.size(); ++i) {
+        const auto& block = *_blocks[i];
+        size += sizeof(Block) + block.keys.capacity() +
+            block.keyEnds.capacity() * sizeof(uint32_t) +
+            block.chunks.capacity() * sizeof(std::shared_ptr<ChunkInfo>) +
+            _blockMaxKeys[i].capacity();
+    }
+    return size;
+}
+
+ChunkMap::Position ChunkMap::_upperBound(StringData keyString) const {
+    const auto blockIt = std::upper_bound(
+        _blockMaxKeys.begin(),
+        _blockMaxKeys.end(),
+        keyString,
+        [](StringData key, const std::string& blockMax) { return key < StringData(blockMax); });
+    if (blockIt == _blockMaxKeys.end()) {
+        return _end();
+    }
+
+    // The block's last chunk sorts after 'keyString', so the result is within this block.
+    const size_t block = blockIt - _blockMaxKeys.begin();
+    const auto& current = *_blocks[block];
+    size_t low = 0, high = current.size() - 1;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (keyString < current.maxKeyString(mid)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return {block, low};
 }
 
-std::pair<ChunkMap::ChunkInfoMap::const_iterator, ChunkMap::ChunkInfoMap::const_iterator>
-ChunkMap::_overlappingBounds(const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
-    const auto itMin = _chunkMap.upper_bound(extractKeyStringInternal(min, _shardKeyOrdering));
-    const auto itMax = [&]() {
-        auto it = isMaxInclusive
-            ? _chunkMap.upper_bound(extractKeyStringInternal(max, _shardKeyOrdering))
-            : _chunkMap.lower_bound(extractKeyStringInternal(max, _shardKeyOrdering));
-        return it == _chunkMap.end() ? it : ++it;
+ChunkMap::Position ChunkMap::_lowerBound(StringData keyString) const {
+    const auto blockIt = std::lower_bound(
+        _blockMaxKeys.begin(),
+        _blockMaxKeys.end(),
+        keyString,
+        [](const std::string& blockMax, StringData key) { return StringData(blockMax) < key; });
+    if (blockIt == _blockMaxKeys.end()) {
+        return _end();
+    }
+
+    const size_t block = blockIt - _blockMaxKeys.begin();
+    const auto& current = *_blocks[block];
+    size_t low = 0, high = current.size() - 1;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (current.maxKeyString(mid) < keyString) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return {block, low};
+}
+
+ChunkMap::Position ChunkMap::_findIntersectingChunk(const BSONObj& shardKey) const {
+    return _upperBound(extractKeyStringInternal(shardKey, _shardKeyOrdering));
+}
+
+std::pair<ChunkMap::Position, ChunkMap::Position> ChunkMap::_overlappingBounds(
+    const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
+    const auto posMin = _upperBound(extractKeyStringInternal(min, _shardKeyOrdering));
+    const auto posMax = [&]() {
+        auto pos = isMaxInclusive ? _upperBound(extractKeyStringInternal(max, _shardKeyOrdering))
+                                  : _lowerBound(extractKeyStringInternal(max, _shardKeyOrdering));
+        if (pos != _end()) {
+            _advance(&pos);
+        }
+        return pos;
     }();
 
-    return {itMin, itMax};
+    return {posMin, posMax};
 }
 
 ShardVersionTargetingInfo::ShardVersionTargetingInfo(const OID& epoch)
@@ -240,7 +513,8 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
                                          std::unique_ptr<CollatorInterface> defaultCollator,
                                          bool unique,
                                          ChunkMap chunkMap,
-                                         ChunkVersion collectionVersion)
+                                         ChunkVersion collectionVersion,
+                                         ShardVersionMap shardVersions)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
       _uuid(uuid),
@@ -249,7 +523,7 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
       _collectionVersion(collectionVersion),
-      _shardVersions(_chunkMap.constructShardVersionMap(collectionVersion.epoch())) {}
+      _shardVersions(std::move(shardVersions)) {}
 
 void RoutingTableHistory::setShardStale(const ShardId& shardId) {
     if (gEnableFinerGrainedCatalogCacheRefresh) {
@@ -644,7 +918,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
                                std::move(defaultCollator),
                                std::move(unique),
                                {std::move(ordering)},
-                               {0, 0, epoch})
+                               {0, 0, epoch},
+                               {})
         .makeUpdated(chunks);
 }
 
@@ -652,7 +927,6 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -668,8 +942,6 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         // Chunks must always come in increasing sorted order
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
-
-        chunkMap.addChunk(chunk);
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -683,6 +955,10 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         return shared_from_this();
     }
 
+    auto chunkMap = _chunkMap.createMerged(changedChunks);
+    auto shardVersions = chunkMap.updateShardVersionMap(
+        _chunkMap, _shardVersions, changedChunks, collectionVersion.epoch());
+
     return std::shared_ptr<RoutingTableHistory>(
         new RoutingTableHistory(_nss,
                                 _uuid,
@@ -690,7 +966,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
                                 CollatorInterface::cloneCollator(getDefaultCollator()),
                                 isUnique(),
                                 std::move(chunkMap),
-                                collectionVersion));
+                                collectionVersion,
+                                std::move(shardVersions)));
 }
 
 }  // namespace mongo
@@ -67,23 +67,62 @@ using ShardVersionMap = std::map<ShardId, ShardVersionTargetingInfo>;
 // This class serves as a Facade around how the mapping of ranges to chunks is represented. It also
 // provides a simpler, high-level interface for domain specific operations without exposing the
 // underlying implementation.
+//
+// Chunks are kept sorted by the KeyString of their max key, in a two-level structure similar to a
+// B+-tree with a single level of inner nodes: a sorted array of immutable blocks of up to
+// kMaxChunksPerBlock chunks each, with the max KeyStrings of each block's chunks packed into one
+// contiguous buffer. A lookup binary searches the array of block boundaries and then one block,
+// which touches far fewer cache lines than walking the nodes of a std::map with hundreds of
+// thousands of entries. Blocks are shared between a ChunkMap and the maps created from it by
+// createMerged(), so an incremental refresh only copies the blocks that contain changed chunks.
 class ChunkMap {
-    // Ordered map from the max for each chunk to an entry describing the chunk
-    using ChunkInfoMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
+    // A block of consecutive chunks. Never modified once it has been added to a ChunkMap.
+    struct Block {
+        size_t size() const {
+            return chunks.size();
+        }
+
+        StringData maxKeyString(size_t i) const {
+            const size_t begin = i ? keyEnds[i - 1] : 0;
+            return StringData(keys.data() + begin, keyEnds[i] - begin);
+        }
+
+        // The max KeyStrings of 'chunks', concatenated, and the offset at which each one ends.
+        std::string keys;
+        std::vector<uint32_t> keyEnds;
+        std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    };
+
+    // A position in the map, as a block and an index within that block. The end position is
+    // {_blocks.size(), 0}.
+    struct Position {
+        bool operator==(const Position& other) const {
+            return block == other.block && index == other.index;
+        }
+        bool operator!=(const Position& other) const {
+            return !(*this == other);
+        }
+
+        size_t block;
+        size_t index;
+    };
 
 public:
+    // Blocks are split once they grow beyond this many chunks.
+    static constexpr size_t kMaxChunksPerBlock = 256;
+
     ChunkMap(Ordering ordering) : _shardKeyOrdering(std::move(ordering)) {}
 
     size_t size() const {
-        return _chunkMap.size();
+        return _size;
     }
 
     template <typename Callable>
     void forEach(Callable&& handler, const BSONObj& shardKey = BSONObj()) const {
-        auto it = shardKey.isEmpty() ? _chunkMap.begin() : _findIntersectingChunk(shardKey);
+        auto pos = shardKey.isEmpty() ? _begin() : _findIntersectingChunk(shardKey);
 
-        for (; it != _chunkMap.end(); ++it) {
-            if (!handler(it->second))
+        for (; pos != _end(); _advance(&pos)) {
+            if (!handler(_at(pos)))
                 break;
         }
     }
@@ -95,23 +134,97 @@ public:
                                  Callable&& handler) const {
         const auto bounds = _overlappingBounds(min, max, isMaxInclusive);
 
-        for (auto it = bounds.first; it != bounds.second; ++it) {
-            if (!handler(it->second))
+        for (auto pos = bounds.first; pos != bounds.second; _advance(&pos)) {
+            if (!handler(_at(pos)))
                 break;
         }
     }
 
     ShardVersionMap constructShardVersionMap(const OID& epoch) const;
-    void addChunk(const ChunkType& chunk);
+
+    /**
+     * Returns the ShardVersionMap of this map, given that it was created by merging
+     * "changedChunks" into "previous" whose ShardVersionMap is "previousShardVersions". Only the
+     * chunks around the changed ranges are visited and validated, unless a shard lost the chunk
+     * which carried its shard version without receiving a newer one, in which case the whole map
+     * is scanned.
+     */
+    ShardVersionMap updateShardVersionMap(const ChunkMap& previous,
+                                          const ShardVersionMap& previousShardVersions,
+                                          const std::vector<ChunkType>& changedChunks,
+                                          const OID& epoch) const;
+
+    /**
+     * Returns a new map with the chunks in "changedChunks" applied in order. Each changed chunk
+     * replaces all chunks in this map, or earlier in "changedChunks", whose max key falls within
+     * its range. Blocks which don't contain any replaced chunks are shared with this map.
+     */
+    ChunkMap createMerged(const std::vector<ChunkType>& changedChunks) const;
+
     std::shared_ptr<ChunkInfo> findIntersectingChunk(const BSONObj& shardKey) const;
 
+    /**
+     * Returns the approximate number of bytes used by the map itself, not counting the ChunkInfo
+     * objects it refers to.
+     */
+    size_t getApproximateMemoryUsage() const;
+
 private:
-    ChunkInfoMap::const_iterator _findIntersectingChunk(const BSONObj& shardKey) const;
-    std::pair<ChunkInfoMap::const_iterator, ChunkInfoMap::const_iterator> _overlappingBounds(
-        const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
+    using Entry = std::pair<StringData, std::shared_ptr<ChunkInfo>>;
+
+    Position _begin() const {
+        return {0, 0};
+    }
+
+    Position _end() const {
+        return {_blocks.size(), 0};
+    }
 
-    ChunkInfoMap _chunkMap;
-    const Ordering _shardKeyOrdering;
+    void _advance(Position* pos) const {
+        if (++pos->index == _blocks[pos->block]->size()) {
+            ++pos->block;
+            pos->index = 0;
+        }
+    }
+
+    void _retreat(Position* pos) const {
+        if (pos->index-- == 0) {
+            pos->index = _blocks[--pos->block]->size() - 1;
+        }
+    }
+
+    const std::shared_ptr<ChunkInfo>& _at(const Position& pos) const {
+        return _blocks[pos.block]->chunks[pos.index];
+    }
+
+    /**
+     * Returns the position of the first chunk whose max KeyString is greater than (upper bound) or
+     * not less than (lower bound) "keyString".
+     */
+    Position _upperBound(StringData keyString) const;
+    Position _lowerBound(StringData keyString) const;
+
+    Position _findIntersectingChunk(const BSONObj& shardKey) const;
+    std::pair<Position, Position> _overlappingBounds(const BSONObj& min,
+                                                     const BSONObj& max,
+                                                     bool isMaxInclusive) const;
+
+    void _appendBlock(std::shared_ptr<const Block> block, const std::string& maxKeyString);
+
+    /**
+     * Appends "entries", which must sort after every chunk already in the map, as new blocks of
+     * evenly distributed size.
+     */
+    void _appendEntries(const std::vector<Entry>& entries);
+
+    std::vector<std::shared_ptr<const Block>> _blocks;
+
+    // The max KeyString of the last chunk in each block, which is the first level of a lookup.
+    std::vector<std::string> _blockMaxKeys;
+
+    size_t _size = 0;
+
+    Ordering _shardKeyOrdering;
 };
 
 /**
@@ -258,12 +371,8 @@ private:
                         std::unique_ptr<CollatorInterface> defaultCollator,
                         bool unique,
                         ChunkMap chunkMap,
-                        ChunkVersion collectionVersion);
-
-    /**
-     * Does a single pass over the chunkMap and constructs the ShardVersionMap object.
-     */
-    ShardVersionMap _constructShardVersionMap() const;
+                        ChunkVersion collectionVersion,
+                        ShardVersionMap shardVersions);
 
     ChunkVersion _getVersion(const ShardId& shardName, bool throwOnStaleShard) const;
 
@@ -295,8 +404,6 @@ private:
 
     // The representation of shard versions and staleness indicators for this namespace. If a
     // shard does not exist, it will not have an entry in the map.
-    // Note: this declaration must not be moved before _chunkMap since it is initialized by using
-    // the _chunkMap instance.
     ShardVersionMap _shardVersions;
 
     friend class ChunkManager;
@@ -122,7 +122,38 @@ void BM_IncrementalRefreshOfPessimalBalancedDistribution(benchmark::State& state
     }
 }
 
-BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)->Args({2, 50000});
+BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)
+    ->Args({2, 50000})
+    ->Args({2, 500000});
+
+void BM_ChunkMapMemoryUsage(benchmark::State& state) {
+    const int nShards = state.range(0);
+    const uint32_t nChunks = state.range(1);
+
+    const auto collEpoch = OID::gen();
+    const auto collName = NamespaceString("test.foo");
+
+    std::vector<ChunkType> chunks;
+    chunks.reserve(nChunks);
+    for (uint32_t i = 0; i < nChunks; ++i) {
+        chunks.emplace_back(collName,
+                            getRangeForChunk(i, nChunks),
+                            ChunkVersion{i + 1, 0, collEpoch},
+                            pessimalShardSelector(i, nShards, nChunks));
+    }
+
+    size_t bytes = 0;
+    for (auto keepRunning : state) {
+        auto chunkMap = ChunkMap(Ordering::make(BSON("_id" << 1))).createMerged(chunks);
+        bytes = chunkMap.getApproximateMemoryUsage();
+        benchmark::DoNotOptimize(chunkMap);
+    }
+
+    state.counters["bytes"] = bytes;
+    state.counters["bytesPerChunk"] = double(bytes) / nChunks;
+}
+
+BENCHMARK(BM_ChunkMapMemoryUsage)->Args({2, 50000})->Args({2, 500000});
 
 template <typename ShardSelectorFn>
 auto BM_FullBuildOfChunkManager(benchmark::State& state, ShardSelectorFn selectShard) {
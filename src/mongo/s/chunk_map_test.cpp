@@ -51,7 +51,7 @@ private:
 
 }  // namespace
 
-TEST_F(ChunkMapTest, TestAddChunk) {
+TEST_F(ChunkMapTest, TestCreateMerged) {
     ChunkMap chunkMap(Ordering::make(getShardKeyPattern().toBSON()));
 
     const OID epoch = OID::gen();
@@ -63,7 +63,7 @@ TEST_F(ChunkMapTest, TestAddChunk) {
                   version,
                   kThisShard};
 
-    chunkMap.addChunk(chunk);
+    chunkMap = chunkMap.createMerged({chunk});
 
     ASSERT_EQ(chunkMap.size(), 1);
 }
@@ -74,14 +74,17 @@ TEST_F(ChunkMapTest, TestEnumerateAllChunks) {
     const OID epoch = OID::gen();
     ChunkVersion version{1, 0, epoch};
 
-    chunkMap.addChunk(ChunkType{
-        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 0)}, version, kThisShard});
+    chunkMap = chunkMap.createMerged({ChunkType{
+        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 0)}, version, kThisShard}});
 
-    chunkMap.addChunk(
-        ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, version, kThisShard});
+    chunkMap = chunkMap.createMerged({
+        ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, version, kThisShard}});
 
-    chunkMap.addChunk(ChunkType{
-        kNss, ChunkRange{BSON("a" << 100), getShardKeyPattern().globalMax()}, version, kThisShard});
+    chunkMap = chunkMap.createMerged(
+        {ChunkType{kNss,
+                   ChunkRange{BSON("a" << 100), getShardKeyPattern().globalMax()},
+                   version,
+                   kThisShard}});
 
     int count = 0;
     auto lastMax = getShardKeyPattern().globalMin();
@@ -103,14 +106,17 @@ TEST_F(ChunkMapTest, TestIntersectingChunk) {
     const OID epoch = OID::gen();
     ChunkVersion version{1, 0, epoch};
 
-    chunkMap.addChunk(ChunkType{
-        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 0)}, version, kThisShard});
+    chunkMap = chunkMap.createMerged({ChunkType{
+        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 0)}, version, kThisShard}});
 
-    chunkMap.addChunk(
-        ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, version, kThisShard});
+    chunkMap = chunkMap.createMerged({
+        ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, version, kThisShard}});
 
-    chunkMap.addChunk(ChunkType{
-        kNss, ChunkRange{BSON("a" << 100), getShardKeyPattern().globalMax()}, version, kThisShard});
+    chunkMap = chunkMap.createMerged(
+        {ChunkType{kNss,
+                   ChunkRange{BSON("a" << 100), getShardKeyPattern().globalMax()},
+                   version,
+                   kThisShard}});
 
     auto intersectingChunk = chunkMap.findIntersectingChunk(BSON("a" << 50));
 
@@ -127,14 +133,17 @@ TEST_F(ChunkMapTest, TestEnumerateOverlappingChunks) {
     const OID epoch = OID::gen();
     ChunkVersion version{1, 0, epoch};
 
-    chunkMap.addChunk(ChunkType{
-        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 0)}, version, kThisShard});
+    chunkMap = chunkMap.createMerged({ChunkType{
+        kNss, ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 0)}, version, kThisShard}});
 
-    chunkMap.addChunk(
-        ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, version, kThisShard});
+    chunkMap = chunkMap.createMerged({
+        ChunkType{kNss, ChunkRange{BSON("a" << 0), BSON("a" << 100)}, version, kThisShard}});
 
-    chunkMap.addChunk(ChunkType{
-        kNss, ChunkRange{BSON("a" << 100), getShardKeyPattern().globalMax()}, version, kThisShard});
+    chunkMap = chunkMap.createMerged(
+        {ChunkType{kNss,
+                   ChunkRange{BSON("a" << 100), getShardKeyPattern().globalMax()},
+                   version,
+                   kThisShard}});
 
     auto min = BSON("a" << -50);
     auto max = BSON("a" << 150);
@@ -148,4 +157,144 @@ TEST_F(ChunkMapTest, TestEnumerateOverlappingChunks) {
     ASSERT_EQ(count, 3);
 }
 
-}  // namespace mongo
\ No newline at end of file
+TEST_F(ChunkMapTest, TestCreateMergedAcrossBlocks) {
+    const OID epoch = OID::gen();
+    ChunkVersion version{1, 0, epoch};
+
+    // Enough chunks to span several blocks: [MinKey, 0), [0, 10), ..., [19980, MaxKey).
+    const int nChunks = 2000;
+    std::vector<ChunkType> chunks;
+    for (int i = 0; i < nChunks; ++i) {
+        const auto min = i == 0 ? getShardKeyPattern().globalMin() : BSON("a" << (i - 1) * 10);
+        const auto max = i == nChunks - 1 ? getShardKeyPattern().globalMax() : BSON("a" << i * 10);
+        chunks.emplace_back(kNss, ChunkRange{min, max}, version, kThisShard);
+        version.incMinor();
+    }
+
+    const auto chunkMap =
+        ChunkMap(Ordering::make(getShardKeyPattern().toBSON())).createMerged(chunks);
+    ASSERT_EQ(chunkMap.size(), nChunks);
+
+    // Split a chunk, merge a range of chunks which crosses a block boundary and move a chunk.
+    const ShardId otherShard("otherShard");
+    version.incMajor();
+    std::vector<ChunkType> changes;
+    changes.emplace_back(kNss, ChunkRange{BSON("a" << 500), BSON("a" << 505)}, version, kThisShard);
+    version.incMinor();
+    changes.emplace_back(kNss, ChunkRange{BSON("a" << 505), BSON("a" << 510)}, version, kThisShard);
+    version.incMajor();
+    changes.emplace_back(
+        kNss, ChunkRange{BSON("a" << 2400), BSON("a" << 2700)}, version, kThisShard);
+    version.incMajor();
+    changes.emplace_back(
+        kNss, ChunkRange{BSON("a" << 10000), BSON("a" << 10010)}, version, otherShard);
+
+    const auto merged = chunkMap.createMerged(changes);
+    ASSERT_EQ(merged.size(), nChunks + 1 - 29);
+
+    // The chunks still cover the whole key space, in order.
+    merged.constructShardVersionMap(epoch);
+    size_t count = 0;
+    merged.forEach([&](const auto& chunk) {
+        ++count;
+        return true;
+    });
+    ASSERT_EQ(count, merged.size());
+
+    const auto assertIntersects = [](const ChunkMap& map, int key, const ChunkRange& expected) {
+        auto chunk = map.findIntersectingChunk(BSON("a" << key));
+        ASSERT(chunk);
+        ASSERT_BSONOBJ_EQ(chunk->getMin(), expected.getMin());
+        ASSERT_BSONOBJ_EQ(chunk->getMax(), expected.getMax());
+    };
+    assertIntersects(merged, 507, ChunkRange{BSON("a" << 505), BSON("a" << 510)});
+    assertIntersects(merged, 2650, ChunkRange{BSON("a" << 2400), BSON("a" << 2700)});
+    assertIntersects(merged, 2700, ChunkRange{BSON("a" << 2700), BSON("a" << 2710)});
+    assertIntersects(
+        merged, 19999, ChunkRange{BSON("a" << 19980), getShardKeyPattern().globalMax()});
+    ASSERT_EQ(merged.findIntersectingChunk(BSON("a" << 10005))->getShardIdAt(boost::none),
+              otherShard);
+
+    count = 0;
+    merged.forEachOverlappingChunk(
+        BSON("a" << 2390), BSON("a" << 2700), true, [&](const auto& chunk) {
+            ++count;
+            return true;
+        });
+    ASSERT_EQ(count, 3);
+
+    // The map the changes were applied to is unaffected.
+    ASSERT_EQ(chunkMap.size(), nChunks);
+    assertIntersects(chunkMap, 507, ChunkRange{BSON("a" << 500), BSON("a" << 510)});
+    assertIntersects(chunkMap, 2650, ChunkRange{BSON("a" << 2650), BSON("a" << 2660)});
+}
+
+TEST_F(ChunkMapTest, TestUpdateShardVersionMap) {
+    const OID epoch = OID::gen();
+    ChunkVersion version{1, 0, epoch};
+    const ShardId shardA("shardA");
+    const ShardId shardB("shardB");
+    const ShardId shardC("shardC");
+
+    // Chunks alternate between shards A and B, except for [0, 10) which is the only one on C.
+    const int nChunks = 1000;
+    std::vector<ChunkType> chunks;
+    for (int i = 0; i < nChunks; ++i) {
+        const auto min = i == 0 ? getShardKeyPattern().globalMin() : BSON("a" << (i - 1) * 10);
+        const auto max = i == nChunks - 1 ? getShardKeyPattern().globalMax() : BSON("a" << i * 10);
+        chunks.emplace_back(
+            kNss, ChunkRange{min, max}, version, i == 1 ? shardC : (i % 2 ? shardA : shardB));
+        version.incMinor();
+    }
+
+    const auto chunkMap =
+        ChunkMap(Ordering::make(getShardKeyPattern().toBSON())).createMerged(chunks);
+    const auto shardVersions = chunkMap.constructShardVersionMap(epoch);
+
+    const auto assertSameShardVersions = [](const ShardVersionMap& actual,
+                                            const ShardVersionMap& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (const auto& [shardId, targetingInfo] : expected) {
+            const auto it = actual.find(shardId);
+            ASSERT(it != actual.end());
+            ASSERT_EQ(it->second.shardVersion, targetingInfo.shardVersion);
+        }
+    };
+
+    // Move a chunk from A to B, bumping the version of another chunk on A.
+    version.incMajor();
+    std::vector<ChunkType> migration;
+    migration.emplace_back(kNss, ChunkRange{BSON("a" << 5000), BSON("a" << 5010)}, version, shardB);
+    version.incMinor();
+    migration.emplace_back(kNss, ChunkRange{BSON("a" << 20), BSON("a" << 30)}, version, shardA);
+
+    const auto migrated = chunkMap.createMerged(migration);
+    const auto migratedShardVersions =
+        migrated.updateShardVersionMap(chunkMap, shardVersions, migration, epoch);
+    assertSameShardVersions(migratedShardVersions, migrated.constructShardVersionMap(epoch));
+    ASSERT_EQ(migratedShardVersions.at(shardA).shardVersion, migration.back().getVersion());
+    ASSERT_EQ(migratedShardVersions.at(shardB).shardVersion, migration.front().getVersion());
+
+    // Move the only chunk on C away, which removes C from the map.
+    version.incMajor();
+    std::vector<ChunkType> drain;
+    drain.emplace_back(kNss, ChunkRange{BSON("a" << 0), BSON("a" << 10)}, version, shardA);
+
+    const auto drained = migrated.createMerged(drain);
+    const auto drainedShardVersions =
+        drained.updateShardVersionMap(migrated, migratedShardVersions, drain, epoch);
+    assertSameShardVersions(drainedShardVersions, drained.constructShardVersionMap(epoch));
+    ASSERT_EQ(drainedShardVersions.count(shardC), 0U);
+
+    // A changed chunk which leaves a gap in the routing table is detected.
+    version.incMajor();
+    std::vector<ChunkType> gap;
+    gap.emplace_back(kNss, ChunkRange{BSON("a" << 105), BSON("a" << 110)}, version, shardA);
+
+    const auto withGap = drained.createMerged(gap);
+    ASSERT_THROWS_CODE(withGap.updateShardVersionMap(drained, drainedShardVersions, gap, epoch),
+                       DBException,
+                       ErrorCodes::ConflictingOperationInProgress);
+}
+
+}  // namespace mongo
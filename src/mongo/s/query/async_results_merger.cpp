@@ -41,6 +41,7 @@
 #include "mongo/db/query/killcursors_request.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
+#include "mongo/s/query/async_results_merger_knobs_gen.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
@@ -92,6 +93,18 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, rules);
 }
 
+/**
+ * Returns the Ordering with which to encode sort keys into KeyStrings, such that comparing the
+ * KeyStrings agrees with 'compareSortKeys', or boost::none if the merge is unsorted or the sort
+ * pattern has too many fields to be described by an Ordering.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const boost::optional<BSONObj>& sort) {
+    if (!sort || static_cast<size_t>(sort->nFields()) > Ordering::kMaxCompoundIndexKeys) {
+        return boost::none;
+    }
+    return Ordering::make(*sort);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -104,8 +117,16 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       // since that is not supported we treat boost::none (unspecified) to mean 'kNormal'.
       _tailableMode(params.getTailableMode().value_or(TailableModeEnum::kNormal)),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(
-          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
+      // Batches from tailable cursors are passed through as-is, and awaitData getMores may block
+      // on the shard, so only read ahead on regular cursors.
+      _readAheadBytes(_tailableMode == TailableModeEnum::kNormal
+                          ? internalQueryAsyncResultsMergerReadAheadBytes.load()
+                          : 0),
+      _sortKeyOrdering(makeSortKeyOrdering(_params.getSort())),
+      _mergeQueue(MergingComparator(_remotes,
+                                    _params.getSort().value_or(BSONObj()),
+                                    _params.getCompareWholeSortKey(),
+                                    _sortKeyOrdering.has_value())),
       _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
@@ -334,7 +355,7 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
@@ -348,8 +369,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popBufferedResult(lk, smallestRemote);
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -366,15 +386,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popBufferedResult(lk, _gettingFromRemote);
 
             if (_tailableMode == TailableModeEnum::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -397,6 +416,33 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+ClusterQueryResult AsyncResultsMerger::_popBufferedResult(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+    if (!remote.sortKeyBuffer.empty()) {
+        remote.sortKeyBuffer.pop();
+    }
+    remote.bufferedBytes -= front.getResult() ? front.getResult()->objsize() : 0;
+
+    _readAheadIfNeeded(lk, remoteIndex);
+    return front;
+}
+
+bool AsyncResultsMerger::_shouldReadAhead(WithLock, const RemoteCursorData& remote) const {
+    return remote.bufferedBytes < _readAheadBytes && remote.status.isOK() && !remote.exhausted() &&
+        !remote.cbHandle.isValid();
+}
+
+void AsyncResultsMerger::_readAheadIfNeeded(WithLock lk, size_t remoteIndex) {
+    // It is illegal to schedule a remote command on a user's behalf without an OperationContext.
+    // Any read-ahead missed while detached happens on the next call to nextEvent().
+    auto& remote = _remotes[remoteIndex];
+    if (_opCtx && _lifecycleState == kAlive && _shouldReadAhead(lk, remote)) {
+        remote.status = _askForNextBatch(lk, remoteIndex);
+    }
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     invariant(_opCtx, "Cannot schedule a getMore without an OperationContext");
     auto& remote = _remotes[remoteIndex];
@@ -470,9 +516,11 @@ Status AsyncResultsMerger::_scheduleGetMores(WithLock lk) {
             return remote.status;
         }
 
-        if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
+        if ((!remote.hasNext() || _shouldReadAhead(lk, remote)) && !remote.exhausted() &&
+            !remote.cbHandle.isValid()) {
             // If this remote is not exhausted and there is no outstanding request for it, schedule
-            // work to retrieve the next batch.
+            // work to retrieve the next batch. If read-ahead is enabled, we do this before its
+            // buffered results have run out.
             auto nextBatchStatus = _askForNextBatch(lk, i);
             if (!nextBatchStatus.isOK()) {
                 return nextBatchStatus;
@@ -627,6 +675,9 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.partialResultsReturned = (remote.status != ErrorCodes::ExchangePassthrough);
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        std::queue<KeyString::Value> emptySortKeyBuffer;
+        std::swap(remote.sortKeyBuffer, emptySortKeyBuffer);
+        remote.bufferedBytes = 0;
         remote.status = Status::OK();
         remote.cursorId = 0;
     }
@@ -674,6 +725,9 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
         // Be careful only to do this when '_opCtx' is non-null, since it is illegal to schedule a
         // remote command on a user's behalf without a non-null OperationContext.
         remote.status = _askForNextBatch(lk, remoteIndex);
+    } else {
+        // If this batch didn't fill the remote's read-ahead budget, ask for the next one now.
+        _readAheadIfNeeded(lk, remoteIndex);
     }
 }
 
@@ -682,6 +736,13 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     _updateRemoteMetadata(lk, remoteIndex, response);
+
+    // Encode each sort key once here rather than re-parsing it on every comparison of the merge.
+    boost::optional<KeyString::Builder> sortKeyBuilder;
+    if (_sortKeyOrdering) {
+        sortKeyBuilder.emplace(KeyString::Version::V1, *_sortKeyOrdering);
+    }
+
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (_params.getSort()) {
@@ -701,8 +762,15 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             }
         }
 
+        if (sortKeyBuilder) {
+            sortKeyBuilder->resetToKey(extractSortKey(obj, _params.getCompareWholeSortKey()),
+                                       *_sortKeyOrdering);
+            remote.sortKeyBuffer.push(sortKeyBuilder->getValueCopy());
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
+        remote.bufferedBytes += obj.objsize();
         ++remote.fetchedCount;
     }
 
@@ -826,6 +894,10 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 //
 
 bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+    if (_compareEncodedSortKeys) {
+        return _remotes[lhs].sortKeyBuffer.front().compare(_remotes[rhs].sortKeyBuffer.front()) > 0;
+    }
+
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -35,7 +35,9 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
@@ -67,6 +69,14 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * By default a remote is only asked for its next batch once everything buffered from it has been
+ * consumed, so a sorted merge stalls for a round trip whenever any remote runs dry. If
+ * 'internalQueryAsyncResultsMergerReadAheadBytes' is set, non-tailable cursors instead keep one
+ * getMore outstanding against each remote while fewer than that many bytes of its results are
+ * buffered. A remote cursor can only serve one getMore at a time, so this bounds read-ahead to a
+ * single batch in flight per remote; the byte limit provides backpressure when the consumer is
+ * slower than the shards.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -305,6 +315,11 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // The sort keys of the results in 'docBuffer', in the same order, encoded as KeyStrings
+        // so that the merge compares them as plain byte strings. Empty unless the merge is sorted
+        // and the sort pattern can be expressed as an Ordering.
+        std::queue<KeyString::Value> sortKeyBuffer;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -315,14 +330,21 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The total size of the documents in 'docBuffer'. Used to bound read-ahead.
+        long long bufferedBytes = 0;
     };
 
     class MergingComparator {
     public:
         MergingComparator(const std::vector<RemoteCursorData>& remotes,
                           const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+                          bool compareWholeSortKey,
+                          bool compareEncodedSortKeys)
+            : _remotes(remotes),
+              _sort(sort),
+              _compareWholeSortKey(compareWholeSortKey),
+              _compareEncodedSortKeys(compareEncodedSortKeys) {}
 
         bool operator()(const size_t& lhs, const size_t& rhs);
 
@@ -335,6 +357,10 @@ private:
         // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
         // be {$sortKey: 1}.
         const bool _compareWholeSortKey;
+
+        // When '_compareEncodedSortKeys' is true, the remotes' 'sortKeyBuffer's are compared
+        // instead of the $sortKey fields of the buffered documents.
+        const bool _compareEncodedSortKeys;
     };
 
     using MinSortKeyRemoteIdPair = std::pair<BSONObj, size_t>;
@@ -369,6 +395,23 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * Returns true if 'remote' should be asked for its next batch before its buffered results have
+     * been consumed. See 'internalQueryAsyncResultsMergerReadAheadBytes'.
+     */
+    bool _shouldReadAhead(WithLock, const RemoteCursorData& remote) const;
+
+    /**
+     * Schedules a getMore on the given remote if it has fallen below its read-ahead limit. Any
+     * error scheduling the request is recorded in the remote's status.
+     */
+    void _readAheadIfNeeded(WithLock, size_t remoteIndex);
+
+    /**
+     * Removes and returns the next buffered result from the given remote.
+     */
+    ClusterQueryResult _popBufferedResult(WithLock, size_t remoteIndex);
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -463,6 +506,14 @@ private:
     TailableModeEnum _tailableMode;
     AsyncResultsMergerParams _params;
 
+    // The value of 'internalQueryAsyncResultsMergerReadAheadBytes' when this ARM was created, or 0
+    // if read-ahead is not used for this cursor.
+    const long long _readAheadBytes;
+
+    // The Ordering used to encode sort keys as KeyStrings when they are buffered, or boost::none if
+    // the merge is unsorted or the sort pattern has more fields than an Ordering can describe.
+    const boost::optional<Ordering> _sortKeyOrdering;
+
     // Must be acquired before accessing any data members (other than _params, which is read-only).
     mutable Mutex _mutex = MONGO_MAKE_LATCH("AsyncResultsMerger::_mutex");
 
@@ -41,9 +41,11 @@
 #include "mongo/db/query/query_request.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/s/query/async_results_merger_knobs_gen.h"
 #include "mongo/s/query/results_merger_test_fixture.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -440,6 +442,56 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortKeysOfMixedTypes) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1, b: -1}}");
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, {})));
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[1], kTestShardHosts[1], CursorResponse(kTestNss, 6, {})));
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[2], kTestShardHosts[2], CursorResponse(kTestNss, 7, {})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // Schedule requests.
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    // Deliver responses. Numbers of different types compare by value, and across types the
+    // canonical BSON type order applies.
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: [null, 'z']}"),
+                                   fromjson("{$sortKey: [2, 'a']}"),
+                                   fromjson("{$sortKey: ['abc', 1]}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: [1.5, 0]}"),
+                                   fromjson("{$sortKey: [2.0, 'b']}"),
+                                   fromjson("{$sortKey: ['ab', 5]}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch2);
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: [NumberLong(2), 'c']}"),
+                                   fromjson("{$sortKey: ['abc', 2]}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    // ARM returns all results in sorted order.
+    for (auto&& expected : {fromjson("{$sortKey: [null, 'z']}"),
+                            fromjson("{$sortKey: [1.5, 0]}"),
+                            fromjson("{$sortKey: [NumberLong(2), 'c']}"),
+                            fromjson("{$sortKey: [2.0, 'b']}"),
+                            fromjson("{$sortKey: [2, 'a']}"),
+                            fromjson("{$sortKey: ['ab', 5]}"),
+                            fromjson("{$sortKey: ['abc', 2]}"),
+                            fromjson("{$sortKey: ['abc', 1]}")}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(expected, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
@@ -1919,5 +1971,86 @@ TEST_F(AsyncResultsMergerTest, ShouldNotScheduleGetMoresWithoutAnOperationContex
     executor()->waitForEvent(killedEvent);
 }
 
+TEST_F(AsyncResultsMergerTest, ReadAheadRequestsNextBatchBeforeBufferIsConsumed) {
+    internalQueryAsyncResultsMergerReadAheadBytes.store(1024 * 1024);
+    ON_BLOCK_EXIT([] { internalQueryAsyncResultsMergerReadAheadBytes.store(0); });
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0],
+        kTestShardHosts[0],
+        CursorResponse(kTestNss, 5, {fromjson("{$sortKey: [1]}"), fromjson("{$sortKey: [3]}")})));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1],
+        kTestShardHosts[1],
+        CursorResponse(kTestNss, 6, {fromjson("{$sortKey: [2]}"), fromjson("{$sortKey: [4]}")})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // Consuming a result from each remote asks it for its next batch, even though both still have
+    // results buffered.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_FALSE(networkHasReadyRequests());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: [1]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    ASSERT_EQ(getNthPendingRequest(0u).target, kTestShardHosts[0]);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: [2]}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_EQ(getNthPendingRequest(1u).target, kTestShardHosts[1]);
+
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(
+        kTestNss, CursorId(0), std::vector<BSONObj>{fromjson("{$sortKey: [5]}")});
+    responses.emplace_back(
+        kTestNss, CursorId(0), std::vector<BSONObj>{fromjson("{$sortKey: [6]}")});
+    scheduleNetworkResponses(std::move(responses));
+
+    for (int i = 3; i <= 6; ++i) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON_ARRAY(i)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+    ASSERT_TRUE(arm->remotesExhausted());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadStopsWhenBufferReachesByteLimit) {
+    const auto docSize = fromjson("{_id: 1}").objsize();
+    internalQueryAsyncResultsMergerReadAheadBytes.store(2 * docSize);
+    ON_BLOCK_EXIT([] { internalQueryAsyncResultsMergerReadAheadBytes.store(0); });
+
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0],
+        kTestShardHosts[0],
+        CursorResponse(
+            kTestNss, 5, {fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    // Two results are still buffered, which meets the limit.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // Dropping below the limit asks for the next batch.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    // The response brings the buffer back up to the limit, so no further batch is requested.
+    std::vector<CursorResponse> responses;
+    responses.emplace_back(kTestNss, CursorId(5), std::vector<BSONObj>{fromjson("{_id: 4}")});
+    scheduleNetworkResponses(std::move(responses));
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    auto killedEvent = arm->kill(operationContext());
+    executor()->waitForEvent(killedEvent);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -33,7 +33,10 @@
 #include "mongo/base/status_with.h"
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/duration.h"
 
+#include <memory>
 #include <type_traits>
 
 namespace mongo {
@@ -42,6 +45,8 @@ enum class MessageCompressor : uint8_t {
     kSnappy = 1,
     kZlib = 2,
     kZstd = 3,
+    kZstdDict = 4,
+    kZstdStream = 5,
     kExtended = 255,
 };
 
@@ -82,6 +87,17 @@ public:
      */
     virtual StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) = 0;
 
+    /*
+     * Like compressData, but compresses against the dictionary with the given ID, which both peers
+     * agreed on during compression negotiation. An ID of 0 means no dictionary. Compressors that
+     * don't support dictionaries ignore it.
+     */
+    virtual StatusWith<std::size_t> compressDataWithDictionary(ConstDataRange input,
+                                                               DataRange output,
+                                                               uint32_t dictionaryId) {
+        return compressData(input, output);
+    }
+
     /*
      * This method decompresses the data in the input ConstDataRange into the output DataRange.
      * It returns the number of bytes actually decompressed into the output range, or an error
@@ -89,6 +105,42 @@ public:
      */
     virtual StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) = 0;
 
+    /*
+     * The state a streaming compressor keeps for one direction of a connection, so that each
+     * message is compressed against the ones sent before it. The peer must decompress the messages
+     * in the order they were compressed, using a context of its own.
+     */
+    class StreamContext {
+    public:
+        virtual ~StreamContext() = default;
+    };
+
+    /*
+     * These return a new context for compressing, respectively decompressing, the messages of one
+     * direction of a connection, or null if this compressor compresses each message on its own.
+     */
+    virtual std::unique_ptr<StreamContext> makeCompressionStream() {
+        return nullptr;
+    }
+    virtual std::unique_ptr<StreamContext> makeDecompressionStream() {
+        return nullptr;
+    }
+
+    /*
+     * Like compressData and decompressData, but continuing the stream of the given context, which
+     * was made by this compressor. Only streaming compressors implement these.
+     */
+    virtual StatusWith<std::size_t> compressDataInStream(StreamContext* stream,
+                                                         ConstDataRange input,
+                                                         DataRange output) {
+        MONGO_UNREACHABLE;
+    }
+    virtual StatusWith<std::size_t> decompressDataInStream(StreamContext* stream,
+                                                           ConstDataRange input,
+                                                           DataRange output) {
+        MONGO_UNREACHABLE;
+    }
+
     /*
      * This returns the number of bytes passed in the input for compressData
      */
@@ -117,6 +169,48 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the number of calls to compressData
+     */
+    int64_t getCompressorMessages() const {
+        return _compressMessages.loadRelaxed();
+    }
+
+    /*
+     * This returns the number of calls to decompressData
+     */
+    int64_t getDecompressorMessages() const {
+        return _decompressMessages.loadRelaxed();
+    }
+
+    /*
+     * This returns the total time spent in compressData, as recorded by recordCompressTime
+     */
+    Microseconds getCompressorTime() const {
+        return Microseconds{_compressMicros.loadRelaxed()};
+    }
+
+    /*
+     * This returns the total time spent in decompressData, as recorded by recordDecompressTime
+     */
+    Microseconds getDecompressorTime() const {
+        return Microseconds{_decompressMicros.loadRelaxed()};
+    }
+
+    /*
+     * Called by the MessageCompressorManager to account for the time spent compressing a message
+     */
+    void recordCompressTime(Microseconds elapsed) {
+        _compressMicros.addAndFetch(durationCount<Microseconds>(elapsed));
+    }
+
+    /*
+     * Called by the MessageCompressorManager to account for the time spent decompressing a message
+     */
+    void recordDecompressTime(Microseconds elapsed) {
+        _decompressMicros.addAndFetch(durationCount<Microseconds>(elapsed));
+    }
+
 
 protected:
     /*
@@ -130,6 +224,7 @@ protected:
      * Called by sub-classes to bump their bytesIn/bytesOut counters for compression
      */
     void counterHitCompress(int64_t bytesIn, int64_t bytesOut) {
+        _compressMessages.addAndFetch(1);
         _compressBytesIn.addAndFetch(bytesIn);
         _compressBytesOut.addAndFetch(bytesOut);
     }
@@ -138,6 +233,7 @@ protected:
      * Called by sub-classes to bump their bytesIn/bytesOut counters for decompression
      */
     void counterHitDecompress(int64_t bytesIn, int64_t bytesOut) {
+        _decompressMessages.addAndFetch(1);
         _decompressBytesIn.addAndFetch(bytesIn);
         _decompressBytesOut.addAndFetch(bytesOut);
     }
@@ -151,5 +247,10 @@ private:
 
     AtomicWord<long long> _decompressBytesIn;
     AtomicWord<long long> _decompressBytesOut;
+
+    AtomicWord<long long> _compressMessages;
+    AtomicWord<long long> _decompressMessages;
+    AtomicWord<long long> _compressMicros;
+    AtomicWord<long long> _decompressMicros;
 };
 }  // namespace mongo
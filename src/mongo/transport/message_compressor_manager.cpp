@@ -33,6 +33,8 @@
 
 #include "mongo/transport/message_compressor_manager.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_endian.h"
 #include "mongo/bson/bsonobj.h"
@@ -40,7 +42,10 @@
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/message.h"
 #include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zstd_dict.h"
 #include "mongo/transport/session.h"
+#include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -74,6 +79,15 @@ struct CompressionHeader {
 
 const transport::Session::Decoration<MessageCompressorManager> getForSession =
     transport::Session::declareDecoration<MessageCompressorManager>();
+
+constexpr auto kCompressionDictionariesFieldName = "compressionDictionaries"_sd;
+constexpr auto kCompressionDictionaryFieldName = "compressionDictionary"_sd;
+constexpr auto kDictionaryIdFieldName = "id"_sd;
+
+ZstdDictMessageCompressor* getZstdDictCompressor(MessageCompressorRegistry* registry) {
+    return static_cast<ZstdDictMessageCompressor*>(
+        registry->getCompressor(static_cast<MessageCompressorId>(MessageCompressor::kZstdDict)));
+}
 }  // namespace
 
 MessageCompressorManager::MessageCompressorManager()
@@ -82,6 +96,19 @@ MessageCompressorManager::MessageCompressorManager()
 MessageCompressorManager::MessageCompressorManager(MessageCompressorRegistry* factory)
     : _registry{factory} {}
 
+MessageCompressorBase::StreamContext* MessageCompressorManager::_getStream(
+    MessageCompressorBase* compressor, Stream* stream, bool forCompression) {
+    if (!stream->context) {
+        auto context = forCompression ? compressor->makeCompressionStream()
+                                      : compressor->makeDecompressionStream();
+        if (!context) {
+            return nullptr;
+        }
+        *stream = {compressor, std::move(context)};
+    }
+    return stream->compressor == compressor ? stream->context.get() : nullptr;
+}
+
 StatusWith<Message> MessageCompressorManager::compressMessage(
     const Message& msg, const MessageCompressorId* compressorId) {
 
@@ -128,7 +155,12 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
-    auto sws = compressor->compressData(input, output);
+    auto stream = _getStream(compressor, &_compressionStream, true /* forCompression */);
+
+    Timer timer;
+    auto sws = stream ? compressor->compressDataInStream(stream, input, output)
+                      : compressor->compressDataWithDictionary(input, output, _dictionaryId);
+    compressor->recordCompressTime(Microseconds{timer.micros()});
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -185,7 +217,12 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
-    auto sws = compressor->decompressData(input, output);
+    auto stream = _getStream(compressor, &_decompressionStream, false /* forCompression */);
+
+    Timer timer;
+    auto sws = stream ? compressor->decompressDataInStream(stream, input, output)
+                      : compressor->decompressData(input, output);
+    compressor->recordDecompressTime(Microseconds{timer.micros()});
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -203,7 +240,11 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
     LOGV2_DEBUG(22928, 3, "Starting client-side compression negotiation");
 
     // We're about to update the compressor list with the negotiation result from the server.
+    // This may be a reconnection, and the new server session starts its streams from scratch.
     _negotiated.clear();
+    _dictionaryId = 0;
+    _compressionStream = {};
+    _decompressionStream = {};
 
     auto& compressorList = _registry->getCompressorNames();
     if (compressorList.size() == 0)
@@ -215,6 +256,15 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
         sub.append(e);
     }
     sub.doneFast();
+
+    // Tell the server which built-in dictionaries we have, so it can pick one we share.
+    if (auto zstdDict = getZstdDictCompressor(_registry)) {
+        BSONArrayBuilder dictionaries(output->subarrayStart(kCompressionDictionariesFieldName));
+        for (auto id : zstdDict->getDictionaryIds()) {
+            dictionaries.append(static_cast<long long>(id));
+        }
+        dictionaries.doneFast();
+    }
 }
 
 void MessageCompressorManager::clientFinish(const BSONObj& input) {
@@ -243,6 +293,47 @@ void MessageCompressorManager::clientFinish(const BSONObj& input) {
             22933, 3, "Adding compressor {ret_getName}", "ret_getName"_attr = ret->getName());
         _negotiated.push_back(ret);
     }
+
+    auto dictionaryElem = input.getField(kCompressionDictionaryFieldName);
+    if (dictionaryElem.eoo()) {
+        return;
+    }
+
+    auto zstdDict = getZstdDictCompressor(_registry);
+    auto status = [&]() -> Status {
+        if (!zstdDict) {
+            return {ErrorCodes::BadValue, "Dictionary compression was not requested"};
+        }
+
+        auto dictionaryId = static_cast<uint32_t>(
+            dictionaryElem.Obj()[kDictionaryIdFieldName].safeNumberLong());
+        if (!zstdDict->hasDictionary(dictionaryId)) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "Unknown compression dictionary " << dictionaryId};
+        }
+
+        _dictionaryId = dictionaryId;
+        return Status::OK();
+    }();
+
+    // The server has already agreed to dictionary compression, but messages we compress without
+    // a dictionary are still valid zstdDict frames, so there's no need to fail the connection.
+    // Prefer the other negotiated compressors instead, if there are any.
+    if (!status.isOK()) {
+        LOGV2_WARNING(5097136,
+                      "Server chose a network compression dictionary we do not have",
+                      "error"_attr = status);
+        auto it = std::find(_negotiated.begin(), _negotiated.end(), zstdDict);
+        if (it != _negotiated.end() && _negotiated.size() > 1) {
+            _negotiated.erase(it);
+        }
+        return;
+    }
+
+    LOGV2_DEBUG(5097137,
+                3,
+                "Using network compression dictionary",
+                "dictionaryId"_attr = _dictionaryId);
 }
 
 void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuilder* output) {
@@ -268,8 +359,12 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     }
 
     // If compression has already been negotiated, then this is a renegotiation, so we should
-    // reset the state of the manager.
+    // reset the state of the manager. The client starts its streams over when it renegotiates, so
+    // ours must as well.
     _negotiated.clear();
+    _dictionaryId = 0;
+    _compressionStream = {};
+    _decompressionStream = {};
 
     // First we go through all the compressor names that the client has requested support for
     BSONObj theirObj = elem.Obj();
@@ -303,6 +398,28 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
         sub.doneFast();
     } else {
         LOGV2_DEBUG(22939, 3, "Could not agree on compressor to use");
+        return;
+    }
+
+    // If we're going to use dictionary compression, pick the newest dictionary the client also
+    // has. Dictionaries are built into the server, so only their IDs are ever exchanged.
+    auto zstdDict = getZstdDictCompressor(_registry);
+    auto clientDictionaries = input.getField(kCompressionDictionariesFieldName);
+    if (!zstdDict || clientDictionaries.type() != Array ||
+        std::find(_negotiated.begin(), _negotiated.end(), zstdDict) == _negotiated.end()) {
+        return;
+    }
+
+    for (auto dictionaryId : zstdDict->getDictionaryIds()) {
+        for (const auto& e : clientDictionaries.Obj()) {
+            if (e.isNumber() && static_cast<uint32_t>(e.safeNumberLong()) == dictionaryId) {
+                BSONObjBuilder dictionary(output->subobjStart(kCompressionDictionaryFieldName));
+                dictionary.append(kDictionaryIdFieldName, static_cast<long long>(dictionaryId));
+                dictionary.doneFast();
+                _dictionaryId = dictionaryId;
+                return;
+            }
+        }
     }
 }
 
@@ -65,6 +65,9 @@ public:
      * Called by a client constructing an isMaster request. This function will append the result
      * of _registry->getCompressorNames() to the BSONObjBuilder as a BSON array. If no compressors
      * are configured, it won't append anything.
+     *
+     * If the zstdDict compressor is offered, this also appends the IDs of the built-in compression
+     * dictionaries as a "compressionDictionaries" array.
      */
     void clientBegin(BSONObjBuilder* output);
 
@@ -75,6 +78,9 @@ public:
      * This looks for a BSON array called "compression" with the server's list of
      * requested algorithms. The first algorithm in that array will be used in subsequent calls
      * to compressMessage.
+     *
+     * If the server also sent a "compressionDictionary" document, the dictionary it names is used
+     * for dictionary compression on this connection.
      */
     void clientFinish(const BSONObj& input);
 
@@ -87,6 +93,9 @@ public:
      *
      * If no compressors are configured that match those requested by the client, then it will
      * not append anything to the BSONObjBuilder output.
+     *
+     * If zstdDict was negotiated and the client sent its list of dictionaries, this appends a
+     * "compressionDictionary" document naming the newest dictionary both sides have, if any.
      */
     void serverNegotiate(const BSONObj& input, BSONObjBuilder* output);
 
@@ -129,6 +138,28 @@ public:
 private:
     std::vector<MessageCompressorBase*> _negotiated;
     MessageCompressorRegistry* _registry;
+
+    // The ID of the dictionary both sides agreed to compress against, or 0 for none.
+    uint32_t _dictionaryId = 0;
+
+    // The context of a streaming compressor and the compressor that made it.
+    struct Stream {
+        MessageCompressorBase* compressor = nullptr;
+        std::unique_ptr<MessageCompressorBase::StreamContext> context;
+    };
+
+    /**
+     * Returns the context of the stream 'compressor' continues, making it on first use, or null if
+     * 'compressor' compresses each message on its own.
+     */
+    static MessageCompressorBase::StreamContext* _getStream(MessageCompressorBase* compressor,
+                                                            Stream* stream,
+                                                            bool forCompression);
+
+    // The streams of the messages this side of the connection sends and receives. Only one
+    // streaming compressor exists, zstdStream, so there is at most one of each.
+    Stream _compressionStream;
+    Stream _decompressionStream;
 };
 
 }  // namespace mongo
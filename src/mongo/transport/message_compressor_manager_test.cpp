@@ -43,6 +43,8 @@
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/transport/message_compressor_zstd_dict.h"
+#include "mongo/transport/message_compressor_zstd_stream.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -240,6 +242,16 @@ TEST(ZstdMessageCompressor, Fidelity) {
     checkFidelity(testMessage, std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdDictMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZstdDictMessageCompressor>());
+}
+
+TEST(ZstdStreamMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZstdStreamMessageCompressor>());
+}
+
 TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<SnappyMessageCompressor>());
 }
@@ -252,6 +264,14 @@ TEST(ZstdMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdDictMessageCompressor, Overflow) {
+    checkOverflow(std::make_unique<ZstdDictMessageCompressor>());
+}
+
+TEST(ZstdStreamMessageCompressor, Overflow) {
+    checkOverflow(std::make_unique<ZstdStreamMessageCompressor>());
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -322,6 +342,235 @@ TEST(MessageCompressorManager, SERVER_28008) {
     ASSERT_EQ(compressorId, zstdId);
 }
 
+Message buildCommandReply(int i) {
+    auto reply = BSON("cursor" << BSON("firstBatch"
+                                       << BSON_ARRAY(BSON("_id" << i << "name"
+                                                                << "user" + std::to_string(i)
+                                                                << "status"
+                                                                << "active"
+                                                                << "visits" << i * 7))
+                                       << "id" << 0LL << "ns"
+                                       << "test.users")
+                               << "ok" << 1.0);
+    const auto bufferSize = MsgData::MsgDataHeaderSize + reply.objsize();
+    auto buf = SharedBuffer::allocate(bufferSize);
+    MsgData::View view(buf.get());
+    view.setId(i);
+    view.setResponseToMsgId(0);
+    view.setOperation(dbMsg);
+    view.setLen(bufferSize);
+    memcpy(view.data(), reply.objdata(), reply.objsize());
+    return Message{buf};
+}
+
+MessageCompressorRegistry buildZstdDictRegistry() {
+    MessageCompressorRegistry registry;
+    auto compressor = std::make_unique<ZstdDictMessageCompressor>();
+    registry.setSupportedCompressors({compressor->getName()});
+    registry.registerImplementation(std::move(compressor));
+    registry.finalizeSupportedCompressors().transitional_ignore();
+    return registry;
+}
+
+ZstdDictMessageCompressor* getZstdDict(MessageCompressorRegistry& registry) {
+    return static_cast<ZstdDictMessageCompressor*>(
+        registry.getCompressor(static_cast<MessageCompressorId>(MessageCompressor::kZstdDict)));
+}
+
+TEST(ZstdDictMessageCompressor, BuiltInDictionaryIsNegotiatedById) {
+    auto clientRegistry = buildZstdDictRegistry();
+    auto serverRegistry = buildZstdDictRegistry();
+    auto serverCompressor = getZstdDict(serverRegistry);
+    auto clientCompressor = getZstdDict(clientRegistry);
+
+    // Every process builds the same dictionaries.
+    auto dictionaryIds = serverCompressor->getDictionaryIds();
+    ASSERT_FALSE(dictionaryIds.empty());
+    ASSERT(clientCompressor->getDictionaryIds() == dictionaryIds);
+
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    auto clientObj = clientOutput.obj();
+    ASSERT_EQ(clientObj["compressionDictionaries"].Array().size(), dictionaryIds.size());
+
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientObj, &serverOutput);
+    auto serverObj = serverOutput.obj();
+    checkNegotiationResult(serverObj, {"zstdDict"});
+
+    // Only the ID of the newest dictionary is sent, never its contents.
+    auto dictionary = serverObj["compressionDictionary"].Obj();
+    ASSERT_BSONOBJ_EQ(dictionary, BSON("id" << static_cast<long long>(dictionaryIds.front())));
+    clientManager.clientFinish(serverObj);
+
+    // Both directions compress against the dictionary, which beats plain zstd on small messages.
+    auto original = buildCommandReply(5000);
+    auto compressed = assertOk(serverManager.compressMessage(original));
+
+    ZstdMessageCompressor plain;
+    std::vector<char> plainBuffer(plain.getMaxCompressedSize(original.dataSize()));
+    auto plainSize = assertOk(plain.compressData(
+        ConstDataRange(original.singleData().data(), original.singleData().dataLen()),
+        DataRange(plainBuffer.data(), plainBuffer.size())));
+    ASSERT_LT(static_cast<size_t>(compressed.size()), plainSize + MsgData::MsgDataHeaderSize);
+
+    auto decompressed = assertOk(clientManager.decompressMessage(compressed));
+    ASSERT_EQ(decompressed.size(), original.size());
+    ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+
+    compressed = assertOk(clientManager.compressMessage(original));
+    decompressed = assertOk(serverManager.decompressMessage(compressed));
+    ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+
+    ASSERT_EQ(serverCompressor->getCompressorMessages(), 1);
+    ASSERT_EQ(clientCompressor->getDecompressorMessages(), 1);
+}
+
+TEST(ZstdDictMessageCompressor, NoCommonDictionary) {
+    auto clientRegistry = buildZstdDictRegistry();
+    auto serverRegistry = buildZstdDictRegistry();
+
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    auto clientObj = clientOutput.obj();
+
+    // Pretend the client was built with a different set of dictionaries.
+    BSONObjBuilder clientObjBuilder;
+    clientObjBuilder.append(clientObj["compression"]);
+    clientObjBuilder.append("compressionDictionaries", BSONArray());
+    clientObj = clientObjBuilder.obj();
+
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientObj, &serverOutput);
+    auto serverObj = serverOutput.obj();
+    checkNegotiationResult(serverObj, {"zstdDict"});
+    ASSERT_FALSE(serverObj.hasField("compressionDictionary"));
+    clientManager.clientFinish(serverObj);
+
+    // Messages are sent as plain zstd frames instead.
+    auto original = buildCommandReply(5000);
+    auto compressed = assertOk(serverManager.compressMessage(original));
+    auto decompressed = assertOk(clientManager.decompressMessage(compressed));
+    ASSERT_EQ(decompressed.size(), original.size());
+    ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+}
+
+MessageCompressorRegistry buildZstdStreamRegistry() {
+    MessageCompressorRegistry registry;
+    auto compressor = std::make_unique<ZstdStreamMessageCompressor>();
+    registry.setSupportedCompressors({compressor->getName()});
+    registry.registerImplementation(std::move(compressor));
+    registry.finalizeSupportedCompressors().transitional_ignore();
+    return registry;
+}
+
+void negotiate(MessageCompressorManager& clientManager, MessageCompressorManager& serverManager) {
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientOutput.obj(), &serverOutput);
+    auto serverObj = serverOutput.obj();
+    checkNegotiationResult(serverObj, {"zstdStream"});
+    clientManager.clientFinish(serverObj);
+}
+
+TEST(ZstdStreamMessageCompressor, StreamSpansMessages) {
+    auto clientRegistry = buildZstdStreamRegistry();
+    auto serverRegistry = buildZstdStreamRegistry();
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+    negotiate(clientManager, serverManager);
+
+    // Each message after the first is compressed against the ones before it, which plain zstd
+    // can't do.
+    ZstdMessageCompressor plain;
+    for (int i = 0; i < 100; ++i) {
+        auto original = buildCommandReply(i);
+        auto compressed = assertOk(serverManager.compressMessage(original));
+        auto decompressed = assertOk(clientManager.decompressMessage(compressed));
+        ASSERT_EQ(decompressed.size(), original.size());
+        ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+
+        if (i > 0) {
+            std::vector<char> plainBuffer(plain.getMaxCompressedSize(original.dataSize()));
+            auto plainSize = assertOk(plain.compressData(
+                ConstDataRange(original.singleData().data(), original.singleData().dataLen()),
+                DataRange(plainBuffer.data(), plainBuffer.size())));
+            ASSERT_LT(static_cast<size_t>(compressed.size()),
+                      plainSize + MsgData::MsgDataHeaderSize);
+        }
+
+        // The other direction is a stream of its own.
+        compressed = assertOk(clientManager.compressMessage(original));
+        decompressed = assertOk(serverManager.decompressMessage(compressed));
+        ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+    }
+
+    // A message out of order can't be decompressed by a fresh stream.
+    MessageCompressorManager otherClientManager(&clientRegistry);
+    auto compressed = assertOk(serverManager.compressMessage(buildCommandReply(100)));
+    ASSERT_NOT_OK(otherClientManager.decompressMessage(compressed).getStatus());
+}
+
+TEST(ZstdStreamMessageCompressor, ReconnectingStartsNewStreams) {
+    auto clientRegistry = buildZstdStreamRegistry();
+    auto serverRegistry = buildZstdStreamRegistry();
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+    negotiate(clientManager, serverManager);
+
+    for (int i = 0; i < 10; ++i) {
+        auto original = buildCommandReply(i);
+        assertOk(serverManager.decompressMessage(
+            assertOk(clientManager.compressMessage(original))));
+        assertOk(clientManager.decompressMessage(
+            assertOk(serverManager.compressMessage(original))));
+    }
+
+    // A reconnection negotiates with a new server session, whose streams start from scratch.
+    MessageCompressorManager newServerManager(&serverRegistry);
+    negotiate(clientManager, newServerManager);
+
+    auto original = buildCommandReply(10);
+    auto decompressed = assertOk(newServerManager.decompressMessage(
+        assertOk(clientManager.compressMessage(original))));
+    ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+    decompressed = assertOk(clientManager.decompressMessage(
+        assertOk(newServerManager.compressMessage(original))));
+    ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+}
+
+TEST(ZstdStreamMessageCompressor, RenegotiatingStartsNewStreams) {
+    auto clientRegistry = buildZstdStreamRegistry();
+    auto serverRegistry = buildZstdStreamRegistry();
+    MessageCompressorManager clientManager(&clientRegistry);
+    MessageCompressorManager serverManager(&serverRegistry);
+
+    // Renegotiating on the same connection starts new streams on both sides, however far the
+    // previous ones got.
+    for (int round = 0; round < 3; ++round) {
+        negotiate(clientManager, serverManager);
+
+        for (int i = 0; i < 10 * round + 1; ++i) {
+            auto original = buildCommandReply(i);
+            auto decompressed = assertOk(serverManager.decompressMessage(
+                assertOk(clientManager.compressMessage(original))));
+            ASSERT_EQ(decompressed.size(), original.size());
+            ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+            decompressed = assertOk(clientManager.decompressMessage(
+                assertOk(serverManager.compressMessage(original))));
+            ASSERT_EQ(decompressed.size(), original.size());
+            ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+        }
+    }
+}
+
 TEST(MessageCompressorManager, MessageSizeTooLarge) {
     auto registry = buildRegistry();
     MessageCompressorManager compManager(&registry);
@@ -36,6 +36,24 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kMessages = "messages"_sd;
+const auto kTimeMicros = "timeMicros"_sd;
+const auto kRatio = "ratio"_sd;
+
+void appendCounters(BSONObjBuilder* b,
+                    long long bytesIn,
+                    long long bytesOut,
+                    long long messages,
+                    Microseconds time,
+                    double ratio) {
+    *b << kBytesIn << bytesIn << kBytesOut << bytesOut << kMessages << messages << kTimeMicros
+       << durationCount<Microseconds>(time) << kRatio << ratio;
+}
+
+// The ratio of uncompressed to compressed bytes, or 0 if nothing was compressed yet.
+double compressionRatio(long long uncompressed, long long compressed) {
+    return compressed > 0 ? static_cast<double>(uncompressed) / compressed : 0;
+}
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -51,13 +69,23 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
         BSONObjBuilder base(compressionSection.subobjStart(name));
 
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
-        compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
-                          << compressor->getCompressorBytesOut();
+        appendCounters(&compressorSection,
+                       compressor->getCompressorBytesIn(),
+                       compressor->getCompressorBytesOut(),
+                       compressor->getCompressorMessages(),
+                       compressor->getCompressorTime(),
+                       compressionRatio(compressor->getCompressorBytesIn(),
+                                        compressor->getCompressorBytesOut()));
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
-        decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
-                            << compressor->getDecompressorBytesOut();
+        appendCounters(&decompressorSection,
+                       compressor->getDecompressorBytesIn(),
+                       compressor->getDecompressorBytesOut(),
+                       compressor->getDecompressorMessages(),
+                       compressor->getDecompressorTime(),
+                       compressionRatio(compressor->getDecompressorBytesOut(),
+                                        compressor->getDecompressorBytesIn()));
         decompressorSection.doneFast();
         base.doneFast();
     }
@@ -57,6 +57,10 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "zlib"_sd;
         case MessageCompressor::kZstd:
             return "zstd"_sd;
+        case MessageCompressor::kZstdDict:
+            return "zstdDict"_sd;
+        case MessageCompressor::kZstdStream:
+            return "zstdStream"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -0,0 +1,469 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd_dict.h"
+
+#include <memory>
+
+// For ZDICT_finalizeDictionary(), which builds a dictionary with a fixed ID from given content.
+#define ZDICT_STATIC_LINKING_ONLY
+#include <zdict.h>
+#include <zstd.h>
+
+#include "mongo/base/init.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// Dictionaries carry most of the gain for small messages, so use the fastest level, which also
+// keeps the per-dictionary compression tables small.
+constexpr int kDictionaryCompressionLevel = 1;
+
+// Room for a dictionary's entropy tables on top of its content.
+constexpr size_t kDictionaryHeaderCapacity = 4 * 1024;
+
+ZSTD_CCtx* getThreadCCtx() {
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx{ZSTD_createCCtx(),
+                                                                         &ZSTD_freeCCtx};
+    return cctx.get();
+}
+
+ZSTD_DCtx* getThreadDCtx() {
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx{ZSTD_createDCtx(),
+                                                                         &ZSTD_freeDCtx};
+    return dctx.get();
+}
+
+/**
+ * Returns the messages dictionary version 1 is built from: typical replica set and sharding
+ * traffic, and CRUD commands and their replies. All values are fixed, so that every process builds
+ * byte-for-byte the same dictionary.
+ */
+std::vector<BSONObj> makeDictionaryV1Samples() {
+    const Timestamp ts(1600000000, 1);
+    const Date_t wall = Date_t::fromMillisSinceEpoch(1600000000000);
+    const OID oid("5f5a5d5e2c3b4a1d2e3f4a5b");
+    const char uuidBytes[16] = {};
+    const BSONBinData uuid(uuidBytes, sizeof(uuidBytes), newUUID);
+    const char hashBytes[20] = {};
+    const BSONBinData hash(hashBytes, sizeof(hashBytes), BinDataGeneral);
+
+    const auto opTime = BSON("ts" << ts << "t" << 1LL);
+    const auto clusterTime =
+        BSON("clusterTime" << ts << "signature" << BSON("hash" << hash << "keyId" << 0LL));
+    const auto lsid = BSON("id" << uuid);
+    const auto replData = BSON("term" << 1LL << "lastOpCommitted" << opTime << "lastCommittedWall"
+                                      << wall << "lastOpVisible" << opTime << "configVersion" << 1
+                                      << "configTerm" << 1 << "replicaSetId" << oid
+                                      << "primaryIndex" << 0 << "syncSourceIndex" << -1);
+    const auto document = BSON("_id" << oid << "name"
+                                     << "name"
+                                     << "value" << 1 << "createdAt" << wall);
+
+    auto withClusterTime = [&](const BSONObj& reply) {
+        BSONObjBuilder builder;
+        builder.appendElements(reply);
+        builder.append("$clusterTime", clusterTime);
+        builder.append("operationTime", ts);
+        return builder.obj();
+    };
+
+    return {
+        BSON("isMaster" << 1 << "client"
+                        << BSON("driver" << BSON("name"
+                                                 << "NetworkInterfaceTL"
+                                                 << "version"
+                                                 << "4.6.0")
+                                         << "os"
+                                         << BSON("type"
+                                                 << "Linux"
+                                                 << "name"
+                                                 << "Ubuntu"
+                                                 << "architecture"
+                                                 << "x86_64"
+                                                 << "version"
+                                                 << "20.04"))
+                        << "hostInfo"
+                        << "localhost:27017"
+                        << "internalClient"
+                        << BSON("minWireVersion" << 9 << "maxWireVersion" << 9) << "$db"
+                        << "admin"),
+        withClusterTime(BSON(
+            "topologyVersion"
+            << BSON("processId" << oid << "counter" << 6LL) << "hosts"
+            << BSON_ARRAY("localhost:27017"
+                          << "localhost:27018")
+            << "setName"
+            << "rs0"
+            << "setVersion" << 1 << "ismaster" << true << "secondary" << false << "primary"
+            << "localhost:27017"
+            << "me"
+            << "localhost:27017"
+            << "electionId" << oid << "lastWrite"
+            << BSON("opTime" << opTime << "lastWriteDate" << wall << "majorityOpTime" << opTime
+                             << "majorityWriteDate" << wall)
+            << "maxBsonObjectSize" << 16777216 << "maxMessageSizeBytes" << 48000000
+            << "maxWriteBatchSize" << 100000 << "localTime" << wall
+            << "logicalSessionTimeoutMinutes" << 30 << "connectionId" << 1 << "minWireVersion" << 0
+            << "maxWireVersion" << 9 << "readOnly" << false << "ok" << 1.0)),
+        BSON("find"
+             << "collection"
+             << "filter" << BSON("_id" << oid) << "limit" << 1 << "singleBatch" << true
+             << "readConcern"
+             << BSON("level"
+                     << "majority"
+                     << "afterClusterTime" << ts)
+             << "lsid" << lsid << "$clusterTime" << clusterTime << "$readPreference"
+             << BSON("mode"
+                     << "secondaryPreferred")
+             << "$db"
+             << "test"),
+        withClusterTime(BSON("cursor" << BSON("firstBatch" << BSON_ARRAY(document) << "id" << 0LL
+                                                           << "ns"
+                                                           << "test.collection")
+                                      << "ok" << 1.0)),
+        BSON("aggregate"
+             << "collection"
+             << "pipeline"
+             << BSON_ARRAY(BSON("$match" << BSON("value" << BSON("$gte" << 1)))
+                           << BSON("$group" << BSON("_id"
+                                                    << "$name"
+                                                    << "count" << BSON("$sum" << 1))))
+             << "cursor" << BSON("batchSize" << 101) << "lsid" << lsid << "$clusterTime"
+             << clusterTime << "$db"
+             << "test"),
+        BSON("getMore" << 123456789LL << "collection"
+                       << "oplog.rs"
+                       << "batchSize" << 13981010 << "maxTimeMS" << 5000LL << "term" << 1LL
+                       << "lastKnownCommittedOpTime" << opTime << "$db"
+                       << "local"
+                       << "$replData" << 1 << "$oplogQueryData" << 1 << "$readPreference"
+                       << BSON("mode"
+                               << "secondaryPreferred")),
+        withClusterTime(BSON(
+            "cursor" << BSON("nextBatch"
+                             << BSON_ARRAY(BSON("op"
+                                                << "i"
+                                                << "ns"
+                                                << "test.collection"
+                                                << "ui" << uuid << "o" << document << "ts" << ts
+                                                << "t" << 1LL << "v" << 2LL << "wall" << wall)
+                                           << BSON("op"
+                                                   << "u"
+                                                   << "ns"
+                                                   << "test.collection"
+                                                   << "ui" << uuid << "o"
+                                                   << BSON("$v" << 1 << "$set"
+                                                                << BSON("value" << 2))
+                                                   << "o2" << BSON("_id" << oid) << "ts" << ts
+                                                   << "t" << 1LL << "v" << 2LL << "wall"
+                                                   << wall))
+                             << "id" << 123456789LL << "ns"
+                             << "local.oplog.rs")
+                     << "ok" << 1.0 << "$replData" << replData << "$oplogQueryData"
+                     << BSON("lastOpCommitted" << opTime << "lastCommittedWall" << wall
+                                               << "lastOpApplied" << opTime << "rbid" << 1
+                                               << "primaryIndex" << 0 << "syncSourceIndex"
+                                               << -1))),
+        BSON("insert"
+             << "collection"
+             << "ordered" << true << "documents" << BSON_ARRAY(document) << "writeConcern"
+             << BSON("w"
+                     << "majority"
+                     << "wtimeout" << 0)
+             << "lsid" << lsid << "txnNumber" << 1LL << "$clusterTime" << clusterTime << "$db"
+             << "test"),
+        withClusterTime(BSON("n" << 1 << "opTime" << opTime << "electionId" << oid << "ok"
+                                 << 1.0)),
+        BSON("update"
+             << "collection"
+             << "ordered" << true << "updates"
+             << BSON_ARRAY(BSON("q" << BSON("_id" << oid) << "u"
+                                    << BSON("$set" << BSON("value" << 2)) << "multi" << false
+                                    << "upsert" << false))
+             << "lsid" << lsid << "txnNumber" << 1LL << "$db"
+             << "test"),
+        withClusterTime(BSON("n" << 1 << "nModified" << 1 << "ok" << 1.0)),
+        BSON("delete"
+             << "collection"
+             << "ordered" << true << "deletes"
+             << BSON_ARRAY(BSON("q" << BSON("_id" << oid) << "limit" << 1)) << "lsid" << lsid
+             << "$db"
+             << "test"),
+        BSON("n" << 0 << "writeErrors"
+                 << BSON_ARRAY(BSON("index" << 0 << "code" << 11000 << "keyPattern"
+                                            << BSON("_id" << 1) << "keyValue"
+                                            << BSON("_id" << oid) << "errmsg"
+                                            << "E11000 duplicate key error collection: "
+                                               "test.collection index: _id_ dup key"))
+                 << "ok" << 1.0),
+        BSON("ok" << 0.0 << "errmsg"
+                  << "operation exceeded time limit"
+                  << "code" << 50 << "codeName"
+                  << "MaxTimeMSExpired"),
+        BSON("replSetUpdatePosition"
+             << 1 << "optimes"
+             << BSON_ARRAY(BSON("durableOpTime" << opTime << "durableWallTime" << wall
+                                                << "appliedOpTime" << opTime << "appliedWallTime"
+                                                << wall << "memberId" << 1 << "cfgver" << 1))
+             << "$replData" << replData << "$db"
+             << "admin"),
+        BSON("replSetHeartbeat"
+             << "rs0"
+             << "configVersion" << 1 << "configTerm" << 1 << "hbv" << 1 << "from"
+             << "localhost:27018"
+             << "fromId" << 1 << "term" << 1LL << "$db"
+             << "admin"),
+        BSON("ok" << 1.0 << "electionTime" << ts << "set"
+                  << "rs0"
+                  << "syncingTo"
+                  << ""
+                  << "term" << 1LL << "state" << 1 << "configVersion" << 1 << "configTerm" << 1
+                  << "durableOpTime" << opTime << "durableWallTime" << wall << "opTime" << opTime
+                  << "wallTime" << wall << "electionId" << oid),
+        BSON("find"
+             << "chunks"
+             << "filter"
+             << BSON("ns"
+                     << "test.collection"
+                     << "lastmod" << BSON("$gte" << ts))
+             << "sort" << BSON("lastmod" << 1) << "readConcern"
+             << BSON("level"
+                     << "majority"
+                     << "afterOpTime" << opTime)
+             << "maxTimeMS" << 30000 << "$db"
+             << "config"),
+        BSON("cursor" << BSON("firstBatch"
+                              << BSON_ARRAY(BSON("_id"
+                                                 << "test.collection-_id_MinKey"
+                                                 << "ns"
+                                                 << "test.collection"
+                                                 << "min" << BSON("_id" << MINKEY) << "max"
+                                                 << BSON("_id" << MAXKEY) << "shard"
+                                                 << "shard0000"
+                                                 << "lastmod" << ts << "lastmodEpoch" << oid
+                                                 << "history"
+                                                 << BSON_ARRAY(BSON("validAfter" << ts << "shard"
+                                                                                 << "shard0000"))))
+                              << "id" << 0LL << "ns"
+                              << "config.chunks")
+                      << "ok" << 1.0 << "$gleStats"
+                      << BSON("lastOpTime" << opTime << "electionId" << oid)
+                      << "$configServerState" << BSON("opTime" << opTime) << "$clusterTime"
+                      << clusterTime << "operationTime" << ts),
+    };
+}
+
+/**
+ * A built-in dictionary version. The ID travels in the compression handshake and in every frame,
+ * so a version's samples must never change: to improve the dictionary, add a new version with a
+ * new ID in the range zstd leaves to applications, [32768, 2^31).
+ */
+struct DictionaryVersion {
+    uint32_t id;
+    std::vector<BSONObj> (*makeSamples)();
+};
+
+// Newest first.
+const DictionaryVersion kDictionaryVersions[] = {
+    {1'560'281'089, makeDictionaryV1Samples},
+};
+
+/**
+ * Builds the dictionary for 'version'. Its content is the samples themselves, laid out as the
+ * bodies of OP_MSG messages, which is what the compressor sees.
+ */
+std::string buildDictionary(const DictionaryVersion& version) {
+    std::string samples;
+    std::vector<size_t> sampleSizes;
+    for (const auto& sample : version.makeSamples()) {
+        // OP_MSG flags and the kind of the body section, all zero.
+        samples.append(5, '\0');
+        samples.append(sample.objdata(), sample.objsize());
+        sampleSizes.push_back(5 + sample.objsize());
+    }
+
+    ZDICT_params_t params{};
+    params.compressionLevel = kDictionaryCompressionLevel;
+    params.dictID = version.id;
+
+    std::string dictionary(samples.size() + kDictionaryHeaderCapacity, '\0');
+    const size_t dictionarySize = ZDICT_finalizeDictionary(&dictionary[0],
+                                                           dictionary.size(),
+                                                           samples.data(),
+                                                           samples.size(),
+                                                           samples.data(),
+                                                           sampleSizes.data(),
+                                                           sampleSizes.size(),
+                                                           params);
+    invariant(!ZDICT_isError(dictionarySize),
+              str::stream() << "Could not build network compression dictionary " << version.id
+                            << ": " << ZDICT_getErrorName(dictionarySize));
+    dictionary.resize(dictionarySize);
+    return dictionary;
+}
+
+}  // namespace
+
+struct ZstdDictMessageCompressor::Dictionary {
+    Dictionary(uint32_t dictionaryId, std::string bytes)
+        : id(dictionaryId),
+          data(std::move(bytes)),
+          cdict(ZSTD_createCDict(data.data(), data.size(), kDictionaryCompressionLevel)),
+          ddict(ZSTD_createDDict(data.data(), data.size())) {
+        invariant(cdict && ddict);
+    }
+
+    ~Dictionary() {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+    }
+
+    const uint32_t id;
+    const std::string data;
+    ZSTD_CDict* const cdict;
+    ZSTD_DDict* const ddict;
+};
+
+ZstdDictMessageCompressor::ZstdDictMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZstdDict) {
+    for (const auto& version : kDictionaryVersions) {
+        _dictionaries.push_back(std::make_unique<Dictionary>(version.id, buildDictionary(version)));
+    }
+}
+
+ZstdDictMessageCompressor::~ZstdDictMessageCompressor() = default;
+
+std::size_t ZstdDictMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize);
+}
+
+StatusWith<std::size_t> ZstdDictMessageCompressor::compressData(ConstDataRange input,
+                                                                DataRange output) {
+    return compressDataWithDictionary(input, output, 0);
+}
+
+StatusWith<std::size_t> ZstdDictMessageCompressor::compressDataWithDictionary(
+    ConstDataRange input, DataRange output, uint32_t dictionaryId) {
+    const Dictionary* dictionary = nullptr;
+    if (input.length() <= kMaxDictionaryMessageSize) {
+        dictionary = _findDictionary(dictionaryId);
+    }
+
+    size_t ret = dictionary ? ZSTD_compress_usingCDict(getThreadCCtx(),
+                                                       const_cast<char*>(output.data()),
+                                                       output.length(),
+                                                       input.data(),
+                                                       input.length(),
+                                                       dictionary->cdict)
+                            : ZSTD_compressCCtx(getThreadCCtx(),
+                                                const_cast<char*>(output.data()),
+                                                output.length(),
+                                                input.data(),
+                                                input.length(),
+                                                ZSTD_CLEVEL_DEFAULT);
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << ZSTD_getErrorName(ret)};
+    }
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdDictMessageCompressor::decompressData(ConstDataRange input,
+                                                                  DataRange output) {
+    // Frames compressed against a dictionary name it in their header.
+    size_t ret;
+    if (auto dictionaryId = ZSTD_getDictID_fromFrame(input.data(), input.length())) {
+        auto dictionary = _findDictionary(dictionaryId);
+        if (!dictionary) {
+            return Status{ErrorCodes::BadValue,
+                          str::stream() << "Could not decompress message: unknown dictionary "
+                                        << dictionaryId};
+        }
+        ret = ZSTD_decompress_usingDDict(getThreadDCtx(),
+                                         const_cast<char*>(output.data()),
+                                         output.length(),
+                                         input.data(),
+                                         input.length(),
+                                         dictionary->ddict);
+    } else {
+        ret = ZSTD_decompressDCtx(getThreadDCtx(),
+                                  const_cast<char*>(output.data()),
+                                  output.length(),
+                                  input.data(),
+                                  input.length());
+    }
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not decompress message: " << ZSTD_getErrorName(ret)};
+    }
+
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+std::vector<uint32_t> ZstdDictMessageCompressor::getDictionaryIds() const {
+    std::vector<uint32_t> ids;
+    for (const auto& dictionary : _dictionaries) {
+        ids.push_back(dictionary->id);
+    }
+    return ids;
+}
+
+const ZstdDictMessageCompressor::Dictionary* ZstdDictMessageCompressor::_findDictionary(
+    uint32_t dictionaryId) const {
+    if (dictionaryId == 0) {
+        return nullptr;
+    }
+
+    for (const auto& dictionary : _dictionaries) {
+        if (dictionary->id == dictionaryId) {
+            return dictionary.get();
+        }
+    }
+    return nullptr;
+}
+
+MONGO_INITIALIZER_GENERAL(ZstdDictMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(std::make_unique<ZstdDictMessageCompressor>());
+    return Status::OK();
+}
+}  // namespace mongo
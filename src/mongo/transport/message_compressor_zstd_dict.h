@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/transport/message_compressor_base.h"
+
+namespace mongo {
+
+/**
+ * A zstd compressor for small messages which compresses against a dictionary shared with the
+ * peer. Typical command requests and replies are a few hundred bytes to a few kilobytes long and
+ * mostly repeat the same field names, which plain zstd can't exploit within a single message.
+ *
+ * The dictionaries are built into the server: each is built at startup from a fixed corpus of
+ * representative commands and replies, and is never trained on or sent along with live traffic,
+ * so a dictionary cannot reveal anything about another connection's data. Each version is
+ * identified by a fixed dictionary ID which zstd embeds in both the dictionary and every frame
+ * compressed against it. During the isMaster compression handshake the client lists the IDs it
+ * has, and the server picks the newest one both sides know; both directions of the connection
+ * then use it.
+ *
+ * Messages larger than kMaxDictionaryMessageSize, or sent on connections which found no common
+ * dictionary, are compressed as plain zstd frames.
+ */
+class ZstdDictMessageCompressor final : public MessageCompressorBase {
+public:
+    // Messages larger than this gain little from a dictionary and are compressed without one.
+    static constexpr size_t kMaxDictionaryMessageSize = 16 * 1024;
+
+    ZstdDictMessageCompressor();
+    ~ZstdDictMessageCompressor();
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> compressDataWithDictionary(ConstDataRange input,
+                                                       DataRange output,
+                                                       uint32_t dictionaryId) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+    /**
+     * Returns the IDs of the built-in dictionaries, newest first.
+     */
+    std::vector<uint32_t> getDictionaryIds() const;
+
+    bool hasDictionary(uint32_t dictionaryId) const {
+        return _findDictionary(dictionaryId);
+    }
+
+private:
+    struct Dictionary;
+
+    const Dictionary* _findDictionary(uint32_t dictionaryId) const;
+
+    // Built once on construction and never modified, so they can be read without a lock.
+    std::vector<std::unique_ptr<Dictionary>> _dictionaries;
+};
+
+}  // namespace mongo
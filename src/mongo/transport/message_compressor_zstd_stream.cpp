@@ -0,0 +1,203 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd_stream.h"
+
+#include <memory>
+
+#include <zstd.h>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/base/init.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// Every block zstd flushes carries a header, which ZSTD_compressBound() doesn't account for when
+// the data is split across flushes.
+constexpr size_t kFlushOverhead = 32;
+
+Status zstdError(StringData what, size_t ret) {
+    return {ErrorCodes::BadValue, str::stream() << what << ": " << ZSTD_getErrorName(ret)};
+}
+
+class CompressionStream final : public MessageCompressorBase::StreamContext {
+public:
+    CompressionStream() : _cctx(ZSTD_createCCtx()) {
+        invariant(_cctx);
+        invariant(!ZSTD_isError(
+            ZSTD_CCtx_setParameter(_cctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT)));
+        invariant(!ZSTD_isError(ZSTD_CCtx_setParameter(
+            _cctx, ZSTD_c_windowLog, ZstdStreamMessageCompressor::kWindowLog)));
+    }
+
+    ~CompressionStream() {
+        ZSTD_freeCCtx(_cctx);
+    }
+
+    ZSTD_CCtx* get() {
+        return _cctx;
+    }
+
+private:
+    ZSTD_CCtx* _cctx;
+};
+
+class DecompressionStream final : public MessageCompressorBase::StreamContext {
+public:
+    DecompressionStream() : _dctx(ZSTD_createDCtx()) {
+        invariant(_dctx);
+        invariant(!ZSTD_isError(ZSTD_DCtx_setParameter(
+            _dctx, ZSTD_d_windowLogMax, ZstdStreamMessageCompressor::kWindowLog)));
+    }
+
+    ~DecompressionStream() {
+        ZSTD_freeDCtx(_dctx);
+    }
+
+    ZSTD_DCtx* get() {
+        return _dctx;
+    }
+
+private:
+    ZSTD_DCtx* _dctx;
+};
+
+}  // namespace
+
+ZstdStreamMessageCompressor::ZstdStreamMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZstdStream) {}
+
+std::size_t ZstdStreamMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize) + kFlushOverhead;
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::compressData(ConstDataRange input,
+                                                                  DataRange output) {
+    // Without a stream, a message is a zstd frame of its own.
+    size_t ret = ZSTD_compress(const_cast<char*>(output.data()),
+                               output.length(),
+                               input.data(),
+                               input.length(),
+                               ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(ret)) {
+        return zstdError("Could not compress input", ret);
+    }
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::decompressData(ConstDataRange input,
+                                                                    DataRange output) {
+    size_t ret = ZSTD_decompress(
+        const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+    if (ZSTD_isError(ret)) {
+        return zstdError("Could not decompress message", ret);
+    }
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+std::unique_ptr<MessageCompressorBase::StreamContext>
+ZstdStreamMessageCompressor::makeCompressionStream() {
+    return std::make_unique<CompressionStream>();
+}
+
+std::unique_ptr<MessageCompressorBase::StreamContext>
+ZstdStreamMessageCompressor::makeDecompressionStream() {
+    return std::make_unique<DecompressionStream>();
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::compressDataInStream(StreamContext* stream,
+                                                                          ConstDataRange input,
+                                                                          DataRange output) {
+    auto cctx = checked_cast<CompressionStream*>(stream)->get();
+    ZSTD_inBuffer in{input.data(), input.length(), 0};
+    ZSTD_outBuffer out{const_cast<char*>(output.data()), output.length(), 0};
+
+    // Flushing makes everything compressed so far decodable, without ending the frame, so the
+    // next message is still compressed against this one.
+    size_t remaining;
+    do {
+        remaining = ZSTD_compressStream2(cctx, &out, &in, ZSTD_e_flush);
+        if (ZSTD_isError(remaining)) {
+            return zstdError("Could not compress input", remaining);
+        }
+    } while (remaining != 0 && out.pos < out.size);
+
+    if (remaining != 0) {
+        return {ErrorCodes::BadValue, "Compressed message does not fit in the output buffer"};
+    }
+    counterHitCompress(input.length(), out.pos);
+    return {out.pos};
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::decompressDataInStream(StreamContext* stream,
+                                                                            ConstDataRange input,
+                                                                            DataRange output) {
+    auto dctx = checked_cast<DecompressionStream*>(stream)->get();
+    ZSTD_inBuffer in{input.data(), input.length(), 0};
+    ZSTD_outBuffer out{const_cast<char*>(output.data()), output.length(), 0};
+
+    // Consume the whole message, then keep going while the decoder still has output buffered.
+    while (true) {
+        auto inBefore = in.pos;
+        auto outBefore = out.pos;
+        size_t ret = ZSTD_decompressStream(dctx, &out, &in);
+        if (ZSTD_isError(ret)) {
+            return zstdError("Could not decompress message", ret);
+        }
+        if (in.pos == in.size && (out.pos == out.size || out.pos == outBefore)) {
+            break;
+        }
+        if (in.pos == inBefore && out.pos == outBefore) {
+            return {ErrorCodes::BadValue, "Decompressed message does not fit in the output buffer"};
+        }
+    }
+
+    counterHitDecompress(input.length(), out.pos);
+    return {out.pos};
+}
+
+MONGO_INITIALIZER_GENERAL(ZstdStreamMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(std::make_unique<ZstdStreamMessageCompressor>());
+    return Status::OK();
+}
+
+}  // namespace mongo
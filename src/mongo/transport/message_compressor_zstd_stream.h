@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/transport/message_compressor_base.h"
+
+namespace mongo {
+
+/**
+ * A zstd compressor that compresses all the messages of one direction of a connection as a single
+ * zstd stream, flushed after every message. Each message is compressed against the window of data
+ * sent before it, so a stream of similar messages, such as the batches of an oplog tailing
+ * cursor, compresses much better than with per-message zstd.
+ *
+ * The MessageCompressorManager of each connection owns the stream contexts. Since the peer must
+ * see every message in the order it was compressed, a connection whose stream fails to compress
+ * or decompress a message can't be used any further.
+ */
+class ZstdStreamMessageCompressor final : public MessageCompressorBase {
+public:
+    // The window each message can refer back into. Decompressing takes a buffer of this size per
+    // connection, and compressing a bit more.
+    static constexpr int kWindowLog = 20;
+
+    ZstdStreamMessageCompressor();
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+    std::unique_ptr<StreamContext> makeCompressionStream() override;
+
+    std::unique_ptr<StreamContext> makeDecompressionStream() override;
+
+    StatusWith<std::size_t> compressDataInStream(StreamContext* stream,
+                                                 ConstDataRange input,
+                                                 DataRange output) override;
+
+    StatusWith<std::size_t> decompressDataInStream(StreamContext* stream,
+                                                   ConstDataRange input,
+                                                   DataRange output) override;
+};
+
+}  // namespace mongo
@@ -38,8 +38,11 @@
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/service_executor_work_stealing.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/interruptible.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 #include <asio.hpp>
 
@@ -177,6 +180,63 @@ protected:
     std::unique_ptr<ServiceExecutorSynchronous> executor;
 };
 
+struct WorkStealingTestOptions : public ServiceExecutorWorkStealing::Options {
+    int workerThreads() const final {
+        return numWorkers;
+    }
+
+    int reactorThreads() const final {
+        return 1;
+    }
+
+    bool pinThreads() const final {
+        return false;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return stuckTimeout;
+    }
+
+    int recursionLimit() const final {
+        return 0;
+    }
+
+    int maxHandedOffThreads() const final {
+        return maxHandedOff;
+    }
+
+    int numWorkers = 2;
+    Milliseconds stuckTimeout{10};
+    int maxHandedOff = 16;
+};
+
+class ServiceExecutorWorkStealingFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = ServiceContext::make();
+        setGlobalServiceContext(std::move(scOwned));
+    }
+
+    void makeExecutor(int numWorkers,
+                      Milliseconds stuckTimeout = Milliseconds{10},
+                      int maxHandedOff = 16) {
+        auto configOwned = std::make_unique<WorkStealingTestOptions>();
+        configOwned->numWorkers = numWorkers;
+        configOwned->stuckTimeout = stuckTimeout;
+        configOwned->maxHandedOff = maxHandedOff;
+        executor = std::make_unique<ServiceExecutorWorkStealing>(
+            getGlobalServiceContext(), std::make_shared<ASIOReactor>(), std::move(configOwned));
+    }
+
+    BSONObj getStats() {
+        BSONObjBuilder bob;
+        executor->appendStats(&bob);
+        return bob.obj();
+    }
+
+    std::unique_ptr<ServiceExecutorWorkStealing> executor;
+};
+
 void scheduleBasicTask(ServiceExecutor* exec, bool expectSuccess) {
     stdx::condition_variable cond;
     auto mutex = MONGO_MAKE_LATCH();
@@ -218,6 +278,127 @@ TEST_F(ServiceExecutorSynchronousFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorWorkStealingFixture, BasicTaskRuns) {
+    makeExecutor(2);
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, ScheduleFailsBeforeStartup) {
+    makeExecutor(2);
+    scheduleBasicTask(executor.get(), false);
+}
+
+/**
+ * Runs a task on the executor which queues a second task behind itself on its own run queue and
+ * then waits for that second task to run, using the given wait function. This can only make
+ * progress if another thread takes over the queue of the waiting worker.
+ */
+template <typename WaitFn>
+void scheduleTaskWaitingOnItsQueue(ServiceExecutor* exec, WaitFn&& wait) {
+    auto mutex = MONGO_MAKE_LATCH();
+    stdx::condition_variable cond;
+    bool followUpRan = false;
+    bool done = false;
+
+    auto task = [&] {
+        auto followUp = [&] {
+            stdx::lock_guard<Latch> lk(mutex);
+            followUpRan = true;
+            cond.notify_all();
+        };
+        ASSERT_OK(exec->schedule(std::move(followUp),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMProcessMessage));
+
+        stdx::unique_lock<Latch> lk(mutex);
+        wait(cond, lk, [&] { return followUpRan; });
+        done = true;
+        cond.notify_all();
+    };
+
+    ASSERT_OK(exec->schedule(
+        std::move(task), ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMStartSession));
+
+    stdx::unique_lock<Latch> lk(mutex);
+    cond.wait(lk, [&] { return done; });
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, IdleWorkerStealsFromBusyWorker) {
+    makeExecutor(2);
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleTaskWaitingOnItsQueue(executor.get(), [](auto& cond, auto& lk, auto pred) {
+        cond.wait(lk, pred);
+    });
+    ASSERT_GTE(getStats()["totalStolen"].numberLong(), 1);
+    ASSERT_EQ(getStats()["handOffs"]["stuck"].numberLong(), 0);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, BlockedWorkerHandsOffItsQueue) {
+    // Keep stuck thread detection out of the way of the Interruptible hooks.
+    makeExecutor(1, Minutes{1});
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleTaskWaitingOnItsQueue(executor.get(), [](auto& cond, auto& lk, auto pred) {
+        Interruptible::notInterruptible()->waitForConditionOrInterrupt(cond, lk, pred);
+    });
+    ASSERT_GTE(getStats()["handOffs"]["blocked"].numberLong(), 1);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, StuckWorkerHandsOffItsQueue) {
+    makeExecutor(1);
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    // A plain condition variable wait is invisible to the Interruptible hooks, so only the
+    // controller's stuck thread detection can get the queue going again.
+    scheduleTaskWaitingOnItsQueue(executor.get(), [](auto& cond, auto& lk, auto pred) {
+        cond.wait(lk, pred);
+    });
+    ASSERT_GTE(getStats()["handOffs"]["stuck"].numberLong(), 1);
+}
+
+TEST_F(ServiceExecutorWorkStealingFixture, StuckWorkerKeepsItsQueueAtHandOffLimit) {
+    makeExecutor(1, Milliseconds{10}, 0);
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    auto mutex = MONGO_MAKE_LATCH();
+    stdx::condition_variable cond;
+    bool release = false;
+    bool followUpRan = false;
+
+    auto task = [&] {
+        auto followUp = [&] {
+            stdx::lock_guard<Latch> lk(mutex);
+            followUpRan = true;
+            cond.notify_all();
+        };
+        ASSERT_OK(executor->schedule(std::move(followUp),
+                                     ServiceExecutor::kEmptyFlags,
+                                     ServiceExecutorTaskName::kSSMProcessMessage));
+
+        stdx::unique_lock<Latch> lk(mutex);
+        cond.wait(lk, [&] { return release; });
+    };
+    ASSERT_OK(executor->schedule(
+        std::move(task), ServiceExecutor::kEmptyFlags, ServiceExecutorTaskName::kSSMStartSession));
+
+    // Give the controller plenty of chances to find the worker stuck.
+    sleepFor(Milliseconds{200});
+    ASSERT_EQ(getStats()["handOffs"]["stuck"].numberLong(), 0);
+
+    stdx::unique_lock<Latch> lk(mutex);
+    release = true;
+    cond.notify_all();
+    cond.wait(lk, [&] { return followUpRan; });
+    ASSERT_EQ(getStats()["handOffs"]["stuck"].numberLong(), 0);
+}
 
 }  // namespace
 }  // namespace mongo
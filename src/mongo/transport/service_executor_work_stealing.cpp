@@ -0,0 +1,643 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_work_stealing.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/base/init.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/random.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/transport/service_executor_gen.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/interruptible.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kThreadsParked = "threadsParked"_sd;
+constexpr auto kRunQueues = "runQueues"_sd;
+constexpr auto kTasksQueued = "tasksQueued"_sd;
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kHandOffs = "handOffs"_sd;
+constexpr auto kBlocked = "blocked"_sd;
+constexpr auto kStuck = "stuck"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "workStealing"_sd;
+
+// How long a reactor thread runs the event loop before checking whether the executor is still
+// running.
+constexpr Milliseconds kReactorRunTime{1000};
+
+thread_local PseudoRandom threadPrng{SecureRandom().nextInt64()};
+
+struct ServerParameterOptions : public ServiceExecutorWorkStealing::Options {
+    int workerThreads() const final {
+        int value = workStealingServiceExecutorWorkerThreads.load();
+        if (value <= 0) {
+            value = std::max(static_cast<int>(ProcessInfo::getNumAvailableCores()), 1);
+        }
+        return value;
+    }
+
+    int reactorThreads() const final {
+        int value = workStealingServiceExecutorReactorThreads.load();
+        if (value <= 0) {
+            value = std::max(static_cast<int>(ProcessInfo::getNumAvailableCores() / 4), 1);
+        }
+        return value;
+    }
+
+    bool pinThreads() const final {
+        return workStealingServiceExecutorPinThreads.load();
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return Milliseconds{workStealingServiceExecutorStuckThreadTimeoutMillis.load()};
+    }
+
+    int maxHandedOffThreads() const final {
+        return workStealingServiceExecutorMaxHandedOffThreads.load();
+    }
+
+    int recursionLimit() const final {
+        return workStealingServiceExecutorRecursionLimit.load();
+    }
+};
+
+#ifdef __linux__
+std::vector<int> getAllowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+void pinCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+        LOGV2_WARNING(5097129,
+                      "Failed to pin service worker thread to CPU",
+                      "cpu"_attr = cpu,
+                      "error"_attr = errnoWithDescription(err));
+    }
+}
+#else
+std::vector<int> getAllowedCpus() {
+    return {};
+}
+
+void pinCurrentThread(int) {}
+#endif
+
+}  // namespace
+
+class ServiceExecutorWorkStealing::WaitListener : public Interruptible::WaitListener {
+public:
+    void onLongSleep(const StringData& name) override {
+        auto worker = _localWorker;
+        if (!worker || worker->taskStarted == 0) {
+            return;
+        }
+
+        // Once handed off, this thread is no longer a worker as far as the rest of its task is
+        // concerned, so anything that task schedules goes through the run queues.
+        if (worker->executor->_handOff(
+                worker->queue, worker->taskStarted, HandOffReason::kBlocked)) {
+            _localWorker = nullptr;
+        }
+    }
+
+    void onWake(const StringData& name,
+                Interruptible::WakeReason reason,
+                Interruptible::WakeSpeed speed) override {}
+};
+
+MONGO_INITIALIZER(ServiceExecutorWorkStealingWaitListener)(InitializerContext* context) {
+    Interruptible::installWaitListener<ServiceExecutorWorkStealing::WaitListener>();
+    return Status::OK();
+}
+
+thread_local ServiceExecutorWorkStealing::LocalWorker* ServiceExecutorWorkStealing::_localWorker =
+    nullptr;
+
+ServiceExecutorWorkStealing::ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                                         ReactorHandle reactor)
+    : ServiceExecutorWorkStealing(
+          ctx, std::move(reactor), std::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorWorkStealing::ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                                         ReactorHandle reactor,
+                                                         std::unique_ptr<Options> config)
+    : _reactorHandle(std::move(reactor)),
+      _config(std::move(config)),
+      _tickSource(ctx->getTickSource()) {}
+
+ServiceExecutorWorkStealing::~ServiceExecutorWorkStealing() {
+    invariant(!_stillRunning.load());
+}
+
+Status ServiceExecutorWorkStealing::start() {
+    invariant(!_stillRunning.load());
+
+    const auto numQueues = static_cast<size_t>(std::max(_config->workerThreads(), 1));
+    const auto cpus = _config->pinThreads() ? getAllowedCpus() : std::vector<int>{};
+    for (size_t i = 0; i < numQueues; ++i) {
+        auto queue = std::make_unique<RunQueue>();
+        if (!cpus.empty()) {
+            queue->cpu = cpus[i % cpus.size()];
+        }
+        _queues.push_back(std::move(queue));
+    }
+
+    LOGV2(5097130,
+          "Starting work-stealing service executor",
+          "runQueues"_attr = numQueues,
+          "reactorThreads"_attr = _config->reactorThreads(),
+          "pinned"_attr = !cpus.empty());
+
+    _stillRunning.store(true);
+
+    for (size_t i = 0; i < numQueues; ++i) {
+        auto status = _launchWorker(i, 0);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    for (int i = 0; i < _config->reactorThreads(); ++i) {
+        _reactorThreads.emplace_back(&ServiceExecutorWorkStealing::_reactorThreadRoutine, this, i);
+    }
+
+    _controllerThread = stdx::thread(&ServiceExecutorWorkStealing::_controllerThreadRoutine, this);
+
+    return Status::OK();
+}
+
+Status ServiceExecutorWorkStealing::shutdown(Milliseconds timeout) {
+    if (!_stillRunning.load())
+        return Status::OK();
+
+    LOGV2_DEBUG(5097131, 3, "Shutting down work-stealing executor");
+
+    _stillRunning.store(false);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_controllerMutex);  // NOLINT
+        _controllerCondition.notify_one();
+    }
+    _controllerThread.join();
+
+    _reactorHandle->stop();
+    for (auto& thread : _reactorThreads) {
+        thread.join();
+    }
+    _reactorThreads.clear();
+
+    for (auto& queue : _queues) {
+        stdx::lock_guard<Latch> lk(queue->mutex);
+        queue->cv.notify_all();
+    }
+
+    stdx::unique_lock<Latch> lock(_shutdownMutex);
+    bool result = _shutdownCondition.wait_for(lock, timeout.toSystemDuration(), [this]() {
+        return _numRunningWorkerThreads.load() == 0;
+    });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "work-stealing executor couldn't shutdown all worker threads within time limit.");
+}
+
+Status ServiceExecutorWorkStealing::schedule(Task task,
+                                             ScheduleFlags flags,
+                                             ServiceExecutorTaskName taskName) {
+    if (!_stillRunning.load()) {
+        return Status{ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    // A thread whose queue was handed off while it was stuck in a task is not told so until that
+    // task returns, so its follow-up work must not run inline or stay on that queue either.
+    auto worker = _localWorker;
+    if (!worker || worker->executor != this ||
+        worker->generation != _queues[worker->queue]->generation.load()) {
+        // Work arriving from the reactor goes to the shorter of two randomly chosen queues, which
+        // keeps the longest queue close to the average without scanning all of them.
+        _push(_pickQueue(), std::move(task), false);
+        return Status::OK();
+    }
+
+    // Execute task directly (recurse) if allowed by the caller. Try to limit the amount of
+    // recursion so we don't blow up the stack.
+    if ((flags & ScheduleFlags::kMayRecurse) &&
+        (worker->recursionDepth < _config->recursionLimit())) {
+        ++worker->recursionDepth;
+        task();
+        --worker->recursionDepth;
+        return Status::OK();
+    }
+
+    // Keep follow-up work for a session on the queue of the worker that ran it.
+    _push(worker->queue, std::move(task), true);
+    return Status::OK();
+}
+
+void ServiceExecutorWorkStealing::appendStats(BSONObjBuilder* bob) const {
+    size_t tasksQueued = 0;
+    for (auto& queue : _queues) {
+        tasksQueued += queue->size.loadRelaxed();
+    }
+
+    *bob << kExecutorLabel << kExecutorName  //
+         << kThreadsRunning << static_cast<int>(_numRunningWorkerThreads.loadRelaxed())
+         << kThreadsParked << static_cast<int>(_numParked.loadRelaxed())  //
+         << kRunQueues << static_cast<int>(_queues.size())                 //
+         << kTasksQueued << static_cast<long long>(tasksQueued)            //
+         << kTotalQueued << _totalQueued.loadRelaxed()                     //
+         << kTotalExecuted << _totalExecuted.loadRelaxed()                 //
+         << kTotalStolen << _totalStolen.loadRelaxed();
+
+    BSONObjBuilder handOffs(bob->subobjStart(kHandOffs));
+    handOffs << kBlocked << _blockedHandOffs.loadRelaxed() << kStuck
+             << _stuckHandOffs.loadRelaxed();
+    handOffs.doneFast();
+}
+
+Status ServiceExecutorWorkStealing::_launchWorker(size_t queue, uint64_t generation) {
+    _numRunningWorkerThreads.addAndFetch(1);
+
+    auto status = launchServiceWorkerThread(
+        [this, queue, generation] { _workerThreadRoutine(queue, generation); });
+    if (!status.isOK()) {
+        stdx::lock_guard<Latch> lk(_shutdownMutex);
+        if (_numRunningWorkerThreads.subtractAndFetch(1) == 0) {
+            _shutdownCondition.notify_all();
+        }
+    }
+
+    return status;
+}
+
+void ServiceExecutorWorkStealing::_workerThreadRoutine(size_t queue, uint64_t generation) {
+    setThreadName(str::stream() << "workStealing-" << queue);
+
+    auto& runQueue = *_queues[queue];
+    if (runQueue.cpu >= 0) {
+        pinCurrentThread(runQueue.cpu);
+    }
+
+    LocalWorker self{this, queue, generation, 0, 0};
+    _localWorker = &self;
+
+    // A hand-off bumps the generation of the queue, after which this thread only finishes the
+    // task it is running and leaves the queue to its replacement.
+    while (_stillRunning.load() && runQueue.generation.load() == generation) {
+        Task task;
+        if (!_pop(queue, &task) && !_steal(queue, &task)) {
+            _park(queue, generation);
+            continue;
+        }
+
+        // Never 0 or kHandedOff, so that a hand-off can tell a running task apart.
+        self.taskStarted = std::max(_tickSource->getTicks(), TickSource::Tick{1});
+        runQueue.taskStarted.store(self.taskStarted);
+        self.recursionDepth = 1;
+        task();
+        _totalExecuted.addAndFetch(1);
+
+        // Failing to swap the start time back out means a hand-off claimed this task, and the
+        // queue now belongs to the replacement thread.
+        auto started = std::exchange(self.taskStarted, 0);
+        if (!runQueue.taskStarted.compareAndSwap(&started, 0)) {
+            break;
+        }
+    }
+
+    _localWorker = nullptr;
+
+    stdx::lock_guard<Latch> lk(_shutdownMutex);
+    if (_numRunningWorkerThreads.subtractAndFetch(1) == 0) {
+        _shutdownCondition.notify_all();
+    }
+}
+
+void ServiceExecutorWorkStealing::_reactorThreadRoutine(size_t index) {
+    setThreadName(str::stream() << "workStealingReactor-" << index);
+
+    while (_stillRunning.load()) {
+        _reactorHandle->runFor(kReactorRunTime);
+    }
+}
+
+void ServiceExecutorWorkStealing::_controllerThreadRoutine() {
+    setThreadName("workStealingController"_sd);
+
+    while (_stillRunning.load()) {
+        const auto stuckThreadTimeout = _config->stuckThreadTimeout();
+
+        std::vector<std::pair<size_t, uint64_t>> launches;
+        {
+            stdx::unique_lock<stdx::mutex> lk(_controllerMutex);  // NOLINT
+            _controllerCondition.wait_for(lk, stuckThreadTimeout.toSystemDuration(), [&] {
+                return !_pendingLaunches.empty() || !_stillRunning.load();
+            });
+            launches = std::exchange(_pendingLaunches, {});
+        }
+
+        if (!_stillRunning.load()) {
+            break;
+        }
+
+        for (auto&& [queue, generation] : launches) {
+            // A queue that has been handed off again since this launch was requested already has
+            // a newer replacement coming.
+            if (_queues[queue]->generation.load() != generation) {
+                continue;
+            }
+
+            auto status = _launchWorker(queue, generation);
+            if (!status.isOK()) {
+                LOGV2_WARNING(5097132,
+                              "Failed to start a replacement service worker thread, will retry",
+                              "queue"_attr = queue,
+                              "error"_attr = status);
+                stdx::lock_guard<stdx::mutex> lk(_controllerMutex);  // NOLINT
+                _pendingLaunches.emplace_back(queue, generation);
+                continue;
+            }
+
+            // Tasks may have been pushed while the queue had no thread to drain it.
+            auto& runQueue = *_queues[queue];
+            stdx::lock_guard<Latch> lk(runQueue.mutex);
+            runQueue.cv.notify_all();
+        }
+
+        // Threads that block outside of an interruptible wait, such as in disk or network I/O,
+        // are caught here once tasks have been waiting behind them for long enough. A parked
+        // worker is cheaper than a new thread, so have one steal those tasks if there is one.
+        const auto now = _tickSource->getTicks();
+        const auto stuckTicks = _tickSource->getTicksPerSecond() *
+            durationCount<Milliseconds>(stuckThreadTimeout) / 1000;
+        for (size_t i = 0; i < _queues.size(); ++i) {
+            auto& runQueue = *_queues[i];
+            auto started = runQueue.taskStarted.load();
+            if (started <= 0 || now - started < stuckTicks || runQueue.size.load() == 0) {
+                continue;
+            }
+
+            if (_numParked.load() > 0) {
+                _wakeParkedWorker();
+                continue;
+            }
+
+            _handOff(i, started, HandOffReason::kStuck);
+        }
+    }
+}
+
+bool ServiceExecutorWorkStealing::_handOff(size_t queue,
+                                           TickSource::Tick taskStarted,
+                                           HandOffReason reason) {
+    // This may run from inside an Interruptible wait with arbitrary latches held, so it must not
+    // acquire any latch itself.
+    const auto maxThreads =
+        _queues.size() + static_cast<size_t>(std::max(_config->maxHandedOffThreads(), 0));
+    if (_numRunningWorkerThreads.load() >= maxThreads) {
+        return false;
+    }
+
+    // Only hand off the very task that was found blocked or stuck. If its thread has moved on in
+    // the meantime it may be parked, and would otherwise be stranded alongside its replacement.
+    auto& runQueue = *_queues[queue];
+    if (!runQueue.taskStarted.compareAndSwap(&taskStarted, kHandedOff)) {
+        return false;
+    }
+    const auto generation = runQueue.generation.addAndFetch(1);
+
+    const bool blocked = reason == HandOffReason::kBlocked;
+    (blocked ? _blockedHandOffs : _stuckHandOffs).addAndFetch(1);
+    LOGV2_DEBUG(5097133,
+                2,
+                "Handing off service executor run queue to a new thread",
+                "queue"_attr = queue,
+                "reason"_attr = blocked ? kBlocked : kStuck);
+
+    stdx::lock_guard<stdx::mutex> lk(_controllerMutex);  // NOLINT
+    _pendingLaunches.emplace_back(queue, generation);
+    _controllerCondition.notify_one();
+    return true;
+}
+
+void ServiceExecutorWorkStealing::_push(size_t queue, Task task, bool fromOwner) {
+    _totalQueued.addAndFetch(1);
+
+    auto& runQueue = *_queues[queue];
+    size_t size;
+    {
+        stdx::lock_guard<Latch> lk(runQueue.mutex);
+        runQueue.tasks.push_back(std::move(task));
+        size = runQueue.tasks.size();
+        runQueue.size.store(size);
+
+        if (runQueue.parked.load()) {
+            runQueue.parked.store(false);
+            _numParked.subtractAndFetch(1);
+            runQueue.cv.notify_one();
+            return;
+        }
+    }
+
+    // The owner of a queue gets to a lone task as soon as it returns from the one it is running,
+    // so only recruit a parked worker when work is actually waiting behind a busy one.
+    if ((!fromOwner || size > 1) && _numParked.load() > 0) {
+        _wakeParkedWorker();
+    }
+}
+
+bool ServiceExecutorWorkStealing::_pop(size_t queue, Task* task) {
+    auto& runQueue = *_queues[queue];
+    stdx::lock_guard<Latch> lk(runQueue.mutex);
+    if (runQueue.tasks.empty()) {
+        return false;
+    }
+
+    *task = std::move(runQueue.tasks.front());
+    runQueue.tasks.pop_front();
+    runQueue.size.store(runQueue.tasks.size());
+    return true;
+}
+
+bool ServiceExecutorWorkStealing::_steal(size_t queue, Task* task) {
+    const auto numQueues = _queues.size();
+    if (numQueues == 1) {
+        return false;
+    }
+
+    const auto start = static_cast<size_t>(threadPrng.nextInt64(numQueues));
+    for (size_t i = 0; i < numQueues; ++i) {
+        const auto victimIndex = (start + i) % numQueues;
+        auto& victim = *_queues[victimIndex];
+        if (victimIndex == queue || victim.size.load() == 0) {
+            continue;
+        }
+
+        // Take the newer half of the victim's queue, leaving the older tasks to its owner.
+        std::vector<Task> stolen;
+        {
+            stdx::lock_guard<Latch> lk(victim.mutex);
+            const auto count = (victim.tasks.size() + 1) / 2;
+            if (count == 0) {
+                continue;
+            }
+
+            auto first = victim.tasks.end() - count;
+            std::move(first, victim.tasks.end(), std::back_inserter(stolen));
+            victim.tasks.erase(first, victim.tasks.end());
+            victim.size.store(victim.tasks.size());
+        }
+
+        _totalStolen.addAndFetch(stolen.size());
+        *task = std::move(stolen.front());
+
+        if (stolen.size() > 1) {
+            auto& runQueue = *_queues[queue];
+            stdx::lock_guard<Latch> lk(runQueue.mutex);
+            std::move(
+                std::next(stolen.begin()), stolen.end(), std::back_inserter(runQueue.tasks));
+            runQueue.size.store(runQueue.tasks.size());
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void ServiceExecutorWorkStealing::_park(size_t queue, uint64_t generation) {
+    auto& runQueue = *_queues[queue];
+    stdx::unique_lock<Latch> lk(runQueue.mutex);
+    if (!runQueue.tasks.empty()) {
+        return;
+    }
+
+    auto unpark = [&] {
+        if (runQueue.parked.load()) {
+            runQueue.parked.store(false);
+            _numParked.subtractAndFetch(1);
+        }
+    };
+
+    runQueue.parked.store(true);
+    _numParked.addAndFetch(1);
+
+    // Look for work again now that we are visible as parked. A task pushed onto a busy queue
+    // before its scheduler could see us parked would otherwise wait for that queue's owner.
+    lk.unlock();
+    const bool workAvailable = std::any_of(
+        _queues.begin(), _queues.end(), [](auto& other) { return other->size.load() > 0; });
+    lk.lock();
+
+    if (workAvailable) {
+        unpark();
+        return;
+    }
+
+    MONGO_IDLE_THREAD_BLOCK;
+    runQueue.cv.wait(lk, [&] {
+        return !runQueue.parked.load() || !_stillRunning.load() ||
+            runQueue.generation.load() != generation;
+    });
+    unpark();
+}
+
+void ServiceExecutorWorkStealing::_wakeParkedWorker() {
+    const auto numQueues = _queues.size();
+    const auto start = static_cast<size_t>(threadPrng.nextInt64(numQueues));
+    for (size_t i = 0; i < numQueues; ++i) {
+        auto& runQueue = *_queues[(start + i) % numQueues];
+        if (!runQueue.parked.loadRelaxed()) {
+            continue;
+        }
+
+        stdx::lock_guard<Latch> lk(runQueue.mutex);
+        if (runQueue.parked.load()) {
+            runQueue.parked.store(false);
+            _numParked.subtractAndFetch(1);
+            runQueue.cv.notify_one();
+            return;
+        }
+    }
+}
+
+size_t ServiceExecutorWorkStealing::_pickQueue() {
+    const auto numQueues = _queues.size();
+    if (numQueues == 1) {
+        return 0;
+    }
+
+    const auto first = static_cast<size_t>(threadPrng.nextInt64(numQueues));
+    auto second = static_cast<size_t>(threadPrng.nextInt64(numQueues - 1));
+    if (second >= first) {
+        ++second;
+    }
+
+    return _queues[first]->size.loadRelaxed() <= _queues[second]->size.loadRelaxed() ? first
+                                                                                        : second;
+}
+
+}  // namespace transport
+}  // namespace mongo
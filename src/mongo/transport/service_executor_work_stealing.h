@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/util/hierarchical_acquisition.h"
+#include "mongo/util/tick_source.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * The work-stealing service executor runs tasks on a fixed set of run queues, one per core by
+ * default, each of which is drained by a single worker thread. Networking is asynchronous, so an
+ * idle connection holds no thread at all: its pending read lives in the reactor, which is run by
+ * a small number of dedicated reactor threads that push completed work onto the run queues.
+ *
+ * Tasks scheduled from a worker stay on that worker's queue to keep a session on the same core.
+ * Tasks scheduled from anywhere else go to the shorter of two randomly chosen queues. A worker
+ * whose queue is empty steals half of the tasks of another queue before parking.
+ *
+ * A worker that blocks while running a task hands its queue off to a freshly started thread and
+ * exits once the task completes. Blocking is detected cooperatively, through the Interruptible
+ * wait hooks which fire once a thread has waited for longer than
+ * Interruptible::kFastWakeTimeout, and by a controller thread which hands off any queue whose
+ * worker has been running a single task for longer than the stuck thread timeout while other
+ * tasks are waiting behind it.
+ */
+class ServiceExecutorWorkStealing final : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        // The number of run queues, and therefore of unblocked worker threads.
+        virtual int workerThreads() const = 0;
+
+        // The number of threads running the reactor's event loop.
+        virtual int reactorThreads() const = 0;
+
+        // Whether the worker threads of each run queue are pinned to a single CPU.
+        virtual bool pinThreads() const = 0;
+
+        // The amount of time a worker may run a single task while its queue is not empty before
+        // the controller thread hands that queue off to a new thread.
+        virtual Milliseconds stuckThreadTimeout() const = 0;
+
+        // The number of threads which may be finishing a task after handing their queue off, on
+        // top of one thread per run queue.
+        virtual int maxHandedOffThreads() const = 0;
+
+        // The maximum allowable depth of recursion for tasks scheduled with the MayRecurse flag
+        // before stack unwinding is forced.
+        virtual int recursionLimit() const = 0;
+    };
+
+    /**
+     * Installed as an Interruptible::WaitListener at startup so that a worker thread which blocks
+     * in an interruptible wait hands its run queue off. It is a no-op on every other thread.
+     */
+    class WaitListener;
+
+    ServiceExecutorWorkStealing(ServiceContext* ctx, ReactorHandle reactor);
+    ServiceExecutorWorkStealing(ServiceContext* ctx,
+                                ReactorHandle reactor,
+                                std::unique_ptr<Options> config);
+    ~ServiceExecutorWorkStealing();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    struct RunQueue {
+        Mutex mutex = MONGO_MAKE_LATCH("ServiceExecutorWorkStealing::RunQueue::mutex");
+        stdx::condition_variable cv;
+        std::deque<Task> tasks;
+
+        // Set by the owning thread while it waits for work and cleared, under the mutex, by
+        // whoever wakes it. May be read without the mutex as a hint.
+        AtomicWord<bool> parked{false};
+
+        // Mirrors tasks.size() so that schedulers and thieves can pick a queue without locking.
+        AtomicWord<size_t> size{0};
+
+        // Identifies the thread currently draining this queue. Bumped on every hand-off, after
+        // which the previous thread exits as soon as it returns to its run loop.
+        AtomicWord<uint64_t> generation{0};
+
+        // When the current task of the owning thread started, 0 when it is between tasks, or
+        // kHandedOff once that task has been claimed by a hand-off. Both the owner finishing a
+        // task and a hand-off swap this out from the start time, so exactly one of them wins.
+        AtomicWord<TickSource::Tick> taskStarted{0};
+
+        // The CPU the threads of this queue are pinned to, or -1.
+        int cpu = -1;
+    };
+
+    /**
+     * Identifies the run queue the current thread is draining, if it is a worker.
+     */
+    struct LocalWorker {
+        ServiceExecutorWorkStealing* executor;
+        size_t queue;
+        uint64_t generation;
+        int recursionDepth;
+
+        // The start time of the task this thread is running, as stored in RunQueue::taskStarted,
+        // or 0 between tasks.
+        TickSource::Tick taskStarted;
+    };
+
+    static constexpr TickSource::Tick kHandedOff = -1;
+
+    enum class HandOffReason { kBlocked, kStuck };
+
+    void _workerThreadRoutine(size_t queue, uint64_t generation);
+    void _reactorThreadRoutine(size_t index);
+    void _controllerThreadRoutine();
+
+    Status _launchWorker(size_t queue, uint64_t generation);
+    bool _handOff(size_t queue, TickSource::Tick taskStarted, HandOffReason reason);
+
+    void _push(size_t queue, Task task, bool fromOwner);
+    bool _pop(size_t queue, Task* task);
+    bool _steal(size_t queue, Task* task);
+    void _park(size_t queue, uint64_t generation);
+    void _wakeParkedWorker();
+
+    size_t _pickQueue();
+
+    static thread_local LocalWorker* _localWorker;
+
+    ReactorHandle _reactorHandle;
+    std::unique_ptr<Options> _config;
+    TickSource* _tickSource;
+
+    AtomicWord<bool> _stillRunning{false};
+
+    std::vector<std::unique_ptr<RunQueue>> _queues;
+    AtomicWord<size_t> _numParked{0};
+    AtomicWord<size_t> _nextQueue{0};
+
+    std::vector<stdx::thread> _reactorThreads;
+
+    // A raw mutex because hand-offs are requested from inside Interruptible waits, where the
+    // blocked thread may hold latches of any level.
+    stdx::mutex _controllerMutex;  // NOLINT
+    stdx::condition_variable _controllerCondition;
+    std::vector<std::pair<size_t, uint64_t>> _pendingLaunches;
+    stdx::thread _controllerThread;
+
+    mutable Mutex _shutdownMutex = MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0),
+                                                    "ServiceExecutorWorkStealing::_shutdownMutex");
+    stdx::condition_variable _shutdownCondition;
+    AtomicWord<size_t> _numRunningWorkerThreads{0};
+
+    AtomicWord<int64_t> _totalQueued{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+    AtomicWord<int64_t> _totalStolen{0};
+    AtomicWord<int64_t> _blockedHandOffs{0};
+    AtomicWord<int64_t> _stuckHandOffs{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
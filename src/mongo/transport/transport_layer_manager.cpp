@@ -27,6 +27,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kNetwork
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/transport/transport_layer_manager.h"
@@ -38,10 +40,14 @@
 #include "mongo/base/status.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
+#include "mongo/logv2/log.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_work_stealing.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
+#include "mongo/transport/transport_layer_uring.h"
+#include "mongo/util/net/ssl_options.h"
 #include "mongo/util/net/ssl_types.h"
 #include "mongo/util/time_support.h"
 
@@ -134,7 +140,7 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     auto sep = ctx->getServiceEntryPoint();
 
     transport::TransportLayerASIO::Options opts(config);
-    if (config->serviceExecutor == "adaptive") {
+    if (config->serviceExecutor == "adaptive" || config->serviceExecutor == "workStealing") {
         opts.transportMode = transport::Mode::kAsynchronous;
     } else if (config->serviceExecutor == "synchronous") {
         opts.transportMode = transport::Mode::kSynchronous;
@@ -142,15 +148,37 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         MONGO_UNREACHABLE;
     }
 
-    auto transportLayerASIO = std::make_unique<transport::TransportLayerASIO>(opts, sep);
+    if (config->transportLayer == "uring") {
+        bool sslEnabled = false;
+#ifdef MONGO_CONFIG_SSL
+        sslEnabled = getSSLGlobalParams().sslMode.load() != SSLParams::SSLMode_disabled;
+#endif
+        if (sslEnabled) {
+            LOGV2_WARNING(5097126,
+                          "The io_uring transport layer does not support TLS, using asio instead");
+        } else if (!transport::TransportLayerUring::isSupported()) {
+            LOGV2_WARNING(5097127,
+                          "The io_uring transport layer is not supported by this kernel, using "
+                          "asio instead");
+        } else {
+            transportLayer = std::make_unique<transport::TransportLayerUring>(opts, sep);
+        }
+    }
+
+    if (!transportLayer) {
+        transportLayer = std::make_unique<transport::TransportLayerASIO>(opts, sep);
+    }
 
     if (config->serviceExecutor == "adaptive") {
-        auto reactor = transportLayerASIO->getReactor(TransportLayer::kIngress);
+        auto reactor = transportLayer->getReactor(TransportLayer::kIngress);
         ctx->setServiceExecutor(std::make_unique<ServiceExecutorAdaptive>(ctx, std::move(reactor)));
+    } else if (config->serviceExecutor == "workStealing") {
+        auto reactor = transportLayer->getReactor(TransportLayer::kIngress);
+        ctx->setServiceExecutor(
+            std::make_unique<ServiceExecutorWorkStealing>(ctx, std::move(reactor)));
     } else if (config->serviceExecutor == "synchronous") {
         ctx->setServiceExecutor(std::make_unique<ServiceExecutorSynchronous>(ctx));
     }
-    transportLayer = std::move(transportLayerASIO);
 
     std::vector<std::unique_ptr<TransportLayer>> retVector;
     retVector.emplace_back(std::move(transportLayer));
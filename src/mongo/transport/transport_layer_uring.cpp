@@ -0,0 +1,1903 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+// Multishot recv is the newest io_uring feature this transport layer depends on, so its flag doubles
+// as the check that the kernel headers are recent enough for everything else.
+#ifdef IORING_RECV_MULTISHOT
+#define MONGO_TRANSPORT_HAVE_URING 1
+#endif
+
+#ifdef MONGO_TRANSPORT_HAVE_URING
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <deque>
+#include <set>
+
+#include "mongo/db/server_options.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/rpc/message.h"
+#include "mongo/stdx/unordered_set.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/net/socket_utils.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace transport {
+
+#ifdef MONGO_TRANSPORT_HAVE_URING
+
+namespace {
+
+// Submission queue depth of each ring. The completion queue is twice as deep.
+constexpr unsigned kRingEntries = 4096;
+
+// Receive buffers handed to the kernel for multishot recv. The count must be a power of two.
+constexpr uint16_t kRecvBufferGroup = 0;
+constexpr unsigned kRecvBufferCount = 512;
+constexpr size_t kRecvBufferSize = 16 * 1024;
+
+// A session stops reading ahead of its consumer once this many whole messages are queued.
+constexpr size_t kMaxReadAheadMessages = 16;
+
+// Reserved user_data values. Operations are otherwise identified by their address.
+constexpr uint64_t kIgnoredUserData = 0;
+constexpr uint64_t kWakeupUserData = 1;
+
+// How long a thread that cannot wait on the ring sleeps before checking it again.
+constexpr auto kIdleWaitInterval = Milliseconds(10);
+
+constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return ::syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(
+    int fd, unsigned toSubmit, unsigned minComplete, unsigned flags, const void* arg, size_t size) {
+    return ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, size);
+}
+
+int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned nrArgs) {
+    return ::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+Status errnoToStatus(int err) {
+    switch (err) {
+        case ECANCELED:
+            return {ErrorCodes::CallbackCanceled, "Callback was canceled"};
+        case EAGAIN:
+        case ETIME:
+            return {ErrorCodes::NetworkTimeout, "Socket operation timed out"};
+        case ECONNRESET:
+        case EPIPE:
+            return {ErrorCodes::HostUnreachable, "Connection reset by peer"};
+        case ENETRESET:
+            return {ErrorCodes::HostUnreachable, "Connection reset by network"};
+        default:
+            return {ErrorCodes::SocketException, errnoWithDescription(err)};
+    }
+}
+
+Status validateMessageLength(size_t msgLen) {
+    if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+        LOGV2(5097104,
+              "recv(): message msgLen {msgLen} is invalid. Min: {min} Max: {max}",
+              "msgLen"_attr = msgLen,
+              "min"_attr = kHeaderSize,
+              "max"_attr = MaxMessageSizeBytes);
+        return {ErrorCodes::ProtocolError,
+                str::stream() << "recv(): message msgLen " << msgLen << " is invalid. "
+                              << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes};
+    }
+    return Status::OK();
+}
+
+/**
+ * One io_uring instance: the mapped submission and completion rings and, optionally, a ring of
+ * provided receive buffers registered with the kernel.
+ *
+ * This class does no synchronization of its own. UringReactor serializes the submission side and
+ * the completion side separately.
+ */
+class IoUring {
+public:
+    static StatusWith<std::unique_ptr<IoUring>> make(unsigned entries) {
+        std::unique_ptr<IoUring> ring(new IoUring());
+        auto& params = ring->_params;
+        params.flags = IORING_SETUP_CLAMP;
+
+        ring->_fd = ioUringSetup(entries, &params);
+        if (ring->_fd < 0) {
+            return Status(ErrorCodes::OperationFailed,
+                          str::stream() << "io_uring_setup failed: " << errnoWithDescription());
+        }
+
+        constexpr auto kRequiredFeatures =
+            IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+        if ((params.features & kRequiredFeatures) != kRequiredFeatures) {
+            return Status(ErrorCodes::OperationFailed,
+                          "io_uring does not provide the required features");
+        }
+
+        ring->_ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                   params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ring->_ring = ::mmap(nullptr,
+                             ring->_ringSize,
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE,
+                             ring->_fd,
+                             IORING_OFF_SQ_RING);
+        if (ring->_ring == MAP_FAILED) {
+            return Status(ErrorCodes::OperationFailed,
+                          str::stream() << "Failed to map io_uring: " << errnoWithDescription());
+        }
+
+        ring->_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        auto sqes = ::mmap(nullptr,
+                           ring->_sqesSize,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE,
+                           ring->_fd,
+                           IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return Status(ErrorCodes::OperationFailed,
+                          str::stream() << "Failed to map io_uring: " << errnoWithDescription());
+        }
+        ring->_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        auto base = static_cast<char*>(ring->_ring);
+        ring->_sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+        ring->_sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        ring->_sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        ring->_cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        ring->_cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        ring->_cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        ring->_cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+        // Submission queue entries are always consumed in order, so the indirection array is the
+        // identity mapping and never changes.
+        auto sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        for (unsigned i = 0; i < params.sq_entries; ++i) {
+            sqArray[i] = i;
+        }
+        ring->_sqeTail = *ring->_sqTail;
+
+        return {std::move(ring)};
+    }
+
+    ~IoUring() {
+        if (_fd >= 0) {
+            ::close(_fd);
+        }
+        if (_sqes) {
+            ::munmap(_sqes, _sqesSize);
+        }
+        if (_ring != MAP_FAILED) {
+            ::munmap(_ring, _ringSize);
+        }
+        if (_bufRing) {
+            ::munmap(_bufRing, _bufCount * sizeof(io_uring_buf));
+        }
+        if (_bufSlab) {
+            ::munmap(_bufSlab, _bufCount * _bufSize);
+        }
+    }
+
+    /**
+     * Returns a zeroed submission queue entry, or nullptr if the queue is full.
+     */
+    io_uring_sqe* getSqe() {
+        auto head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+        if (_sqeTail - head >= _params.sq_entries) {
+            return nullptr;
+        }
+
+        auto sqe = &_sqes[_sqeTail++ & _sqMask];
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    /**
+     * Makes every entry returned by getSqe() visible to the kernel and returns how many were
+     * added since the last call.
+     */
+    unsigned publish() {
+        auto published = std::exchange(_sqePublished, _sqeTail);
+        __atomic_store_n(_sqTail, _sqeTail, __ATOMIC_RELEASE);
+        return _sqeTail - published;
+    }
+
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, const void* arg, size_t size) {
+        return ioUringEnter(_fd, toSubmit, minComplete, flags, arg, size);
+    }
+
+    /**
+     * Invokes 'cb' with every available completion and returns how many there were.
+     */
+    template <typename Callback>
+    unsigned reap(Callback&& cb) {
+        auto head = *_cqHead;
+        auto tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+        auto count = tail - head;
+        for (; head != tail; ++head) {
+            const auto& cqe = _cqes[head & _cqMask];
+            cb(cqe.user_data, cqe.res, cqe.flags);
+        }
+        __atomic_store_n(_cqHead, tail, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    bool supportsOps(std::initializer_list<int> ops) {
+        constexpr unsigned kMaxOps = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) + kMaxOps * sizeof(io_uring_probe_op));
+        auto probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (ioUringRegister(_fd, IORING_REGISTER_PROBE, probe, kMaxOps) < 0) {
+            return false;
+        }
+
+        return std::all_of(ops.begin(), ops.end(), [&](int op) {
+            return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        });
+    }
+
+    /**
+     * Registers 'count' buffers of 'size' bytes as buffer group 'group'. Receives submitted with
+     * IOSQE_BUFFER_SELECT pick a buffer from this ring and report it in the completion flags.
+     */
+    Status registerBufferRing(unsigned count, size_t size, uint16_t group) {
+        invariant(count && (count & (count - 1)) == 0);
+        invariant(!_bufRing);
+
+        auto ring = ::mmap(nullptr,
+                           count * sizeof(io_uring_buf),
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0);
+        if (ring == MAP_FAILED) {
+            return {ErrorCodes::ExceededMemoryLimit,
+                    str::stream() << "Failed to allocate receive buffers: "
+                                  << errnoWithDescription()};
+        }
+        _bufRing = static_cast<io_uring_buf_ring*>(ring);
+        _bufCount = count;
+
+        auto slab = ::mmap(
+            nullptr, count * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED) {
+            return {ErrorCodes::ExceededMemoryLimit,
+                    str::stream() << "Failed to allocate receive buffers: "
+                                  << errnoWithDescription()};
+        }
+        _bufSlab = static_cast<char*>(slab);
+        _bufSize = size;
+
+        io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(_bufRing);
+        reg.ring_entries = count;
+        reg.bgid = group;
+        if (ioUringRegister(_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            return {ErrorCodes::OperationFailed,
+                    str::stream() << "Failed to register receive buffers: "
+                                  << errnoWithDescription()};
+        }
+
+        for (unsigned bid = 0; bid < count; ++bid) {
+            recycleBuffer(bid);
+        }
+        return Status::OK();
+    }
+
+    const char* buffer(uint16_t bid) const {
+        return _bufSlab + bid * _bufSize;
+    }
+
+    /**
+     * Hands a provided buffer back to the kernel once its contents have been consumed.
+     */
+    void recycleBuffer(uint16_t bid) {
+        // The ring is indexed by hand: in C++ the kernel header's flexible 'bufs' member does not
+        // start at offset zero, where the kernel expects the first entry.
+        auto& buf = reinterpret_cast<io_uring_buf*>(_bufRing)[_bufTail & (_bufCount - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(buffer(bid));
+        buf.len = _bufSize;
+        buf.bid = bid;
+        __atomic_store_n(&_bufRing->tail, ++_bufTail, __ATOMIC_RELEASE);
+    }
+
+private:
+    IoUring() {
+        memset(&_params, 0, sizeof(_params));
+    }
+
+    int _fd = -1;
+    io_uring_params _params;
+
+    void* _ring = MAP_FAILED;
+    size_t _ringSize = 0;
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    unsigned* _sqHead = nullptr;
+    unsigned* _sqTail = nullptr;
+    unsigned _sqMask = 0;
+    unsigned* _cqHead = nullptr;
+    unsigned* _cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    // Entries handed out by getSqe() and entries already made visible to the kernel.
+    unsigned _sqeTail = 0;
+    unsigned _sqePublished = 0;
+
+    io_uring_buf_ring* _bufRing = nullptr;
+    char* _bufSlab = nullptr;
+    unsigned _bufCount = 0;
+    size_t _bufSize = 0;
+    uint16_t _bufTail = 0;
+};
+
+/**
+ * An in-flight io_uring request. Its address is the user_data of the submission, and the reactor
+ * owns it until complete() reports that no further completions will arrive.
+ */
+class UringOperation {
+public:
+    virtual ~UringOperation() = default;
+
+    /**
+     * Handles one completion on the thread that reaped it. Returns true once the operation is
+     * finished and may be destroyed. Implementations must not run user continuations inline; they
+     * are scheduled on the reactor instead.
+     */
+    virtual bool complete(int res, uint32_t flags) = 0;
+};
+
+}  // namespace
+
+/**
+ * A Reactor whose event loop waits on an io_uring.
+ *
+ * Any number of threads may run the reactor at once, as with ASIOReactor. One of them at a time
+ * owns the ring: it submits everything prepared since the last wait together with the wait itself,
+ * handles the completions, and fires expired timers. Scheduled tasks, including the fulfilment of
+ * promises produced by completions, run on whichever thread is free.
+ */
+class TransportLayerUring::UringReactor final : public Reactor {
+public:
+    explicit UringReactor(bool withRecvBuffers)
+        : _ring(uassertStatusOK(IoUring::make(kRingEntries))) {
+        if (withRecvBuffers) {
+            uassertStatusOK(
+                _ring->registerBufferRing(kRecvBufferCount, kRecvBufferSize, kRecvBufferGroup));
+        }
+
+        _wakeupFd = ::eventfd(0, EFD_CLOEXEC);
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Failed to create eventfd: " << errnoWithDescription(),
+                _wakeupFd >= 0);
+
+        stdx::lock_guard<Latch> lk(_sqMutex);
+        _armWakeup(lk);
+    }
+
+    ~UringReactor() override {
+        // The kernel tears a closed ring down asynchronously, so requests still in flight could
+        // go on writing into memory owned by their operations. Everything is canceled and its
+        // final completion reaped before any of that memory is freed.
+        _cancelAllAndDrain();
+        _ring.reset();
+        ::close(_wakeupFd);
+    }
+
+    void run() noexcept override {
+        ThreadIdGuard threadIdGuard(this);
+        _runUntil(Date_t::max());
+    }
+
+    void runFor(Milliseconds time) noexcept override {
+        ThreadIdGuard threadIdGuard(this);
+        _runUntil(now() + time);
+    }
+
+    void stop() override {
+        _stopped.store(true);
+        _tasksCv.notify_all();
+        _wakeup();
+    }
+
+    void drain() override {
+        ThreadIdGuard threadIdGuard(this);
+        _stopped.store(false);
+
+        bool progress = true;
+        while (progress) {
+            progress = _runScheduledTasks();
+
+            stdx::unique_lock<Latch> ringLk(_ringMutex, stdx::try_to_lock);
+            if (ringLk.owns_lock()) {
+                _flush();
+                progress |= _reapCompletions() > 0;
+                _fireTimers(now());
+            }
+
+            if (progress) {
+                LOGV2_DEBUG(5097103, 2, "Draining remaining work in reactor.");
+            }
+        }
+        _stopped.store(true);
+    }
+
+    std::unique_ptr<ReactorTimer> makeTimer() override;
+
+    Date_t now() override {
+        return Date_t::now();
+    }
+
+    void schedule(Task task) override {
+        {
+            stdx::lock_guard<Latch> lk(_tasksMutex);
+            _tasks.push_back(std::move(task));
+        }
+        _tasksCv.notify_one();
+        if (_waiting.load()) {
+            _wakeup();
+        }
+    }
+
+    void dispatch(Task task) override {
+        if (onReactorThread()) {
+            task(Status::OK());
+        } else {
+            schedule(std::move(task));
+        }
+    }
+
+    bool onReactorThread() const override {
+        return this == _reactorForThread;
+    }
+
+    /**
+     * Prepares a submission on behalf of 'op', or on behalf of nobody if 'op' is null. On a thread
+     * running this reactor the submission is batched with everything else prepared before the
+     * next wait; elsewhere it is submitted immediately.
+     */
+    template <typename Prep>
+    void submit(UringOperation* op, Prep&& prep) {
+        {
+            stdx::lock_guard<Latch> lk(_sqMutex);
+            auto sqe = _getSqe(lk);
+            prep(sqe);
+            sqe->user_data = op ? reinterpret_cast<uint64_t>(op) : kIgnoredUserData;
+            if (op) {
+                _inflight.insert(op);
+            }
+        }
+
+        if (!onReactorThread()) {
+            _flush();
+        }
+    }
+
+    /**
+     * Cancels every in-flight request that targets 'fd'.
+     */
+    void cancelFd(int fd) {
+        submit(nullptr, [&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = fd;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        });
+    }
+
+    /**
+     * Cancels the request submitted on behalf of 'op'.
+     */
+    void cancelOperation(UringOperation* op) {
+        submit(nullptr, [&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = reinterpret_cast<uint64_t>(op);
+        });
+    }
+
+    /**
+     * Access to the provided receive buffers. Only valid from UringOperation::complete().
+     */
+    const char* recvBuffer(uint16_t bid) const {
+        return _ring->buffer(bid);
+    }
+
+    void recycleRecvBuffer(uint16_t bid) {
+        _ring->recycleBuffer(bid);
+    }
+
+    template <typename T>
+    void fulfil(Promise<T> promise, StatusWith<T> result) {
+        schedule([promise = std::move(promise), result = std::move(result)](Status) mutable {
+            promise.setFromStatusWith(std::move(result));
+        });
+    }
+
+    void fulfil(Promise<void> promise, Status status) {
+        schedule([promise = std::move(promise), status = std::move(status)](Status) mutable {
+            if (status.isOK()) {
+                promise.emplaceValue();
+            } else {
+                promise.setError(std::move(status));
+            }
+        });
+    }
+
+private:
+    class Timer;
+
+    struct TimerEntry {
+        explicit TimerEntry(Promise<void> p) : promise(std::move(p)) {}
+
+        Promise<void> promise;
+        bool fired = false;
+    };
+    using TimerHandle = std::shared_ptr<TimerEntry>;
+    using TimerQueueEntry = std::pair<Date_t, TimerHandle>;
+
+    struct TimerQueueCompare {
+        bool operator()(const TimerQueueEntry& lhs, const TimerQueueEntry& rhs) const {
+            return lhs.first > rhs.first;
+        }
+    };
+
+    class ThreadIdGuard {
+    public:
+        ThreadIdGuard(UringReactor* reactor) {
+            invariant(!_reactorForThread);
+            _reactorForThread = reactor;
+        }
+
+        ~ThreadIdGuard() {
+            invariant(_reactorForThread);
+            _reactorForThread = nullptr;
+        }
+    };
+
+    void _runUntil(Date_t deadline) {
+        while (!_stopped.load()) {
+            if (_runScheduledTasks()) {
+                continue;
+            }
+
+            const auto start = now();
+            if (start >= deadline) {
+                return;
+            }
+
+            stdx::unique_lock<Latch> ringLk(_ringMutex, stdx::try_to_lock);
+            if (!ringLk.owns_lock()) {
+                // Another thread is waiting on the ring and will hand completions over as tasks.
+                stdx::unique_lock<Latch> lk(_tasksMutex);
+                _tasksCv.wait_until(lk,
+                                    std::min(deadline, start + kIdleWaitInterval).toSystemTimePoint(),
+                                    [&] { return !_tasks.empty() || _stopped.load(); });
+                continue;
+            }
+
+            auto waitUntil = std::min(deadline, _fireTimers(start));
+            _waitForCompletions(std::max(waitUntil - start, Milliseconds(0)));
+        }
+    }
+
+    /**
+     * Runs scheduled tasks until none are left, then submits whatever they prepared. Returns
+     * whether any task ran.
+     */
+    bool _runScheduledTasks() {
+        bool ranAny = false;
+        while (!_stopped.load()) {
+            Task task;
+            {
+                stdx::lock_guard<Latch> lk(_tasksMutex);
+                if (_tasks.empty()) {
+                    break;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+
+            task(Status::OK());
+            ranAny = true;
+        }
+
+        if (ranAny) {
+            _flush();
+        }
+        return ranAny;
+    }
+
+    /**
+     * Submits pending entries and blocks for at most 'timeout' until a completion arrives, then
+     * handles every available completion. Requires _ringMutex.
+     */
+    void _waitForCompletions(Milliseconds timeout) {
+        _waiting.store(true);
+        {
+            auto guard = makeGuard([&] { _waiting.store(false); });
+            stdx::lock_guard<Latch> lk(_tasksMutex);
+            if (!_tasks.empty() || _stopped.load()) {
+                return;
+            }
+            guard.dismiss();
+        }
+
+        unsigned toSubmit;
+        {
+            stdx::lock_guard<Latch> lk(_sqMutex);
+            toSubmit = _ring->publish();
+        }
+
+        __kernel_timespec ts;
+        ts.tv_sec = durationCount<Seconds>(timeout);
+        ts.tv_nsec = durationCount<Nanoseconds>(timeout - Seconds(ts.tv_sec));
+
+        io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+        auto ret = _ring->enter(
+            toSubmit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        auto err = errno;
+        _waiting.store(false);
+
+        if (ret < 0 && err != ETIME && err != EINTR && err != EBUSY) {
+            LOGV2_WARNING(5097105,
+                          "Error waiting for io_uring completions",
+                          "error"_attr = errnoWithDescription(err));
+        }
+
+        _reapCompletions();
+    }
+
+    unsigned _reapCompletions() {
+        return _ring->reap([&](uint64_t userData, int res, uint32_t flags) {
+            if (userData == kIgnoredUserData) {
+                return;
+            }
+
+            if (userData == kWakeupUserData) {
+                stdx::lock_guard<Latch> lk(_sqMutex);
+                _armWakeup(lk);
+                return;
+            }
+
+            auto op = reinterpret_cast<UringOperation*>(userData);
+            if (op->complete(res, flags)) {
+                {
+                    stdx::lock_guard<Latch> lk(_sqMutex);
+                    _inflight.erase(op);
+                }
+                delete op;
+            }
+        });
+    }
+
+    /**
+     * Cancels every request in the ring and waits until each has delivered its final completion,
+     * destroying the operations without completing them. Only for use by the destructor, once no
+     * thread is running the reactor.
+     */
+    void _cancelAllAndDrain() {
+        stdx::lock_guard<Latch> ringLk(_ringMutex);
+
+        {
+            stdx::lock_guard<Latch> lk(_sqMutex);
+            auto sqe = _getSqe(lk);
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+            sqe->user_data = kIgnoredUserData;
+        }
+
+        // Every operation in '_inflight' has exactly one request outstanding, as does the read on
+        // '_wakeupFd', which is not re-armed from here on.
+        bool wakeupArmed = true;
+        while (wakeupArmed || !_inflight.empty()) {
+            unsigned toSubmit;
+            {
+                stdx::lock_guard<Latch> lk(_sqMutex);
+                toSubmit = _ring->publish();
+            }
+
+            if (_ring->enter(toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR && errno != EBUSY) {
+                // Without their completions the kernel may still be using the operations, so
+                // leaking them is the only safe option left.
+                LOGV2_WARNING(5097148,
+                              "Error draining io_uring completions",
+                              "error"_attr = errnoWithDescription(),
+                              "leakedOperations"_attr = _inflight.size());
+                _inflight.clear();
+                return;
+            }
+
+            _ring->reap([&](uint64_t userData, int res, uint32_t flags) {
+                if (userData == kIgnoredUserData) {
+                    return;
+                }
+
+                if (userData == kWakeupUserData) {
+                    wakeupArmed = false;
+                    return;
+                }
+
+                if (!(flags & IORING_CQE_F_MORE)) {
+                    auto op = reinterpret_cast<UringOperation*>(userData);
+                    stdx::lock_guard<Latch> lk(_sqMutex);
+                    _inflight.erase(op);
+                    delete op;
+                }
+            });
+        }
+    }
+
+    /**
+     * Schedules the promises of expired timers and returns the deadline of the next one.
+     */
+    Date_t _fireTimers(Date_t now) {
+        std::vector<Promise<void>> expired;
+        Date_t next = Date_t::max();
+        {
+            stdx::lock_guard<Latch> lk(_tasksMutex);
+            while (!_timers.empty() && _timers.front().first <= now) {
+                std::pop_heap(_timers.begin(), _timers.end(), TimerQueueCompare());
+                auto entry = std::move(_timers.back().second);
+                _timers.pop_back();
+
+                if (!std::exchange(entry->fired, true)) {
+                    expired.push_back(std::move(entry->promise));
+                }
+            }
+
+            if (!_timers.empty()) {
+                next = _timers.front().first;
+            }
+        }
+
+        for (auto& promise : expired) {
+            fulfil(std::move(promise), Status::OK());
+        }
+        return next;
+    }
+
+    TimerHandle _addTimer(Date_t deadline, Promise<void> promise) {
+        auto entry = std::make_shared<TimerEntry>(std::move(promise));
+        {
+            stdx::lock_guard<Latch> lk(_tasksMutex);
+            _timers.emplace_back(deadline, entry);
+            std::push_heap(_timers.begin(), _timers.end(), TimerQueueCompare());
+        }
+
+        // The thread waiting on the ring may be sleeping past the new deadline.
+        if (_waiting.load()) {
+            _wakeup();
+        }
+        return entry;
+    }
+
+    void _cancelTimer(const TimerHandle& entry) {
+        {
+            stdx::lock_guard<Latch> lk(_tasksMutex);
+            if (std::exchange(entry->fired, true)) {
+                return;
+            }
+        }
+
+        // The entry itself stays queued until its deadline passes and is then discarded.
+        fulfil(std::move(entry->promise),
+               Status(ErrorCodes::CallbackCanceled, "Timer was canceled"));
+    }
+
+    io_uring_sqe* _getSqe(WithLock) {
+        while (true) {
+            if (auto sqe = _ring->getSqe()) {
+                return sqe;
+            }
+
+            // The submission queue is full, so submit it to make room.
+            auto toSubmit = _ring->publish();
+            if (_ring->enter(toSubmit, 0, 0, nullptr, 0) < 0 && errno != EBUSY &&
+                errno != EINTR) {
+                LOGV2_WARNING(5097106,
+                              "Error submitting to io_uring",
+                              "error"_attr = errnoWithDescription());
+            }
+        }
+    }
+
+    void _flush() {
+        unsigned toSubmit;
+        {
+            stdx::lock_guard<Latch> lk(_sqMutex);
+            toSubmit = _ring->publish();
+        }
+
+        if (toSubmit && _ring->enter(toSubmit, 0, 0, nullptr, 0) < 0) {
+            LOGV2_WARNING(5097107,
+                          "Error submitting to io_uring",
+                          "error"_attr = errnoWithDescription());
+        }
+    }
+
+    void _armWakeup(WithLock lk) {
+        auto sqe = _getSqe(lk);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = _wakeupFd;
+        sqe->addr = reinterpret_cast<uint64_t>(&_wakeupValue);
+        sqe->len = sizeof(_wakeupValue);
+        sqe->user_data = kWakeupUserData;
+    }
+
+    void _wakeup() {
+        uint64_t one = 1;
+        if (::write(_wakeupFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            LOGV2_WARNING(5097108,
+                          "Failed to wake up io_uring reactor",
+                          "error"_attr = errnoWithDescription());
+        }
+    }
+
+    static thread_local UringReactor* _reactorForThread;
+
+    std::unique_ptr<IoUring> _ring;
+
+    // Held by the single thread that waits on the ring and reaps its completions.
+    Mutex _ringMutex = MONGO_MAKE_LATCH("UringReactor::_ringMutex");
+
+    // Guards the submission queue and the set of operations that own a submission.
+    Mutex _sqMutex = MONGO_MAKE_LATCH("UringReactor::_sqMutex");
+    stdx::unordered_set<UringOperation*> _inflight;
+
+    // Guards scheduled tasks and timers.
+    Mutex _tasksMutex = MONGO_MAKE_LATCH("UringReactor::_tasksMutex");
+    stdx::condition_variable _tasksCv;
+    std::deque<Task> _tasks;
+    std::vector<TimerQueueEntry> _timers;
+
+    // Set while a thread is blocked in io_uring_enter(), which only a write to _wakeupFd can
+    // interrupt.
+    AtomicWord<bool> _waiting{false};
+    AtomicWord<bool> _stopped{false};
+
+    int _wakeupFd = -1;
+    uint64_t _wakeupValue = 0;
+};
+
+thread_local TransportLayerUring::UringReactor*
+    TransportLayerUring::UringReactor::_reactorForThread = nullptr;
+
+class TransportLayerUring::UringReactor::Timer final : public ReactorTimer {
+public:
+    explicit Timer(UringReactor* reactor) : _reactor(reactor) {}
+
+    ~Timer() override {
+        cancel();
+    }
+
+    void cancel(const BatonHandle& baton = nullptr) override {
+        if (auto entry = std::exchange(_entry, nullptr)) {
+            _reactor->_cancelTimer(entry);
+        }
+    }
+
+    Future<void> waitUntil(Date_t deadline, const BatonHandle& baton = nullptr) override {
+        cancel();
+
+        auto pf = makePromiseFuture<void>();
+        _entry = _reactor->_addTimer(deadline, std::move(pf.promise));
+        return std::move(pf.future);
+    }
+
+private:
+    UringReactor* const _reactor;
+    TimerHandle _entry;
+};
+
+std::unique_ptr<ReactorTimer> TransportLayerUring::UringReactor::makeTimer() {
+    return std::make_unique<Timer>(this);
+}
+
+/**
+ * An accepted connection.
+ *
+ * Asynchronous reads arm a multishot recv that fills provided buffers; the completion handler
+ * assembles whole messages and hands them to the pending asyncSourceMessage() or queues them for
+ * the next one. Asynchronous writes submit a send and resubmit the remainder after a short write.
+ * Synchronous reads and writes use the socket directly and must not be mixed with asynchronous
+ * reads on the same session.
+ */
+class TransportLayerUring::UringSession final : public Session {
+    UringSession(const UringSession&) = delete;
+    UringSession& operator=(const UringSession&) = delete;
+
+public:
+    // Takes ownership of 'fd' unless the constructor throws. Throws a DBException if the socket
+    // cannot be configured.
+    UringSession(TransportLayerUring* tl, UringReactor* reactor, int fd)
+        : _tl(tl), _reactor(reactor), _fd(fd) {
+        sockaddr_storage storage;
+        socklen_t len = sizeof(storage);
+        if (::getsockname(_fd, reinterpret_cast<sockaddr*>(&storage), &len) != 0) {
+            uasserted(ErrorCodes::SocketException, errnoWithDescription());
+        }
+        _localAddr = SockAddr(reinterpret_cast<sockaddr*>(&storage), len);
+
+        len = sizeof(storage);
+        if (::getpeername(_fd, reinterpret_cast<sockaddr*>(&storage), &len) != 0) {
+            uasserted(ErrorCodes::SocketException, errnoWithDescription());
+        }
+        _remoteAddr = SockAddr(reinterpret_cast<sockaddr*>(&storage), len);
+
+        auto family = _localAddr.getType();
+        if (family == AF_INET || family == AF_INET6) {
+            const int one = 1;
+            ::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            ::setsockopt(_fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+            setSocketKeepAliveParams(_fd);
+        }
+
+        _local = HostAndPort(_localAddr.toString(true));
+        _remote = HostAndPort(_remoteAddr.toString(true));
+    }
+
+    ~UringSession() override {
+        end();
+        ::close(_fd);
+    }
+
+    TransportLayer* getTransportLayer() const override {
+        return _tl;
+    }
+
+    const HostAndPort& remote() const override {
+        return _remote;
+    }
+
+    const HostAndPort& local() const override {
+        return _local;
+    }
+
+    const SockAddr& remoteAddr() const override {
+        return _remoteAddr;
+    }
+
+    const SockAddr& localAddr() const override {
+        return _localAddr;
+    }
+
+    void end() override {
+        if (_ended.swap(true)) {
+            return;
+        }
+
+        if (::shutdown(_fd, SHUT_RDWR) != 0 && errno != ENOTCONN) {
+            LOGV2_ERROR(5097109,
+                        "Error shutting down socket: {error}",
+                        "Error shutting down socket",
+                        "error"_attr = errnoWithDescription());
+        }
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            invariant(!_recvOp);
+            if (auto msg = _popReadyMessage(lk)) {
+                return std::move(*msg);
+            }
+            if (!_readStatus.isOK()) {
+                return _readStatus;
+            }
+        }
+
+        char header[kHeaderSize];
+        if (auto status = _readSync(header, kHeaderSize); !status.isOK()) {
+            return status;
+        }
+
+        const auto msgLen = size_t(MSGHEADER::ConstView(header).getMessageLength());
+        if (auto status = validateMessageLength(msgLen); !status.isOK()) {
+            return status;
+        }
+
+        auto buffer = SharedBuffer::allocate(msgLen);
+        memcpy(buffer.get(), header, kHeaderSize);
+        if (auto status = _readSync(buffer.get() + kHeaderSize, msgLen - kHeaderSize);
+            !status.isOK()) {
+            return status;
+        }
+
+        networkCounter.hitPhysicalIn(msgLen);
+        return Message(std::move(buffer));
+    }
+
+    Future<Message> asyncSourceMessage(const BatonHandle& baton = nullptr) override {
+        stdx::unique_lock<Latch> lk(_mutex);
+        if (auto msg = _popReadyMessage(lk)) {
+            return Future<Message>::makeReady(std::move(*msg));
+        }
+        if (!_readStatus.isOK()) {
+            return Future<Message>::makeReady(_readStatus);
+        }
+
+        invariant(!_pendingRead);
+        auto pf = makePromiseFuture<Message>();
+        _pendingRead.emplace(std::move(pf.promise));
+        if (!_recvOp) {
+            _armRecv(lk);
+        }
+        return std::move(pf.future);
+    }
+
+    Status sinkMessage(Message message) override {
+        auto status = _writeSync(message.buf(), message.size());
+        if (status.isOK()) {
+            networkCounter.hitPhysicalOut(message.size());
+        }
+        return status;
+    }
+
+    Future<void> asyncSinkMessage(Message message, const BatonHandle& baton = nullptr) override {
+        auto pf = makePromiseFuture<void>();
+        auto op = new SendOperation(_shared(), std::move(message), std::move(pf.promise));
+        op->submit();
+        return std::move(pf.future);
+    }
+
+    void cancelAsyncOperations(const BatonHandle& baton = nullptr) override {
+        LOGV2_DEBUG(5097110,
+                    3,
+                    "Cancelling outstanding I/O operations on connection to {remote}",
+                    "remote"_attr = _remote);
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            if (_recvOp) {
+                _cancelRequested = true;
+            }
+        }
+        _reactor->cancelFd(_fd);
+    }
+
+    void setTimeout(boost::optional<Milliseconds> timeout) override {
+        invariant(!timeout || timeout->count() > 0);
+        _configuredTimeout = timeout;
+    }
+
+    bool isConnected() override {
+        if (_ended.load()) {
+            return false;
+        }
+
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            if (!_ready.empty()) {
+                return true;
+            }
+        }
+
+        pollfd pfd = {_fd, POLLIN, 0};
+        auto ret = ::poll(&pfd, 1, 0);
+        if (ret == 0) {
+            return true;
+        }
+        if (ret < 0) {
+            LOGV2_WARNING(5097111,
+                          "Failed to poll socket for connectivity check: {reason}",
+                          "Failed to poll socket for connectivity check",
+                          "reason"_attr = errnoWithDescription());
+            return false;
+        }
+
+        if (pfd.revents & POLLIN) {
+            char testByte;
+            auto size = ::recv(_fd, &testByte, sizeof(testByte), MSG_PEEK);
+            if (size == sizeof(testByte)) {
+                return true;
+            } else if (size == -1) {
+                LOGV2_WARNING(5097112,
+                              "Failed to check socket connectivity: {error}",
+                              "Failed to check socket connectivity",
+                              "error"_attr = errnoWithDescription());
+            }
+            // If size == 0 then we got disconnected and we should return false.
+        }
+
+        return false;
+    }
+
+private:
+    class RecvOperation final : public UringOperation {
+    public:
+        explicit RecvOperation(std::shared_ptr<UringSession> session)
+            : _session(std::move(session)) {}
+
+        bool complete(int res, uint32_t flags) override {
+            return _session->_onRecv(res, flags);
+        }
+
+    private:
+        const std::shared_ptr<UringSession> _session;
+    };
+
+    class SendOperation final : public UringOperation {
+    public:
+        SendOperation(std::shared_ptr<UringSession> session,
+                      Message message,
+                      Promise<void> promise)
+            : _session(std::move(session)),
+              _message(std::move(message)),
+              _promise(std::move(promise)) {}
+
+        void submit() {
+            _session->_reactor->submit(this, [&](io_uring_sqe* sqe) {
+                sqe->opcode = IORING_OP_SEND;
+                sqe->fd = _session->_fd;
+                sqe->addr = reinterpret_cast<uint64_t>(_message.buf() + _sent);
+                sqe->len = _message.size() - _sent;
+                sqe->msg_flags = MSG_NOSIGNAL;
+            });
+        }
+
+        bool complete(int res, uint32_t flags) override {
+            if (res == -EINTR || res == -EAGAIN) {
+                submit();
+                return false;
+            }
+
+            if (res < 0) {
+                _session->_reactor->fulfil(std::move(_promise), errnoToStatus(-res));
+                return true;
+            }
+
+            _sent += res;
+            if (_sent < static_cast<size_t>(_message.size())) {
+                submit();
+                return false;
+            }
+
+            networkCounter.hitPhysicalOut(_message.size());
+            _session->_reactor->fulfil(std::move(_promise), Status::OK());
+            return true;
+        }
+
+    private:
+        const std::shared_ptr<UringSession> _session;
+        const Message _message;
+        Promise<void> _promise;
+        size_t _sent = 0;
+    };
+
+    std::shared_ptr<UringSession> _shared() {
+        return std::static_pointer_cast<UringSession>(shared_from_this());
+    }
+
+    boost::optional<Message> _popReadyMessage(WithLock) {
+        if (_ready.empty()) {
+            return boost::none;
+        }
+        auto msg = std::move(_ready.front());
+        _ready.pop_front();
+        return msg;
+    }
+
+    void _armRecv(WithLock) {
+        _recvOp = new RecvOperation(_shared());
+        _reactor->submit(_recvOp, [&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = _fd;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = kRecvBufferGroup;
+        });
+    }
+
+    /**
+     * Handles a completion of the multishot recv. Returns true when the recv has terminated.
+     */
+    bool _onRecv(int res, uint32_t flags) {
+        const bool finished = !(flags & IORING_CQE_F_MORE);
+        bool canceledByUser = false;
+        boost::optional<Promise<Message>> promise;
+        boost::optional<StatusWith<Message>> result;
+
+        stdx::unique_lock<Latch> lk(_mutex);
+        if (res > 0) {
+            invariant(flags & IORING_CQE_F_BUFFER);
+            const uint16_t bid = flags >> IORING_CQE_BUFFER_SHIFT;
+            auto status = _consume(lk, _reactor->recvBuffer(bid), res);
+            _reactor->recycleRecvBuffer(bid);
+            if (!status.isOK()) {
+                _readStatus = std::move(status);
+            }
+        } else if (res == 0) {
+            _readStatus = Status(ErrorCodes::HostUnreachable, "Connection closed by peer");
+        } else if (res == -ECANCELED) {
+            canceledByUser = _cancelRequested;
+        } else if (res != -ENOBUFS) {
+            // Running out of provided buffers only terminates the recv; it is re-armed below.
+            _readStatus = errnoToStatus(-res);
+        }
+
+        if (finished) {
+            _recvOp = nullptr;
+            _recvThrottled = false;
+            _cancelRequested = false;
+        }
+
+        if (_pendingRead) {
+            if (auto msg = _popReadyMessage(lk)) {
+                result.emplace(std::move(*msg));
+            } else if (!_readStatus.isOK()) {
+                result.emplace(_readStatus);
+            } else if (canceledByUser) {
+                result.emplace(Status(ErrorCodes::CallbackCanceled, "Callback was canceled"));
+            }
+
+            if (result) {
+                promise.emplace(std::move(*_pendingRead));
+                _pendingRead.reset();
+            }
+        }
+
+        if (_recvOp && !_recvThrottled && _ready.size() >= kMaxReadAheadMessages) {
+            // Stop reading ahead of a slow consumer. The next asyncSourceMessage() re-arms.
+            _recvThrottled = true;
+            _reactor->cancelOperation(_recvOp);
+        } else if (!_recvOp && _pendingRead && _readStatus.isOK()) {
+            _armRecv(lk);
+        }
+        lk.unlock();
+
+        if (promise) {
+            _reactor->fulfil(std::move(*promise), std::move(*result));
+        }
+        return finished;
+    }
+
+    /**
+     * Appends received bytes to the message being assembled, queueing each message once it is
+     * complete.
+     */
+    Status _consume(WithLock, const char* data, size_t len) {
+        while (len > 0) {
+            if (!_inbound) {
+                auto n = std::min(kHeaderSize - _headerBytes, len);
+                memcpy(_header + _headerBytes, data, n);
+                _headerBytes += n;
+                data += n;
+                len -= n;
+                if (_headerBytes < kHeaderSize) {
+                    break;
+                }
+
+                _inboundLength = size_t(MSGHEADER::ConstView(_header).getMessageLength());
+                if (auto status = validateMessageLength(_inboundLength); !status.isOK()) {
+                    return status;
+                }
+
+                _inbound = SharedBuffer::allocate(_inboundLength);
+                memcpy(_inbound.get(), _header, kHeaderSize);
+                _inboundBytes = kHeaderSize;
+            } else {
+                auto n = std::min(_inboundLength - _inboundBytes, len);
+                memcpy(_inbound.get() + _inboundBytes, data, n);
+                _inboundBytes += n;
+                data += n;
+                len -= n;
+            }
+
+            if (_inboundBytes == _inboundLength) {
+                networkCounter.hitPhysicalIn(_inboundLength);
+                _ready.emplace_back(std::exchange(_inbound, SharedBuffer()));
+                _headerBytes = 0;
+            }
+        }
+        return Status::OK();
+    }
+
+    Status _pollSync(short events) {
+        if (!_configuredTimeout) {
+            return Status::OK();
+        }
+
+        pollfd pfd = {_fd, events, 0};
+        while (true) {
+            auto ret = ::poll(&pfd, 1, durationCount<Milliseconds>(*_configuredTimeout));
+            if (ret > 0) {
+                return Status::OK();
+            } else if (ret == 0) {
+                return errnoToStatus(ETIME);
+            } else if (errno != EINTR) {
+                return errnoToStatus(errno);
+            }
+        }
+    }
+
+    Status _readSync(char* buf, size_t len) {
+        while (len > 0) {
+            if (auto status = _pollSync(POLLIN); !status.isOK()) {
+                return status;
+            }
+
+            auto n = ::recv(_fd, buf, len, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errnoToStatus(errno);
+            } else if (n == 0) {
+                return {ErrorCodes::HostUnreachable, "Connection closed by peer"};
+            }
+            buf += n;
+            len -= n;
+        }
+        return Status::OK();
+    }
+
+    Status _writeSync(const char* buf, size_t len) {
+        while (len > 0) {
+            if (auto status = _pollSync(POLLOUT); !status.isOK()) {
+                return status;
+            }
+
+            auto n = ::send(_fd, buf, len, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errnoToStatus(errno);
+            }
+            buf += n;
+            len -= n;
+        }
+        return Status::OK();
+    }
+
+    TransportLayerUring* const _tl;
+    UringReactor* const _reactor;
+    const int _fd;
+
+    SockAddr _localAddr;
+    SockAddr _remoteAddr;
+    HostAndPort _local;
+    HostAndPort _remote;
+
+    boost::optional<Milliseconds> _configuredTimeout;
+    AtomicWord<bool> _ended{false};
+
+    Mutex _mutex = MONGO_MAKE_LATCH("UringSession::_mutex");
+
+    // The message being assembled from received bytes.
+    char _header[kHeaderSize];
+    size_t _headerBytes = 0;
+    SharedBuffer _inbound;
+    size_t _inboundBytes = 0;
+    size_t _inboundLength = 0;
+
+    // Complete messages not yet returned, and the first error that ended reading.
+    std::deque<Message> _ready;
+    Status _readStatus = Status::OK();
+    boost::optional<Promise<Message>> _pendingRead;
+
+    // The multishot recv, while it is armed.
+    RecvOperation* _recvOp = nullptr;
+    bool _recvThrottled = false;
+    bool _cancelRequested = false;
+};
+
+namespace {
+
+class AcceptOperation final : public UringOperation {
+public:
+    /**
+     * 'onAccept' receives every completion of the multishot accept and returns whether the
+     * operation is finished. It is responsible for re-arming the accept when the kernel terminates
+     * it.
+     */
+    using Callback = unique_function<bool(AcceptOperation*, int, bool)>;
+
+    AcceptOperation(int listenFd, Callback onAccept)
+        : _listenFd(listenFd), _onAccept(std::move(onAccept)) {}
+
+    void prep(io_uring_sqe* sqe) const {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = _listenFd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+    }
+
+    bool complete(int res, uint32_t flags) override {
+        return _onAccept(this, res, flags & IORING_CQE_F_MORE);
+    }
+
+private:
+    const int _listenFd;
+    Callback _onAccept;
+};
+
+}  // namespace
+
+bool TransportLayerUring::isSupported() {
+    static const bool supported = [] {
+        auto swRing = IoUring::make(8);
+        if (!swRing.isOK()) {
+            LOGV2_DEBUG(5097113,
+                        1,
+                        "io_uring is not available",
+                        "error"_attr = swRing.getStatus());
+            return false;
+        }
+
+        // IORING_OP_SEND_ZC arrived in the same kernel release as multishot recv, which cannot be
+        // probed for directly.
+        auto& ring = swRing.getValue();
+        if (!ring->supportsOps({IORING_OP_ACCEPT,
+                                IORING_OP_RECV,
+                                IORING_OP_SEND,
+                                IORING_OP_READ,
+                                IORING_OP_ASYNC_CANCEL,
+                                IORING_OP_SEND_ZC})) {
+            LOGV2_DEBUG(5097114, 1, "io_uring does not support the required operations");
+            return false;
+        }
+
+        if (auto status = ring->registerBufferRing(8, 4096, kRecvBufferGroup); !status.isOK()) {
+            LOGV2_DEBUG(5097115,
+                        1,
+                        "io_uring does not support provided buffer rings",
+                        "error"_attr = status);
+            return false;
+        }
+
+        return true;
+    }();
+
+    return supported;
+}
+
+TransportLayerUring::TransportLayerUring(const Options& opts, ServiceEntryPoint* sep)
+    : _sep(sep), _listenerOptions(opts) {
+    if (_listenerOptions.isIngress()) {
+        _ingressReactor = std::make_shared<UringReactor>(true);
+        _acceptorReactor = std::make_shared<UringReactor>(false);
+    }
+
+    Options egressOpts = opts;
+    egressOpts.mode = Options::kEgress;
+    egressOpts.ipList.clear();
+    _egressLayer = std::make_unique<TransportLayerASIO>(egressOpts, nullptr);
+}
+
+TransportLayerUring::~TransportLayerUring() {
+    // Destroying the reactors releases the in-flight accepts before the sockets are closed.
+    _acceptorReactor.reset();
+    _ingressReactor.reset();
+    for (auto& listenSocket : _listenSockets) {
+        ::close(listenSocket.second);
+    }
+}
+
+StatusWith<SessionHandle> TransportLayerUring::connect(HostAndPort peer,
+                                                       ConnectSSLMode sslMode,
+                                                       Milliseconds timeout) {
+    return _egressLayer->connect(std::move(peer), sslMode, timeout);
+}
+
+Future<SessionHandle> TransportLayerUring::asyncConnect(HostAndPort peer,
+                                                        ConnectSSLMode sslMode,
+                                                        const ReactorHandle& reactor,
+                                                        Milliseconds timeout) {
+    return _egressLayer->asyncConnect(std::move(peer), sslMode, reactor, timeout);
+}
+
+BatonHandle TransportLayerUring::makeBaton(OperationContext* opCtx) const {
+    return _egressLayer->makeBaton(opCtx);
+}
+
+Status TransportLayerUring::setup() {
+    if (auto status = _egressLayer->setup(); !status.isOK()) {
+        return status;
+    }
+
+    if (!_listenerOptions.isIngress()) {
+        return Status::OK();
+    }
+
+#ifdef MONGO_CONFIG_SSL
+    if (getSSLGlobalParams().sslMode.load() != SSLParams::SSLMode_disabled) {
+        return {ErrorCodes::InvalidOptions, "The io_uring transport layer does not support TLS"};
+    }
+#endif
+
+    std::vector<std::string> listenAddrs;
+    if (_listenerOptions.ipList.empty()) {
+        listenAddrs = {"127.0.0.1"};
+        if (_listenerOptions.enableIPv6) {
+            listenAddrs.emplace_back("::1");
+        }
+    } else {
+        listenAddrs = _listenerOptions.ipList;
+    }
+
+    if (_listenerOptions.useUnixSockets) {
+        listenAddrs.emplace_back(makeUnixSockPath(_listenerOptions.port));
+    }
+
+    _listenerPort = _listenerOptions.port;
+
+    // Self-deduplicating list of unique addresses.
+    std::set<SockAddr> addrs;
+    for (auto& ip : listenAddrs) {
+        if (ip.empty()) {
+            LOGV2_WARNING(5097116, "Skipping empty bind address");
+            continue;
+        }
+
+        auto resolved = SockAddr::createAll(
+            ip, _listenerPort, _listenerOptions.enableIPv6 ? AF_UNSPEC : AF_INET);
+        if (resolved.empty()) {
+            LOGV2_WARNING(5097117, "Found no addresses", "address"_attr = ip);
+            continue;
+        }
+        addrs.insert(resolved.begin(), resolved.end());
+    }
+
+    for (auto& addr : addrs) {
+        const auto family = addr.getType();
+        if (family == AF_UNIX) {
+            if (::unlink(addr.getAddr().c_str()) == -1 && errno != ENOENT) {
+                return {ErrorCodes::SocketException,
+                        str::stream() << "Failed to unlink socket file " << addr.getAddr() << " "
+                                      << errnoWithDescription()};
+            }
+        }
+
+        if (family == AF_INET6 && !_listenerOptions.enableIPv6) {
+            return {ErrorCodes::BadValue, "Specified ipv6 bind address, but ipv6 is disabled"};
+        }
+
+        int fd = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            // Allow the server to start when "ipv6: true" and "bindIpAll: true", but the platform
+            // does not support ipv6.
+            if (errno == EAFNOSUPPORT && family == AF_INET6 && addr.isDefaultRoute()) {
+                LOGV2_WARNING(5097118,
+                              "Failed to bind to {bind_addr} as the platform does not support ipv6",
+                              "bind_addr"_attr = addr.toString());
+                continue;
+            }
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to create socket for " << addr.toString() << ": "
+                                  << errnoWithDescription()};
+        }
+        _listenSockets.emplace_back(addr, fd);
+
+        const int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (family == AF_INET6) {
+            ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &one, sizeof(one));
+        }
+
+        if (::bind(fd, addr.raw(), addr.addressSize) != 0) {
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to bind to " << addr.toString() << ": "
+                                  << errnoWithDescription()};
+        }
+
+        if (family == AF_UNIX) {
+            if (::chmod(addr.getAddr().c_str(), serverGlobalParams.unixSocketPermissions) == -1) {
+                return {ErrorCodes::SocketException,
+                        str::stream() << "Failed to chmod socket file " << addr.getAddr() << " "
+                                      << errnoWithDescription()};
+            }
+        }
+
+        if (_listenerOptions.port == 0 && (family == AF_INET || family == AF_INET6)) {
+            if (_listenerPort != _listenerOptions.port) {
+                return {ErrorCodes::BadValue,
+                        "Port 0 (ephemeral port) is not allowed when"
+                        " listening on multiple IP interfaces"};
+            }
+
+            sockaddr_storage storage;
+            socklen_t len = sizeof(storage);
+            if (::getsockname(fd, reinterpret_cast<sockaddr*>(&storage), &len) != 0) {
+                return {ErrorCodes::SocketException, errnoWithDescription()};
+            }
+            _listenerPort = SockAddr(reinterpret_cast<sockaddr*>(&storage), len).getPort();
+        }
+    }
+
+    if (_listenSockets.empty()) {
+        return {ErrorCodes::SocketException, "No available addresses/ports to bind to"};
+    }
+
+    return Status::OK();
+}
+
+void TransportLayerUring::_runListener() noexcept {
+    setThreadName("listener");
+
+    stdx::unique_lock lk(_mutex);
+    if (_isShutdown) {
+        return;
+    }
+
+    for (auto& listenSocket : _listenSockets) {
+        if (::listen(listenSocket.second, serverGlobalParams.listenBacklog) != 0) {
+            LOGV2_FATAL(5097119,
+                        "Error listening for new connections on {address}: {error}",
+                        "Error listening for new connections",
+                        "address"_attr = listenSocket.first,
+                        "error"_attr = errnoWithDescription());
+        }
+
+        _acceptConnection(listenSocket.second);
+        LOGV2(5097120, "Listening on", "address"_attr = listenSocket.first.getAddr());
+    }
+
+    LOGV2(5097121,
+          "Waiting for connections",
+          "port"_attr = _listenerPort,
+          "ssl"_attr = "off",
+          "transportLayer"_attr = "uring");
+
+    _listener.active = true;
+    _listener.cv.notify_all();
+    ON_BLOCK_EXIT([&] {
+        _listener.active = false;
+        _listener.cv.notify_all();
+    });
+
+    while (!_isShutdown) {
+        lk.unlock();
+        _acceptorReactor->run();
+        lk.lock();
+    }
+
+    // Cancel the multishot accepts so that no new connections are opened. The sockets themselves
+    // are closed when the transport layer is destroyed, as TransportLayerASIO does.
+    for (auto& listenSocket : _listenSockets) {
+        _acceptorReactor->cancelFd(listenSocket.second);
+        auto& addr = listenSocket.first;
+        if (addr.getType() == AF_UNIX && !addr.isAnonymousUNIXSocket()) {
+            auto path = addr.getAddr();
+            LOGV2(5097122, "removing socket file: {path}", "path"_attr = path);
+            if (::unlink(path.c_str()) != 0) {
+                LOGV2_WARNING(5097123,
+                              "Unable to remove UNIX socket {path}: {error}",
+                              "Unable to remove UNIX socket",
+                              "path"_attr = path,
+                              "error"_attr = errnoWithDescription());
+            }
+        }
+    }
+}
+
+void TransportLayerUring::_acceptConnection(int listenFd) {
+    auto onAccept = [this, listenFd](AcceptOperation* op, int res, bool more) {
+        if (auto lk = stdx::lock_guard(_mutex); _isShutdown) {
+            if (res >= 0) {
+                ::close(res);
+            }
+            return !more;
+        }
+
+        if (res >= 0) {
+            _onAccept(res);
+        } else if (res == -ECANCELED) {
+            return !more;
+        } else {
+            LOGV2(5097124,
+                  "Error accepting new connection",
+                  "listenFd"_attr = listenFd,
+                  "error"_attr = errnoWithDescription(-res));
+        }
+
+        if (!more) {
+            _acceptorReactor->submit(op, [&](io_uring_sqe* sqe) { op->prep(sqe); });
+        }
+        return false;
+    };
+
+    auto op = new AcceptOperation(listenFd, std::move(onAccept));
+    _acceptorReactor->submit(op, [&](io_uring_sqe* sqe) { op->prep(sqe); });
+}
+
+void TransportLayerUring::_onAccept(int fd) {
+    std::shared_ptr<UringSession> session;
+    try {
+        session = std::make_shared<UringSession>(this, _ingressReactor.get(), fd);
+    } catch (const DBException& e) {
+        ::close(fd);
+        LOGV2_WARNING(5097125, "Error accepting new connection", "error"_attr = e);
+        return;
+    }
+
+    _sep->startSession(std::move(session));
+}
+
+Status TransportLayerUring::start() {
+    if (auto status = _egressLayer->start(); !status.isOK()) {
+        return status;
+    }
+
+    stdx::unique_lock lk(_mutex);
+
+    // Make sure we haven't shutdown already
+    invariant(!_isShutdown);
+
+    if (_listenerOptions.isIngress()) {
+        _listener.thread = stdx::thread([this] { _runListener(); });
+        _listener.cv.wait(lk, [&] { return _isShutdown || _listener.active; });
+    }
+
+    return Status::OK();
+}
+
+void TransportLayerUring::shutdown() {
+    _egressLayer->shutdown();
+
+    stdx::unique_lock lk(_mutex);
+    if (std::exchange(_isShutdown, true)) {
+        // We were already stopped
+        return;
+    }
+
+    auto thread = std::exchange(_listener.thread, {});
+    if (!thread.joinable()) {
+        // If the listener never started, then we can return now
+        return;
+    }
+
+    // Spam stop() on the reactor, it interrupts run()
+    while (_listener.active) {
+        lk.unlock();
+        _acceptorReactor->stop();
+        lk.lock();
+    }
+
+    // Release the lock and wait for the thread to die
+    lk.unlock();
+    thread.join();
+}
+
+ReactorHandle TransportLayerUring::getReactor(WhichReactor which) {
+    switch (which) {
+        case TransportLayer::kIngress:
+            return _ingressReactor;
+        case TransportLayer::kEgress:
+        case TransportLayer::kNewReactor:
+            return _egressLayer->getReactor(which);
+    }
+
+    MONGO_UNREACHABLE;
+}
+
+#else  // MONGO_TRANSPORT_HAVE_URING
+
+bool TransportLayerUring::isSupported() {
+    return false;
+}
+
+TransportLayerUring::TransportLayerUring(const Options& opts, ServiceEntryPoint* sep)
+    : _sep(sep), _listenerOptions(opts) {
+    MONGO_UNREACHABLE;
+}
+
+TransportLayerUring::~TransportLayerUring() = default;
+
+StatusWith<SessionHandle> TransportLayerUring::connect(HostAndPort peer,
+                                                       ConnectSSLMode sslMode,
+                                                       Milliseconds timeout) {
+    MONGO_UNREACHABLE;
+}
+
+Future<SessionHandle> TransportLayerUring::asyncConnect(HostAndPort peer,
+                                                        ConnectSSLMode sslMode,
+                                                        const ReactorHandle& reactor,
+                                                        Milliseconds timeout) {
+    MONGO_UNREACHABLE;
+}
+
+BatonHandle TransportLayerUring::makeBaton(OperationContext* opCtx) const {
+    MONGO_UNREACHABLE;
+}
+
+Status TransportLayerUring::setup() {
+    MONGO_UNREACHABLE;
+}
+
+Status TransportLayerUring::start() {
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerUring::shutdown() {
+    MONGO_UNREACHABLE;
+}
+
+ReactorHandle TransportLayerUring::getReactor(WhichReactor which) {
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerUring::_acceptConnection(int listenFd) {
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerUring::_onAccept(int fd) {
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerUring::_runListener() noexcept {
+    MONGO_UNREACHABLE;
+}
+
+#endif  // MONGO_TRANSPORT_HAVE_URING
+
+}  // namespace transport
+}  // namespace mongo
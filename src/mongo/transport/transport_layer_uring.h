@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/hierarchical_acquisition.h"
+#include "mongo/util/net/sockaddr.h"
+
+namespace mongo {
+
+class ServiceEntryPoint;
+
+namespace transport {
+
+/**
+ * A TransportLayer implementation that drives ingress networking with Linux io_uring.
+ *
+ * Listening sockets use multishot accept, so a single submission keeps producing connections.
+ * Asynchronous sessions read with multishot recv into a ring of buffers registered with the
+ * kernel, and all submissions made while the reactor is running are flushed together with the
+ * io_uring_enter() call that waits for completions. Synchronous sessions use blocking socket
+ * calls on the accepted descriptor, as TransportLayerASIO does.
+ *
+ * TLS is not supported. Egress connections are delegated to an egress-only TransportLayerASIO.
+ *
+ * Callers must check isSupported() before constructing one; TransportLayerManager falls back to
+ * TransportLayerASIO when the running kernel does not provide the required io_uring features.
+ */
+class TransportLayerUring final : public TransportLayer {
+    TransportLayerUring(const TransportLayerUring&) = delete;
+    TransportLayerUring& operator=(const TransportLayerUring&) = delete;
+
+public:
+    using Options = TransportLayerASIO::Options;
+
+    /**
+     * Returns true if the process can create an io_uring instance that supports every operation
+     * this transport layer relies on. The probe runs once and its result is cached.
+     */
+    static bool isSupported();
+
+    TransportLayerUring(const Options& opts, ServiceEntryPoint* sep);
+
+    ~TransportLayerUring() override;
+
+    StatusWith<SessionHandle> connect(HostAndPort peer,
+                                      ConnectSSLMode sslMode,
+                                      Milliseconds timeout) final;
+
+    Future<SessionHandle> asyncConnect(HostAndPort peer,
+                                       ConnectSSLMode sslMode,
+                                       const ReactorHandle& reactor,
+                                       Milliseconds timeout) final;
+
+    Status setup() final;
+
+    ReactorHandle getReactor(WhichReactor which) final;
+
+    Status start() final;
+
+    void shutdown() final;
+
+    BatonHandle makeBaton(OperationContext* opCtx) const override;
+
+    int listenerPort() const {
+        return _listenerPort;
+    }
+
+private:
+    class UringReactor;
+    class UringSession;
+
+    void _acceptConnection(int listenFd);
+    void _onAccept(int fd);
+
+    void _runListener() noexcept;
+
+    Mutex _mutex = MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "TransportLayerUring::_mutex");
+
+    // The _ingressReactor carries all I/O for accepted sessions and is run by the service executor
+    // in asynchronous mode. The _acceptorReactor only carries the multishot accepts and is run by
+    // the listener thread.
+    std::shared_ptr<UringReactor> _ingressReactor;
+    std::shared_ptr<UringReactor> _acceptorReactor;
+
+    std::unique_ptr<TransportLayerASIO> _egressLayer;
+
+    std::vector<std::pair<SockAddr, int>> _listenSockets;
+
+    struct Listener {
+        stdx::thread thread;
+        stdx::condition_variable cv;
+        bool active = false;
+    };
+    Listener _listener;
+
+    ServiceEntryPoint* const _sep = nullptr;
+
+    Options _listenerOptions;
+    int _listenerPort = 0;
+
+    bool _isShutdown = false;
+};
+
+}  // namespace transport
+}  // namespace mongo
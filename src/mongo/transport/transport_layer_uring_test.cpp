@@ -0,0 +1,348 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kTest
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_uring.h"
+
+#include "mongo/db/server_options.h"
+#include "mongo/logv2/log.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+
+#include "asio.hpp"
+
+namespace mongo {
+namespace {
+
+bool uringSupported() {
+    if (!transport::TransportLayerUring::isSupported()) {
+        LOGV2(5097128, "io_uring is not supported by this kernel, skipping test");
+        return false;
+    }
+    return true;
+}
+
+class SessionCollectorSEP : public ServiceEntryPoint {
+public:
+    void startSession(transport::SessionHandle session) override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _sessions.push_back(std::move(session));
+        _cv.notify_one();
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {
+        std::vector<transport::SessionHandle> sessions;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            sessions.swap(_sessions);
+        }
+        for (auto& session : sessions) {
+            session->end();
+        }
+    }
+
+    Status start() override {
+        return Status::OK();
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    void appendStats(BSONObjBuilder*) const override {}
+
+    size_t numOpenSessions() const override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        return _sessions.size();
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    transport::SessionHandle waitForSession() {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return !_sessions.empty(); });
+        return _sessions.back();
+    }
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("SessionCollectorSEP::_mutex");
+    stdx::condition_variable _cv;
+    std::vector<transport::SessionHandle> _sessions;
+};
+
+std::unique_ptr<transport::TransportLayerUring> makeAndStartTL(ServiceEntryPoint* sep) {
+    auto options = [] {
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        transport::TransportLayerUring::Options opts(&params);
+        opts.port = 0;
+        return opts;
+    }();
+
+    auto tl = std::make_unique<transport::TransportLayerUring>(options, sep);
+    ASSERT_OK(tl->setup());
+    ASSERT_OK(tl->start());
+    return tl;
+}
+
+Message makePing(int id) {
+    OpMsgBuilder builder;
+    builder.setBody(BSON("ping" << 1 << "id" << id));
+    Message msg = builder.finish();
+    msg.header().setResponseToMsgId(0);
+    msg.header().setId(id);
+    return msg;
+}
+
+/**
+ * A loopback client that writes whole messages and reads them back.
+ */
+class LoopbackClient {
+public:
+    explicit LoopbackClient(int port)
+        : _sock(_ctx), _endpoint(asio::ip::address_v4::loopback(), port) {
+        std::error_code ec;
+        _sock.connect(_endpoint, ec);
+        ASSERT_EQ(ec, std::error_code());
+    }
+
+    void send(const Message& msg) {
+        std::error_code ec;
+        asio::write(_sock, asio::buffer(msg.buf(), msg.size()), ec);
+        ASSERT_FALSE(ec);
+    }
+
+    Message receive() {
+        std::error_code ec;
+        auto header = SharedBuffer::allocate(sizeof(MSGHEADER::Value));
+        asio::read(_sock, asio::buffer(header.get(), sizeof(MSGHEADER::Value)), ec);
+        ASSERT_FALSE(ec);
+
+        auto msgLen = size_t(MSGHEADER::ConstView(header.get()).getMessageLength());
+        auto buffer = SharedBuffer::allocate(msgLen);
+        memcpy(buffer.get(), header.get(), sizeof(MSGHEADER::Value));
+        asio::read(_sock,
+                   asio::buffer(buffer.get() + sizeof(MSGHEADER::Value),
+                                msgLen - sizeof(MSGHEADER::Value)),
+                   ec);
+        ASSERT_FALSE(ec);
+        return Message(std::move(buffer));
+    }
+
+    void close() {
+        _sock.close();
+    }
+
+private:
+    asio::io_context _ctx;
+    asio::ip::tcp::socket _sock;
+    asio::ip::tcp::endpoint _endpoint;
+};
+
+/**
+ * Runs a reactor on a background thread for the lifetime of the object.
+ */
+class ReactorThread {
+public:
+    explicit ReactorThread(transport::ReactorHandle reactor)
+        : _reactor(std::move(reactor)), _thread([this] { _reactor->run(); }) {}
+
+    ~ReactorThread() {
+        _reactor->stop();
+        _thread.join();
+    }
+
+private:
+    transport::ReactorHandle _reactor;
+    stdx::thread _thread;
+};
+
+TEST(TransportLayerUring, PortZeroConnect) {
+    if (!uringSupported()) {
+        return;
+    }
+
+    SessionCollectorSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    ASSERT_GT(tl->listenerPort(), 0);
+
+    LoopbackClient client(tl->listenerPort());
+    auto session = sep.waitForSession();
+    ASSERT_EQ(session->getTransportLayer(), tl.get());
+    ASSERT_EQ(session->localAddr().getPort(), unsigned(tl->listenerPort()));
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, SourceSyncTimeoutTimesOut) {
+    if (!uringSupported()) {
+        return;
+    }
+
+    SessionCollectorSEP sep;
+    auto tl = makeAndStartTL(&sep);
+
+    LoopbackClient client(tl->listenerPort());
+    auto session = sep.waitForSession();
+    session->setTimeout(Milliseconds{500});
+    ASSERT_EQ(session->sourceMessage().getStatus(), ErrorCodes::NetworkTimeout);
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, SyncRoundTrip) {
+    if (!uringSupported()) {
+        return;
+    }
+
+    SessionCollectorSEP sep;
+    auto tl = makeAndStartTL(&sep);
+
+    LoopbackClient client(tl->listenerPort());
+    auto session = sep.waitForSession();
+    session->setTimeout(Milliseconds{5000});
+
+    auto ping = makePing(1);
+    client.send(ping);
+    auto received = uassertStatusOK(session->sourceMessage());
+    ASSERT_EQ(received.size(), ping.size());
+    ASSERT_EQ(memcmp(received.buf(), ping.buf(), ping.size()), 0);
+
+    ASSERT_OK(session->sinkMessage(received));
+    auto echoed = client.receive();
+    ASSERT_EQ(memcmp(echoed.buf(), ping.buf(), ping.size()), 0);
+
+    client.close();
+    ASSERT_EQ(session->sourceMessage().getStatus(), ErrorCodes::HostUnreachable);
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, AsyncPipelinedRoundTrip) {
+    if (!uringSupported()) {
+        return;
+    }
+
+    SessionCollectorSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    ReactorThread reactorThread(tl->getReactor(transport::TransportLayer::kIngress));
+
+    LoopbackClient client(tl->listenerPort());
+    auto session = sep.waitForSession();
+
+    // Send more messages than a session reads ahead before any of them are consumed, so that the
+    // multishot recv is throttled and re-armed.
+    constexpr int kMessages = 64;
+    for (int i = 0; i < kMessages; ++i) {
+        client.send(makePing(i));
+    }
+
+    for (int i = 0; i < kMessages; ++i) {
+        auto msg = session->asyncSourceMessage().get();
+        ASSERT_EQ(msg.header().getId(), i);
+        session->asyncSinkMessage(msg).get();
+    }
+
+    for (int i = 0; i < kMessages; ++i) {
+        ASSERT_EQ(client.receive().header().getId(), i);
+    }
+
+    client.close();
+    ASSERT_EQ(session->asyncSourceMessage().getNoThrow().getStatus(),
+              ErrorCodes::HostUnreachable);
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, AsyncSourceCanBeCanceled) {
+    if (!uringSupported()) {
+        return;
+    }
+
+    SessionCollectorSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    ReactorThread reactorThread(tl->getReactor(transport::TransportLayer::kIngress));
+
+    LoopbackClient client(tl->listenerPort());
+    auto session = sep.waitForSession();
+
+    auto future = session->asyncSourceMessage();
+    session->cancelAsyncOperations();
+    ASSERT_EQ(future.getNoThrow().getStatus(), ErrorCodes::CallbackCanceled);
+
+    // The session is still usable after a cancellation.
+    client.send(makePing(7));
+    ASSERT_EQ(session->asyncSourceMessage().get().header().getId(), 7);
+
+    sep.endAllSessions({});
+    tl->shutdown();
+}
+
+TEST(TransportLayerUring, ReactorRunsTasksAndTimers) {
+    if (!uringSupported()) {
+        return;
+    }
+
+    SessionCollectorSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    auto reactor = tl->getReactor(transport::TransportLayer::kIngress);
+    ReactorThread reactorThread(reactor);
+
+    auto pf = makePromiseFuture<bool>();
+    reactor->schedule([&](Status status) {
+        ASSERT_OK(status);
+        pf.promise.emplaceValue(reactor->onReactorThread());
+    });
+    ASSERT_TRUE(pf.future.get());
+
+    auto timer = reactor->makeTimer();
+    const auto start = reactor->now();
+    timer->waitUntil(start + Milliseconds(50)).get();
+    ASSERT_GTE(reactor->now() - start, Milliseconds(50));
+
+    auto canceled = timer->waitUntil(reactor->now() + Hours(1));
+    timer->cancel();
+    ASSERT_EQ(canceled.getNoThrow(), ErrorCodes::CallbackCanceled);
+
+    tl->shutdown();
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/arena.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+struct alignas(std::max_align_t) Arena::Block {
+    // One reference per live allocation, plus one while the block is the arena's current block.
+    AtomicWord<int64_t> refCount{1};
+
+    char* begin() {
+        return reinterpret_cast<char*>(this + 1);
+    }
+};
+
+namespace {
+
+/**
+ * Precedes every allocation, naming the block it was carved from, or null if it came from the
+ * heap. Padded so that the allocation which follows it is suitably aligned.
+ */
+struct alignas(std::max_align_t) AllocationHeader {
+    void* block;
+};
+
+constexpr size_t roundUpToAlignment(size_t size) {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+}
+
+thread_local Arena* currentArena = nullptr;
+
+void* allocateFromHeap(size_t size) {
+    auto header = new (mongoMalloc(sizeof(AllocationHeader) + size)) AllocationHeader{nullptr};
+    return header + 1;
+}
+
+}  // namespace
+
+Arena::CurrentScope::CurrentScope(Arena* arena) : _arena(arena), _previous(currentArena) {
+    currentArena = arena;
+}
+
+Arena::CurrentScope::~CurrentScope() {
+    currentArena = _previous;
+    if (_arena) {
+        _arena->rewindIfUnused();
+    }
+}
+
+Arena::~Arena() {
+    if (_current) {
+        releaseBlock(_current);
+    }
+}
+
+void* Arena::allocate(size_t size) {
+    if (currentArena) {
+        return currentArena->allocateFromArena(size);
+    }
+    return allocateFromHeap(size);
+}
+
+void Arena::deallocate(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+
+    auto header = static_cast<AllocationHeader*>(ptr) - 1;
+    if (auto block = static_cast<Block*>(header->block)) {
+        releaseBlock(block);
+    } else {
+        std::free(header);
+    }
+}
+
+void Arena::rewindIfUnused() {
+    if (_current && _current->refCount.load() == 1) {
+        // Everything carved from the current block has already been freed. Since only this thread
+        // allocates from the block, nothing can start referring to it again behind our back, so it
+        // is safe to start over.
+        _next = _current->begin();
+    }
+}
+
+void* Arena::allocateFromArena(size_t size) {
+    if (size > kMaxArenaAllocationSize) {
+        return allocateFromHeap(size);
+    }
+
+    const size_t bytesNeeded = sizeof(AllocationHeader) + roundUpToAlignment(size);
+
+    if (static_cast<size_t>(_end - _next) < bytesNeeded) {
+        rewindIfUnused();
+    }
+    if (static_cast<size_t>(_end - _next) < bytesNeeded) {
+        if (_current) {
+            releaseBlock(_current);
+        }
+        _current = new (mongoMalloc(sizeof(Block) + kBlockSize)) Block;
+        _next = _current->begin();
+        _end = _next + kBlockSize;
+        ++_numBlocksAllocated;
+    }
+
+    _current->refCount.fetchAndAdd(1);
+    auto header = new (_next) AllocationHeader{_current};
+    _next += bytesNeeded;
+    return header + 1;
+}
+
+void Arena::releaseBlock(Block* block) noexcept {
+    if (block->refCount.subtractAndFetch(1) == 0) {
+        block->~Block();
+        std::free(block);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+/**
+ * A bump allocator for the short-lived objects created while running an operation, such as the
+ * documents which flow through a query plan.
+ *
+ * Memory is carved out of fixed-size blocks. Each block counts the allocations within it which
+ * are still live, and goes back to the heap once the arena has moved on to another block and all
+ * of them have been freed. An allocation may therefore outlive the arena, for example a document
+ * cached by a cursor across getMores, and may be freed on any thread. Such an allocation only
+ * keeps its own block alive. When every allocation in the arena's current block has been freed,
+ * the block is reused from the start, so an operation which frees its documents as it goes runs
+ * out of a single block.
+ *
+ * Only the thread which owns an arena may allocate from it. Code which is not handed an arena
+ * explicitly calls the static allocate(), which draws from the arena installed on the current
+ * thread by a CurrentScope, or from the heap if there is none.
+ */
+class Arena {
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+public:
+    static constexpr size_t kBlockSize = 16 * 1024;
+
+    // Larger requests are served by the heap, so that one large object which escapes the
+    // operation cannot keep a block alive on its own.
+    static constexpr size_t kMaxArenaAllocationSize = 1024;
+
+    /**
+     * Makes 'arena' the current arena of this thread for the lifetime of the scope. Scopes nest.
+     *
+     * On exit, the arena goes back to the start of its current block if everything allocated from
+     * that block has already been freed, so that each scope starts from a clean block rather than
+     * only reusing it once it fills up.
+     */
+    class CurrentScope {
+        CurrentScope(const CurrentScope&) = delete;
+        CurrentScope& operator=(const CurrentScope&) = delete;
+
+    public:
+        explicit CurrentScope(Arena* arena);
+        ~CurrentScope();
+
+    private:
+        Arena* const _arena;
+        Arena* const _previous;
+    };
+
+    /**
+     * Deleter for std::unique_ptr which owns memory obtained from allocate().
+     */
+    struct Deleter {
+        void operator()(void* ptr) const noexcept {
+            deallocate(ptr);
+        }
+    };
+
+    Arena() = default;
+    ~Arena();
+
+    /**
+     * Allocates 'size' bytes, suitably aligned for any type, from the current arena of this
+     * thread, or from the heap if there is none.
+     */
+    static void* allocate(size_t size);
+
+    /**
+     * Frees memory obtained from allocate() or allocateFromArena(), regardless of which arena or
+     * thread it was allocated by. Accepts nullptr.
+     */
+    static void deallocate(void* ptr) noexcept;
+
+    /**
+     * Allocates 'size' bytes from this arena. Must be called on the thread which owns it.
+     */
+    void* allocateFromArena(size_t size);
+
+    /**
+     * Starts carving allocations from the beginning of the current block again if none of those
+     * made from it are still live. Must be called on the thread which owns the arena.
+     */
+    void rewindIfUnused();
+
+    /**
+     * Returns the number of blocks this arena has obtained from the heap.
+     */
+    size_t getNumBlocksAllocated() const {
+        return _numBlocksAllocated;
+    }
+
+private:
+    struct Block;
+
+    /**
+     * Drops one reference to 'block', returning it to the heap if it was the last one.
+     */
+    static void releaseBlock(Block* block) noexcept;
+
+    // The block allocations are currently carved from, on which the arena holds a reference, and
+    // the unused part of it.
+    Block* _current = nullptr;
+    char* _next = nullptr;
+    char* _end = nullptr;
+
+    size_t _numBlocksAllocated = 0;
+};
+
+}  // namespace mongo
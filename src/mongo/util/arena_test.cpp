@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/arena.h"
+#include "mongo/util/intrusive_counter.h"
+
+namespace mongo {
+namespace {
+
+bool isAligned(void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t) == 0;
+}
+
+TEST(ArenaTest, AllocationsAreAlignedAndDistinct) {
+    Arena arena;
+    std::vector<char*> ptrs;
+    for (size_t size = 1; size <= 100; ++size) {
+        auto ptr = static_cast<char*>(arena.allocateFromArena(size));
+        ASSERT_TRUE(isAligned(ptr));
+        std::memset(ptr, static_cast<int>(size), size);
+        ptrs.push_back(ptr);
+    }
+
+    for (size_t size = 1; size <= 100; ++size) {
+        auto ptr = ptrs[size - 1];
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(ptr[i], static_cast<char>(size));
+        }
+        Arena::deallocate(ptr);
+    }
+    ASSERT_EQ(arena.getNumBlocksAllocated(), 1U);
+}
+
+TEST(ArenaTest, ReusesBlockOnceEverythingInItIsFreed) {
+    Arena arena;
+    for (int i = 0; i < 10000; ++i) {
+        Arena::deallocate(arena.allocateFromArena(100));
+    }
+    ASSERT_EQ(arena.getNumBlocksAllocated(), 1U);
+}
+
+TEST(ArenaTest, ScopeExitRewindsBlockOnceEverythingInItIsFreed) {
+    Arena arena;
+    void* first;
+    {
+        Arena::CurrentScope scope(&arena);
+        first = Arena::allocate(16);
+        Arena::deallocate(first);
+    }
+
+    {
+        Arena::CurrentScope scope(&arena);
+        auto ptr = Arena::allocate(16);
+        ASSERT_EQ(ptr, first);
+
+        // A live allocation stops the next scope from rewinding over it.
+        void* second;
+        {
+            Arena::CurrentScope innerScope(&arena);
+            second = Arena::allocate(16);
+        }
+        auto third = Arena::allocate(16);
+        ASSERT_NE(third, second);
+        Arena::deallocate(third);
+        Arena::deallocate(second);
+        Arena::deallocate(ptr);
+    }
+    ASSERT_EQ(arena.getNumBlocksAllocated(), 1U);
+}
+
+TEST(ArenaTest, MovesToANewBlockWhileAllocationsAreLive) {
+    Arena arena;
+    std::vector<void*> live;
+    for (size_t i = 0; i < 2 * Arena::kBlockSize / 100; ++i) {
+        live.push_back(arena.allocateFromArena(100));
+    }
+    ASSERT_GT(arena.getNumBlocksAllocated(), 1U);
+
+    for (auto ptr : live) {
+        Arena::deallocate(ptr);
+    }
+}
+
+TEST(ArenaTest, LargeAllocationsComeFromTheHeap) {
+    Arena arena;
+    auto ptr = arena.allocateFromArena(Arena::kMaxArenaAllocationSize + 1);
+    ASSERT_TRUE(isAligned(ptr));
+    ASSERT_EQ(arena.getNumBlocksAllocated(), 0U);
+    Arena::deallocate(ptr);
+}
+
+TEST(ArenaTest, StaticAllocateUsesTheCurrentArena) {
+    Arena arena;
+    Arena::deallocate(Arena::allocate(16));
+    ASSERT_EQ(arena.getNumBlocksAllocated(), 0U);
+
+    {
+        Arena::CurrentScope scope(&arena);
+        Arena::deallocate(Arena::allocate(16));
+        ASSERT_EQ(arena.getNumBlocksAllocated(), 1U);
+
+        Arena inner;
+        {
+            Arena::CurrentScope innerScope(&inner);
+            Arena::deallocate(Arena::allocate(16));
+        }
+        ASSERT_EQ(inner.getNumBlocksAllocated(), 1U);
+
+        Arena::deallocate(Arena::allocate(16));
+        ASSERT_EQ(arena.getNumBlocksAllocated(), 1U);
+    }
+
+    Arena::deallocate(Arena::allocate(16));
+    ASSERT_EQ(arena.getNumBlocksAllocated(), 1U);
+}
+
+TEST(ArenaTest, AllocationsMayOutliveTheArenaAndBeFreedOnAnotherThread) {
+    boost::intrusive_ptr<const RCString> str;
+    {
+        Arena arena;
+        Arena::CurrentScope scope(&arena);
+        str = RCString::create("a string which escapes the operation");
+    }
+
+    stdx::thread([str = std::move(str)]() mutable {
+        ASSERT_EQ(str->stringData(), "a string which escapes the operation");
+        str.reset();
+    }).join();
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,234 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace {
+
+// How quickly the baseline latency follows the current latency when the latter is higher
+constexpr double kBaselineDecay = 0.01;
+
+// Lower bound of the latency gradient, which limits how much a single adjustment can shrink
+constexpr double kMinGradient = 0.5;
+
+// Fraction of the computed change applied in each adjustment, to smooth out noise
+constexpr double kSmoothing = 0.2;
+
+// Factor by which resource pressure shrinks the pool
+constexpr double kResourcePressureFactor = 0.8;
+
+// Relative throughput drop after an increase which causes the increase to be undone
+constexpr double kThroughputTolerance = 0.1;
+
+// Fraction of the tickets which must be in use on average for the pool to count as saturated
+constexpr double kSaturatedFraction = 0.9;
+
+}  // namespace
+
+StringData AdaptiveTicketController::decisionName(Decision decision) {
+    switch (decision) {
+        case Decision::kNone:
+            return "none"_sd;
+        case Decision::kIncrease:
+            return "increase"_sd;
+        case Decision::kDecrease:
+            return "decrease"_sd;
+        case Decision::kRevertIncrease:
+            return "revertIncrease"_sd;
+        case Decision::kResourcePressure:
+            return "resourcePressure"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+AdaptiveTicketController::AdaptiveTicketController(TicketHolder* holder)
+    : _holder(holder), _lastNumReleased(holder->numReleased()) {}
+
+void AdaptiveTicketController::reset() {
+    _usedSum = 0;
+    _waitingSum = 0;
+    _numSamples = 0;
+    _lastNumReleased = _holder->numReleased();
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _baselineLatencyMicros = 0;
+    _latencyMicros = 0;
+    _throughput = 0;
+    _throughputBeforeIncrease = 0;
+    _sizeBeforeIncrease = 0;
+    _lastDecision = Decision::kNone;
+}
+
+void AdaptiveTicketController::sample() {
+    _usedSum += _holder->used();
+    _waitingSum += _holder->waiting();
+    _numSamples++;
+}
+
+AdaptiveTicketController::Decision AdaptiveTicketController::adjust(Milliseconds interval,
+                                                                    bool resourcePressure,
+                                                                    int minTickets,
+                                                                    int maxTickets) {
+    Observation observation;
+    observation.interval = interval;
+    observation.resourcePressure = resourcePressure;
+
+    const int64_t numReleased = _holder->numReleased();
+    observation.numReleased = numReleased - _lastNumReleased;
+    _lastNumReleased = numReleased;
+
+    if (_numSamples > 0) {
+        observation.avgUsed = static_cast<double>(_usedSum) / _numSamples;
+        observation.avgWaiting = static_cast<double>(_waitingSum) / _numSamples;
+    }
+    _usedSum = 0;
+    _waitingSum = 0;
+    _numSamples = 0;
+
+    const int current = _holder->outof();
+    const int target = computeTarget(observation, current, minTickets, maxTickets);
+    if (target != current) {
+        Status status = _holder->resize(target);
+        if (!status.isOK()) {
+            LOGV2_WARNING(5097100,
+                          "Failed to adjust the number of tickets",
+                          "from"_attr = current,
+                          "to"_attr = target,
+                          "error"_attr = status);
+        }
+    }
+
+    return lastDecision();
+}
+
+int AdaptiveTicketController::computeTarget(const Observation& observation,
+                                            int current,
+                                            int minTickets,
+                                            int maxTickets) {
+    stdx::lock_guard<Latch> lk(_mutex);
+
+    const double intervalMicros = durationCount<Microseconds>(observation.interval);
+    _throughput = intervalMicros > 0 ? observation.numReleased * 1'000'000 / intervalMicros : 0;
+
+    // By Little's law, the average number of tickets in use is the rate at which they are
+    // released times the average time for which they are held.
+    if (observation.numReleased > 0) {
+        _latencyMicros = observation.avgUsed * intervalMicros / observation.numReleased;
+        if (_baselineLatencyMicros == 0 || _latencyMicros < _baselineLatencyMicros) {
+            _baselineLatencyMicros = _latencyMicros;
+        } else {
+            _baselineLatencyMicros += (_latencyMicros - _baselineLatencyMicros) * kBaselineDecay;
+        }
+    }
+
+    const bool saturated =
+        observation.avgWaiting > 0 || observation.avgUsed >= current * kSaturatedFraction;
+
+    double target = current;
+    Decision decision = Decision::kNone;
+    if (observation.resourcePressure) {
+        target = std::floor(current * kResourcePressureFactor);
+        decision = Decision::kResourcePressure;
+    } else if (_lastDecision == Decision::kIncrease &&
+               _throughput < _throughputBeforeIncrease * (1 - kThroughputTolerance)) {
+        target = _sizeBeforeIncrease;
+        decision = Decision::kRevertIncrease;
+    } else if (saturated && _latencyMicros > 0) {
+        // Without any waiters there is no point in growing, but the pool may still be shrunk when
+        // the tickets in use take longer to be released than they used to
+        const double gradient =
+            std::clamp(_baselineLatencyMicros / _latencyMicros, kMinGradient, 1.0);
+        const double headroom = observation.avgWaiting > 0 ? std::sqrt(current) : 0;
+        const double change =
+            std::round((current * gradient + headroom - current) * kSmoothing);
+
+        target = current + change;
+        if (change > 0) {
+            decision = Decision::kIncrease;
+        } else if (change < 0) {
+            decision = Decision::kDecrease;
+        }
+    }
+
+    const int newSize = std::clamp(static_cast<int>(target), minTickets, maxTickets);
+    if (newSize == current) {
+        decision = Decision::kNone;
+    } else if (decision == Decision::kNone) {
+        // The bounds changed since the last adjustment
+        decision = newSize > current ? Decision::kIncrease : Decision::kDecrease;
+    }
+
+    switch (decision) {
+        case Decision::kNone:
+            break;
+        case Decision::kIncrease:
+            _throughputBeforeIncrease = _throughput;
+            _sizeBeforeIncrease = current;
+            _numIncreases++;
+            break;
+        case Decision::kDecrease:
+        case Decision::kRevertIncrease:
+            _numDecreases++;
+            break;
+        case Decision::kResourcePressure:
+            _numResourcePressureDecreases++;
+            break;
+    }
+    _lastDecision = decision;
+
+    return newSize;
+}
+
+AdaptiveTicketController::Decision AdaptiveTicketController::lastDecision() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _lastDecision;
+}
+
+void AdaptiveTicketController::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    builder->append("lastDecision", decisionName(_lastDecision));
+    builder->append("latencyMicros", _latencyMicros);
+    builder->append("baselineLatencyMicros", _baselineLatencyMicros);
+    builder->append("throughputPerSec", _throughput);
+    builder->append("increases", _numIncreases);
+    builder->append("decreases", _numDecreases);
+    builder->append("resourcePressureDecreases", _numResourcePressureDecreases);
+}
+
+}  // namespace mongo
@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+
+/**
+ * Periodically resizes a TicketHolder to the amount of concurrency which the system can actually
+ * sustain, in the manner of a gradient-based congestion controller.
+ *
+ * The average time for which a ticket is held is derived from the load observed over each
+ * adjustment interval through Little's law. The lowest such latency seen serves as the baseline
+ * latency of an unloaded system, and the ratio between the baseline and the current latency
+ * scales the number of tickets down when operations slow down because they compete for
+ * resources. Some headroom proportional to the square root of the current size is added on top,
+ * so that the number of tickets keeps growing while there is demand and latency stays flat. An
+ * increase which made throughput drop is undone, and external resource pressure (such as cache
+ * eviction falling behind) shrinks the pool multiplicatively regardless of latency.
+ *
+ * The owner must call sample() at a regular, short interval and adjust() once per adjustment
+ * interval. Both must be called from a single thread; appendStats() may be called from any thread.
+ */
+class AdaptiveTicketController {
+    AdaptiveTicketController(const AdaptiveTicketController&) = delete;
+    AdaptiveTicketController& operator=(const AdaptiveTicketController&) = delete;
+
+public:
+    /**
+     * Load on the TicketHolder observed over one adjustment interval.
+     */
+    struct Observation {
+        Milliseconds interval;
+
+        // Number of tickets released during the interval
+        int64_t numReleased = 0;
+
+        // Average number of tickets in use and of threads waiting for one during the interval
+        double avgUsed = 0;
+        double avgWaiting = 0;
+
+        // Set if some resource shared by the ticket holders is overloaded
+        bool resourcePressure = false;
+    };
+
+    enum class Decision { kNone, kIncrease, kDecrease, kRevertIncrease, kResourcePressure };
+
+    static StringData decisionName(Decision decision);
+
+    explicit AdaptiveTicketController(TicketHolder* holder);
+
+    /**
+     * Forgets everything learned about the workload, for example after the controller was
+     * disabled for some time.
+     */
+    void reset();
+
+    /**
+     * Records the number of tickets currently used and waited for.
+     */
+    void sample();
+
+    /**
+     * Resizes the TicketHolder based on the samples taken since the previous call, keeping its
+     * size within [minTickets, maxTickets]. Returns the decision taken.
+     */
+    Decision adjust(Milliseconds interval, bool resourcePressure, int minTickets, int maxTickets);
+
+    /**
+     * Computes the new number of tickets for the given observation and the current number of
+     * tickets, and records the decision taken. Exposed for testing, adjust() is the entry point
+     * otherwise.
+     */
+    int computeTarget(const Observation& observation, int current, int minTickets, int maxTickets);
+
+    Decision lastDecision() const;
+
+    /**
+     * Reports the latest observation and the decisions taken so far, for serverStatus.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    TicketHolder* const _holder;
+
+    // Accumulated by sample() and consumed by adjust(). Only accessed by the controlling thread.
+    int64_t _usedSum = 0;
+    int64_t _waitingSum = 0;
+    int64_t _numSamples = 0;
+    int64_t _lastNumReleased = 0;
+
+    // Protects the state below, which appendStats() reports.
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("AdaptiveTicketController::_mutex");
+
+    // Lowest average ticket hold time observed, slowly decaying towards the current one so that
+    // the baseline follows changes in the workload. Zero until there has been some throughput.
+    double _baselineLatencyMicros = 0;
+    double _latencyMicros = 0;
+    double _throughput = 0;
+
+    // Throughput before the latest increase, so that the increase can be undone if it hurt.
+    double _throughputBeforeIncrease = 0;
+    int _sizeBeforeIncrease = 0;
+
+    Decision _lastDecision = Decision::kNone;
+    long long _numIncreases = 0;
+    long long _numDecreases = 0;
+    long long _numResourcePressureDecreases = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+namespace mongo {
+namespace {
+
+using Decision = AdaptiveTicketController::Decision;
+
+const int kMinTickets = 5;
+const int kMaxTickets = 1000;
+
+/**
+ * Load where each ticket is held for 'latency' on average.
+ */
+AdaptiveTicketController::Observation makeObservation(double avgUsed,
+                                                      double avgWaiting,
+                                                      Microseconds latency) {
+    AdaptiveTicketController::Observation observation;
+    observation.interval = Seconds(1);
+    observation.avgUsed = avgUsed;
+    observation.avgWaiting = avgWaiting;
+    observation.numReleased = static_cast<int64_t>(
+        avgUsed * durationCount<Microseconds>(Seconds(1)) / durationCount<Microseconds>(latency));
+    return observation;
+}
+
+TEST(AdaptiveTicketControllerTest, GrowsWhileOperationsWaitAndLatencyIsFlat) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    const int target = controller.computeTarget(
+        makeObservation(64, 10, Milliseconds(10)), 64, kMinTickets, kMaxTickets);
+    ASSERT_GT(target, 64);
+    ASSERT(controller.lastDecision() == Decision::kIncrease);
+}
+
+TEST(AdaptiveTicketControllerTest, DoesNotGrowWithoutWaiters) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    ASSERT_EQ(64,
+              controller.computeTarget(
+                  makeObservation(10, 0, Milliseconds(10)), 64, kMinTickets, kMaxTickets));
+    ASSERT(controller.lastDecision() == Decision::kNone);
+
+    // Saturated, but nobody waits and latency is flat
+    ASSERT_EQ(64,
+              controller.computeTarget(
+                  makeObservation(64, 0, Milliseconds(10)), 64, kMinTickets, kMaxTickets));
+    ASSERT(controller.lastDecision() == Decision::kNone);
+}
+
+TEST(AdaptiveTicketControllerTest, ShrinksWhenLatencyRises) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    // Establish the baseline latency
+    ASSERT_EQ(64,
+              controller.computeTarget(
+                  makeObservation(64, 0, Milliseconds(10)), 64, kMinTickets, kMaxTickets));
+
+    const int target = controller.computeTarget(
+        makeObservation(64, 10, Milliseconds(20)), 64, kMinTickets, kMaxTickets);
+    ASSERT_LT(target, 64);
+    ASSERT(controller.lastDecision() == Decision::kDecrease);
+}
+
+TEST(AdaptiveTicketControllerTest, RevertsIncreaseWhichReducedThroughput) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    const int increased = controller.computeTarget(
+        makeObservation(64, 10, Milliseconds(10)), 64, kMinTickets, kMaxTickets);
+    ASSERT_GT(increased, 64);
+
+    // More tickets in use, but each takes much longer to be released
+    ASSERT_EQ(64,
+              controller.computeTarget(makeObservation(increased, 10, Milliseconds(15)),
+                                       increased,
+                                       kMinTickets,
+                                       kMaxTickets));
+    ASSERT(controller.lastDecision() == Decision::kRevertIncrease);
+}
+
+TEST(AdaptiveTicketControllerTest, ShrinksUnderResourcePressure) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    auto observation = makeObservation(64, 10, Milliseconds(10));
+    observation.resourcePressure = true;
+    ASSERT_EQ(51, controller.computeTarget(observation, 64, kMinTickets, kMaxTickets));
+    ASSERT(controller.lastDecision() == Decision::kResourcePressure);
+
+    // Never below the minimum
+    ASSERT_EQ(kMinTickets,
+              controller.computeTarget(observation, kMinTickets, kMinTickets, kMaxTickets));
+    ASSERT(controller.lastDecision() == Decision::kNone);
+}
+
+TEST(AdaptiveTicketControllerTest, StaysWithinBounds) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    ASSERT_EQ(64,
+              controller.computeTarget(
+                  makeObservation(64, 10, Milliseconds(10)), 64, kMinTickets, 64));
+    ASSERT(controller.lastDecision() == Decision::kNone);
+
+    // Bounds which no longer include the current size are applied right away
+    ASSERT_EQ(32,
+              controller.computeTarget(
+                  makeObservation(10, 0, Milliseconds(10)), 64, kMinTickets, 32));
+    ASSERT(controller.lastDecision() == Decision::kDecrease);
+}
+
+TEST(AdaptiveTicketControllerTest, AdjustResizesTicketHolder) {
+    TicketHolder holder(64);
+    AdaptiveTicketController controller(&holder);
+
+    controller.sample();
+    ASSERT(controller.adjust(Seconds(1), true, kMinTickets, kMaxTickets) ==
+           Decision::kResourcePressure);
+    ASSERT_EQ(51, holder.outof());
+
+    BSONObjBuilder builder;
+    controller.appendStats(&builder);
+    auto stats = builder.obj();
+    ASSERT_EQ("resourcePressure", stats["lastDecision"].str());
+    ASSERT_EQ(1, stats["resourcePressureDecreases"].numberLong());
+}
+
+}  // namespace
+}  // namespace mongo
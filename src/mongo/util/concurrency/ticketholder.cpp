@@ -33,9 +33,11 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "mongo/logv2/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -99,6 +101,9 @@ bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
         return true;
     }
 
+    _waiting.fetchAndAdd(1);
+    ON_BLOCK_EXIT([&] { _waiting.fetchAndSubtract(1); });
+
     const Milliseconds intervalMs(500);
     struct timespec ts;
 
@@ -130,6 +135,14 @@ bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
 }
 
 void TicketHolder::release() {
+    _numReleased.fetchAndAdd(1);
+
+    int deficit = _deficit.load();
+    while (deficit > 0) {
+        if (_deficit.compareAndSwap(&deficit, deficit - 1)) {
+            return;
+        }
+    }
     check(sem_post(&_sem));
 }
 
@@ -145,13 +158,23 @@ Status TicketHolder::resize(int newSize) {
                       str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
                                     << "; given " << newSize);
 
+    // Add and remove tickets directly on the semaphore, so that resizing is not accounted for as
+    // tickets being released or waited for. Growing first cancels out any tickets still owed from
+    // an earlier shrink.
     while (_outof.load() < newSize) {
-        release();
+        int deficit = _deficit.load();
+        if (deficit == 0 || !_deficit.compareAndSwap(&deficit, deficit - 1)) {
+            check(sem_post(&_sem));
+        }
         _outof.fetchAndAdd(1);
     }
 
+    // Shrinking never blocks, since the tickets may all be in use for a long time. Those which are
+    // not available now are taken as they are released instead.
     while (_outof.load() > newSize) {
-        waitForTicket();
+        if (!tryAcquire()) {
+            _deficit.fetchAndAdd(1);
+        }
         _outof.subtractAndFetch(1);
     }
 
@@ -162,11 +185,14 @@ Status TicketHolder::resize(int newSize) {
 int TicketHolder::available() const {
     int val = 0;
     check(sem_getvalue(&_sem, &val));
-    return val;
+    return std::max(0, val - _deficit.load());
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    // Tickets still owed to a shrink are in use on top of those counted by outof().
+    int val = 0;
+    check(sem_getvalue(&_sem, &val));
+    return outof() + _deficit.load() - val;
 }
 
 int TicketHolder::outof() const {
@@ -186,6 +212,12 @@ bool TicketHolder::tryAcquire() {
 
 void TicketHolder::waitForTicket(OperationContext* opCtx) {
     stdx::unique_lock<Latch> lk(_mutex);
+    if (_tryAcquire()) {
+        return;
+    }
+
+    _waiting.fetchAndAdd(1);
+    ON_BLOCK_EXIT([&] { _waiting.fetchAndSubtract(1); });
 
     if (opCtx) {
         opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
@@ -196,6 +228,12 @@ void TicketHolder::waitForTicket(OperationContext* opCtx) {
 
 bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
     stdx::unique_lock<Latch> lk(_mutex);
+    if (_tryAcquire()) {
+        return true;
+    }
+
+    _waiting.fetchAndAdd(1);
+    ON_BLOCK_EXIT([&] { _waiting.fetchAndSubtract(1); });
 
     if (opCtx) {
         return opCtx->waitForConditionOrInterruptUntil(
@@ -207,6 +245,7 @@ bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
 }
 
 void TicketHolder::release() {
+    _numReleased.fetchAndAdd(1);
     {
         stdx::lock_guard<Latch> lk(_mutex);
         _num++;
@@ -33,6 +33,7 @@
 #endif
 
 #include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -82,12 +83,35 @@ public:
 
     int outof() const;
 
+    /**
+     * Number of threads currently blocked waiting for a ticket.
+     */
+    int waiting() const {
+        return _waiting.load();
+    }
+
+    /**
+     * Total number of tickets released since this TicketHolder was created. Together with used(),
+     * this allows observers to derive the throughput and the average time for which tickets are
+     * held.
+     */
+    int64_t numReleased() const {
+        return _numReleased.load();
+    }
+
 private:
+    AtomicWord<int> _waiting{0};
+    AtomicWord<int64_t> _numReleased{0};
+
 #if defined(__linux__)
     mutable sem_t _sem;
 
     // You can read _outof without a lock, but have to hold _resizeMutex to change.
     AtomicWord<int> _outof;
+
+    // Tickets which a shrinking resize() could not take out of the semaphore because they were in
+    // use. Released tickets pay this off before going back to the semaphore.
+    AtomicWord<int> _deficit{0};
     Mutex _resizeMutex =
         MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "TicketHolder::_resizeMutex");
 #else
@@ -72,4 +72,53 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+#if defined(__linux__)
+TEST(TicketholderTest, ShrinkingDoesNotWaitForTicketsInUse) {
+    TicketHolder holder(10);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.available(), 0);
+    ASSERT_EQ(holder.used(), 10);
+
+    // The first tickets released go towards the shrink rather than back to the pool.
+    for (int i = 0; i < 5; ++i) {
+        holder.release();
+        ASSERT_EQ(holder.available(), 0);
+    }
+    ASSERT_EQ(holder.used(), 5);
+
+    holder.release();
+    ASSERT_EQ(holder.available(), 1);
+    ASSERT_EQ(holder.used(), 4);
+    ASSERT(holder.tryAcquire());
+
+    // Growing again cancels whatever is still owed before adding new tickets.
+    ASSERT_OK(holder.resize(10));
+    for (int i = 0; i < 5; ++i) {
+        ASSERT(holder.tryAcquire());
+    }
+    ASSERT_OK(holder.resize(5));
+    ASSERT_OK(holder.resize(7));
+    ASSERT_EQ(holder.outof(), 7);
+    ASSERT_EQ(holder.available(), 0);
+    ASSERT_EQ(holder.used(), 10);
+
+    for (int i = 0; i < 3; ++i) {
+        holder.release();
+    }
+    ASSERT_EQ(holder.available(), 0);
+    ASSERT_EQ(holder.used(), 7);
+
+    for (int i = 0; i < 7; ++i) {
+        holder.release();
+    }
+    ASSERT_EQ(holder.available(), 7);
+    ASSERT_EQ(holder.used(), 0);
+}
+#endif
 }  // namespace
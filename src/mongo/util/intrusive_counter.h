@@ -35,6 +35,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/allocator.h"
+#include "mongo/util/arena.h"
 
 namespace mongo {
 
@@ -124,15 +125,16 @@ public:
 #pragma warning(push)
 #pragma warning(disable : 4291)
     void operator delete(void* ptr) {
-        free(ptr);
+        Arena::deallocate(ptr);
     }
 #pragma warning(pop)
 
 private:
     // these can only be created by calling create()
     RCString(){};
+    // Drawn from the current thread's Arena, if any.
     void* operator new(size_t objSize, size_t realSize) {
-        return mongoMalloc(realSize);
+        return Arena::allocate(realSize);
     }
 
     int _size;  // does NOT include trailing NUL byte.